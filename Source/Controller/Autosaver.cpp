@@ -26,8 +26,11 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
 
+#include <wx/stopwatch.h>
+
 namespace TrenchBroom {
     namespace Controller {
         unsigned int backupNoOfFile(const String& path) {
@@ -48,7 +51,12 @@ namespace TrenchBroom {
             return backupNo1 < backupNo2;
         }
         
-        String Autosaver::backupName(const String& mapBasename, unsigned int backupNo) {
+        void AutosaveThread::log(LogLevel level, const String& message) {
+            wxCriticalSectionLocker lock(m_lock);
+            m_messages.push_back(LogMessage(level, message));
+        }
+
+        String AutosaveThread::backupName(const String& mapBasename, unsigned int backupNo) {
             std::stringstream sstream;
             sstream << mapBasename;
             sstream << " ";
@@ -57,7 +65,7 @@ namespace TrenchBroom {
             return sstream.str();
         }
         
-        bool Autosaver::isBackupName(const String& basename, const String& mapBasename, unsigned int& backupNo) {
+        bool AutosaveThread::isBackupName(const String& basename, const String& mapBasename, unsigned int& backupNo) {
             if (basename.length() < mapBasename.length() + 2)
                 return false;
             if (basename.substr(0, mapBasename.length()) != mapBasename)
@@ -70,26 +78,22 @@ namespace TrenchBroom {
             return true;
         }
         
-        void Autosaver::autosave() {
-            const String mapPath = m_document.GetFilename().ToStdString();
-            if (mapPath.empty())
-                return;
-            
+        void AutosaveThread::saveBackup() {
             IO::FileManager fileManager;
-            String basePath = fileManager.deleteLastPathComponent(mapPath);
+            String basePath = fileManager.deleteLastPathComponent(m_mapPath);
             String autosavePath = fileManager.appendPath(basePath, "autosave");
-            String mapFilename = fileManager.pathComponents(mapPath).back();
+            String mapFilename = fileManager.pathComponents(m_mapPath).back();
             String mapBasename = fileManager.deleteExtension(mapFilename);
             
             if (!fileManager.exists(autosavePath)) {
                 if (!fileManager.makeDirectory(autosavePath)) {
-                    m_document.console().error("Cannot create autosave directory at %s", autosavePath.c_str());
+                    log(LLError, "Cannot create autosave directory at " + autosavePath);
                     return;
                 }
                 
-                m_document.console().info("Autosave directory created at %s", autosavePath.c_str());
+                log(LLInfo, "Autosave directory created at " + autosavePath);
             } else if (!fileManager.isDirectory(autosavePath)) {
-                m_document.console().error("Cannot create autosave directory at %s because a file exists at that path", autosavePath.c_str());
+                log(LLError, "Cannot create autosave directory at " + autosavePath + " because a file exists at that path");
                 return;
             }
             
@@ -116,10 +120,10 @@ namespace TrenchBroom {
                 while (backups.size() > m_maxBackups - 1) {
                     const String filePath = fileManager.appendPath(autosavePath, backups.front());
                     if (!fileManager.deleteFile(filePath)) {
-                        m_document.console().error("Cannot delete file %s", filePath.c_str());
+                        log(LLError, "Cannot delete file " + filePath);
                         return;
                     } else {
-                        m_document.console().debug("Deleted file %s", filePath.c_str());
+                        log(LLDebug, "Deleted file " + filePath);
                     }
                     
                     backups.erase(backups.begin());
@@ -134,15 +138,15 @@ namespace TrenchBroom {
                         const String filePath = fileManager.appendPath(autosavePath, filename);
                         const String backupFilePath = fileManager.appendPath(autosavePath, backupFilename);
                         if (fileManager.exists(backupFilePath)) {
-                            m_document.console().error("Cannot move file %s to %s because a file exists at that path", filePath.c_str(), backupFilePath.c_str());
+                            log(LLError, "Cannot move file " + filePath + " to " + backupFilePath + " because a file exists at that path");
                             return;
                         }
                         
                         if (!fileManager.moveFile(filePath, backupFilePath, false)) {
-                            m_document.console().error("Cannot move file %s to %s", filePath.c_str(), backupFilePath.c_str());
+                            log(LLError, "Cannot move file " + filePath + " to " + backupFilePath);
                             return;
                         } else {
-                            m_document.console().debug("Moved file %s to %s", filePath.c_str(), backupFilePath.c_str());
+                            log(LLDebug, "Moved file " + filePath + " to " + backupFilePath);
                         }
                     }
                 }
@@ -158,9 +162,90 @@ namespace TrenchBroom {
             const String backupFilePath = fileManager.appendPath(autosavePath, backupFilename);
             
             wxStopWatch watch;
+            FILE* stream = fopen(backupFilePath.c_str(), "w");
+            if (stream == NULL) {
+                log(LLError, "Cannot open file " + backupFilePath);
+                return;
+            }
+            
+            std::fwrite(m_mapText.data(), 1, m_mapText.size(), stream);
+            fclose(stream);
+            
+            StringStream message;
+            message << "Autosaved to " << backupFilePath << " in " << watch.Time() / 1000.0f << " seconds";
+            log(LLDebug, message.str());
+        }
+        
+        wxThread::ExitCode AutosaveThread::Entry() {
+            saveBackup();
+            
+            wxCriticalSectionLocker lock(m_lock);
+            m_finished = true;
+            return (wxThread::ExitCode)0;
+        }
+
+        AutosaveThread::AutosaveThread(const String& mapPath, String& mapText, unsigned int maxBackups) :
+        wxThread(wxTHREAD_JOINABLE),
+        m_mapPath(mapPath),
+        m_maxBackups(maxBackups),
+        m_finished(false) {
+            m_mapText.swap(mapText);
+        }
+        
+        bool AutosaveThread::finished() const {
+            wxCriticalSectionLocker lock(m_lock);
+            return m_finished;
+        }
+        
+        void AutosaveThread::logMessages(Utility::Console& console) const {
+            wxCriticalSectionLocker lock(m_lock);
+            LogMessageList::const_iterator it, end;
+            for (it = m_messages.begin(), end = m_messages.end(); it != end; ++it) {
+                const LogMessage& message = *it;
+                switch (message.level) {
+                    case LLDebug:
+                        console.debug(message.message);
+                        break;
+                    case LLInfo:
+                        console.info(message.message);
+                        break;
+                    case LLError:
+                        console.error(message.message);
+                        break;
+                }
+            }
+        }
+        
+        bool Autosaver::autosave() {
+            if (m_thread != NULL)
+                return false;
+            
+            const String mapPath = m_document.GetFilename().ToStdString();
+            if (mapPath.empty())
+                return true;
+            
+            // the snapshot mostly consists of text cached by the previous save, so this is cheap
+            String mapText;
             IO::MapWriter mapWriter;
-            mapWriter.writeToFileAtPath(m_document.map(), backupFilePath, true);
-            m_document.console().debug("Autosaved to %s in %f seconds", backupFilePath.c_str(), watch.Time() / 1000.0f);
+            mapWriter.writeToBuffer(m_document.map(), mapText);
+            
+            m_thread = new AutosaveThread(mapPath, mapText, m_maxBackups);
+            if (m_thread->Create() != wxTHREAD_NO_ERROR || m_thread->Run() != wxTHREAD_NO_ERROR) {
+                m_document.console().error("Cannot start autosave thread");
+                delete m_thread;
+                m_thread = NULL;
+            }
+            return true;
+        }
+        
+        void Autosaver::finishAutosave(bool wait) {
+            if (m_thread == NULL || (!wait && !m_thread->finished()))
+                return;
+            
+            m_thread->Wait();
+            m_thread->logMessages(m_document.console());
+            delete m_thread;
+            m_thread = NULL;
         }
         
         Autosaver::Autosaver(Model::MapDocument& document, time_t saveInterval, time_t idleInterval, unsigned int maxBackups) :
@@ -170,13 +255,18 @@ namespace TrenchBroom {
         m_maxBackups(maxBackups),
         m_lastSaveTime(time(NULL)),
         m_lastModificationTime(0),
-        m_dirty(false) {}
+        m_dirty(false),
+        m_thread(NULL) {}
 
         Autosaver::~Autosaver() {
+            finishAutosave(true);
             autosave();
+            finishAutosave(true);
         }
 
         void Autosaver::triggerAutosave() {
+            finishAutosave(false);
+            
             time_t currentTime = time(NULL);
             IO::FileManager fileManager;
             if (fileManager.exists(m_document.GetFilename().ToStdString()) &&
@@ -185,9 +275,10 @@ namespace TrenchBroom {
                 currentTime - m_lastModificationTime >= m_idleInterval &&
                 currentTime - m_lastSaveTime >= m_saveInterval) {
                 
-                autosave();
-                m_lastSaveTime = currentTime;
-                m_dirty = false;
+                if (autosave()) {
+                    m_lastSaveTime = currentTime;
+                    m_dirty = false;
+                }
             }
         }
         
@@ -22,17 +22,72 @@
 
 #include "Utility/String.h"
 
+#include <wx/thread.h>
+
 #include <ctime>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Model {
         class MapDocument;
     }
     
+    namespace Utility {
+        class Console;
+    }
+    
     namespace Controller {
         unsigned int backupNoOfFile(const String& path);
         bool compareByBackupNo(const String& file1, const String& file2);
 
+        /**
+         * Rotates the backups of a map and writes a snapshot of the map text to a new backup file. Since the
+         * console must only be used on the UI thread, all messages are collected and logged once the thread has
+         * finished.
+         */
+        class AutosaveThread : public wxThread {
+        protected:
+            typedef enum {
+                LLDebug,
+                LLInfo,
+                LLError
+            } LogLevel;
+            
+            struct LogMessage {
+                LogLevel level;
+                String message;
+                
+                LogMessage(LogLevel i_level, const String& i_message) :
+                level(i_level),
+                message(i_message) {}
+            };
+            
+            typedef std::vector<LogMessage> LogMessageList;
+            
+            const String m_mapPath;
+            String m_mapText;
+            const unsigned int m_maxBackups;
+            
+            LogMessageList m_messages;
+            bool m_finished;
+            mutable wxCriticalSection m_lock;
+
+            void log(LogLevel level, const String& message);
+            String backupName(const String& mapBasename, unsigned int backupNo);
+            bool isBackupName(const String& basename, const String& mapBasename, unsigned int& backupNo);
+            void saveBackup();
+            
+            ExitCode Entry();
+        public:
+            /**
+             * Takes ownership of the contents of the given map text to avoid copying it on the UI thread.
+             */
+            AutosaveThread(const String& mapPath, String& mapText, unsigned int maxBackups);
+            
+            bool finished() const;
+            void logMessages(Utility::Console& console) const;
+        };
+
         class Autosaver {
         protected:
             Model::MapDocument& m_document;
@@ -44,9 +99,10 @@ namespace TrenchBroom {
             time_t m_lastModificationTime;
             bool m_dirty;
             
-            String backupName(const String& mapBasename, unsigned int backupNo);
-            bool isBackupName(const String& basename, const String& mapBasename, unsigned int& backupNo);
-            void autosave();
+            AutosaveThread* m_thread;
+            
+            bool autosave();
+            void finishAutosave(bool wait);
         public:
             Autosaver(Model::MapDocument& document, time_t saveInterval = 10 * 60, time_t idleInterval = 3, unsigned int maxBackups = 30);
             ~Autosaver();
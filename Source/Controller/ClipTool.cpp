@@ -41,6 +41,7 @@
 #include "Renderer/Shader/ShaderProgram.h"
 #include "View/EditorView.h"
 #include "Utility/Grid.h"
+#include "Utility/Parallel.h"
 #include "Utility/Preferences.h"
 
 namespace TrenchBroom {
@@ -78,11 +79,33 @@ namespace TrenchBroom {
             return sum / static_cast<float>((normals1.size() + normals2.size()));
         }
 
+        class SplitBrushesTask : public Utility::ParallelTask {
+        private:
+            ClipTool::BrushPreviewList& m_previews;
+        public:
+            SplitBrushesTask(ClipTool::BrushPreviewList& previews) :
+            m_previews(previews) {}
+
+            void run(size_t index) {
+                // the front brushes lie below the front face, which is above the back face's boundary
+                ClipTool::BrushPreview& preview = m_previews[index];
+                const Model::BrushGeometry& geometry = preview.brush->geometry();
+                geometry.split(preview.backFace->boundary(), preview.frontFace, preview.backFace, preview.front, preview.back);
+            }
+        };
+
+        void ClipTool::clearPreviews() {
+            BrushPreviewList::iterator it, end;
+            for (it = m_previews.begin(), end = m_previews.end(); it != end; ++it) {
+                delete it->frontFace;
+                delete it->backFace;
+            }
+            m_previews.clear();
+            m_validPlane = false;
+        }
+
         void ClipTool::updateBrushes() {
-            m_frontBrushes.clear();
-            m_backBrushes.clear();
-            
-            Model::BrushList allFrontBrushes, allBackBrushes;
+            clearPreviews();
             
             Renderer::Camera& camera = view().camera();
             Vec3f planePoints[3];
@@ -141,10 +164,10 @@ namespace TrenchBroom {
                 const bool forceIntegerFacePoints = document().map().forceIntegerFacePoints();
                 const String textureName = document().mruTexture() != NULL ? document().mruTexture()->name() : Model::Texture::Empty;
                 
+                m_previews.reserve(brushes.size());
                 Model::BrushList::const_iterator brushIt, brushEnd;
                 for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
                     Model::Brush& brush = **brushIt;
-                    Model::Entity* entity = brush.entity();
                     Model::Face* frontFace = new Model::Face(worldBounds, forceIntegerFacePoints, planePoints[0], planePoints[1], planePoints[2], textureName);
                     Model::Face* backFace = new Model::Face(worldBounds, forceIntegerFacePoints, planePoints[0], planePoints[2], planePoints[1], textureName);
                     
@@ -173,29 +196,54 @@ namespace TrenchBroom {
                     frontFace->setAttributes(*bestFrontFace);
                     backFace->setAttributes(*bestBackFace);
                     
-                    Model::Brush* frontBrush = new Model::Brush(worldBounds, forceIntegerFacePoints, brush);
-                    if (frontBrush->clip(*frontFace)) {
-                        m_frontBrushes[entity].push_back(frontBrush);
-                        allFrontBrushes.push_back(frontBrush);
-                    } else {
-                        delete frontBrush;
-                    }
-                    
-                    Model::Brush* backBrush = new Model::Brush(worldBounds, forceIntegerFacePoints, brush);
-                    if (backBrush->clip(*backFace)) {
-                        m_backBrushes[entity].push_back(backBrush);
-                        allBackBrushes.push_back(backBrush);
-                    } else {
-                        delete backBrush;
-                    }
+                    m_previews.push_back(BrushPreview(&brush, frontFace, backFace));
+                }
+                
+                SplitBrushesTask task(m_previews);
+                Utility::runParallel(task, m_previews.size());
+                m_validPlane = true;
+                
+                Renderer::BrushFigure::BrushPartList frontParts, backParts;
+                BrushPreviewList::const_iterator previewIt, previewEnd;
+                for (previewIt = m_previews.begin(), previewEnd = m_previews.end(); previewIt != previewEnd; ++previewIt) {
+                    const BrushPreview& preview = *previewIt;
+                    if (!preview.front.empty())
+                        frontParts.push_back(Renderer::BrushFigure::BrushPart(preview.brush, &preview.front));
+                    if (!preview.back.empty())
+                        backParts.push_back(Renderer::BrushFigure::BrushPart(preview.brush, &preview.back));
                 }
+                
+                m_frontBrushFigure->setBrushParts(frontParts);
+                m_backBrushFigure->setBrushParts(backParts);
             } else {
-                allFrontBrushes = brushes;
-                m_frontBrushes = entityBrushes(allFrontBrushes);
+                m_frontBrushFigure->setBrushes(brushes);
+                m_backBrushFigure->setBrushes(Model::EmptyBrushList);
             }
-
-            m_frontBrushFigure->setBrushes(allFrontBrushes);
-            m_backBrushFigure->setBrushes(allBackBrushes);
+        }
+        
+        Model::EntityBrushesMap ClipTool::createBrushes(bool front) {
+            if (!m_validPlane)
+                return front ? Model::entityBrushes(document().editStateManager().selectedBrushes()) : Model::EntityBrushesMap();
+            
+            const BBoxf& worldBounds = document().map().worldBounds();
+            const bool forceIntegerFacePoints = document().map().forceIntegerFacePoints();
+            
+            Model::EntityBrushesMap result;
+            BrushPreviewList::const_iterator it, end;
+            for (it = m_previews.begin(), end = m_previews.end(); it != end; ++it) {
+                const BrushPreview& preview = *it;
+                if ((front ? preview.front : preview.back).empty())
+                    continue;
+                
+                Model::Brush* brush = new Model::Brush(worldBounds, forceIntegerFacePoints, *preview.brush);
+                Model::Face* face = new Model::Face(worldBounds, forceIntegerFacePoints, front ? *preview.frontFace : *preview.backFace);
+                if (brush->clip(*face))
+                    result[preview.brush->entity()].push_back(brush);
+                else
+                    delete brush;
+            }
+            
+            return result;
         }
         
         Vec3f::List ClipTool::getNormals(const Vec3f& hitPoint, const Model::Face& hitFace) const {
@@ -271,6 +319,7 @@ namespace TrenchBroom {
         }
         
         bool ClipTool::handleDeactivate(InputState& inputState) {
+            clearPreviews();
             deleteFigure(m_frontBrushFigure);
             m_frontBrushFigure = NULL;
             deleteFigure(m_backBrushFigure);
@@ -570,6 +619,7 @@ namespace TrenchBroom {
         m_hitIndex(-1),
         m_directHit(false),
         m_clipSide(CMFront),
+        m_validPlane(false),
         m_frontBrushFigure(NULL),
         m_backBrushFigure(NULL) {}
         
@@ -604,13 +654,13 @@ namespace TrenchBroom {
             Model::EntityBrushesMap addBrushes;
             switch (m_clipSide) {
                 case CMFront:
-                    addBrushes = m_frontBrushes;
+                    addBrushes = createBrushes(true);
                     break;
                 case CMBack:
-                    addBrushes = m_backBrushes;
+                    addBrushes = createBrushes(false);
                     break;
                 default:
-                    addBrushes = mergeEntityBrushes(m_frontBrushes, m_backBrushes);
+                    addBrushes = mergeEntityBrushes(createBrushes(true), createBrushes(false));
                     break;
             }
             
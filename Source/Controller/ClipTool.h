@@ -21,10 +21,12 @@
 #define __TrenchBroom__ClipTool__
 
 #include "Controller/Tool.h"
+#include "Model/BrushGeometry.h"
 #include "Model/Filter.h"
 #include "Utility/VecMath.h"
 
 #include <cassert>
+#include <vector>
 
 using namespace TrenchBroom::VecMath;
 
@@ -67,6 +69,27 @@ namespace TrenchBroom {
                 CMBack,
                 CMBoth
             } ClipSide;
+
+
+            /**
+             * The parts of a selected brush that would remain after clipping it. The brushes are only created from
+             * the faces when the clip is performed.
+             */
+            class BrushPreview {
+            public:
+                Model::Brush* brush;
+                Model::Face* frontFace;
+                Model::Face* backFace;
+                Model::SplitGeometry front;
+                Model::SplitGeometry back;
+
+                BrushPreview(Model::Brush* i_brush, Model::Face* i_frontFace, Model::Face* i_backFace) :
+                brush(i_brush),
+                frontFace(i_frontFace),
+                backFace(i_backFace) {}
+            };
+
+            typedef std::vector<BrushPreview> BrushPreviewList;
         private:
             class ClipFilter : public Model::Filter {
             protected:
@@ -104,13 +127,15 @@ namespace TrenchBroom {
             bool m_directHit;
             
             ClipSide m_clipSide;
-            Model::EntityBrushesMap m_frontBrushes;
-            Model::EntityBrushesMap m_backBrushes;
+            bool m_validPlane;
+            BrushPreviewList m_previews;
             Renderer::BrushFigure* m_frontBrushFigure;
             Renderer::BrushFigure* m_backBrushFigure;
             
             Vec3f selectNormal(const Vec3f::List& normals1, const Vec3f::List& normals2) const;
+            void clearPreviews();
             void updateBrushes();
+            Model::EntityBrushesMap createBrushes(bool front);
             Vec3f::List getNormals(const Vec3f& hitPoint, const Model::Face& hitFace) const;
             bool isPointIdenticalWithExistingPoint(const Vec3f& point) const;
             bool isPointLinearlyDependent(const Vec3f& point) const;
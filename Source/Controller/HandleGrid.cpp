@@ -0,0 +1,121 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HandleGrid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace TrenchBroom {
+    namespace Controller {
+        void HandleGrid::collectCells(const Cell& center, int extent, CellSet& visitedCells, Vec3f::List& result) const {
+            for (int x = center.x - extent; x <= center.x + extent; x++) {
+                for (int y = center.y - extent; y <= center.y + extent; y++) {
+                    for (int z = center.z - extent; z <= center.z + extent; z++) {
+                        const Cell current(x, y, z);
+                        if (!visitedCells.insert(current).second)
+                            continue;
+
+                        CellMap::const_iterator it = m_cells.find(current);
+                        if (it != m_cells.end())
+                            result.insert(result.end(), it->second.begin(), it->second.end());
+                    }
+                }
+            }
+        }
+
+        HandleGrid::HandleGrid(float cellSize) :
+        m_cellSize(cellSize) {
+            assert(m_cellSize > 0.0f);
+        }
+
+        void HandleGrid::insert(const Vec3f& position) {
+            m_cells[cell(position)].push_back(position);
+        }
+
+        void HandleGrid::remove(const Vec3f& position) {
+            CellMap::iterator cellIt = m_cells.find(cell(position));
+            if (cellIt == m_cells.end())
+                return;
+
+            Vec3f::List& positions = cellIt->second;
+            Vec3f::List::iterator positionIt = std::find(positions.begin(), positions.end(), position);
+            if (positionIt == positions.end())
+                return;
+
+            *positionIt = positions.back();
+            positions.pop_back();
+            if (positions.empty())
+                m_cells.erase(cellIt);
+        }
+
+        void HandleGrid::clear() {
+            m_cells.clear();
+        }
+
+        void HandleGrid::query(const Rayf& ray, float maxDistance, float radius, Vec3f::List& result) const {
+            if (m_cells.empty())
+                return;
+
+            // every cell that contains a position close enough to the ray is within this many cells of a cell that
+            // the ray passes through
+            const int extent = static_cast<int>(std::ceil(radius / m_cellSize));
+            const float infinity = std::numeric_limits<float>::max();
+
+            // walk the cells along the ray, see Amanatides and Woo, "A Fast Voxel Traversal Algorithm for Ray Tracing"
+            int current[3] = { cellCoordinate(ray.origin.x()), cellCoordinate(ray.origin.y()), cellCoordinate(ray.origin.z()) };
+            int step[3];
+            float nextBoundary[3];
+            float boundaryDelta[3];
+            for (size_t i = 0; i < 3; i++) {
+                const float direction = ray.direction[i];
+                if (direction > 0.0f) {
+                    step[i] = 1;
+                    nextBoundary[i] = (static_cast<float>(current[i] + 1) * m_cellSize - ray.origin[i]) / direction;
+                    boundaryDelta[i] = m_cellSize / direction;
+                } else if (direction < 0.0f) {
+                    step[i] = -1;
+                    nextBoundary[i] = (static_cast<float>(current[i]) * m_cellSize - ray.origin[i]) / direction;
+                    boundaryDelta[i] = -m_cellSize / direction;
+                } else {
+                    step[i] = 0;
+                    nextBoundary[i] = infinity;
+                    boundaryDelta[i] = infinity;
+                }
+            }
+
+            CellSet visitedCells;
+            while (true) {
+                collectCells(Cell(current[0], current[1], current[2]), extent, visitedCells, result);
+
+                size_t axis = 0;
+                if (nextBoundary[1] < nextBoundary[axis])
+                    axis = 1;
+                if (nextBoundary[2] < nextBoundary[axis])
+                    axis = 2;
+                if (nextBoundary[axis] > maxDistance)
+                    break;
+
+                current[axis] += step[axis];
+                nextBoundary[axis] += boundaryDelta[axis];
+            }
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__HandleGrid__
+#define __TrenchBroom__HandleGrid__
+
+#include "Utility/VecMath.h"
+
+#include <cmath>
+#include <vector>
+
+#if defined _WIN32
+#include <unordered_map>
+#include <unordered_set>
+#else
+#include <tr1/unordered_map>
+#include <tr1/unordered_set>
+#endif
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Controller {
+        /**
+         * Sorts handle positions into the cells of a uniform grid so that picking only needs to test the handles
+         * in the cells along the pick ray instead of all handles. The cells are kept in a hash map, so the grid is
+         * unbounded and empty cells do not take up any memory.
+         */
+        class HandleGrid {
+        private:
+            class Cell {
+            public:
+                int x;
+                int y;
+                int z;
+
+                Cell(int i_x, int i_y, int i_z) :
+                x(i_x),
+                y(i_y),
+                z(i_z) {}
+
+                inline bool operator==(const Cell& other) const {
+                    return x == other.x && y == other.y && z == other.z;
+                }
+            };
+
+            class CellHash {
+            public:
+                inline size_t operator()(const Cell& cell) const {
+                    return (static_cast<size_t>(cell.x) * 73856093u) ^ (static_cast<size_t>(cell.y) * 19349663u) ^ (static_cast<size_t>(cell.z) * 83492791u);
+                }
+            };
+
+            typedef std::tr1::unordered_map<Cell, Vec3f::List, CellHash> CellMap;
+            typedef std::tr1::unordered_set<Cell, CellHash> CellSet;
+
+            float m_cellSize;
+            CellMap m_cells;
+
+            inline int cellCoordinate(float value) const {
+                return static_cast<int>(std::floor(value / m_cellSize));
+            }
+
+            inline Cell cell(const Vec3f& position) const {
+                return Cell(cellCoordinate(position.x()), cellCoordinate(position.y()), cellCoordinate(position.z()));
+            }
+
+            void collectCells(const Cell& center, int extent, CellSet& visitedCells, Vec3f::List& result) const;
+        public:
+            HandleGrid(float cellSize = 64.0f);
+
+            void insert(const Vec3f& position);
+            void remove(const Vec3f& position);
+            void clear();
+
+            inline bool empty() const {
+                return m_cells.empty();
+            }
+
+            /**
+             * Collects the positions which may be closer than the given radius to the part of the given ray that
+             * lies within the given distance of its origin. The result may contain positions that are farther away,
+             * but it contains every position that is close enough.
+             */
+            void query(const Rayf& ray, float maxDistance, float radius, Vec3f::List& result) const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__HandleGrid__) */
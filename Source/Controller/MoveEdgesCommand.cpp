@@ -17,6 +17,7 @@
  along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "Controller/ParallelBrushOperation.h"
 #include "Controller/VertexHandleManager.h"
 #include "MoveEdgesCommand.h"
 #include "Model/Brush.h"
@@ -26,6 +27,24 @@
 
 namespace TrenchBroom {
     namespace Controller {
+        class MoveEdgesOperation {
+        private:
+            const Vec3f& m_delta;
+        public:
+            typedef Model::EdgeInfoList Result;
+            
+            MoveEdgesOperation(const Vec3f& delta) :
+            m_delta(delta) {}
+            
+            inline bool canApply(const Model::Brush& brush, const Model::EdgeInfoList& edgeInfos) const {
+                return brush.canMoveEdges(edgeInfos, m_delta);
+            }
+            
+            inline Result apply(Model::Brush& brush, const Model::EdgeInfoList& edgeInfos) const {
+                return brush.moveEdges(edgeInfos, m_delta);
+            }
+        };
+
         bool MoveEdgesCommand::performDo() {
             if (!canDo())
                 return false;
@@ -35,13 +54,9 @@ namespace TrenchBroom {
             document().brushesWillChange(m_brushes);
             m_edgesAfter.clear();
             
-            Model::BrushEdgesMap::const_iterator it, end;
-            for (it = m_brushEdges.begin(), end = m_brushEdges.end(); it != end; ++it) {
-                Model::Brush* brush = it->first;
-                const Model::EdgeInfoList& edgeInfos = it->second;
-                const Model::EdgeInfoList newEdgeInfos = brush->moveEdges(edgeInfos, m_delta);
-                m_edgesAfter.insert(m_edgesAfter.end(), newEdgeInfos.begin(), newEdgeInfos.end());
-            }
+            // the brushes are independent of each other, but the new edges are collected in the original order
+            ParallelBrushOperation<Model::BrushEdgesMap, MoveEdgesOperation> operation(m_brushEdges, MoveEdgesOperation(m_delta));
+            operation.apply(m_brushes, m_edgesAfter);
 
             document().brushesDidChange(m_brushes);
             m_handleManager.add(m_brushes);
@@ -92,14 +107,8 @@ namespace TrenchBroom {
         }
 
         bool MoveEdgesCommand::canDo() const {
-            Model::BrushEdgesMap::const_iterator it, end;
-            for (it = m_brushEdges.begin(), end = m_brushEdges.end(); it != end; ++it) {
-                Model::Brush* brush = it->first;
-                const Model::EdgeInfoList& edges = it->second;
-                if (!brush->canMoveEdges(edges, m_delta))
-                    return false;
-            }
-            return true;
+            ParallelBrushOperation<Model::BrushEdgesMap, MoveEdgesOperation> operation(m_brushEdges, MoveEdgesOperation(m_delta));
+            return operation.canApply();
         }
     }
 }
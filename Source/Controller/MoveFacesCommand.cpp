@@ -17,6 +17,7 @@
  along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "Controller/ParallelBrushOperation.h"
 #include "Controller/VertexHandleManager.h"
 #include "MoveFacesCommand.h"
 #include "Model/Brush.h"
@@ -25,6 +26,24 @@
 
 namespace TrenchBroom {
     namespace Controller {
+        class MoveFacesOperation {
+        private:
+            const Vec3f& m_delta;
+        public:
+            typedef Model::FaceInfoList Result;
+            
+            MoveFacesOperation(const Vec3f& delta) :
+            m_delta(delta) {}
+            
+            inline bool canApply(const Model::Brush& brush, const Model::FaceInfoList& faceInfos) const {
+                return brush.canMoveFaces(faceInfos, m_delta);
+            }
+            
+            inline Result apply(Model::Brush& brush, const Model::FaceInfoList& faceInfos) const {
+                return brush.moveFaces(faceInfos, m_delta);
+            }
+        };
+
         bool MoveFacesCommand::performDo() {
             if (!canDo())
                 return false;
@@ -34,13 +53,9 @@ namespace TrenchBroom {
             document().brushesWillChange(m_brushes);
             m_facesAfter.clear();
 
-            Model::BrushFacesMap::const_iterator it, end;
-            for (it = m_brushFaces.begin(), end = m_brushFaces.end(); it != end; ++it) {
-                Model::Brush* brush = it->first;
-                const Model::FaceInfoList& faceInfos = it->second;
-                const Model::FaceInfoList newFaces = brush->moveFaces(faceInfos, m_delta);
-                m_facesAfter.insert(m_facesAfter.end(), newFaces.begin(), newFaces.end());
-            }
+            // the brushes are independent of each other, but the new faces are collected in the original order
+            ParallelBrushOperation<Model::BrushFacesMap, MoveFacesOperation> operation(m_brushFaces, MoveFacesOperation(m_delta));
+            operation.apply(m_brushes, m_facesAfter);
 
             document().brushesDidChange(m_brushes);
             m_handleManager.add(m_brushes);
@@ -91,14 +106,8 @@ namespace TrenchBroom {
         }
 
         bool MoveFacesCommand::canDo() const {
-            Model::BrushFacesMap::const_iterator it, end;
-            for (it = m_brushFaces.begin(), end = m_brushFaces.end(); it != end; ++it) {
-                Model::Brush* brush = it->first;
-                const Model::FaceInfoList& faces = it->second;
-                if (!brush->canMoveFaces(faces, m_delta))
-                    return false;
-            }
-            return true;
+            ParallelBrushOperation<Model::BrushFacesMap, MoveFacesOperation> operation(m_brushFaces, MoveFacesOperation(m_delta));
+            return operation.canApply();
         }
     }
 }
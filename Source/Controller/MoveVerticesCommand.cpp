@@ -19,6 +19,7 @@
 
 #include "MoveVerticesCommand.h"
 
+#include "Controller/ParallelBrushOperation.h"
 #include "Controller/VertexHandleManager.h"
 #include "Model/Brush.h"
 #include "Model/BrushGeometry.h"
@@ -29,6 +30,24 @@
 
 namespace TrenchBroom {
     namespace Controller {
+        class MoveVerticesOperation {
+        private:
+            const Vec3f& m_delta;
+        public:
+            typedef Vec3f::List Result;
+            
+            MoveVerticesOperation(const Vec3f& delta) :
+            m_delta(delta) {}
+            
+            inline bool canApply(const Model::Brush& brush, const Vec3f::List& vertexPositions) const {
+                return brush.canMoveVertices(vertexPositions, m_delta);
+            }
+            
+            inline Result apply(Model::Brush& brush, const Vec3f::List& vertexPositions) const {
+                return brush.moveVertices(vertexPositions, m_delta);
+            }
+        };
+
         bool MoveVerticesCommand::performDo() {
             if (!canDo())
                 return false;
@@ -38,14 +57,9 @@ namespace TrenchBroom {
             document().brushesWillChange(m_brushes);
             m_verticesAfter.clear();
 
-            BrushVerticesMap::const_iterator mapIt, mapEnd;
-            for (mapIt = m_brushVertices.begin(), mapEnd = m_brushVertices.end(); mapIt != mapEnd; ++mapIt) {
-                Model::Brush* brush = mapIt->first;
-                const Vec3f::List& oldVertexPositions = mapIt->second;
-                const Vec3f::List newVertexPositions = brush->moveVertices(oldVertexPositions, m_delta);
-                
-                m_verticesAfter.insert(newVertexPositions.begin(), newVertexPositions.end());
-            }
+            // the brushes are independent of each other, but the new vertices are collected in the original order
+            ParallelBrushOperation<BrushVerticesMap, MoveVerticesOperation> operation(m_brushVertices, MoveVerticesOperation(m_delta));
+            operation.apply(m_brushes, m_verticesAfter);
             
             document().brushesDidChange(m_brushes);
             m_handleManager.add(m_brushes);
@@ -94,14 +108,8 @@ namespace TrenchBroom {
         }
 
         bool MoveVerticesCommand::canDo() const {
-            BrushVerticesMap::const_iterator it, end;
-            for (it = m_brushVertices.begin(), end = m_brushVertices.end(); it != end; ++it) {
-                Model::Brush* brush = it->first;
-                const Vec3f::List& vertices = it->second;
-                if (!brush->canMoveVertices(vertices, m_delta))
-                    return false;
-            }
-            return true;
+            ParallelBrushOperation<BrushVerticesMap, MoveVerticesOperation> operation(m_brushVertices, MoveVerticesOperation(m_delta));
+            return operation.canApply();
         }
 
         bool MoveVerticesCommand::hasRemainingVertices() const {
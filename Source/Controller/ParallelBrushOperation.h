@@ -0,0 +1,164 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__ParallelBrushOperation__
+#define __TrenchBroom__ParallelBrushOperation__
+
+#include "Model/Brush.h"
+#include "Model/BrushTypes.h"
+#include "Model/Entity.h"
+#include "Model/EntityTypes.h"
+#include "Utility/Parallel.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Controller {
+        /**
+         * Keeps the given brushes from invalidating the geometry of their entities while they are changed on the
+         * worker threads, because brushes of the same entity would otherwise write to it concurrently. The affected
+         * entities are invalidated once on the calling thread when the guard goes out of scope.
+         */
+        class DeferEntityInvalidation {
+        private:
+            const Model::BrushList& m_brushes;
+            
+            // prevent copying
+            DeferEntityInvalidation(const DeferEntityInvalidation& other);
+            void operator= (const DeferEntityInvalidation& other);
+        public:
+            DeferEntityInvalidation(const Model::BrushList& brushes) :
+            m_brushes(brushes) {
+                Model::BrushList::const_iterator it, end;
+                for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it)
+                    (*it)->setDeferEntityInvalidation(true);
+            }
+            
+            ~DeferEntityInvalidation() {
+                Model::EntitySet entities;
+                Model::BrushList::const_iterator it, end;
+                for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it) {
+                    Model::Brush& brush = **it;
+                    brush.setDeferEntityInvalidation(false);
+                    if (brush.entity() != NULL)
+                        entities.insert(brush.entity());
+                }
+                
+                Model::EntitySet::const_iterator entityIt, entityEnd;
+                for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt)
+                    (*entityIt)->invalidateGeometry();
+            }
+        };
+        
+        /**
+         * Applies an operation to every brush of a map from brushes to the vertices, edges or faces to change. An
+         * operation provides the type Result and the following members:
+         *
+         * bool canApply(const Model::Brush& brush, const Infos& infos) const;
+         * Result apply(Model::Brush& brush, const Infos& infos) const;
+         *
+         * The brushes are processed on the worker threads, so an operation must only touch the given brush. The
+         * results are merged in the order of the map, so they do not depend on how the brushes were scheduled.
+         */
+        template <class BrushMap, class Operation>
+        class ParallelBrushOperation {
+        private:
+            typedef std::vector<typename BrushMap::const_iterator> EntryList;
+            typedef typename Operation::Result Result;
+            typedef std::vector<Result> ResultList;
+            
+            class CanApplyTask : public Utility::ParallelTask {
+            private:
+                const EntryList& m_entries;
+                const Operation& m_operation;
+                std::vector<char>& m_results;
+            public:
+                CanApplyTask(const EntryList& entries, const Operation& operation, std::vector<char>& results) :
+                m_entries(entries),
+                m_operation(operation),
+                m_results(results) {}
+                
+                void run(size_t index) {
+                    m_results[index] = m_operation.canApply(*m_entries[index]->first, m_entries[index]->second);
+                }
+            };
+            
+            class ApplyTask : public Utility::ParallelTask {
+            private:
+                const EntryList& m_entries;
+                const Operation& m_operation;
+                ResultList& m_results;
+            public:
+                ApplyTask(const EntryList& entries, const Operation& operation, ResultList& results) :
+                m_entries(entries),
+                m_operation(operation),
+                m_results(results) {}
+                
+                void run(size_t index) {
+                    m_results[index] = m_operation.apply(*m_entries[index]->first, m_entries[index]->second);
+                }
+            };
+            
+            const BrushMap& m_brushMap;
+            Operation m_operation;
+            EntryList m_entries;
+        public:
+            ParallelBrushOperation(const BrushMap& brushMap, const Operation& operation) :
+            m_brushMap(brushMap),
+            m_operation(operation) {
+                m_entries.reserve(m_brushMap.size());
+                typename BrushMap::const_iterator it, end;
+                for (it = m_brushMap.begin(), end = m_brushMap.end(); it != end; ++it)
+                    m_entries.push_back(it);
+            }
+            
+            bool canApply() const {
+                std::vector<char> results(m_entries.size(), 0);
+                CanApplyTask task(m_entries, m_operation, results);
+                Utility::runParallel(task, m_entries.size());
+                
+                for (size_t i = 0; i < results.size(); i++)
+                    if (!results[i])
+                        return false;
+                return true;
+            }
+            
+            /**
+             * Applies the operation to the brushes, which must be the keys of the map, and inserts the elements of
+             * the results into the given collection.
+             */
+            template <class Collection>
+            void apply(const Model::BrushList& brushes, Collection& collection) const {
+                ResultList results(m_entries.size());
+                {
+                    DeferEntityInvalidation deferEntityInvalidation(brushes);
+                    ApplyTask task(m_entries, m_operation, results);
+                    Utility::runParallel(task, m_entries.size());
+                }
+                
+                for (size_t i = 0; i < results.size(); i++)
+                    std::copy(results[i].begin(), results[i].end(), std::inserter(collection, collection.end()));
+            }
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__ParallelBrushOperation__) */
@@ -19,20 +19,29 @@
 
 #include "RebuildBrushGeometryCommand.h"
 
+#include "Controller/ParallelBrushOperation.h"
 #include "Model/Brush.h"
+#include "Utility/Parallel.h"
 
 #include <cassert>
 
 namespace TrenchBroom {
     namespace Controller {
+        class RebuildGeometryFunction {
+        public:
+            inline void operator()(Model::Brush* brush) const {
+                brush->rebuildGeometry();
+            }
+        };
+
         bool RebuildBrushGeometryCommand::performDo() {
             makeSnapshots(m_brushes);
             document().brushesWillChange(m_brushes);
             
-            Model::BrushList::const_iterator it, end;
-            for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it) {
-                Model::Brush& brush = **it;
-                brush.rebuildGeometry();
+            {
+                DeferEntityInvalidation deferEntityInvalidation(m_brushes);
+                RebuildGeometryFunction rebuildGeometry;
+                Utility::parallelForEach(m_brushes, rebuildGeometry);
             }
             document().brushesDidChange(m_brushes);
             return true;
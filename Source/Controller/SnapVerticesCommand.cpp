@@ -19,23 +19,37 @@
 
 #include "SnapVerticesCommand.h"
 
+#include "Controller/ParallelBrushOperation.h"
 #include "Model/Brush.h"
 #include "Utility/Grid.h"
+#include "Utility/Parallel.h"
 
 namespace TrenchBroom {
     namespace Controller {
+        class SnapVerticesFunction {
+        private:
+            unsigned int m_snapTo;
+        public:
+            SnapVerticesFunction(unsigned int snapTo) :
+            m_snapTo(snapTo) {}
+
+            inline void operator()(Model::Brush* brush) const {
+                if (m_snapTo == 0)
+                    brush->correct(0.01f);
+                else
+                    brush->snap(m_snapTo);
+            }
+        };
+
         bool SnapVerticesCommand::performDo() {
             
             makeSnapshots(m_brushes);
             document().brushesWillChange(m_brushes);
             
-            Model::BrushList::const_iterator it, end;
-            for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it) {
-                Model::Brush& brush = **it;
-                if (m_snapTo == 0)
-                    brush.correct(0.01f);
-                else
-                    brush.snap(m_snapTo);
+            {
+                DeferEntityInvalidation deferEntityInvalidation(m_brushes);
+                SnapVerticesFunction snapVertices(m_snapTo);
+                Utility::parallelForEach(m_brushes, snapVertices);
             }
             
             document().brushesDidChange(m_brushes);
@@ -19,6 +19,7 @@
 
 #include "SplitEdgesCommand.h"
 
+#include "Controller/ParallelBrushOperation.h"
 #include "Controller/VertexHandleManager.h"
 #include "Model/Brush.h"
 #include "Model/BrushGeometry.h"
@@ -26,6 +27,32 @@
 
 namespace TrenchBroom {
     namespace Controller {
+        class SplitEdgesOperation {
+        private:
+            const Vec3f& m_delta;
+        public:
+            typedef Vec3f::List Result;
+            
+            SplitEdgesOperation(const Vec3f& delta) :
+            m_delta(delta) {}
+            
+            inline bool canApply(const Model::Brush& brush, const Model::EdgeInfoList& edgeInfos) const {
+                Model::EdgeInfoList::const_iterator it, end;
+                for (it = edgeInfos.begin(), end = edgeInfos.end(); it != end; ++it)
+                    if (!brush.canSplitEdge(*it, m_delta))
+                        return false;
+                return true;
+            }
+            
+            inline Result apply(Model::Brush& brush, const Model::EdgeInfoList& edgeInfos) const {
+                Result newVertexPositions;
+                Model::EdgeInfoList::const_iterator it, end;
+                for (it = edgeInfos.begin(), end = edgeInfos.end(); it != end; ++it)
+                    newVertexPositions.push_back(brush.splitEdge(*it, m_delta));
+                return newVertexPositions;
+            }
+        };
+
         bool SplitEdgesCommand::performDo() {
             if (!canDo())
                 return false;
@@ -35,17 +62,9 @@ namespace TrenchBroom {
             document().brushesWillChange(m_brushes);
             m_verticesAfter.clear();
 
-            Model::BrushEdgesMap::const_iterator bIt, bEnd;
-            for (bIt = m_brushEdges.begin(), bEnd = m_brushEdges.end(); bIt != bEnd; ++bIt) {
-                Model::Brush* brush = bIt->first;
-                const Model::EdgeInfoList& edgeInfos = bIt->second;
-                Model::EdgeInfoList::const_iterator eIt, eEnd;
-                for (eIt = edgeInfos.begin(), eEnd = edgeInfos.end(); eIt != eEnd; ++eIt) {
-                    const Model::EdgeInfo& edgeInfo = *eIt;
-                    const Vec3f newVertexPosition = brush->splitEdge(edgeInfo, m_delta);
-                    m_verticesAfter.insert(newVertexPosition);
-                }
-            }
+            // the edges of one brush are split in order, but the brushes are independent of each other
+            ParallelBrushOperation<Model::BrushEdgesMap, SplitEdgesOperation> operation(m_brushEdges, SplitEdgesOperation(m_delta));
+            operation.apply(m_brushes, m_verticesAfter);
 
             document().brushesDidChange(m_brushes);
             m_handleManager.add(m_brushes);
@@ -93,18 +112,8 @@ namespace TrenchBroom {
         }
 
         bool SplitEdgesCommand::canDo() const {
-            Model::BrushEdgesMap::const_iterator bIt, bEnd;
-            for (bIt = m_brushEdges.begin(), bEnd = m_brushEdges.end(); bIt != bEnd; ++bIt) {
-                Model::Brush* brush = bIt->first;
-                const Model::EdgeInfoList& edgeInfos = bIt->second;
-                Model::EdgeInfoList::const_iterator eIt, eEnd;
-                for (eIt = edgeInfos.begin(), eEnd = edgeInfos.end(); eIt != eEnd; ++eIt) {
-                    const Model::EdgeInfo& edgeInfo = *eIt;
-                    if (!brush->canSplitEdge(edgeInfo, m_delta))
-                        return false;
-                }
-            }
-            return true;
+            ParallelBrushOperation<Model::BrushEdgesMap, SplitEdgesOperation> operation(m_brushEdges, SplitEdgesOperation(m_delta));
+            return operation.canApply();
         }
     }
 }
@@ -19,6 +19,7 @@
 
 #include "SplitFacesCommand.h"
 
+#include "Controller/ParallelBrushOperation.h"
 #include "Controller/VertexHandleManager.h"
 #include "Model/Brush.h"
 #include "Model/BrushGeometry.h"
@@ -26,6 +27,32 @@
 
 namespace TrenchBroom {
     namespace Controller {
+        class SplitFacesOperation {
+        private:
+            const Vec3f& m_delta;
+        public:
+            typedef Vec3f::List Result;
+            
+            SplitFacesOperation(const Vec3f& delta) :
+            m_delta(delta) {}
+            
+            inline bool canApply(const Model::Brush& brush, const Model::FaceInfoList& faceInfos) const {
+                Model::FaceInfoList::const_iterator it, end;
+                for (it = faceInfos.begin(), end = faceInfos.end(); it != end; ++it)
+                    if (!brush.canSplitFace(*it, m_delta))
+                        return false;
+                return true;
+            }
+            
+            inline Result apply(Model::Brush& brush, const Model::FaceInfoList& faceInfos) const {
+                Result newVertexPositions;
+                Model::FaceInfoList::const_iterator it, end;
+                for (it = faceInfos.begin(), end = faceInfos.end(); it != end; ++it)
+                    newVertexPositions.push_back(brush.splitFace(*it, m_delta));
+                return newVertexPositions;
+            }
+        };
+
         bool SplitFacesCommand::performDo() {
             if (!canDo())
                 return false;
@@ -35,17 +62,9 @@ namespace TrenchBroom {
             document().brushesWillChange(m_brushes);
             m_verticesAfter.clear();
 
-            Model::BrushFacesMap::const_iterator bIt, bEnd;
-            for (bIt = m_brushFaces.begin(), bEnd = m_brushFaces.end(); bIt != bEnd; ++bIt) {
-                Model::Brush* brush = bIt->first;
-                const Model::FaceInfoList& faceInfos = bIt->second;
-                Model::FaceInfoList::const_iterator fIt, fEnd;
-                for (fIt = faceInfos.begin(), fEnd = faceInfos.end(); fIt != fEnd; ++fIt) {
-                    const Model::FaceInfo& faceInfo = *fIt;
-                    Vec3f newVertexPosition = brush->splitFace(faceInfo, m_delta);
-                    m_verticesAfter.insert(newVertexPosition);
-                }
-            }
+            // the faces of one brush are split in order, but the brushes are independent of each other
+            ParallelBrushOperation<Model::BrushFacesMap, SplitFacesOperation> operation(m_brushFaces, SplitFacesOperation(m_delta));
+            operation.apply(m_brushes, m_verticesAfter);
 
             document().brushesDidChange(m_brushes);
             m_handleManager.add(m_brushes);
@@ -96,18 +115,8 @@ namespace TrenchBroom {
         }
 
         bool SplitFacesCommand::canDo() const {
-            Model::BrushFacesMap::const_iterator bIt, bEnd;
-            for (bIt = m_brushFaces.begin(), bEnd = m_brushFaces.end(); bIt != bEnd; ++bIt) {
-                Model::Brush* brush = bIt->first;
-                const Model::FaceInfoList& faceInfos = bIt->second;
-                Model::FaceInfoList::const_iterator fIt, fEnd;
-                for (fIt = faceInfos.begin(), fEnd = faceInfos.end(); fIt != fEnd; ++fIt) {
-                    const Model::FaceInfo& faceInfo = *fIt;
-                    if (!brush->canSplitFace(faceInfo, m_delta))
-                        return false;
-                }
-            }
-            return true;
+            ParallelBrushOperation<Model::BrushFacesMap, SplitFacesOperation> operation(m_brushFaces, SplitFacesOperation(m_delta));
+            return operation.canApply();
         }
     }
 }
@@ -122,13 +122,8 @@ namespace TrenchBroom {
             Model::VertexList::const_iterator vIt, vEnd;
             for (vIt = brushVertices.begin(), vEnd = brushVertices.end(); vIt != vEnd; ++vIt) {
                 const Model::Vertex& vertex = **vIt;
-                Model::VertexToBrushesMap::iterator mapIt = m_selectedVertexHandles.find(vertex.position);
-                if (mapIt != m_selectedVertexHandles.end()) {
-                    mapIt->second.push_back(&brush);
+                if (addHandle(vertex.position, brush, m_selectedVertexHandles, m_unselectedVertexHandles, m_unselectedVertexGrid))
                     m_selectedVertexCount++;
-                } else {
-                    m_unselectedVertexHandles[vertex.position].push_back(&brush);
-                }
             }
             m_totalVertexCount += brushVertices.size();
 
@@ -137,13 +132,8 @@ namespace TrenchBroom {
             for (eIt = brushEdges.begin(), eEnd = brushEdges.end(); eIt != eEnd; ++eIt) {
                 Model::Edge& edge = **eIt;
                 Vec3f position = edge.center();
-                Model::VertexToEdgesMap::iterator mapIt = m_selectedEdgeHandles.find(position);
-                if (mapIt != m_selectedEdgeHandles.end()) {
-                    mapIt->second.push_back(&edge);
+                if (addHandle(position, edge, m_selectedEdgeHandles, m_unselectedEdgeHandles, m_unselectedEdgeGrid))
                     m_selectedEdgeCount++;
-                } else {
-                    m_unselectedEdgeHandles[position].push_back(&edge);
-                }
             }
             m_totalEdgeCount+= brushEdges.size();
 
@@ -152,13 +142,8 @@ namespace TrenchBroom {
             for (fIt = brushFaces.begin(), fEnd = brushFaces.end(); fIt != fEnd; ++fIt) {
                 Model::Face& face = **fIt;
                 Vec3f position = face.center();
-                Model::VertexToFacesMap::iterator mapIt = m_selectedFaceHandles.find(position);
-                if (mapIt != m_selectedFaceHandles.end()) {
-                    mapIt->second.push_back(&face);
+                if (addHandle(position, face, m_selectedFaceHandles, m_unselectedFaceHandles, m_unselectedFaceGrid))
                     m_selectedFaceCount++;
-                } else {
-                    m_unselectedFaceHandles[position].push_back(&face);
-                }
             }
             m_totalFaceCount += brushFaces.size();
 
@@ -176,11 +161,11 @@ namespace TrenchBroom {
             Model::VertexList::const_iterator vIt, vEnd;
             for (vIt = brushVertices.begin(), vEnd = brushVertices.end(); vIt != vEnd; ++vIt) {
                 const Model::Vertex& vertex = **vIt;
-                if (removeHandle(vertex.position, brush, m_selectedVertexHandles)) {
+                if (removeHandle(vertex.position, brush, m_selectedVertexHandles, m_selectedVertexGrid)) {
                     assert(m_selectedVertexCount > 0);
                     m_selectedVertexCount--;
                 } else {
-                    removeHandle(vertex.position, brush, m_unselectedVertexHandles);
+                    removeHandle(vertex.position, brush, m_unselectedVertexHandles, m_unselectedVertexGrid);
                 }
             }
             assert(m_totalVertexCount >= brushVertices.size());
@@ -191,11 +176,11 @@ namespace TrenchBroom {
             for (eIt = brushEdges.begin(), eEnd = brushEdges.end(); eIt != eEnd; ++eIt) {
                 Model::Edge& edge = **eIt;
                 Vec3f position = edge.center();
-                if (removeHandle(position, edge, m_selectedEdgeHandles)) {
+                if (removeHandle(position, edge, m_selectedEdgeHandles, m_selectedEdgeGrid)) {
                     assert(m_selectedEdgeCount > 0);
                     m_selectedEdgeCount--;
                 } else {
-                    removeHandle(position, edge, m_unselectedEdgeHandles);
+                    removeHandle(position, edge, m_unselectedEdgeHandles, m_unselectedEdgeGrid);
                 }
             }
             assert(m_totalEdgeCount >= brushEdges.size());
@@ -206,11 +191,11 @@ namespace TrenchBroom {
             for (fIt = brushFaces.begin(), fEnd = brushFaces.end(); fIt != fEnd; ++fIt) {
                 Model::Face& face = **fIt;
                 Vec3f position = face.center();
-                if (removeHandle(position, face, m_selectedFaceHandles)) {
+                if (removeHandle(position, face, m_selectedFaceHandles, m_selectedFaceGrid)) {
                     assert(m_selectedFaceCount > 0);
                     m_selectedFaceCount--;
                 } else {
-                    removeHandle(position, face, m_unselectedFaceHandles);
+                    removeHandle(position, face, m_unselectedFaceHandles, m_unselectedFaceGrid);
                 }
             }
             assert(m_totalFaceCount >= brushFaces.size());
@@ -228,14 +213,20 @@ namespace TrenchBroom {
         void VertexHandleManager::clear() {
             m_unselectedVertexHandles.clear();
             m_selectedVertexHandles.clear();
+            m_unselectedVertexGrid.clear();
+            m_selectedVertexGrid.clear();
             m_totalVertexCount = 0;
             m_selectedVertexCount = 0;
             m_unselectedEdgeHandles.clear();
             m_selectedEdgeHandles.clear();
+            m_unselectedEdgeGrid.clear();
+            m_selectedEdgeGrid.clear();
             m_totalEdgeCount = 0;
             m_selectedEdgeCount = 0;
             m_unselectedFaceHandles.clear();
             m_selectedFaceHandles.clear();
+            m_unselectedFaceGrid.clear();
+            m_selectedFaceGrid.clear();
             m_totalFaceCount = 0;
             m_selectedFaceCount = 0;
             m_renderStateValid = false;
@@ -243,7 +234,7 @@ namespace TrenchBroom {
 
         void VertexHandleManager::selectVertexHandle(const Vec3f& position) {
             size_t count = 0;
-            if ((count = moveHandle(position, m_unselectedVertexHandles, m_selectedVertexHandles)) > 0) {
+            if ((count = moveHandle(position, m_unselectedVertexHandles, m_unselectedVertexGrid, m_selectedVertexHandles, m_selectedVertexGrid)) > 0) {
                 m_selectedVertexCount += count;
                 m_renderStateValid = false;
             }
@@ -251,7 +242,7 @@ namespace TrenchBroom {
 
         void VertexHandleManager::deselectVertexHandle(const Vec3f& position) {
             size_t count = 0;
-            if ((count = moveHandle(position, m_selectedVertexHandles, m_unselectedVertexHandles)) > 0) {
+            if ((count = moveHandle(position, m_selectedVertexHandles, m_selectedVertexGrid, m_unselectedVertexHandles, m_unselectedVertexGrid)) > 0) {
                 assert(m_selectedVertexCount >= count);
                 m_selectedVertexCount -= count;
                 m_renderStateValid = false;
@@ -265,21 +256,14 @@ namespace TrenchBroom {
         }
 
         void VertexHandleManager::deselectVertexHandles() {
-            Model::VertexToBrushesMap::const_iterator vIt, vEnd;
-            for (vIt = m_selectedVertexHandles.begin(), vEnd = m_selectedVertexHandles.end(); vIt != vEnd; ++vIt) {
-                const Vec3f& position = vIt->first;
-                const Model::BrushList& selectedBrushes = vIt->second;
-                Model::BrushList& unselectedBrushes = m_unselectedVertexHandles[position];
-                unselectedBrushes.insert(unselectedBrushes.begin(), selectedBrushes.begin(), selectedBrushes.end());
-            }
-            m_selectedVertexHandles.clear();
+            moveAllHandles(m_selectedVertexHandles, m_selectedVertexGrid, m_unselectedVertexHandles, m_unselectedVertexGrid);
             m_selectedVertexCount = 0;
             m_renderStateValid = false;
         }
 
         void VertexHandleManager::selectEdgeHandle(const Vec3f& position) {
             size_t count = 0;
-            if ((count = moveHandle(position, m_unselectedEdgeHandles, m_selectedEdgeHandles)) > 0) {
+            if ((count = moveHandle(position, m_unselectedEdgeHandles, m_unselectedEdgeGrid, m_selectedEdgeHandles, m_selectedEdgeGrid)) > 0) {
                 m_selectedEdgeCount += count;
                 m_renderStateValid = false;
             }
@@ -287,7 +271,7 @@ namespace TrenchBroom {
 
         void VertexHandleManager::deselectEdgeHandle(const Vec3f& position) {
             size_t count = 0;
-            if ((count = moveHandle(position, m_selectedEdgeHandles, m_unselectedEdgeHandles)) > 0) {
+            if ((count = moveHandle(position, m_selectedEdgeHandles, m_selectedEdgeGrid, m_unselectedEdgeHandles, m_unselectedEdgeGrid)) > 0) {
                 assert(m_selectedEdgeCount >= count);
                 m_selectedEdgeCount -= count;
                 m_renderStateValid = false;
@@ -303,21 +287,14 @@ namespace TrenchBroom {
         }
 
         void VertexHandleManager::deselectEdgeHandles() {
-            Model::VertexToEdgesMap::const_iterator eIt, eEnd;
-            for (eIt = m_selectedEdgeHandles.begin(), eEnd = m_selectedEdgeHandles.end(); eIt != eEnd; ++eIt) {
-                const Vec3f& position = eIt->first;
-                const Model::EdgeList& selectedEdges = eIt->second;
-                Model::EdgeList& unselectedEdges = m_unselectedEdgeHandles[position];
-                unselectedEdges.insert(unselectedEdges.begin(), selectedEdges.begin(), selectedEdges.end());
-            }
-            m_selectedEdgeHandles.clear();
+            moveAllHandles(m_selectedEdgeHandles, m_selectedEdgeGrid, m_unselectedEdgeHandles, m_unselectedEdgeGrid);
             m_selectedEdgeCount = 0;
             m_renderStateValid = false;
         }
 
         void VertexHandleManager::selectFaceHandle(const Vec3f& position) {
             size_t count = 0;
-            if ((count = moveHandle(position, m_unselectedFaceHandles, m_selectedFaceHandles)) > 0) {
+            if ((count = moveHandle(position, m_unselectedFaceHandles, m_unselectedFaceGrid, m_selectedFaceHandles, m_selectedFaceGrid)) > 0) {
                 m_selectedFaceCount += count;
                 m_renderStateValid = false;
             }
@@ -325,7 +302,7 @@ namespace TrenchBroom {
 
         void VertexHandleManager::deselectFaceHandle(const Vec3f& position) {
             size_t count = 0;
-            if ((count = moveHandle(position, m_selectedFaceHandles, m_unselectedFaceHandles)) > 0) {
+            if ((count = moveHandle(position, m_selectedFaceHandles, m_selectedFaceGrid, m_unselectedFaceHandles, m_unselectedFaceGrid)) > 0) {
                 assert(m_selectedFaceCount >= count);
                 m_selectedFaceCount -= count;
                 m_renderStateValid = false;
@@ -341,14 +318,7 @@ namespace TrenchBroom {
         }
 
         void VertexHandleManager::deselectFaceHandles() {
-            Model::VertexToFacesMap::const_iterator fIt, fEnd;
-            for (fIt = m_selectedFaceHandles.begin(), fEnd = m_selectedFaceHandles.end(); fIt != fEnd; ++fIt) {
-                const Vec3f& position = fIt->first;
-                const Model::FaceList& selectedFaces = fIt->second;
-                Model::FaceList& unselectedFaces = m_unselectedFaceHandles[position];
-                unselectedFaces.insert(unselectedFaces.begin(), selectedFaces.begin(), selectedFaces.end());
-            }
-            m_selectedFaceHandles.clear();
+            moveAllHandles(m_selectedFaceHandles, m_selectedFaceGrid, m_unselectedFaceHandles, m_unselectedFaceGrid);
             m_selectedFaceCount = 0;
             m_renderStateValid = false;
         }
@@ -359,58 +329,41 @@ namespace TrenchBroom {
             deselectFaceHandles();
         }
 
-        void VertexHandleManager::pick(const Rayf& ray, Model::PickResult& pickResult, bool splitMode) const {
-            Model::VertexToBrushesMap::const_iterator vIt, vEnd;
-            Model::VertexToEdgesMap::const_iterator eIt, eEnd;
-            Model::VertexToFacesMap::const_iterator fIt, fEnd;
+        void VertexHandleManager::pickHandles(const Rayf& ray, const HandleGrid& grid, Model::HitType::Type type, Model::PickResult& pickResult) const {
+            if (grid.empty())
+                return;
 
-            if ((m_selectedEdgeHandles.empty() && m_selectedFaceHandles.empty()) || splitMode) {
-                for (vIt = m_unselectedVertexHandles.begin(), vEnd = m_unselectedVertexHandles.end(); vIt != vEnd; ++vIt) {
-                    const Vec3f& position = vIt->first;
-                    Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::VertexHandleHit);
-                    if (hit != NULL)
-                        pickResult.add(hit);
-                }
-            }
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            float handleRadius = prefs.getFloat(Preferences::HandleRadius);
+            float scalingFactor = prefs.getFloat(Preferences::HandleScalingFactor);
+            float maxDistance = prefs.getFloat(Preferences::MaximumHandleDistance);
 
-            for (vIt = m_selectedVertexHandles.begin(), vEnd = m_selectedVertexHandles.end(); vIt != vEnd; ++vIt) {
-                const Vec3f& position = vIt->first;
-                Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::VertexHandleHit);
-                if (hit != NULL)
-                    pickResult.add(hit);
-            }
+            // the handles grow with their distance to the ray origin, so this is the largest radius that a handle can have
+            float maxRadius = 2.0f * handleRadius * scalingFactor * maxDistance;
 
-            if (m_selectedVertexHandles.empty() && m_selectedFaceHandles.empty() && !splitMode) {
-                for (eIt = m_unselectedEdgeHandles.begin(), eEnd = m_unselectedEdgeHandles.end(); eIt != eEnd; ++eIt) {
-                    const Vec3f& position = eIt->first;
-                    Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::EdgeHandleHit);
-                    if (hit != NULL)
-                        pickResult.add(hit);
-                }
-            }
+            Vec3f::List positions;
+            grid.query(ray, maxDistance, maxRadius, positions);
 
-            for (eIt = m_selectedEdgeHandles.begin(), eEnd = m_selectedEdgeHandles.end(); eIt != eEnd; ++eIt) {
-                const Vec3f& position = eIt->first;
-                Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::EdgeHandleHit);
+            Vec3f::List::const_iterator it, end;
+            for (it = positions.begin(), end = positions.end(); it != end; ++it) {
+                Model::VertexHandleHit* hit = pickHandle(ray, *it, type);
                 if (hit != NULL)
                     pickResult.add(hit);
             }
+        }
 
-            if (m_selectedVertexHandles.empty() && m_selectedEdgeHandles.empty() && !splitMode) {
-                for (fIt = m_unselectedFaceHandles.begin(), fEnd = m_unselectedFaceHandles.end(); fIt != fEnd; ++fIt) {
-                    const Vec3f& position = fIt->first;
-                    Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::FaceHandleHit);
-                    if (hit != NULL)
-                        pickResult.add(hit);
-                }
-            }
+        void VertexHandleManager::pick(const Rayf& ray, Model::PickResult& pickResult, bool splitMode) const {
+            if ((m_selectedEdgeHandles.empty() && m_selectedFaceHandles.empty()) || splitMode)
+                pickHandles(ray, m_unselectedVertexGrid, Model::HitType::VertexHandleHit, pickResult);
+            pickHandles(ray, m_selectedVertexGrid, Model::HitType::VertexHandleHit, pickResult);
 
-            for (fIt = m_selectedFaceHandles.begin(), fEnd = m_selectedFaceHandles.end(); fIt != fEnd; ++fIt) {
-                const Vec3f& position = fIt->first;
-                Model::VertexHandleHit* hit = pickHandle(ray, position, Model::HitType::FaceHandleHit);
-                if (hit != NULL)
-                    pickResult.add(hit);
-            }
+            if (m_selectedVertexHandles.empty() && m_selectedFaceHandles.empty() && !splitMode)
+                pickHandles(ray, m_unselectedEdgeGrid, Model::HitType::EdgeHandleHit, pickResult);
+            pickHandles(ray, m_selectedEdgeGrid, Model::HitType::EdgeHandleHit, pickResult);
+
+            if (m_selectedVertexHandles.empty() && m_selectedEdgeHandles.empty() && !splitMode)
+                pickHandles(ray, m_unselectedFaceGrid, Model::HitType::FaceHandleHit, pickResult);
+            pickHandles(ray, m_selectedFaceGrid, Model::HitType::FaceHandleHit, pickResult);
         }
 
         void VertexHandleManager::render(Renderer::Vbo& vbo, Renderer::RenderContext& renderContext, bool splitMode) {
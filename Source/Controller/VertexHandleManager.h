@@ -20,6 +20,7 @@
 #ifndef __TrenchBroom__HandleManager__
 #define __TrenchBroom__HandleManager__
 
+#include "Controller/HandleGrid.h"
 #include "Model/Brush.h"
 #include "Model/BrushGeometryTypes.h"
 #include "Model/Picker.h"
@@ -68,6 +69,13 @@ namespace TrenchBroom {
             Model::VertexToFacesMap m_unselectedFaceHandles;
             Model::VertexToFacesMap m_selectedFaceHandles;
             
+            HandleGrid m_unselectedVertexGrid;
+            HandleGrid m_selectedVertexGrid;
+            HandleGrid m_unselectedEdgeGrid;
+            HandleGrid m_selectedEdgeGrid;
+            HandleGrid m_unselectedFaceGrid;
+            HandleGrid m_selectedFaceGrid;
+            
             size_t m_totalVertexCount;
             size_t m_selectedVertexCount;
             size_t m_totalEdgeCount;
@@ -83,8 +91,39 @@ namespace TrenchBroom {
             bool m_renderStateValid;
             bool m_recreateRenderers;
             
+            /*
+             * The handle maps merge positions which are almost equal, so every map key is also stored in the grid
+             * which belongs to the map. The grids are only updated when a key is added to or removed from a map.
+             */
+            
             template <typename Element>
-            inline bool removeHandle(const Vec3f& position, Element& element, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& map) {
+            inline std::vector<Element*>& handleList(const Vec3f& position, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& map, HandleGrid& grid) {
+                typedef std::vector<Element*> List;
+                typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
+                
+                std::pair<typename Map::iterator, bool> result = map.insert(typename Map::value_type(position, List()));
+                if (result.second)
+                    grid.insert(result.first->first);
+                return result.first->second;
+            }
+            
+            template <typename Element>
+            inline bool addHandle(const Vec3f& position, Element& element, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& selectedMap, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& unselectedMap, HandleGrid& unselectedGrid) {
+                typedef std::vector<Element*> List;
+                typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
+                
+                typename Map::iterator mapIt = selectedMap.find(position);
+                if (mapIt != selectedMap.end()) {
+                    mapIt->second.push_back(&element);
+                    return true;
+                }
+                
+                handleList(position, unselectedMap, unselectedGrid).push_back(&element);
+                return false;
+            }
+            
+            template <typename Element>
+            inline bool removeHandle(const Vec3f& position, Element& element, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& map, HandleGrid& grid) {
                 typedef std::vector<Element*> List;
                 typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
                 
@@ -98,13 +137,15 @@ namespace TrenchBroom {
                     return false;
                 
                 elements.erase(listIt);
-                if (elements.empty())
+                if (elements.empty()) {
+                    grid.remove(mapIt->first);
                     map.erase(mapIt);
+                }
                 return true;
             }
             
             template <typename Element>
-            inline size_t moveHandle(const Vec3f& position, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& from, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& to) {
+            inline size_t moveHandle(const Vec3f& position, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& from, HandleGrid& fromGrid, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& to, HandleGrid& toGrid) {
                 typedef std::vector<Element*> List;
                 typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
                 
@@ -113,14 +154,30 @@ namespace TrenchBroom {
                     return 0;
                 
                 List& fromElements = mapIt->second;
-                List& toElements = to[position];
+                List& toElements = handleList(position, to, toGrid);
                 size_t elementCount = fromElements.size();
                 toElements.insert(toElements.end(), fromElements.begin(), fromElements.end());
                 
+                fromGrid.remove(mapIt->first);
                 from.erase(mapIt);
                 return elementCount;
             }
             
+            template <typename Element>
+            inline void moveAllHandles(std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& from, HandleGrid& fromGrid, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& to, HandleGrid& toGrid) {
+                typedef std::vector<Element*> List;
+                typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
+                
+                typename Map::const_iterator mapIt, mapEnd;
+                for (mapIt = from.begin(), mapEnd = from.end(); mapIt != mapEnd; ++mapIt) {
+                    const List& fromElements = mapIt->second;
+                    List& toElements = handleList(mapIt->first, to, toGrid);
+                    toElements.insert(toElements.begin(), fromElements.begin(), fromElements.end());
+                }
+                from.clear();
+                fromGrid.clear();
+            }
+            
             inline Model::VertexHandleHit* pickHandle(const Rayf& ray, const Vec3f& position, Model::HitType::Type type) const {
                 Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
                 float handleRadius = prefs.getFloat(Preferences::HandleRadius);
@@ -136,6 +193,8 @@ namespace TrenchBroom {
                 return NULL;
             }
             
+            void pickHandles(const Rayf& ray, const HandleGrid& grid, Model::HitType::Type type, Model::PickResult& pickResult) const;
+            
             void createRenderers();
             void destroyRenderers();
         public:
@@ -21,6 +21,7 @@
 
 #include <wx/wx.h>
 #include <wx/filename.h>
+#include <wx/stdpaths.h>
 
 #include <map> 
 
@@ -66,7 +67,7 @@ namespace TrenchBroom {
         }
         
         bool AbstractFileManager::makeDirectory(const String& path) {
-            return wxMkdir(path);
+            return wxFileName::Mkdir(path, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
         }
         
         bool AbstractFileManager::deleteFile(const String& path) {
@@ -77,6 +78,10 @@ namespace TrenchBroom {
             return wxRenameFile(sourcePath, destPath, overwrite);
         }
         
+        time_t AbstractFileManager::modificationTime(const String& path) {
+            return wxFileModificationTime(path);
+        }
+        
         char AbstractFileManager::pathSeparator() {
             static const char c = wxFileName::GetPathSeparator();
             return c;
@@ -280,6 +285,10 @@ namespace TrenchBroom {
             return path.substr(0, pos);
         }
 
+        String AbstractFileManager::cacheDirectory() {
+            return appendPath(wxStandardPaths::Get().GetUserDataDir().ToStdString(), "Cache");
+        }
+
 #ifndef _WIN32
         MappedFile::Ptr AbstractFileManager::mapFile(const String& path, std::ios_base::openmode mode) {
             int filedesc = -1;
@@ -25,6 +25,7 @@
 #include "Utility/String.h"
 
 #include <cassert>
+#include <ctime>
 
 namespace TrenchBroom {
     namespace IO {
@@ -74,9 +75,13 @@ namespace TrenchBroom {
             bool isAbsolutePath(const String& path);
             bool isDirectory(const String& path);
             bool exists(const String& path);
+            /**
+             * Creates the given directory and all of its missing parent directories.
+             */
             bool makeDirectory(const String& path);
             bool deleteFile(const String& path);
             bool moveFile(const String& sourcePath, const String& destPath, bool overwrite);
+            time_t modificationTime(const String& path);
             char pathSeparator();
             StringList directoryContents(const String& path, String extension = "", bool directories = true, bool files = true);
             bool resolveRelativePath(const String& relativePath, const StringList& rootPaths, String& absolutePath);
@@ -96,6 +101,11 @@ namespace TrenchBroom {
             String appendExtension(const String& path, const String& ext);
             String deleteExtension(const String& path);
             
+            /**
+             * Returns the directory in which TrenchBroom keeps caches that belong to the user rather than to a
+             * single map.
+             */
+            String cacheDirectory();
             virtual String logDirectory() = 0;
             virtual String resourceDirectory() = 0;
             virtual String resolveFontPath(const String& fontName) = 0;
@@ -0,0 +1,140 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BinaryCache.h"
+
+#include "IO/FileManager.h"
+#include "IO/IOException.h"
+#include "IO/IOUtils.h"
+
+#include "Version.h"
+
+#include <cassert>
+#include <cstdio>
+
+namespace TrenchBroom {
+    namespace IO {
+        uint64_t BinaryCache::hash(const char* begin, const char* end) {
+            // 64 bit FNV-1a
+            uint64_t result = 14695981039346656037ULL;
+            for (const char* cur = begin; cur < end; ++cur) {
+                result ^= static_cast<unsigned char>(*cur);
+                result *= 1099511628211ULL;
+            }
+            return result;
+        }
+
+        bool BinaryCache::writeFile(const String& path, const std::vector<char>& buffer) {
+            FileManager fileManager;
+            const String directory = fileManager.deleteLastPathComponent(path);
+            if (!directory.empty() && !fileManager.exists(directory) && !fileManager.makeDirectory(directory))
+                return false;
+
+            const String tempPath = fileManager.appendExtension(path, "tmp");
+            FILE* stream = fopen(tempPath.c_str(), "wb");
+            if (stream == NULL)
+                return false;
+
+            const size_t written = buffer.empty() ? 0 : std::fwrite(&buffer[0], 1, buffer.size(), stream);
+            const bool closed = fclose(stream) == 0;
+            if (written != buffer.size() || !closed) {
+                fileManager.deleteFile(tempPath);
+                return false;
+            }
+
+            return fileManager.moveFile(tempPath, path, true);
+        }
+
+        void BinaryCacheReader::checkRemaining(size_t count) {
+            if (static_cast<size_t>(m_end - m_cursor) < count)
+                throw IOException::unexpectedEof();
+        }
+
+        size_t BinaryCacheReader::readCount(size_t elementSize) {
+            const size_t count = static_cast<size_t>(read<uint32_t>());
+            // every element occupies at least elementSize bytes, so a larger count indicates a corrupt cache
+            if (count > static_cast<size_t>(m_end - m_cursor) / elementSize)
+                throw IOException("Invalid element count %u in cache", static_cast<unsigned int>(count));
+            return count;
+        }
+
+        String BinaryCacheReader::readString() {
+            const size_t length = readCount(1);
+            const String result(m_cursor, length);
+            m_cursor += length;
+            return result;
+        }
+
+        Vec3f BinaryCacheReader::readVec3f() {
+            Vec3f value;
+            for (size_t i = 0; i < 3; i++)
+                value[i] = read<float>();
+            return value;
+        }
+
+        Color BinaryCacheReader::readColor() {
+            Color color;
+            for (size_t i = 0; i < 4; i++)
+                color[i] = read<float>();
+            return color;
+        }
+
+        bool BinaryCacheReader::readHeader(const char* magic, uint32_t formatVersion) {
+            m_cursor = m_begin;
+
+            const size_t magicLength = strlen(magic);
+            checkRemaining(magicLength);
+            if (strncmp(m_cursor, magic, magicLength) != 0)
+                return false;
+            m_cursor += magicLength;
+
+            if (read<uint32_t>() != formatVersion)
+                return false;
+            return readString() == VERSIONSTR;
+        }
+
+        BinaryCacheReader::BinaryCacheReader(const char* begin, const char* end) :
+        m_begin(begin),
+        m_cursor(begin),
+        m_end(end) {
+            assert(m_end >= m_begin);
+        }
+
+        void BinaryCacheWriter::writeString(const String& str, std::vector<char>& buffer) {
+            write<uint32_t>(buffer, static_cast<uint32_t>(str.size()));
+            writeBytes(buffer, str.data(), str.size());
+        }
+
+        void BinaryCacheWriter::writeVec3f(const Vec3f& vec, std::vector<char>& buffer) {
+            for (size_t i = 0; i < 3; i++)
+                write<float>(buffer, vec[i]);
+        }
+
+        void BinaryCacheWriter::writeColor(const Color& color, std::vector<char>& buffer) {
+            for (size_t i = 0; i < 4; i++)
+                write<float>(buffer, color[i]);
+        }
+
+        void BinaryCacheWriter::writeHeader(const char* magic, uint32_t formatVersion, std::vector<char>& buffer) {
+            writeBytes(buffer, magic, strlen(magic));
+            write<uint32_t>(buffer, formatVersion);
+            writeString(VERSIONSTR, buffer);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BinaryCache_h
+#define TrenchBroom_BinaryCache_h
+
+#include "Utility/Color.h"
+#include "Utility/String.h"
+#include "Utility/VecMath.h"
+
+#include <cstring>
+#include <vector>
+
+#if defined _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * Common functionality of the binary cache files which TrenchBroom writes to avoid parsing its input files
+         * again.
+         */
+        class BinaryCache {
+        public:
+            static uint64_t hash(const char* begin, const char* end);
+
+            /**
+             * Writes the given buffer to a temporary file which then replaces the file at the given path, so that
+             * a partially written cache is never picked up. Creates the containing directory if necessary.
+             */
+            static bool writeFile(const String& path, const std::vector<char>& buffer);
+        };
+
+        class BinaryCacheReader {
+        protected:
+            const char* m_begin;
+            const char* m_cursor;
+            const char* m_end;
+
+            void checkRemaining(size_t count);
+
+            template <typename T>
+            inline T read() {
+                checkRemaining(sizeof(T));
+                T value;
+                memcpy(&value, m_cursor, sizeof(T));
+                m_cursor += sizeof(T);
+                return value;
+            }
+
+            size_t readCount(size_t elementSize);
+            String readString();
+            Vec3f readVec3f();
+            Color readColor();
+
+            /**
+             * Checks the magic string, the format version and the TrenchBroom version at the beginning of the
+             * cache. Returns false if any of them does not match.
+             */
+            bool readHeader(const char* magic, uint32_t formatVersion);
+        public:
+            BinaryCacheReader(const char* begin, const char* end);
+        };
+
+        class BinaryCacheWriter {
+        protected:
+            void writeString(const String& str, std::vector<char>& buffer);
+            void writeVec3f(const Vec3f& vec, std::vector<char>& buffer);
+            void writeColor(const Color& color, std::vector<char>& buffer);
+            void writeHeader(const char* magic, uint32_t formatVersion, std::vector<char>& buffer);
+        };
+    }
+}
+
+#endif
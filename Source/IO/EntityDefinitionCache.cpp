@@ -0,0 +1,309 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntityDefinitionCache.h"
+
+#include "IO/FileManager.h"
+#include "IO/IOException.h"
+#include "IO/IOUtils.h"
+#include "Utility/List.h"
+
+#include <iomanip>
+
+namespace TrenchBroom {
+    namespace IO {
+        const char* EntityDefinitionCache::Magic = "TBED";
+        const uint32_t EntityDefinitionCache::FormatVersion = 1;
+        const uint8_t EntityDefinitionCache::NoEvaluator = 0xFF;
+
+        String EntityDefinitionCache::cachePath(const String& definitionPath) {
+            FileManager fileManager;
+            const StringList components = fileManager.pathComponents(definitionPath);
+            const String fileName = components.empty() ? "" : fileManager.deleteExtension(components.back());
+
+            // different definition files may have the same name, so the cache name includes a hash of the path
+            StringStream cacheName;
+            cacheName << fileName << "-" << std::hex << std::setw(16) << std::setfill('0') << BinaryCache::hash(definitionPath.data(), definitionPath.data() + definitionPath.size());
+
+            const String cacheDirectory = fileManager.appendPath(fileManager.cacheDirectory(), "EntityDefinitions");
+            return fileManager.appendPath(cacheDirectory, fileManager.appendExtension(cacheName.str(), "tbdefs"));
+        }
+
+        Model::PropertyDefinition::Ptr EntityDefinitionCacheReader::readPropertyDefinition() {
+            const Model::PropertyDefinition::Type type = static_cast<Model::PropertyDefinition::Type>(read<uint8_t>());
+            const String name = readString();
+            const String description = readString();
+
+            switch (type) {
+                case Model::PropertyDefinition::TargetSourceProperty:
+                case Model::PropertyDefinition::TargetDestinationProperty:
+                    return Model::PropertyDefinition::Ptr(new Model::PropertyDefinition(name, type, description));
+                case Model::PropertyDefinition::StringProperty: {
+                    const String defaultValue = readString();
+                    return Model::PropertyDefinition::Ptr(new Model::StringPropertyDefinition(name, description, defaultValue));
+                }
+                case Model::PropertyDefinition::IntegerProperty: {
+                    const int defaultValue = static_cast<int>(read<int32_t>());
+                    return Model::PropertyDefinition::Ptr(new Model::IntegerPropertyDefinition(name, description, defaultValue));
+                }
+                case Model::PropertyDefinition::FloatProperty: {
+                    const float defaultValue = read<float>();
+                    return Model::PropertyDefinition::Ptr(new Model::FloatPropertyDefinition(name, description, defaultValue));
+                }
+                case Model::PropertyDefinition::ChoiceProperty: {
+                    const int defaultValue = static_cast<int>(read<int32_t>());
+                    Model::ChoicePropertyDefinition* definition = new Model::ChoicePropertyDefinition(name, description, defaultValue);
+                    Model::PropertyDefinition::Ptr result(definition);
+
+                    const size_t optionCount = readCount(2 * sizeof(uint32_t));
+                    for (size_t i = 0; i < optionCount; i++) {
+                        const String value = readString();
+                        const String optionDescription = readString();
+                        definition->addOption(value, optionDescription);
+                    }
+                    return result;
+                }
+                case Model::PropertyDefinition::FlagsProperty: {
+                    Model::FlagsPropertyDefinition* definition = new Model::FlagsPropertyDefinition(name, description);
+                    Model::PropertyDefinition::Ptr result(definition);
+
+                    const size_t optionCount = readCount(2 * sizeof(uint32_t) + 1);
+                    for (size_t i = 0; i < optionCount; i++) {
+                        const int value = static_cast<int>(read<int32_t>());
+                        const String optionDescription = readString();
+                        const bool isDefault = read<uint8_t>() != 0;
+                        definition->addOption(value, optionDescription, isDefault);
+                    }
+                    return result;
+                }
+                default:
+                    throw IOException("Invalid property definition type %u in entity definition cache", static_cast<unsigned int>(type));
+            }
+        }
+
+        Model::ModelDefinition::Ptr EntityDefinitionCacheReader::readModelDefinition() {
+            const String name = readString();
+            const unsigned int skinIndex = static_cast<unsigned int>(read<uint32_t>());
+            const unsigned int frameIndex = static_cast<unsigned int>(read<uint32_t>());
+
+            const uint8_t evaluatorType = read<uint8_t>();
+            if (evaluatorType == EntityDefinitionCache::NoEvaluator)
+                return Model::ModelDefinition::Ptr(new Model::ModelDefinition(name, skinIndex, frameIndex));
+
+            const Model::PropertyKey propertyKey = readString();
+            switch (evaluatorType) {
+                case Model::ModelDefinitionEvaluator::PropertyEvaluator: {
+                    const Model::PropertyValue propertyValue = readString();
+                    return Model::ModelDefinition::Ptr(new Model::ModelDefinition(name, skinIndex, frameIndex, propertyKey, propertyValue));
+                }
+                case Model::ModelDefinitionEvaluator::FlagEvaluator: {
+                    const int flagValue = static_cast<int>(read<int32_t>());
+                    return Model::ModelDefinition::Ptr(new Model::ModelDefinition(name, skinIndex, frameIndex, propertyKey, flagValue));
+                }
+                default:
+                    throw IOException("Invalid model definition in entity definition cache");
+            }
+        }
+
+        Model::EntityDefinition* EntityDefinitionCacheReader::readDefinition() {
+            const Model::EntityDefinition::Type type = static_cast<Model::EntityDefinition::Type>(read<uint8_t>());
+            if (type != Model::EntityDefinition::PointEntity && type != Model::EntityDefinition::BrushEntity)
+                throw IOException("Invalid entity definition type %u in entity definition cache", static_cast<unsigned int>(type));
+
+            const String name = readString();
+            const Color color = readColor();
+            const String description = readString();
+
+            Model::PropertyDefinition::List propertyDefinitions;
+            const size_t propertyCount = readCount(1 + 2 * sizeof(uint32_t));
+            propertyDefinitions.reserve(propertyCount);
+            for (size_t i = 0; i < propertyCount; i++)
+                propertyDefinitions.push_back(readPropertyDefinition());
+
+            if (type == Model::EntityDefinition::BrushEntity)
+                return new Model::BrushEntityDefinition(name, color, description, propertyDefinitions);
+
+            const Vec3f min = readVec3f();
+            const Vec3f max = readVec3f();
+
+            Model::ModelDefinition::List modelDefinitions;
+            const size_t modelCount = readCount(3 * sizeof(uint32_t) + 1);
+            modelDefinitions.reserve(modelCount);
+            for (size_t i = 0; i < modelCount; i++)
+                modelDefinitions.push_back(readModelDefinition());
+
+            return new Model::PointEntityDefinition(name, color, BBoxf(min, max), description, propertyDefinitions, modelDefinitions);
+        }
+
+        EntityDefinitionCacheReader::EntityDefinitionCacheReader(const char* begin, const char* end) :
+        BinaryCacheReader(begin, end) {}
+
+        bool EntityDefinitionCacheReader::read(const EntityDefinitionCache::Key& key, Model::EntityDefinitionList& definitions) {
+            if (!readHeader(EntityDefinitionCache::Magic, EntityDefinitionCache::FormatVersion))
+                return false;
+
+            EntityDefinitionCache::Key cachedKey;
+            cachedKey.path = readString();
+            cachedKey.size = read<uint64_t>();
+            cachedKey.modificationTime = read<int64_t>();
+            cachedKey.hash = read<uint64_t>();
+            cachedKey.defaultColor = readColor();
+            if (!(cachedKey == key))
+                return false;
+
+            Model::EntityDefinitionList result;
+            try {
+                const size_t definitionCount = readCount(1 + 4 * sizeof(uint32_t) + 4 * sizeof(float));
+                result.reserve(definitionCount);
+                for (size_t i = 0; i < definitionCount; i++)
+                    result.push_back(readDefinition());
+            } catch (...) {
+                Utility::deleteAll(result);
+                throw;
+            }
+
+            definitions.insert(definitions.end(), result.begin(), result.end());
+            return true;
+        }
+
+        void EntityDefinitionCacheWriter::writePropertyDefinition(const Model::PropertyDefinition& definition, std::vector<char>& buffer) {
+            write<uint8_t>(buffer, static_cast<uint8_t>(definition.type()));
+            writeString(definition.name(), buffer);
+            writeString(definition.description(), buffer);
+
+            switch (definition.type()) {
+                case Model::PropertyDefinition::StringProperty:
+                    writeString(definition.defaultPropertyValue(), buffer);
+                    break;
+                case Model::PropertyDefinition::IntegerProperty: {
+                    const Model::IntegerPropertyDefinition& integerDefinition = static_cast<const Model::IntegerPropertyDefinition&>(definition);
+                    write<int32_t>(buffer, static_cast<int32_t>(integerDefinition.defaultValue()));
+                    break;
+                }
+                case Model::PropertyDefinition::FloatProperty: {
+                    const Model::FloatPropertyDefinition& floatDefinition = static_cast<const Model::FloatPropertyDefinition&>(definition);
+                    write<float>(buffer, floatDefinition.defaultValue());
+                    break;
+                }
+                case Model::PropertyDefinition::ChoiceProperty: {
+                    const Model::ChoicePropertyDefinition& choiceDefinition = static_cast<const Model::ChoicePropertyDefinition&>(definition);
+                    write<int32_t>(buffer, static_cast<int32_t>(choiceDefinition.defaultValue()));
+
+                    const Model::ChoicePropertyOption::List& options = choiceDefinition.options();
+                    write<uint32_t>(buffer, static_cast<uint32_t>(options.size()));
+                    for (size_t i = 0; i < options.size(); i++) {
+                        writeString(options[i].value(), buffer);
+                        writeString(options[i].description(), buffer);
+                    }
+                    break;
+                }
+                case Model::PropertyDefinition::FlagsProperty: {
+                    const Model::FlagsPropertyDefinition& flagsDefinition = static_cast<const Model::FlagsPropertyDefinition&>(definition);
+
+                    const Model::FlagsPropertyOption::List& options = flagsDefinition.options();
+                    write<uint32_t>(buffer, static_cast<uint32_t>(options.size()));
+                    for (size_t i = 0; i < options.size(); i++) {
+                        write<int32_t>(buffer, static_cast<int32_t>(options[i].value()));
+                        writeString(options[i].description(), buffer);
+                        write<uint8_t>(buffer, options[i].isDefault() ? 1 : 0);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        bool EntityDefinitionCacheWriter::writeModelDefinition(const Model::ModelDefinition& definition, std::vector<char>& buffer) {
+            writeString(definition.name(), buffer);
+            write<uint32_t>(buffer, static_cast<uint32_t>(definition.skinIndex()));
+            write<uint32_t>(buffer, static_cast<uint32_t>(definition.frameIndex()));
+
+            const Model::ModelDefinitionEvaluator* evaluator = definition.evaluator();
+            if (evaluator == NULL) {
+                write<uint8_t>(buffer, EntityDefinitionCache::NoEvaluator);
+                return true;
+            }
+
+            switch (evaluator->type()) {
+                case Model::ModelDefinitionEvaluator::PropertyEvaluator: {
+                    const Model::ModelDefinitionPropertyEvaluator* propertyEvaluator = static_cast<const Model::ModelDefinitionPropertyEvaluator*>(evaluator);
+                    write<uint8_t>(buffer, static_cast<uint8_t>(Model::ModelDefinitionEvaluator::PropertyEvaluator));
+                    writeString(propertyEvaluator->propertyKey(), buffer);
+                    writeString(propertyEvaluator->propertyValue(), buffer);
+                    return true;
+                }
+                case Model::ModelDefinitionEvaluator::FlagEvaluator: {
+                    const Model::ModelDefinitionFlagEvaluator* flagEvaluator = static_cast<const Model::ModelDefinitionFlagEvaluator*>(evaluator);
+                    write<uint8_t>(buffer, static_cast<uint8_t>(Model::ModelDefinitionEvaluator::FlagEvaluator));
+                    writeString(flagEvaluator->propertyKey(), buffer);
+                    write<int32_t>(buffer, static_cast<int32_t>(flagEvaluator->flagValue()));
+                    return true;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        bool EntityDefinitionCacheWriter::writeDefinition(const Model::EntityDefinition& definition, std::vector<char>& buffer) {
+            write<uint8_t>(buffer, static_cast<uint8_t>(definition.type()));
+            writeString(definition.name(), buffer);
+            writeColor(definition.color(), buffer);
+            writeString(definition.description(), buffer);
+
+            const Model::PropertyDefinition::List& propertyDefinitions = definition.propertyDefinitions();
+            write<uint32_t>(buffer, static_cast<uint32_t>(propertyDefinitions.size()));
+            for (size_t i = 0; i < propertyDefinitions.size(); i++)
+                writePropertyDefinition(*propertyDefinitions[i], buffer);
+
+            if (definition.type() == Model::EntityDefinition::BrushEntity)
+                return true;
+
+            const Model::PointEntityDefinition& pointDefinition = static_cast<const Model::PointEntityDefinition&>(definition);
+            writeVec3f(pointDefinition.bounds().min, buffer);
+            writeVec3f(pointDefinition.bounds().max, buffer);
+
+            const Model::ModelDefinition::List& modelDefinitions = pointDefinition.modelDefinitions();
+            write<uint32_t>(buffer, static_cast<uint32_t>(modelDefinitions.size()));
+            for (size_t i = 0; i < modelDefinitions.size(); i++)
+                if (!writeModelDefinition(*modelDefinitions[i], buffer))
+                    return false;
+            return true;
+        }
+
+        bool EntityDefinitionCacheWriter::writeToBuffer(const EntityDefinitionCache::Key& key, const Model::EntityDefinitionList& definitions, std::vector<char>& buffer) {
+            buffer.clear();
+            writeHeader(EntityDefinitionCache::Magic, EntityDefinitionCache::FormatVersion, buffer);
+            writeString(key.path, buffer);
+            write<uint64_t>(buffer, key.size);
+            write<int64_t>(buffer, key.modificationTime);
+            write<uint64_t>(buffer, key.hash);
+            writeColor(key.defaultColor, buffer);
+
+            write<uint32_t>(buffer, static_cast<uint32_t>(definitions.size()));
+            for (size_t i = 0; i < definitions.size(); i++) {
+                if (!writeDefinition(*definitions[i], buffer)) {
+                    buffer.clear();
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+}
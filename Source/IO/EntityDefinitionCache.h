@@ -0,0 +1,116 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_EntityDefinitionCache_h
+#define TrenchBroom_EntityDefinitionCache_h
+
+#include "IO/BinaryCache.h"
+#include "Model/EntityDefinition.h"
+#include "Model/EntityDefinitionTypes.h"
+#include "Model/PropertyDefinition.h"
+#include "Utility/Color.h"
+#include "Utility/String.h"
+
+#include <vector>
+
+#if defined _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * The entity definition cache is a binary file that stores the definitions parsed from an FGD or DEF file.
+         * It is keyed by the path, size, modification time and contents of the definition file and by the default
+         * entity color, which the parsers assign to definitions that do not specify a color.
+         */
+        class EntityDefinitionCache {
+        public:
+            static const char* Magic;
+            static const uint32_t FormatVersion;
+            static const uint8_t NoEvaluator;
+
+            class Key {
+            public:
+                String path;
+                uint64_t size;
+                int64_t modificationTime;
+                uint64_t hash;
+                Color defaultColor;
+
+                Key() :
+                size(0),
+                modificationTime(0),
+                hash(0) {}
+
+                Key(const String& i_path, const char* begin, const char* end, int64_t i_modificationTime, const Color& i_defaultColor) :
+                path(i_path),
+                size(static_cast<uint64_t>(end - begin)),
+                modificationTime(i_modificationTime),
+                hash(BinaryCache::hash(begin, end)),
+                defaultColor(i_defaultColor) {}
+
+                inline bool operator==(const Key& other) const {
+                    return (path == other.path &&
+                            size == other.size &&
+                            modificationTime == other.modificationTime &&
+                            hash == other.hash &&
+                            defaultColor == other.defaultColor);
+                }
+            };
+
+            static String cachePath(const String& definitionPath);
+        };
+
+        class EntityDefinitionCacheReader : public BinaryCacheReader {
+        protected:
+            using BinaryCacheReader::read;
+
+            Model::PropertyDefinition::Ptr readPropertyDefinition();
+            Model::ModelDefinition::Ptr readModelDefinition();
+            Model::EntityDefinition* readDefinition();
+        public:
+            EntityDefinitionCacheReader(const char* begin, const char* end);
+
+            /**
+             * Reads the cached definitions and appends them to the given list. Returns false if the cache does not
+             * belong to the given key or to this version of TrenchBroom. Throws an IOException if the cache is
+             * corrupt. In both cases, the given list is left unchanged.
+             */
+            bool read(const EntityDefinitionCache::Key& key, Model::EntityDefinitionList& definitions);
+        };
+
+        class EntityDefinitionCacheWriter : public BinaryCacheWriter {
+        protected:
+            void writePropertyDefinition(const Model::PropertyDefinition& definition, std::vector<char>& buffer);
+            bool writeModelDefinition(const Model::ModelDefinition& definition, std::vector<char>& buffer);
+            bool writeDefinition(const Model::EntityDefinition& definition, std::vector<char>& buffer);
+        public:
+            /**
+             * Serializes the given definitions into the given buffer. Returns false if a definition cannot be
+             * represented in the cache.
+             */
+            bool writeToBuffer(const EntityDefinitionCache::Key& key, const Model::EntityDefinitionList& definitions, std::vector<char>& buffer);
+        };
+    }
+}
+
+#endif
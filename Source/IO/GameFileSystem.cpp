@@ -0,0 +1,122 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GameFileSystem.h"
+
+#include "IO/Pak.h"
+
+#include <wx/arrstr.h>
+#include <wx/dir.h>
+
+#include <algorithm>
+
+namespace TrenchBroom {
+    namespace IO {
+        String GameFileIndex::normalizeName(const String& name) {
+            String result = Utility::toLower(name);
+            std::replace(result.begin(), result.end(), '\\', '/');
+            return result;
+        }
+
+        void GameFileIndex::indexPaks(const String& searchPath) {
+            const PakManager::PakList& paks = PakManager::sharedManager->paks(searchPath);
+            PakManager::PakList::const_iterator pakIt, pakEnd;
+            for (pakIt = paks.begin(), pakEnd = paks.end(); pakIt != pakEnd; ++pakIt) {
+                const Pak::PakDirectory& directory = pakIt->directory();
+                Pak::PakDirectory::const_iterator entryIt, entryEnd;
+                for (entryIt = directory.begin(), entryEnd = directory.end(); entryIt != entryEnd; ++entryIt)
+                    m_entries[normalizeName(entryIt->first)] = Entry(entryIt->second.data());
+            }
+        }
+
+        void GameFileIndex::indexLooseFiles(const String& searchPath) {
+            if (!wxDir::Exists(searchPath))
+                return;
+
+            wxArrayString files;
+            wxDir::GetAllFiles(searchPath, &files);
+
+            // the returned paths are prefixed with the search path
+            FileManager fileManager;
+            const char separator = fileManager.pathSeparator();
+            for (size_t i = 0; i < files.size(); i++) {
+                const String path = files[i].ToStdString();
+                size_t start = searchPath.size();
+                while (start < path.size() && path[start] == separator)
+                    start++;
+                m_entries[normalizeName(path.substr(start))] = Entry(path);
+            }
+        }
+
+        GameFileIndex::GameFileIndex(const StringList& searchPaths) {
+            StringList::const_iterator it, end;
+            for (it = searchPaths.begin(), end = searchPaths.end(); it != end; ++it) {
+                indexPaks(*it);
+                indexLooseFiles(*it);
+            }
+        }
+
+        bool GameFileIndex::exists(const String& name) const {
+            return m_entries.find(normalizeName(name)) != m_entries.end();
+        }
+
+        MappedFile::Ptr GameFileIndex::findFile(const String& name) const {
+            EntryMap::const_iterator it = m_entries.find(normalizeName(name));
+            if (it == m_entries.end())
+                return MappedFile::Ptr();
+
+            const Entry& entry = it->second;
+            if (entry.isPakEntry())
+                return entry.pakEntry();
+
+            FileManager fileManager;
+            return fileManager.mapFile(entry.path());
+        }
+
+        GameFileSystem* GameFileSystem::sharedFileSystem = NULL;
+
+        GameFileSystem::~GameFileSystem() {
+            invalidate();
+        }
+
+        const GameFileIndex& GameFileSystem::index(const StringList& searchPaths) {
+            const String key = Utility::join(searchPaths, ",");
+            IndexMap::iterator it = m_indices.find(key);
+            if (it != m_indices.end())
+                return *it->second;
+
+            GameFileIndex* index = new GameFileIndex(searchPaths);
+            m_indices[key] = index;
+            return *index;
+        }
+
+        MappedFile::Ptr GameFileSystem::findFile(const String& name, const StringList& searchPaths) {
+            wxCriticalSectionLocker lock(m_lock);
+            return index(searchPaths).findFile(name);
+        }
+
+        void GameFileSystem::invalidate() {
+            wxCriticalSectionLocker lock(m_lock);
+            IndexMap::iterator it, end;
+            for (it = m_indices.begin(), end = m_indices.end(); it != end; ++it)
+                delete it->second;
+            m_indices.clear();
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__GameFileSystem__
+#define __TrenchBroom__GameFileSystem__
+
+#include "IO/FileManager.h"
+#include "Utility/String.h"
+
+#include <wx/thread.h>
+
+#include <map>
+
+#if defined _WIN32
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * Indexes the loose files and the pak entries of a list of search paths into a single case insensitive
+         * namespace. Later search paths override earlier ones, loose files override pak entries of the same search
+         * path, and paks override the paks that precede them in lexicographical order, just like Quake resolves its
+         * game files. Since the index is complete, lookups never touch the disk unless a loose file is found.
+         */
+        class GameFileIndex {
+        private:
+            class Entry {
+            private:
+                String m_path;
+                MappedFile::Ptr m_pakEntry;
+            public:
+                Entry() {}
+
+                Entry(const String& path) :
+                m_path(path) {}
+
+                Entry(MappedFile::Ptr pakEntry) :
+                m_pakEntry(pakEntry) {}
+
+                inline bool isPakEntry() const {
+                    return m_pakEntry.get() != NULL;
+                }
+
+                inline const String& path() const {
+                    return m_path;
+                }
+
+                inline MappedFile::Ptr pakEntry() const {
+                    return m_pakEntry;
+                }
+            };
+
+            typedef std::tr1::unordered_map<String, Entry> EntryMap;
+
+            EntryMap m_entries;
+
+            static String normalizeName(const String& name);
+            void indexPaks(const String& searchPath);
+            void indexLooseFiles(const String& searchPath);
+        public:
+            GameFileIndex(const StringList& searchPaths);
+
+            bool exists(const String& name) const;
+            MappedFile::Ptr findFile(const String& name) const;
+        };
+
+        /**
+         * Keeps one index for each distinct list of search paths. The indices are only rebuilt after they have been
+         * invalidated, which happens whenever a document's search paths change. Since entity models are loaded on
+         * worker threads, all access to the indices is serialized.
+         */
+        class GameFileSystem {
+        private:
+            typedef std::map<String, GameFileIndex*> IndexMap;
+
+            IndexMap m_indices;
+            wxCriticalSection m_lock;
+
+            const GameFileIndex& index(const StringList& searchPaths);
+        public:
+            static GameFileSystem* sharedFileSystem;
+
+            ~GameFileSystem();
+
+            MappedFile::Ptr findFile(const String& name, const StringList& searchPaths);
+            void invalidate();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__GameFileSystem__) */
@@ -21,8 +21,8 @@
 #define TrenchBroom_IOUtils_h
 
 #include "IO/FileManager.h"
+#include "IO/GameFileSystem.h"
 #include "IO/IOTypes.h"
-#include "IO/Pak.h"
 #include "Utility/String.h"
 #include "Utility/VecMath.h"
 
@@ -30,6 +30,7 @@
 #include <cstring>
 #include <iostream>
 #include <limits>
+#include <vector>
 
 #ifdef _MSC_VER
 #include <cstdint>
@@ -40,23 +41,7 @@ using namespace TrenchBroom::VecMath;
 namespace TrenchBroom {
     namespace IO {
         inline MappedFile::Ptr findGameFile(const String& filePath, const StringList& searchPaths) {
-            MappedFile::Ptr mappedFile;
-            FileManager fileManager;
-
-            StringList::const_reverse_iterator pathIt, pathEnd;
-            for (pathIt = searchPaths.rbegin(), pathEnd = searchPaths.rend(); pathIt != pathEnd; ++pathIt) {
-                const String& searchPath = *pathIt;
-                const String path = fileManager.appendPath(searchPath, filePath);
-                MappedFile::Ptr file;
-                if (fileManager.exists(path) && !fileManager.isDirectory(path))
-                    file = fileManager.mapFile(path);
-                else
-                    file = PakManager::sharedManager->entry(filePath, searchPath);
-                if (file.get() != NULL)
-                    return file;
-            }
-
-            return mappedFile;
+            return GameFileSystem::sharedFileSystem->findFile(filePath, searchPaths);
         }
 
         template <typename T>
@@ -108,6 +93,17 @@ namespace TrenchBroom {
             memcpy(buffer, cursor, n);
             cursor += n;
         }
+
+        template <typename T>
+        inline void write(std::vector<char>& buffer, const T value) {
+            const size_t offset = buffer.size();
+            buffer.resize(offset + sizeof(T));
+            memcpy(&buffer[offset], &value, sizeof(T));
+        }
+
+        inline void writeBytes(std::vector<char>& buffer, const char* bytes, size_t n) {
+            buffer.insert(buffer.end(), bytes, bytes + n);
+        }
     }
 }
 
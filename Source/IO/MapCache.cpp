@@ -0,0 +1,328 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapCache.h"
+
+#include "IO/FileManager.h"
+#include "IO/IOException.h"
+#include "IO/IOUtils.h"
+#include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Map.h"
+#include "Utility/List.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace IO {
+        const char* MapCache::Magic = "TBMC";
+        const uint32_t MapCache::FormatVersion = 1;
+        const uint32_t MapCache::NoIndex = 0xFFFFFFFF;
+
+        String MapCache::cachePath(const String& mapPath) {
+            FileManager fileManager;
+            return fileManager.appendExtension(mapPath, "tbcache");
+        }
+
+        Model::Face* MapCacheReader::readFace(const BBoxf& worldBounds, bool forceIntegerFacePoints) {
+            Model::FacePoints points;
+            for (size_t i = 0; i < 3; i++)
+                points[i] = readVec3f();
+
+            Planef boundary;
+            boundary.normal = readVec3f();
+            boundary.distance = read<float>();
+
+            const String textureName = readString();
+            const float xOffset = read<float>();
+            const float yOffset = read<float>();
+            const float rotation = read<float>();
+            const float xScale = read<float>();
+            const float yScale = read<float>();
+            const size_t filePosition = static_cast<size_t>(read<uint32_t>());
+
+            Model::Face* face = new Model::Face(worldBounds, forceIntegerFacePoints, points, boundary, textureName);
+            face->setXOffset(xOffset);
+            face->setYOffset(yOffset);
+            face->setRotation(rotation);
+            face->setXScale(xScale);
+            face->setYScale(yScale);
+            face->setFilePosition(filePosition);
+            return face;
+        }
+
+        Model::BrushGeometry* MapCacheReader::readGeometry(const Model::FaceList& faces) {
+            Model::VertexList vertices;
+            Model::EdgeList edges;
+            Model::SideList sides;
+
+            try {
+                const size_t vertexCount = readCount(3 * sizeof(float) + 1);
+                vertices.reserve(vertexCount);
+                for (size_t i = 0; i < vertexCount; i++) {
+                    Model::Vertex* vertex = new Model::Vertex();
+                    vertex->position = readVec3f();
+                    vertex->mark = static_cast<Model::Vertex::Mark>(read<uint8_t>());
+                    vertices.push_back(vertex);
+                }
+
+                // the sides must exist before the edges can refer to them
+                const size_t sideCount = readCount(3 * sizeof(uint32_t) + 1);
+                sides.reserve(sideCount);
+                for (size_t i = 0; i < sideCount; i++)
+                    sides.push_back(new Model::Side());
+
+                const size_t edgeCount = readCount(4 * sizeof(uint32_t) + 1);
+                edges.reserve(edgeCount);
+                for (size_t i = 0; i < edgeCount; i++) {
+                    const uint32_t start = read<uint32_t>();
+                    const uint32_t end = read<uint32_t>();
+                    const uint32_t left = read<uint32_t>();
+                    const uint32_t right = read<uint32_t>();
+                    if (start >= vertexCount || end >= vertexCount ||
+                        (left != MapCache::NoIndex && left >= sideCount) ||
+                        (right != MapCache::NoIndex && right >= sideCount))
+                        throw IOException("Invalid edge in geometry cache");
+
+                    Model::Edge* edge = new Model::Edge(vertices[start], vertices[end],
+                                                        left != MapCache::NoIndex ? sides[left] : NULL,
+                                                        right != MapCache::NoIndex ? sides[right] : NULL);
+                    edge->mark = static_cast<Model::Edge::Mark>(read<uint8_t>());
+                    edges.push_back(edge);
+                }
+
+                for (size_t i = 0; i < sideCount; i++) {
+                    Model::Side* side = sides[i];
+                    const uint32_t faceIndex = read<uint32_t>();
+                    if (faceIndex != MapCache::NoIndex && faceIndex >= faces.size())
+                        throw IOException("Invalid side in geometry cache");
+                    side->face = faceIndex != MapCache::NoIndex ? faces[faceIndex] : NULL;
+                    side->mark = static_cast<Model::Side::Mark>(read<uint8_t>());
+
+                    const size_t sideEdgeCount = readCount(sizeof(uint32_t));
+                    side->edges.reserve(sideEdgeCount);
+                    side->vertices.reserve(sideEdgeCount);
+                    for (size_t j = 0; j < sideEdgeCount; j++) {
+                        const uint32_t edgeIndex = read<uint32_t>();
+                        if (edgeIndex >= edgeCount)
+                            throw IOException("Invalid side in geometry cache");
+
+                        Model::Edge* edge = edges[edgeIndex];
+                        Model::Vertex* vertex = edge->startVertex(side);
+                        if (vertex == NULL)
+                            throw IOException("Invalid side in geometry cache");
+                        side->edges.push_back(edge);
+                        side->vertices.push_back(vertex);
+                    }
+                }
+            } catch (...) {
+                Utility::deleteAll(sides);
+                Utility::deleteAll(edges);
+                Utility::deleteAll(vertices);
+                throw;
+            }
+
+            return new Model::BrushGeometry(vertices, edges, sides);
+        }
+
+        Model::Brush* MapCacheReader::readBrush(const BBoxf& worldBounds) {
+            const size_t fileLine = static_cast<size_t>(read<uint32_t>());
+            const size_t fileLineCount = static_cast<size_t>(read<uint32_t>());
+            const bool forceIntegerFacePoints = read<uint8_t>() != 0;
+
+            Model::FaceList faces;
+            Model::BrushGeometry* geometry = NULL;
+            try {
+                const size_t faceCount = readCount(17 * sizeof(float) + 2 * sizeof(uint32_t));
+                faces.reserve(faceCount);
+                for (size_t i = 0; i < faceCount; i++)
+                    faces.push_back(readFace(worldBounds, forceIntegerFacePoints));
+                geometry = readGeometry(faces);
+            } catch (...) {
+                Utility::deleteAll(faces);
+                throw;
+            }
+
+            Model::Brush* brush = new Model::Brush(worldBounds, forceIntegerFacePoints, faces, geometry);
+            brush->setFilePosition(fileLine, fileLineCount);
+            return brush;
+        }
+
+        Model::Entity* MapCacheReader::readEntity(const BBoxf& worldBounds) {
+            Model::Entity* entity = new Model::Entity(worldBounds);
+            try {
+                const size_t fileLine = static_cast<size_t>(read<uint32_t>());
+                const size_t fileLineCount = static_cast<size_t>(read<uint32_t>());
+                entity->setFilePosition(fileLine, fileLineCount);
+
+                const size_t propertyCount = readCount(2 * sizeof(uint32_t));
+                for (size_t i = 0; i < propertyCount; i++) {
+                    const Model::PropertyKey key = readString();
+                    const Model::PropertyValue value = readString();
+                    entity->setProperty(key, value);
+                }
+
+                const size_t brushCount = readCount(4 * sizeof(uint32_t) + 1);
+                for (size_t i = 0; i < brushCount; i++)
+                    entity->addBrush(*readBrush(worldBounds));
+            } catch (...) {
+                delete entity;
+                throw;
+            }
+            return entity;
+        }
+
+        MapCacheReader::MapCacheReader(const char* begin, const char* end) :
+        BinaryCacheReader(begin, end) {}
+
+        bool MapCacheReader::read(Model::Map& map, uint64_t mapHash) {
+            if (!readHeader(MapCache::Magic, MapCache::FormatVersion))
+                return false;
+            if (read<uint64_t>() != mapHash)
+                return false;
+
+            Model::EntityList entities;
+            try {
+                const size_t entityCount = readCount(4 * sizeof(uint32_t));
+                entities.reserve(entityCount);
+                for (size_t i = 0; i < entityCount; i++)
+                    entities.push_back(readEntity(map.worldBounds()));
+            } catch (...) {
+                Utility::deleteAll(entities);
+                throw;
+            }
+
+            for (size_t i = 0; i < entities.size(); i++)
+                map.addEntity(*entities[i]);
+            return true;
+        }
+
+        void MapCacheWriter::writeFace(const Model::Face& face, std::vector<char>& buffer) {
+            for (size_t i = 0; i < 3; i++)
+                writeVec3f(face.point(i), buffer);
+            writeVec3f(face.boundary().normal, buffer);
+            write<float>(buffer, face.boundary().distance);
+            writeString(face.textureName(), buffer);
+            write<float>(buffer, face.xOffset());
+            write<float>(buffer, face.yOffset());
+            write<float>(buffer, face.rotation());
+            write<float>(buffer, face.xScale());
+            write<float>(buffer, face.yScale());
+            write<uint32_t>(buffer, static_cast<uint32_t>(face.filePosition()));
+        }
+
+        void MapCacheWriter::writeGeometry(const Model::Brush& brush, std::vector<char>& buffer) {
+            const Model::FaceList& faces = brush.faces();
+            const Model::VertexList& vertices = brush.vertices();
+            const Model::EdgeList& edges = brush.edges();
+            const Model::SideList& sides = brush.sides();
+
+            FaceIndexMap faceIndices;
+            for (size_t i = 0; i < faces.size(); i++)
+                faceIndices[faces[i]] = static_cast<uint32_t>(i);
+
+            VertexIndexMap vertexIndices;
+            write<uint32_t>(buffer, static_cast<uint32_t>(vertices.size()));
+            for (size_t i = 0; i < vertices.size(); i++) {
+                const Model::Vertex& vertex = *vertices[i];
+                vertexIndices[&vertex] = static_cast<uint32_t>(i);
+                writeVec3f(vertex.position, buffer);
+                write<uint8_t>(buffer, static_cast<uint8_t>(vertex.mark));
+            }
+
+            SideIndexMap sideIndices;
+            write<uint32_t>(buffer, static_cast<uint32_t>(sides.size()));
+            for (size_t i = 0; i < sides.size(); i++)
+                sideIndices[sides[i]] = static_cast<uint32_t>(i);
+
+            EdgeIndexMap edgeIndices;
+            write<uint32_t>(buffer, static_cast<uint32_t>(edges.size()));
+            for (size_t i = 0; i < edges.size(); i++) {
+                const Model::Edge& edge = *edges[i];
+                edgeIndices[&edge] = static_cast<uint32_t>(i);
+                write<uint32_t>(buffer, vertexIndices[edge.start]);
+                write<uint32_t>(buffer, vertexIndices[edge.end]);
+                write<uint32_t>(buffer, edge.left != NULL ? sideIndices[edge.left] : MapCache::NoIndex);
+                write<uint32_t>(buffer, edge.right != NULL ? sideIndices[edge.right] : MapCache::NoIndex);
+                write<uint8_t>(buffer, static_cast<uint8_t>(edge.mark));
+            }
+
+            for (size_t i = 0; i < sides.size(); i++) {
+                const Model::Side& side = *sides[i];
+                write<uint32_t>(buffer, side.face != NULL ? faceIndices[side.face] : MapCache::NoIndex);
+                write<uint8_t>(buffer, static_cast<uint8_t>(side.mark));
+                write<uint32_t>(buffer, static_cast<uint32_t>(side.edges.size()));
+                for (size_t j = 0; j < side.edges.size(); j++)
+                    write<uint32_t>(buffer, edgeIndices[side.edges[j]]);
+            }
+        }
+
+        void MapCacheWriter::writeBrush(const Model::Brush& brush, std::vector<char>& buffer) {
+            write<uint32_t>(buffer, static_cast<uint32_t>(brush.fileLine()));
+            write<uint32_t>(buffer, static_cast<uint32_t>(brush.fileLineCount()));
+            write<uint8_t>(buffer, brush.forceIntegerFacePoints() ? 1 : 0);
+
+            const Model::FaceList& faces = brush.faces();
+            write<uint32_t>(buffer, static_cast<uint32_t>(faces.size()));
+            for (size_t i = 0; i < faces.size(); i++)
+                writeFace(*faces[i], buffer);
+
+            writeGeometry(brush, buffer);
+        }
+
+        void MapCacheWriter::writeEntity(const Model::Entity& entity, std::vector<char>& buffer) {
+            write<uint32_t>(buffer, static_cast<uint32_t>(entity.fileLine()));
+            write<uint32_t>(buffer, static_cast<uint32_t>(entity.fileLineCount()));
+
+            const Model::PropertyList& properties = entity.properties();
+            write<uint32_t>(buffer, static_cast<uint32_t>(properties.size()));
+            for (size_t i = 0; i < properties.size(); i++) {
+                writeString(properties[i].key(), buffer);
+                writeString(properties[i].value(), buffer);
+            }
+
+            const Model::BrushList& brushes = entity.brushes();
+            write<uint32_t>(buffer, static_cast<uint32_t>(brushes.size()));
+            for (size_t i = 0; i < brushes.size(); i++)
+                writeBrush(*brushes[i], buffer);
+        }
+
+        void MapCacheWriter::writeToBuffer(const Model::Map& map, uint64_t mapHash, std::vector<char>& buffer) {
+            buffer.clear();
+            writeHeader(MapCache::Magic, MapCache::FormatVersion, buffer);
+            write<uint64_t>(buffer, mapHash);
+
+            const Model::EntityList& entities = map.entities();
+            write<uint32_t>(buffer, static_cast<uint32_t>(entities.size()));
+            for (size_t i = 0; i < entities.size(); i++)
+                writeEntity(*entities[i], buffer);
+        }
+
+        bool MapCacheWriteTask::compute() {
+            return BinaryCache::writeFile(m_cachePath, m_buffer);
+        }
+
+        MapCacheWriteTask::MapCacheWriteTask(const String& cachePath, std::vector<char>& buffer) :
+        m_cachePath(cachePath) {
+            m_buffer.swap(buffer);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapCache_h
+#define TrenchBroom_MapCache_h
+
+#include "IO/BinaryCache.h"
+#include "Model/BrushGeometryTypes.h"
+#include "Model/BrushTypes.h"
+#include "Model/EntityTypes.h"
+#include "Model/FaceTypes.h"
+#include "Utility/Future.h"
+#include "Utility/String.h"
+#include "Utility/VecMath.h"
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+#if defined _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class Brush;
+        class BrushGeometry;
+        class Entity;
+        class Face;
+        class Map;
+    }
+
+    namespace IO {
+        /**
+         * The geometry cache is a binary sidecar file that stores a map's entities, brushes and faces together
+         * with the fully computed brush geometry. It is keyed by a hash of the map file's contents and by the
+         * TrenchBroom version, so that it is ignored as soon as either of them changes.
+         */
+        class MapCache {
+        public:
+            static const char* Magic;
+            static const uint32_t FormatVersion;
+            static const uint32_t NoIndex;
+
+            static String cachePath(const String& mapPath);
+        };
+
+        class MapCacheReader : public BinaryCacheReader {
+        protected:
+            using BinaryCacheReader::read;
+
+            Model::Face* readFace(const BBoxf& worldBounds, bool forceIntegerFacePoints);
+            Model::BrushGeometry* readGeometry(const Model::FaceList& faces);
+            Model::Brush* readBrush(const BBoxf& worldBounds);
+            Model::Entity* readEntity(const BBoxf& worldBounds);
+        public:
+            MapCacheReader(const char* begin, const char* end);
+
+            /**
+             * Reads the cached entities into the given map. Returns false if the cache does not belong to the
+             * given map hash or to this version of TrenchBroom. Throws an IOException if the cache is corrupt. In
+             * both cases, the map is left unchanged.
+             */
+            bool read(Model::Map& map, uint64_t mapHash);
+        };
+
+        class MapCacheWriter : public BinaryCacheWriter {
+        protected:
+            typedef std::map<const Model::Vertex*, uint32_t> VertexIndexMap;
+            typedef std::map<const Model::Edge*, uint32_t> EdgeIndexMap;
+            typedef std::map<const Model::Side*, uint32_t> SideIndexMap;
+            typedef std::map<const Model::Face*, uint32_t> FaceIndexMap;
+
+            void writeFace(const Model::Face& face, std::vector<char>& buffer);
+            void writeGeometry(const Model::Brush& brush, std::vector<char>& buffer);
+            void writeBrush(const Model::Brush& brush, std::vector<char>& buffer);
+            void writeEntity(const Model::Entity& entity, std::vector<char>& buffer);
+        public:
+            void writeToBuffer(const Model::Map& map, uint64_t mapHash, std::vector<char>& buffer);
+        };
+
+        /**
+         * Writes a serialized geometry cache to disk on the thread pool. The result tells whether the file was
+         * written.
+         */
+        class MapCacheWriteTask : public Utility::AsyncTask<bool> {
+        protected:
+            const String m_cachePath;
+            std::vector<char> m_buffer;
+
+            bool compute();
+        public:
+            /**
+             * Takes ownership of the contents of the given buffer to avoid copying it on the UI thread.
+             */
+            MapCacheWriteTask(const String& cachePath, std::vector<char>& buffer);
+        };
+    }
+}
+
+#endif
@@ -35,10 +35,16 @@
 
 namespace TrenchBroom {
     namespace IO {
-        size_t MapWriter::writeFace(Model::Face& face, const size_t lineNumber, FILE* stream) {
-            const String textureName = Utility::isBlank(face.textureName()) ? Model::Texture::Empty : face.textureName();
-
-            std::fprintf(stream, FaceFormat.c_str(),
+        void MapWriter::appendFace(const Model::Face& face, String& buffer) {
+            // large enough for nine floats printed with FloatPrecision significant digits
+            char pointsBuffer[2048];
+            char attributesBuffer[256];
+            
+#if defined _MSC_VER
+            sprintf_s(pointsBuffer, FacePointsFormat.c_str(),
+#else
+            std::sprintf(pointsBuffer, FacePointsFormat.c_str(),
+#endif
                     face.point(0).x(),
                     face.point(0).y(),
                     face.point(0).z(),
@@ -47,43 +53,86 @@ namespace TrenchBroom {
                     face.point(1).z(),
                     face.point(2).x(),
                     face.point(2).y(),
-                    face.point(2).z(),
-                    textureName.c_str(),
+                    face.point(2).z());
+
+#if defined _MSC_VER
+            sprintf_s(attributesBuffer, FaceAttributesFormat.c_str(),
+#else
+            std::sprintf(attributesBuffer, FaceAttributesFormat.c_str(),
+#endif
                     face.xOffset(),
                     face.yOffset(),
                     face.rotation(),
                     face.xScale(),
                     face.yScale());
-            face.setFilePosition(lineNumber);
-            return 1;
+            
+            buffer += pointsBuffer;
+            buffer += Utility::isBlank(face.textureName()) ? Model::Texture::Empty : face.textureName();
+            buffer += attributesBuffer;
         }
         
-        size_t MapWriter::writeBrush(Model::Brush& brush, const size_t lineNumber, FILE* stream) {
-            size_t lineCount = 0;
-            std::fprintf(stream, "{\n"); lineCount++;
+        void MapWriter::appendBrush(const Model::Brush& brush, String& buffer) {
+            buffer += "{\n";
             const Model::FaceList& faces = brush.faces();
             Model::FaceList::const_iterator faceIt, faceEnd;
-            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
-                lineCount += writeFace(**faceIt, lineNumber + lineCount, stream);
-            }
-            std::fprintf(stream, "}\n"); lineCount++;
-            brush.setFilePosition(lineNumber, lineCount);
-            return lineCount;
+            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt)
+                appendFace(**faceIt, buffer);
+            buffer += "}\n";
         }
         
-        size_t MapWriter::writeEntityHeader(Model::Entity& entity, FILE* stream) {
-            size_t lineCount = 0;
-            std::fprintf(stream, "{\n"); lineCount++;
+        void MapWriter::appendEntityHeader(const Model::Entity& entity, String& buffer) {
+            buffer += "{\n";
             
             const Model::PropertyList& properties = entity.properties();
             Model::PropertyList::const_iterator it, end;
             for (it = properties.begin(), end = properties.end(); it != end; ++it) {
                 const Model::Property& property = *it;
-                std::fprintf(stream, "\"%s\" \"%s\"\n", property.key().c_str(), property.value().c_str()); lineCount++;
+                buffer += "\"";
+                buffer += property.key();
+                buffer += "\" \"";
+                buffer += property.value();
+                buffer += "\"\n";
+            }
+        }
+
+        const String& MapWriter::serializedBrush(const Model::Brush& brush) {
+            // only brushes that have changed since the last save need to be formatted again
+            if (!brush.serializedTextValid()) {
+                String text;
+                appendBrush(brush, text);
+                brush.setSerializedText(text);
             }
+            return brush.serializedText();
+        }
+        
+        const String& MapWriter::serializedEntityHeader(const Model::Entity& entity) {
+            if (!entity.serializedTextValid()) {
+                String text;
+                appendEntityHeader(entity, text);
+                entity.setSerializedText(text);
+            }
+            return entity.serializedText();
+        }
+
+        size_t MapWriter::writeBrush(Model::Brush& brush, const size_t lineNumber, FILE* stream) {
+            const String& text = serializedBrush(brush);
+            std::fwrite(text.data(), 1, text.size(), stream);
+            
+            const Model::FaceList& faces = brush.faces();
+            for (size_t i = 0; i < faces.size(); i++)
+                faces[i]->setFilePosition(lineNumber + 1 + i);
+            
+            const size_t lineCount = faces.size() + 2;
+            brush.setFilePosition(lineNumber, lineCount);
             return lineCount;
         }
         
+        size_t MapWriter::writeEntityHeader(Model::Entity& entity, FILE* stream) {
+            const String& text = serializedEntityHeader(entity);
+            std::fwrite(text.data(), 1, text.size(), stream);
+            return entity.properties().size() + 1;
+        }
+        
         size_t MapWriter::writeEntityFooter(FILE* stream) {
             std::fprintf(stream, "}\n");
             return 1;
@@ -171,10 +220,10 @@ namespace TrenchBroom {
               "%." << FloatPrecision << "g ) " <<
             "( %." << FloatPrecision << "g " <<
               "%." << FloatPrecision << "g " <<
-              "%." << FloatPrecision << "g ) " <<
-            "%s %.6g %.6g %.6g %.6g %.6g\n";
+              "%." << FloatPrecision << "g ) ";
             
-            FaceFormat = str.str();
+            FacePointsFormat = str.str();
+            FaceAttributesFormat = " %.6g %.6g %.6g %.6g %.6g\n";
         }
         
         void MapWriter::writeObjectsToStream(const Model::EntityList& pointEntities, const Model::BrushList& brushes, std::ostream& stream) {
@@ -245,6 +294,19 @@ namespace TrenchBroom {
                 writeEntity(*entities[i], stream);
         }
         
+        void MapWriter::writeToBuffer(const Model::Map& map, String& buffer) {
+            const Model::EntityList& entities = map.entities();
+            for (unsigned int i = 0; i < entities.size(); i++) {
+                const Model::Entity& entity = *entities[i];
+                buffer += serializedEntityHeader(entity);
+                
+                const Model::BrushList& brushes = entity.brushes();
+                for (unsigned int j = 0; j < brushes.size(); j++)
+                    buffer += serializedBrush(*brushes[j]);
+                buffer += "}\n";
+            }
+        }
+        
         void MapWriter::writeToFileAtPath(Model::Map& map, const String& path, bool overwrite) {
             FileManager fileManager;
             if (fileManager.exists(path) && !overwrite)
@@ -46,9 +46,15 @@ namespace TrenchBroom {
         class MapWriter {
         private:
             static const int FloatPrecision = 100;
-            String FaceFormat;
+            String FacePointsFormat;
+            String FaceAttributesFormat;
         protected:
-            size_t writeFace(Model::Face& face, const size_t lineNumber, FILE* stream);
+            void appendFace(const Model::Face& face, String& buffer);
+            void appendBrush(const Model::Brush& brush, String& buffer);
+            void appendEntityHeader(const Model::Entity& entity, String& buffer);
+            const String& serializedBrush(const Model::Brush& brush);
+            const String& serializedEntityHeader(const Model::Entity& entity);
+            
             size_t writeBrush(Model::Brush& brush, const size_t lineNumber, FILE* stream);
             size_t writeEntityHeader(Model::Entity& entity, FILE* stream);
             size_t writeEntityFooter(FILE* stream);
@@ -64,6 +70,7 @@ namespace TrenchBroom {
             void writeObjectsToStream(const Model::EntityList& pointEntities, const Model::BrushList& brushes, std::ostream& stream);
             void writeFacesToStream(const Model::FaceList& faces, std::ostream& stream);
             void writeToStream(const Model::Map& map, std::ostream& stream);
+            void writeToBuffer(const Model::Map& map, String& buffer);
             void writeToFileAtPath(Model::Map& map, const String& path, bool overwrite);
         };
     }
@@ -55,8 +55,8 @@ namespace TrenchBroom {
             }
         }
         
-        MappedFile::Ptr Pak::entry(const String& name) {
-            PakDirectory::iterator it = m_directory.find(Utility::toLower(name));
+        MappedFile::Ptr Pak::entry(const String& name) const {
+            PakDirectory::const_iterator it = m_directory.find(Utility::toLower(name));
             if (it == m_directory.end())
                 return MappedFile::Ptr();
             
@@ -66,49 +66,27 @@ namespace TrenchBroom {
 
         PakManager* PakManager::sharedManager = NULL;
         
-        bool PakManager::findPaks(const String& path, PakList& result) {
+        const PakManager::PakList& PakManager::paks(const String& path) {
             String lowerPath = Utility::toLower(path);
             PakMap::iterator it = m_paks.find(lowerPath);
+            if (it != m_paks.end())
+                return it->second;
             
-            if (it != m_paks.end()) {
-                result = it->second;
-                return true;
-            }
+            PakList& newPaks = m_paks[lowerPath];
             
             FileManager fileManager;
             const StringList pakNames = fileManager.directoryContents(path, "pak");
-            if (!pakNames.empty()) {
-                PakList newPaks;
-                for (unsigned int i = 0; i < pakNames.size(); i++) {
-                    String pakPath = fileManager.appendPath(path, pakNames[i]);
-                    if (!fileManager.isDirectory(pakPath)) {
-                        MappedFile::Ptr file = fileManager.mapFile(pakPath);
-                        assert(file.get() != NULL);
-                        newPaks.push_back(Pak(pakPath, file));
-                    }
-                }
-
-                std::sort(newPaks.begin(), newPaks.end(), ComparePaksByPath());
-                m_paks[lowerPath] = newPaks;
-                result = newPaks;
-                return true;
-            }
-            
-            return false;
-        }
-
-        MappedFile::Ptr PakManager::entry(const String& name, const String& searchPath) {
-            PakList paks;
-            if (findPaks(searchPath, paks)) {
-                PakList::reverse_iterator pak, endPak;
-                for (pak = paks.rbegin(), endPak = paks.rend(); pak != endPak; ++pak) {
-                    MappedFile::Ptr data = pak->entry(name);
-                    if (data.get() != NULL)
-                        return data;
+            for (unsigned int i = 0; i < pakNames.size(); i++) {
+                String pakPath = fileManager.appendPath(path, pakNames[i]);
+                if (!fileManager.isDirectory(pakPath)) {
+                    MappedFile::Ptr file = fileManager.mapFile(pakPath);
+                    assert(file.get() != NULL);
+                    newPaks.push_back(Pak(pakPath, file));
                 }
             }
             
-            return MappedFile::Ptr();
+            std::sort(newPaks.begin(), newPaks.end(), ComparePaksByPath());
+            return newPaks;
         }
     }
 }
@@ -63,9 +63,12 @@ namespace TrenchBroom {
         };
 
         class Pak {
-        private:
+        public:
+            /**
+             * Maps the lowercase entry names to the entries.
+             */
             typedef std::map<String, PakEntry> PakDirectory;
-
+        private:
             String m_path;
             MappedFile::Ptr m_file;
             PakDirectory m_directory;
@@ -76,7 +79,11 @@ namespace TrenchBroom {
                 return m_path;
             }
 
-            MappedFile::Ptr entry(const String& name);
+            inline const PakDirectory& directory() const {
+                return m_directory;
+            }
+
+            MappedFile::Ptr entry(const String& name) const;
         };
 
         class ComparePaksByPath {
@@ -87,16 +94,20 @@ namespace TrenchBroom {
         };
 
         class PakManager {
-        private:
+        public:
             typedef std::vector<Pak> PakList;
+        private:
             typedef std::map<String, PakList> PakMap;
 
             PakMap m_paks;
-            bool findPaks(const String& path, PakList& result);
         public:
             static PakManager* sharedManager;
 
-            MappedFile::Ptr entry(const String& name, const String& searchPath);
+            /**
+             * Returns the paks in the given directory, sorted by their paths. The result is cached, even if the
+             * directory does not contain any paks.
+             */
+            const PakList& paks(const String& path);
         };
     }
 }
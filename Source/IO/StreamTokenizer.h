@@ -83,8 +83,13 @@ namespace TrenchBroom {
                 return m_column;
             }
 
+            // tokens may be converted on several threads at once, so the buffers must not be shared, and tokens
+            // which do not fit into the buffer are converted from a copy on the heap
             inline float toFloat() const {
-                static char buffer[64];
+                char buffer[64];
+                if (length() >= sizeof(buffer))
+                    return static_cast<float>(std::atof(data().c_str()));
+                
                 memcpy(buffer, m_begin, length());
                 buffer[length()] = 0;
                 float f = static_cast<float>(std::atof(buffer));
@@ -92,7 +97,10 @@ namespace TrenchBroom {
             }
 
             inline int toInteger() const {
-                static char buffer[64];
+                char buffer[64];
+                if (length() >= sizeof(buffer))
+                    return static_cast<int>(std::atoi(data().c_str()));
+                
                 memcpy(buffer, m_begin, length());
                 buffer[length()] = 0;
                 int i = static_cast<int>(std::atoi(buffer));
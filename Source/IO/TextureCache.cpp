@@ -0,0 +1,107 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureCache.h"
+
+#include "IO/FileManager.h"
+#include "IO/IOException.h"
+#include "IO/IOUtils.h"
+#include "Utility/List.h"
+
+#include <iomanip>
+
+namespace TrenchBroom {
+    namespace IO {
+        const char* TextureCache::Magic = "TBTX";
+        const uint32_t TextureCache::FormatVersion = 1;
+
+        String TextureCache::cachePath(const Key& key) {
+            StringStream cacheName;
+            cacheName << std::hex << std::setw(16) << std::setfill('0') << key.wadHash;
+
+            FileManager fileManager;
+            const String cacheDirectory = fileManager.appendPath(fileManager.cacheDirectory(), "Textures");
+            return fileManager.appendPath(cacheDirectory, fileManager.appendExtension(cacheName.str(), "tbtex"));
+        }
+
+        TextureCache::Entry* TextureCacheReader::readEntry() {
+            const String name = readString();
+            const uint8_t format = read<uint8_t>();
+            const unsigned int width = static_cast<unsigned int>(read<uint32_t>());
+            const unsigned int height = static_cast<unsigned int>(read<uint32_t>());
+            if (width == 0 || height == 0)
+                throw IOException("Invalid texture dimensions (%ux%u) in texture cache", width, height);
+
+            const Color averageColor = readColor();
+            const size_t size = readCount(1);
+            unsigned char* data = new unsigned char[size];
+            memcpy(data, m_cursor, size);
+            m_cursor += size;
+
+            return new TextureCache::Entry(name, format, width, height, averageColor, data, size);
+        }
+
+        TextureCacheReader::TextureCacheReader(const char* begin, const char* end) :
+        BinaryCacheReader(begin, end) {}
+
+        bool TextureCacheReader::read(const TextureCache::Key& key, TextureCache::Entry::List& entries) {
+            if (!readHeader(TextureCache::Magic, TextureCache::FormatVersion))
+                return false;
+
+            TextureCache::Key cachedKey;
+            cachedKey.wadHash = read<uint64_t>();
+            cachedKey.paletteHash = read<uint64_t>();
+            if (!(cachedKey == key))
+                return false;
+
+            TextureCache::Entry::List result;
+            try {
+                const size_t entryCount = readCount(sizeof(uint32_t) + 1 + 2 * sizeof(uint32_t) + 4 * sizeof(float) + sizeof(uint32_t));
+                result.reserve(entryCount);
+                for (size_t i = 0; i < entryCount; i++)
+                    result.push_back(readEntry());
+            } catch (...) {
+                Utility::deleteAll(result);
+                throw;
+            }
+
+            entries.insert(entries.end(), result.begin(), result.end());
+            return true;
+        }
+
+        void TextureCacheWriter::writeToBuffer(const TextureCache::Key& key, const TextureCache::Entry::List& entries, std::vector<char>& buffer) {
+            buffer.clear();
+            writeHeader(TextureCache::Magic, TextureCache::FormatVersion, buffer);
+            write<uint64_t>(buffer, key.wadHash);
+            write<uint64_t>(buffer, key.paletteHash);
+
+            write<uint32_t>(buffer, static_cast<uint32_t>(entries.size()));
+            for (size_t i = 0; i < entries.size(); i++) {
+                const TextureCache::Entry& entry = *entries[i];
+                writeString(entry.name(), buffer);
+                write<uint8_t>(buffer, entry.format());
+                write<uint32_t>(buffer, static_cast<uint32_t>(entry.width()));
+                write<uint32_t>(buffer, static_cast<uint32_t>(entry.height()));
+                writeColor(entry.averageColor(), buffer);
+                write<uint32_t>(buffer, static_cast<uint32_t>(entry.size()));
+                writeBytes(buffer, reinterpret_cast<const char*>(entry.data()), entry.size());
+            }
+        }
+    }
+}
@@ -0,0 +1,163 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_TextureCache_h
+#define TrenchBroom_TextureCache_h
+
+#include "IO/BinaryCache.h"
+#include "Utility/Color.h"
+#include "Utility/String.h"
+
+#include <vector>
+
+#if defined _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * The texture cache is a binary file that stores the compressed images of the textures in a wad file. It is
+         * named after the hash of the wad contents, so identical wads share a cache no matter where they are
+         * located, and it is only used if it was created with the same palette.
+         */
+        class TextureCache {
+        public:
+            static const char* Magic;
+            static const uint32_t FormatVersion;
+
+            class Key {
+            public:
+                uint64_t wadHash;
+                uint64_t paletteHash;
+
+                Key() :
+                wadHash(0),
+                paletteHash(0) {}
+
+                Key(const char* wadBegin, const char* wadEnd, const char* paletteBegin, const char* paletteEnd) :
+                wadHash(BinaryCache::hash(wadBegin, wadEnd)),
+                paletteHash(BinaryCache::hash(paletteBegin, paletteEnd)) {}
+
+                inline bool operator==(const Key& other) const {
+                    return wadHash == other.wadHash && paletteHash == other.paletteHash;
+                }
+            };
+
+            /**
+             * A compressed texture image. The format is opaque to the cache, and the entry owns the image data until
+             * it is released.
+             */
+            class Entry {
+            public:
+                typedef std::vector<Entry*> List;
+            private:
+                String m_name;
+                uint8_t m_format;
+                unsigned int m_width;
+                unsigned int m_height;
+                Color m_averageColor;
+                unsigned char* m_data;
+                size_t m_size;
+
+                // prevent copying
+                Entry(const Entry& other);
+                void operator= (const Entry& other);
+            public:
+                Entry(const String& name, uint8_t format, unsigned int width, unsigned int height, const Color& averageColor, unsigned char* data, size_t size) :
+                m_name(name),
+                m_format(format),
+                m_width(width),
+                m_height(height),
+                m_averageColor(averageColor),
+                m_data(data),
+                m_size(size) {}
+
+                ~Entry() {
+                    delete [] m_data;
+                    m_data = NULL;
+                }
+
+                inline const String& name() const {
+                    return m_name;
+                }
+
+                inline uint8_t format() const {
+                    return m_format;
+                }
+
+                inline unsigned int width() const {
+                    return m_width;
+                }
+
+                inline unsigned int height() const {
+                    return m_height;
+                }
+
+                inline const Color& averageColor() const {
+                    return m_averageColor;
+                }
+
+                inline const unsigned char* data() const {
+                    return m_data;
+                }
+
+                inline size_t size() const {
+                    return m_size;
+                }
+
+                /**
+                 * Passes the ownership of the image data to the caller.
+                 */
+                inline unsigned char* releaseData() {
+                    unsigned char* data = m_data;
+                    m_data = NULL;
+                    return data;
+                }
+            };
+
+            static String cachePath(const Key& key);
+        };
+
+        class TextureCacheReader : public BinaryCacheReader {
+        protected:
+            using BinaryCacheReader::read;
+
+            TextureCache::Entry* readEntry();
+        public:
+            TextureCacheReader(const char* begin, const char* end);
+
+            /**
+             * Reads the cached textures and appends them to the given list. Returns false if the cache does not
+             * belong to the given key or to this version of TrenchBroom. Throws an IOException if the cache is
+             * corrupt. In both cases, the given list is left unchanged.
+             */
+            bool read(const TextureCache::Key& key, TextureCache::Entry::List& entries);
+        };
+
+        class TextureCacheWriter : public BinaryCacheWriter {
+        public:
+            void writeToBuffer(const TextureCache::Key& key, const TextureCache::Entry::List& entries, std::vector<char>& buffer);
+        };
+    }
+}
+
+#endif
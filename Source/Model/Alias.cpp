@@ -55,78 +55,52 @@ namespace TrenchBroom {
         m_center(center),
         m_bounds(bounds) {}
 
-        AliasSingleFrame* AliasSingleFrame::firstFrame() {
-            return this;
-        }
-
-        AliasFrameGroup::AliasFrameGroup(const AliasTimeList& times, const AliasSingleFrameList& frames) :
-        m_times(times),
-        m_frames(frames) {
-            assert(m_times.size() == m_frames.size());
-
-            if (!m_frames.empty()) {
-                m_bounds = m_frames[0]->bounds();
-                for (size_t i = 1; i < m_frames.size(); i++)
-                    m_bounds.mergeWith(m_frames[i]->bounds());
-            } else {
-                m_bounds.min = m_bounds.max = Vec3f::Null;
-            }
-        }
-
-        AliasFrameGroup::~AliasFrameGroup() {
-            Utility::deleteAll(m_frames);
-        }
-
-        AliasSingleFrame* AliasFrameGroup::firstFrame() {
-            return m_frames[0];
-        }
-
-        Vec3f Alias::unpackFrameVertex(const AliasPackedFrameVertex& packedVertex, const Vec3f& origin, const Vec3f& size) {
+        Vec3f Alias::unpackFrameVertex(const AliasPackedFrameVertex& packedVertex) const {
             Vec3f vertex;
             for (size_t i = 0; i < 3; i++)
-                vertex[i] = size[i] * packedVertex[i] + origin[i];
+                vertex[i] = m_scale[i] * packedVertex[i] + m_origin[i];
             return vertex;
         }
 
-        AliasSingleFrame* Alias::readFrame(char*& cursor, const Vec3f& origin, const Vec3f& scale, unsigned int skinWidth, unsigned int skinHeight, const AliasSkinVertexList& vertices, const AliasSkinTriangleList& triangles) {
+        AliasSingleFrame* Alias::readFrame(char* cursor) const {
             using namespace IO;
             
             char name[AliasLayout::SimpleFrameLength];
             cursor += AliasLayout::SimpleFrameName;
             readBytes(cursor, name, AliasLayout::SimpleFrameLength);
 
-            std::vector<AliasPackedFrameVertex> packedFrameVertices(vertices.size());
-            readBytes(cursor, reinterpret_cast<char*>(&packedFrameVertices[0]), vertices.size() * 4);
+            std::vector<AliasPackedFrameVertex> packedFrameVertices(m_vertices.size());
+            readBytes(cursor, reinterpret_cast<char*>(&packedFrameVertices[0]), m_vertices.size() * 4);
 
-            Vec3f::List frameVertices(vertices.size());
+            Vec3f::List frameVertices(m_vertices.size());
             Vec3f center;
             BBoxf bounds;
 
-            frameVertices[0] = unpackFrameVertex(packedFrameVertices[0], origin, scale);
+            frameVertices[0] = unpackFrameVertex(packedFrameVertices[0]);
             center = frameVertices[0];
             bounds.min = frameVertices[0];
             bounds.max = frameVertices[0];
 
-            for (unsigned int i = 1; i < vertices.size(); i++) {
-                frameVertices[i] = unpackFrameVertex(packedFrameVertices[i], origin, scale);
+            for (unsigned int i = 1; i < m_vertices.size(); i++) {
+                frameVertices[i] = unpackFrameVertex(packedFrameVertices[i]);
                 center += frameVertices[i];
                 bounds.mergeWith(frameVertices[i]);
             }
 
-            center /= static_cast<float>(vertices.size());
+            center /= static_cast<float>(m_vertices.size());
 
             AliasFrameTriangleList frameTriangles;
-            frameTriangles.reserve(triangles.size());
-            for (unsigned int i = 0; i < triangles.size(); i++) {
+            frameTriangles.reserve(m_triangles.size());
+            for (unsigned int i = 0; i < m_triangles.size(); i++) {
                 AliasFrameTriangle* frameTriangle = new AliasFrameTriangle();
                 for (unsigned int j = 0; j < 3; j++) {
-                    size_t index = triangles[i].vertices[j];
+                    size_t index = m_triangles[i].vertices[j];
 
                     Vec2f texCoords;
-                    texCoords[0] = static_cast<float>(vertices[index].s) / static_cast<float>(skinWidth);
-                    texCoords[1] = static_cast<float>(vertices[index].t) / static_cast<float>(skinHeight);
+                    texCoords[0] = static_cast<float>(m_vertices[index].s) / static_cast<float>(m_skinWidth);
+                    texCoords[1] = static_cast<float>(m_vertices[index].t) / static_cast<float>(m_skinHeight);
 
-                    if (vertices[index].onseam && !triangles[i].front)
+                    if (m_vertices[index].onseam && !m_triangles[i].front)
                         texCoords[0] += 0.5f;
 
                     (*frameTriangle)[j].setPosition(frameVertices[index]);
@@ -144,24 +118,25 @@ namespace TrenchBroom {
             Utility::deleteAll(m_triangles);
         }
 
-        Alias::Alias(const String& name, char* begin, char* end) :
-        m_name(name) {
+        Alias::Alias(const String& name, IO::MappedFile::Ptr file) :
+        m_name(name),
+        m_file(file) {
             using namespace IO;
             
+            char* begin = m_file->begin();
             char* cursor = begin + AliasLayout::HeaderScale;
-            Vec3f scale = readVec3f(cursor);
-            Vec3f origin = readVec3f(cursor);
+            m_scale = readVec3f(cursor);
+            m_origin = readVec3f(cursor);
 
             cursor = begin + AliasLayout::HeaderNumSkins;
             unsigned int skinCount = readUnsignedInt<int32_t>(cursor);
-            unsigned int skinWidth = readUnsignedInt<int32_t>(cursor);
-            unsigned int skinHeight = readUnsignedInt<int32_t>(cursor);
-            unsigned int skinSize = skinWidth * skinHeight;
+            m_skinWidth = readUnsignedInt<int32_t>(cursor);
+            m_skinHeight = readUnsignedInt<int32_t>(cursor);
+            unsigned int skinSize = m_skinWidth * m_skinHeight;
 
             unsigned int vertexCount = readUnsignedInt<int32_t>(cursor);
             unsigned int triangleCount = readUnsignedInt<int32_t>(cursor);
             unsigned int frameCount = readUnsignedInt<int32_t>(cursor);
-            frameCount = frameCount; // dummy to suppress "unused" warning
             
             cursor = begin + AliasLayout::Skins;
             for (unsigned int i = 0; i < skinCount; i++) {
@@ -170,7 +145,7 @@ namespace TrenchBroom {
                     unsigned char* skinPicture = new unsigned char[skinSize];
                     readBytes(cursor, skinPicture, skinSize);
 
-                    AliasSkin* skin = new AliasSkin(skinPicture, skinWidth, skinHeight);
+                    AliasSkin* skin = new AliasSkin(skinPicture, m_skinWidth, m_skinHeight);
                     m_skins.push_back(skin);
                 } else {
                     unsigned int numPics = readUnsignedInt<int32_t>(cursor);
@@ -189,50 +164,45 @@ namespace TrenchBroom {
                         skinPictures[j] = skinPicture;
                     }
 
-                    AliasSkin* skin = new AliasSkin(skinPictures, times, numPics, skinWidth, skinHeight);
+                    AliasSkin* skin = new AliasSkin(skinPictures, times, numPics, m_skinWidth, m_skinHeight);
                     m_skins.push_back(skin);
                 }
             }
 
             // now cursor is at the first skin vertex
-            std::vector<AliasSkinVertex> vertices(vertexCount);
+            m_vertices.resize(vertexCount);
             for (unsigned int i = 0; i < vertexCount; i++) {
-                vertices[i].onseam = readBool<int32_t>(cursor);
-                vertices[i].s = readInt<int32_t>(cursor);
-                vertices[i].t = readInt<int32_t>(cursor);
+                m_vertices[i].onseam = readBool<int32_t>(cursor);
+                m_vertices[i].s = readInt<int32_t>(cursor);
+                m_vertices[i].t = readInt<int32_t>(cursor);
             }
 
             // now cursor is at the first skin triangle
-            std::vector<AliasSkinTriangle> triangles(triangleCount);
+            m_triangles.resize(triangleCount);
             for (unsigned int i = 0; i < triangleCount; i++) {
-                triangles[i].front = readBool<int32_t>(cursor);
+                m_triangles[i].front = readBool<int32_t>(cursor);
                 for (unsigned int j = 0; j < 3; j++)
-                    triangles[i].vertices[j] = readUnsignedInt<int32_t>(cursor);
+                    m_triangles[i].vertices[j] = readUnsignedInt<int32_t>(cursor);
             }
 
-            // now cursor is at the first frame
+            // now cursor is at the first frame, only record where each frame starts
+            const size_t frameSize = AliasLayout::SimpleFrameName + AliasLayout::SimpleFrameLength + vertexCount * AliasLayout::FrameVertexSize;
+            m_frameCursors.reserve(frameCount);
             for (unsigned int i = 0; i < frameCount; i++) {
                 int type = readInt<int32_t>(cursor);
                 if (type == 0) { // single frame
-                    m_frames.push_back(readFrame(cursor, origin, scale, skinWidth, skinHeight, vertices, triangles));
-                } else { // frame group
+                    m_frameCursors.push_back(cursor);
+                    cursor += frameSize;
+                } else { // frame group, only its first frame is used
                     char* base = cursor;
                     unsigned int groupFrameCount = readUnsignedInt<int32_t>(cursor);
-
-                    char* timeCursor = base + AliasLayout::MultiFrameTimes;
                     char* frameCursor = base + AliasLayout::MultiFrameTimes + groupFrameCount * sizeof(float);
-
-                    AliasTimeList groupFrameTimes(groupFrameCount);
-                    AliasSingleFrameList groupFrames(groupFrameCount);
-                    for (unsigned int j = 0; j < groupFrameCount; j++) {
-                        groupFrameTimes[i] = readFloat<float>(timeCursor);
-                        groupFrames[j] = readFrame(frameCursor, origin, scale, skinWidth, skinHeight, vertices, triangles);
-                    }
-
-                    m_frames.push_back(new AliasFrameGroup(groupFrameTimes, groupFrames));
-                    cursor = frameCursor;
+                    m_frameCursors.push_back(frameCursor);
+                    cursor = frameCursor + groupFrameCount * frameSize;
                 }
             }
+
+            m_frames.resize(m_frameCursors.size(), NULL);
         }
 
         Alias::~Alias() {
@@ -240,27 +210,32 @@ namespace TrenchBroom {
             Utility::deleteAll(m_skins);
         }
 
+        AliasSingleFrame& Alias::frame(size_t index) const {
+            assert(index < m_frameCursors.size());
+            
+            wxCriticalSectionLocker lock(m_frameLock);
+            if (m_frames[index] == NULL)
+                m_frames[index] = readFrame(m_frameCursors[index]);
+            return *m_frames[index];
+        }
+
         AliasManager* AliasManager::sharedManager = NULL;
 
-        Alias const * const AliasManager::alias(const String& name, const StringList& paths, Utility::Console& console) {
-            String pathList = Utility::join(paths, ",");
-            String key = pathList + ":" + name;
+        Alias const * const AliasManager::alias(const String& name, const StringList& paths) {
+            String key = Utility::join(paths, ",") + ":" + name;
 
+            wxCriticalSectionLocker lock(m_lock);
             AliasMap::iterator it = m_aliases.find(key);
             if (it != m_aliases.end())
                 return it->second;
 
-            console.info("Loading '%s' (searching %s)", name.c_str(), pathList.c_str());
-
             IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
-            if (file.get() != NULL) {
-                Alias* alias = new Alias(name, file->begin(), file->end());
-                m_aliases[key] = alias;
-                return alias;
-            }
-
-            console.warn("Unable to find MDL '%s'", name.c_str());
-            return NULL;
+            if (file.get() == NULL)
+                return NULL;
+            
+            Alias* alias = new Alias(name, file);
+            m_aliases[key] = alias;
+            return alias;
         }
 
         AliasManager::AliasManager() {}
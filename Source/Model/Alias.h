@@ -21,10 +21,11 @@
 #define TrenchBroom_Alias_h
 
 #include "IO/Pak.h"
-#include "Utility/Console.h"
 #include "Utility/String.h"
 #include "Utility/VecMath.h"
 
+#include <wx/thread.h>
+
 #include <istream>
 #include <map>
 #include <vector>
@@ -165,15 +166,7 @@ namespace TrenchBroom {
         typedef std::vector<AliasSingleFrame*> AliasSingleFrameList;
         typedef std::vector<AliasSkin*> AliasSkinList;
         
-        class AliasFrame {
-        public:
-            virtual ~AliasFrame() {};
-            virtual AliasSingleFrame* firstFrame() = 0;
-        };
-        
-        typedef std::vector<AliasFrame*> AliasFrameList;
-        
-        class AliasSingleFrame : public AliasFrame {
+        class AliasSingleFrame {
         private:
             String m_name;
             AliasFrameTriangleList m_triangles;
@@ -198,48 +191,49 @@ namespace TrenchBroom {
             inline const BBoxf& bounds() const {
                 return m_bounds;
             }
-            
-            AliasSingleFrame* firstFrame();
-        };
-        
-        class AliasFrameGroup : public AliasFrame {
-        private:
-            AliasTimeList m_times;
-            AliasSingleFrameList m_frames;
-            BBoxf m_bounds;
-        public:
-            AliasFrameGroup(const AliasTimeList& times, const AliasSingleFrameList& frames);
-            ~AliasFrameGroup();
-            AliasSingleFrame* firstFrame();
         };
         
+        /**
+         * Only the skins and the frame directory are read when an alias is created. The frames are decoded on
+         * first access, so that only the frames which are actually displayed are ever unpacked. Of a frame group,
+         * only the first frame is accessible.
+         */
         class Alias {
         private:
+            typedef std::vector<char*> FrameCursorList;
+            
             String m_name;
-            AliasFrameList m_frames;
+            IO::MappedFile::Ptr m_file;
+            Vec3f m_origin;
+            Vec3f m_scale;
+            unsigned int m_skinWidth;
+            unsigned int m_skinHeight;
+            AliasSkinVertexList m_vertices;
+            AliasSkinTriangleList m_triangles;
             AliasSkinList m_skins;
             
-            Vec3f unpackFrameVertex(const AliasPackedFrameVertex& packedVertex, const Vec3f& origin, const Vec3f& size);
-            AliasSingleFrame* readFrame(char*& cursor, const Vec3f& origin, const Vec3f& scale, unsigned int skinWidth, unsigned int skinHeight, const AliasSkinVertexList& vertices, const AliasSkinTriangleList& triangles);
+            FrameCursorList m_frameCursors;
+            mutable AliasSingleFrameList m_frames;
+            mutable wxCriticalSection m_frameLock;
+            
+            Vec3f unpackFrameVertex(const AliasPackedFrameVertex& packedVertex) const;
+            AliasSingleFrame* readFrame(char* cursor) const;
         public:
-            Alias(const String& name, char* begin, char* end);
+            Alias(const String& name, IO::MappedFile::Ptr file);
             ~Alias();
             
             inline const String& name() const {
                 return m_name;
             }
             
-            inline const AliasFrameList& frames() const {
-                return m_frames;
+            inline size_t frameCount() const {
+                return m_frameCursors.size();
             }
             
-            inline AliasSingleFrame& frame(size_t index) const {
-                assert(index < m_frames.size());
-                return *m_frames[index]->firstFrame();
-            }
+            AliasSingleFrame& frame(size_t index) const;
             
             inline AliasSingleFrame& firstFrame() const {
-                return *m_frames[0]->firstFrame();
+                return frame(0);
             }
             
             inline const AliasSkinList& skins() const {
@@ -247,16 +241,20 @@ namespace TrenchBroom {
             }
         };
         
+        /**
+         * Caches the loaded aliases. The manager may be used from several model loader threads at once.
+         */
         class AliasManager {
         private:
             typedef std::map<String, Alias*> AliasMap;
             
             AliasMap m_aliases;
+            wxCriticalSection m_lock;
         public:
             static AliasManager* sharedManager;
             AliasManager();
             ~AliasManager();
-            Alias const * const alias(const String& name, const StringList& paths, Utility::Console& console);
+            Alias const * const alias(const String& name, const StringList& paths);
         };
     }
 }
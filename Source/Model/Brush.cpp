@@ -34,6 +34,21 @@ namespace TrenchBroom {
             m_entity = NULL;
             setEditState(EditState::Default);
             m_selectedFaceCount = 0;
+            m_contentTypes = 0;
+            m_contentTypesValid = false;
+            m_filterGeneration = 0;
+            m_filterResult = false;
+            m_deferEntityInvalidation = false;
+        }
+
+        void Brush::validateContentTypes() const {
+            m_contentTypes = 0;
+            FaceList::const_iterator it, end;
+            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
+                const Face& face = **it;
+                m_contentTypes |= 1u << face.contentType();
+            }
+            m_contentTypesValid = true;
         }
 
         Brush::Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces) :
@@ -131,6 +146,29 @@ namespace TrenchBroom {
             rebuildGeometry();
         }
 
+        Brush::Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces, BrushGeometry* geometry) :
+        MapObject(),
+        m_geometry(geometry),
+        m_worldBounds(worldBounds),
+        m_forceIntegerFacePoints(forceIntegerFacePoints) {
+            assert(m_geometry != NULL);
+            init();
+
+            FaceList::const_iterator it, end;
+            for (it = faces.begin(), end = faces.end(); it != end; ++it) {
+                Face* face = *it;
+                face->setBrush(this);
+                m_faces.push_back(face);
+            }
+
+            const SideList& sides = m_geometry->sides;
+            for (size_t i = 0; i < sides.size(); i++) {
+                Side* side = sides[i];
+                if (side->face != NULL)
+                    side->face->setSide(side);
+            }
+        }
+
         Brush::~Brush() {
             setEntity(NULL);
             delete m_geometry;
@@ -221,6 +259,8 @@ namespace TrenchBroom {
         }
 
         void Brush::rebuildGeometry() {
+            invalidateSerializedText();
+            m_planes.invalidate();
             delete m_geometry;
             m_geometry = new BrushGeometry(m_worldBounds);
 
@@ -246,7 +286,7 @@ namespace TrenchBroom {
                 face->invalidateVertexCache();
             }
 
-            if (m_entity != NULL)
+            if (m_entity != NULL && !m_deferEntityInvalidation)
                 m_entity->invalidateGeometry();
         }
 
@@ -352,6 +392,7 @@ namespace TrenchBroom {
         }
 
         Vec3f::List Brush::moveVertices(const Vec3f::List& vertexPositions, const Vec3f& delta) {
+            m_planes.invalidate();
             FaceSet newFaces;
             FaceSet droppedFaces;
 
@@ -384,6 +425,7 @@ namespace TrenchBroom {
         }
 
         EdgeInfoList Brush::moveEdges(const EdgeInfoList& edgeInfos, const Vec3f& delta) {
+            m_planes.invalidate();
             FaceSet newFaces;
             FaceSet droppedFaces;
 
@@ -416,6 +458,7 @@ namespace TrenchBroom {
         }
 
         FaceInfoList Brush::moveFaces(const FaceInfoList& faceInfos, const Vec3f& delta) {
+            m_planes.invalidate();
             FaceSet newFaces;
             FaceSet droppedFaces;
 
@@ -448,6 +491,7 @@ namespace TrenchBroom {
         }
 
         Vec3f Brush::splitEdge(const EdgeInfo& edge, const Vec3f& delta) {
+            m_planes.invalidate();
             FaceSet newFaces;
             FaceSet droppedFaces;
 
@@ -480,6 +524,7 @@ namespace TrenchBroom {
         }
 
         Vec3f Brush::splitFace(const FaceInfo& faceInfo, const Vec3f& delta) {
+            m_planes.invalidate();
             FaceSet newFaces;
             FaceSet droppedFaces;
 
@@ -508,23 +553,18 @@ namespace TrenchBroom {
         }
 
         void Brush::pick(const Rayf& ray, PickResult& pickResults) {
-            float dist = bounds().intersectWithRay(ray, NULL);
+            if (!m_planes.valid())
+                m_planes.validate(m_faces);
+
+            Face* face = NULL;
+            const float dist = m_planes.intersectWithRay(ray, face);
             if (Math<float>::isnan(dist))
                 return;
 
-            dist = Math<float>::nan();
-            Side* side = NULL;
-            for (unsigned int i = 0; i < m_geometry->sides.size() && Math<float>::isnan(dist); i++) {
-                side = m_geometry->sides[i];
-                dist = side->intersectWithRay(ray);
-            }
-
-            if (!Math<float>::isnan(dist)) {
-                assert(side != NULL);
-                Vec3f hitPoint = ray.pointAtDistance(dist);
-                FaceHit* hit = new FaceHit(*(side->face), hitPoint, dist);
-                pickResults.add(hit);
-            }
+            assert(face != NULL);
+            Vec3f hitPoint = ray.pointAtDistance(dist);
+            FaceHit* hit = new FaceHit(*face, hitPoint, dist);
+            pickResults.add(hit);
         }
 
         bool Brush::containsPoint(const Vec3f point) const {
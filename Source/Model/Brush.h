@@ -22,6 +22,7 @@
 
 #include "IO/ByteBuffer.h"
 #include "Model/BrushGeometry.h"
+#include "Model/BrushPlanes.h"
 #include "Model/EditState.h"
 #include "Model/FaceTypes.h"
 #include "Model/MapObject.h"
@@ -45,17 +46,31 @@ namespace TrenchBroom {
             class Entity* m_entity;
             FaceList m_faces;
             BrushGeometry* m_geometry;
+            BrushPlanes m_planes; // rebuilt lazily when the brush is picked after its geometry has changed
 
             unsigned int m_selectedFaceCount;
 
             const BBoxf& m_worldBounds;
             bool m_forceIntegerFacePoints;
+            bool m_deferEntityInvalidation;
+
+            mutable unsigned int m_contentTypes;
+            mutable bool m_contentTypesValid;
+            mutable unsigned int m_filterGeneration;
+            mutable bool m_filterResult;
 
             void init();
+            void validateContentTypes() const;
         public:
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces);
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Brush& brushTemplate);
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const BBoxf& brushBounds, Texture* texture);
+            
+            /**
+             * Creates a brush with the given faces and takes ownership of the given, already computed geometry. The
+             * sides of the geometry must refer to the given faces.
+             */
+            Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces, BrushGeometry* geometry);
             ~Brush();
 
             void restore(const Brush& brushTemplate, bool checkId = false);
@@ -87,6 +102,41 @@ namespace TrenchBroom {
                 m_selectedFaceCount--;
             }
 
+            /**
+             * Returns a bit mask which contains the bit 1 << type for every content type that occurs among the faces
+             * of this brush.
+             */
+            inline unsigned int contentTypes() const {
+                if (!m_contentTypesValid)
+                    validateContentTypes();
+                return m_contentTypes;
+            }
+
+            /**
+             * Must be called when a face is added to or removed from this brush or when the texture of one of its
+             * faces changes.
+             */
+            inline void invalidateContentTypes() {
+                m_contentTypesValid = false;
+                m_filterGeneration = 0;
+            }
+
+            /**
+             * Returns true and stores the cached result of filtering this brush by the textures of its faces in the
+             * given result if that result was computed for the given filter generation.
+             */
+            inline bool cachedFilterResult(unsigned int filterGeneration, bool& result) const {
+                if (m_filterGeneration != filterGeneration)
+                    return false;
+                result = m_filterResult;
+                return true;
+            }
+
+            inline void cacheFilterResult(unsigned int filterGeneration, bool result) const {
+                m_filterGeneration = filterGeneration;
+                m_filterResult = result;
+            }
+
             virtual EditState::Type setEditState(EditState::Type editState);
 
             inline const BBoxf& worldBounds() const {
@@ -129,12 +179,29 @@ namespace TrenchBroom {
                 return m_geometry->edges;
             }
 
+            inline const SideList& sides() const {
+                return m_geometry->sides;
+            }
+
+            inline const BrushGeometry& geometry() const {
+                return *m_geometry;
+            }
+
             inline bool closed() const {
                 return m_geometry->closed();
             }
 
             void rebuildGeometry();
 
+            /**
+             * While this is set, changing the geometry of this brush does not invalidate the geometry of its entity.
+             * This allows the brushes of one entity to be changed on several threads at once, but the entity must be
+             * invalidated on the calling thread afterwards.
+             */
+            inline void setDeferEntityInvalidation(bool deferEntityInvalidation) {
+                m_deferEntityInvalidation = deferEntityInvalidation;
+            }
+
             void transform(const Mat4f& pointTransform, const Mat4f& vectorTransform, const bool lockTextures, const bool invertOrientation);
 
             bool clip(Face& face);
@@ -22,11 +22,32 @@
 #include "Model/Face.h"
 #include "Utility/List.h"
 
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <cstdio>
 
 namespace TrenchBroom {
     namespace Model {
+        static inline Vec3f splitPoint(const Planef& plane, const Vec3f& start, float startDist, const Vec3f& end, float endDist) {
+            // Do exactly what QBSP is doing:
+            const float dot = startDist / (startDist - endDist);
+
+            Vec3f point;
+            for (unsigned int i = 0; i < 3; i++) {
+                if (plane.normal[i] == 1.0f)
+                    point[i] = plane.distance;
+                else if (plane.normal[i] == -1.0f)
+                    point[i] = -plane.distance;
+                else
+                    point[i] = start[i] + dot * (end[i] - start[i]);
+            }
+
+            // cheat a little bit?, just like QBSP
+            point.correct();
+            return point;
+        }
+
         SideList Vertex::incidentSides(const EdgeList& edges) const {
             SideList result;
 
@@ -84,25 +105,13 @@ namespace TrenchBroom {
         }
 
         Vertex* Edge::split(const Planef& plane) {
-            // Do exactly what QBSP is doing:
             const float startDist = plane.pointDistance(start->position);
             const float endDist = plane.pointDistance(end->position);
 
             assert(startDist != endDist);
-            const float dot = startDist / (startDist - endDist);
 
             Vertex* newVertex = new Vertex();
-            for (unsigned int i = 0; i < 3; i++) {
-                if (plane.normal[i] == 1.0f)
-                    newVertex->position[i] = plane.distance;
-                else if (plane.normal[i] == -1.0f)
-                    newVertex->position[i] = -plane.distance;
-                else
-                    newVertex->position[i] = start->position[i] + dot * (end->position[i] - start->position[i]);
-            }
-
-            // cheat a little bit?, just like QBSP
-            newVertex->position.correct();
+            newVertex->position = splitPoint(plane, start->position, startDist, end->position, endDist);
             
             if (start->mark == Vertex::Drop)
                 start = newVertex;
@@ -1318,10 +1327,17 @@ namespace TrenchBroom {
             unsigned int drop = 0;
             unsigned int undecided = 0;
 
-            // mark vertices
+            // mark vertices, classifying their positions against the plane all at once
+            assert(!vertices.empty());
+            Vec3f::List positions(vertices.size());
+            for (size_t i = 0; i < vertices.size(); i++)
+                positions[i] = vertices[i]->position;
+            std::vector<PointStatus::Type> statuses(vertices.size());
+            pointStatus(boundary, &positions[0], positions.size(), &statuses[0], 0.1f);
+            
             for (size_t i = 0; i < vertices.size(); i++) {
                 Vertex& vertex = *vertices[i];
-                PointStatus::Type vs = boundary.pointStatus(vertex.position, 0.1f);
+                const PointStatus::Type vs = statuses[i];
                 if (vs == PointStatus::PSAbove) {
                     vertex.mark = Vertex::Drop;
                     drop++;
@@ -1544,6 +1560,161 @@ namespace TrenchBroom {
             return vertex->incidentSides(edges);
         }
 
+        void BrushGeometry::split(const Planef& plane, Face* frontCapFace, Face* backCapFace, SplitGeometry& front, SplitGeometry& back) const {
+            typedef std::map<const Vertex*, float> DistanceMap;
+            typedef std::pair<float, size_t> AngleIndex;
+
+            front.clear();
+            back.clear();
+
+            // use the same epsilon as addFace so that the parts match the brushes that result from clipping
+            const float epsilon = 0.1f;
+
+            DistanceMap distances;
+            size_t above = 0;
+            size_t below = 0;
+            for (size_t i = 0; i < vertices.size(); i++) {
+                const Vertex* vertex = vertices[i];
+                const float distance = plane.pointDistance(vertex->position);
+                distances[vertex] = distance;
+                if (distance > epsilon)
+                    above++;
+                else if (distance < -epsilon)
+                    below++;
+            }
+
+            if (above == 0 || below == 0) {
+                SplitGeometry& whole = above > 0 ? front : back;
+                whole.vertices.reserve(vertices.size());
+                for (size_t i = 0; i < vertices.size(); i++)
+                    whole.vertices.push_back(vertices[i]->position);
+                whole.edges.reserve(edges.size());
+                for (size_t i = 0; i < edges.size(); i++)
+                    whole.edges.push_back(edges[i]->info());
+                whole.sides.reserve(sides.size());
+                for (size_t i = 0; i < sides.size(); i++) {
+                    const Side& side = *sides[i];
+                    whole.sides.push_back(SplitSide(side.face));
+                    whole.sides.back().vertices = side.info().vertices;
+                }
+                return;
+            }
+
+            Vec3f::List capVertices;
+            for (size_t i = 0; i < vertices.size(); i++) {
+                const Vertex* vertex = vertices[i];
+                const float distance = distances[vertex];
+                if (distance >= -epsilon)
+                    front.vertices.push_back(vertex->position);
+                if (distance <= epsilon)
+                    back.vertices.push_back(vertex->position);
+                if (distance >= -epsilon && distance <= epsilon)
+                    capVertices.push_back(vertex->position);
+            }
+
+            // the split points are always computed from the vertex above to the vertex below the plane so that the
+            // edges and both sides incident to an edge agree on them exactly
+            for (size_t i = 0; i < edges.size(); i++) {
+                const Edge& edge = *edges[i];
+                const float startDist = distances[edge.start];
+                const float endDist = distances[edge.end];
+
+                if (startDist >= -epsilon && endDist >= -epsilon) {
+                    // edges which lie in the plane are added with the cap sides
+                    if (startDist > epsilon || endDist > epsilon)
+                        front.edges.push_back(edge.info());
+                } else if (startDist <= epsilon && endDist <= epsilon) {
+                    back.edges.push_back(edge.info());
+                } else {
+                    const bool startAbove = startDist > epsilon;
+                    const Vec3f& abovePosition = startAbove ? edge.start->position : edge.end->position;
+                    const Vec3f& belowPosition = startAbove ? edge.end->position : edge.start->position;
+                    const Vec3f point = splitPoint(plane, abovePosition, startAbove ? startDist : endDist, belowPosition, startAbove ? endDist : startDist);
+
+                    front.vertices.push_back(point);
+                    back.vertices.push_back(point);
+                    capVertices.push_back(point);
+                    front.edges.push_back(EdgeInfo(abovePosition, point));
+                    back.edges.push_back(EdgeInfo(point, belowPosition));
+                }
+            }
+
+            for (size_t i = 0; i < sides.size(); i++) {
+                const Side& side = *sides[i];
+                SplitSide frontSide(side.face);
+                SplitSide backSide(side.face);
+                bool sideAbove = false;
+                bool sideBelow = false;
+
+                const size_t count = side.vertices.size();
+                for (size_t j = 0; j < count; j++) {
+                    const Vertex* current = side.vertices[j];
+                    const Vertex* next = side.vertices[(j + 1) % count];
+                    const float currentDist = distances[current];
+                    const float nextDist = distances[next];
+
+                    if (currentDist >= -epsilon)
+                        frontSide.vertices.push_back(current->position);
+                    if (currentDist <= epsilon)
+                        backSide.vertices.push_back(current->position);
+                    sideAbove |= currentDist > epsilon;
+                    sideBelow |= currentDist < -epsilon;
+
+                    Vec3f point;
+                    if (currentDist > epsilon && nextDist < -epsilon)
+                        point = splitPoint(plane, current->position, currentDist, next->position, nextDist);
+                    else if (currentDist < -epsilon && nextDist > epsilon)
+                        point = splitPoint(plane, next->position, nextDist, current->position, currentDist);
+                    else
+                        continue;
+
+                    frontSide.vertices.push_back(point);
+                    backSide.vertices.push_back(point);
+                }
+
+                if (sideAbove)
+                    front.sides.push_back(frontSide);
+                if (sideBelow)
+                    back.sides.push_back(backSide);
+            }
+
+            if (capVertices.size() < 3)
+                return;
+
+            // the cap is convex, so its vertices can be ordered by their angle around its center
+            Vec3f center = capVertices[0];
+            for (size_t i = 1; i < capVertices.size(); i++)
+                center += capVertices[i];
+            center /= static_cast<float>(capVertices.size());
+
+            const Vec3f xAxis = (capVertices[0] - center).normalized();
+            const Vec3f yAxis = crossed(plane.normal, xAxis);
+
+            std::vector<AngleIndex> angles;
+            angles.reserve(capVertices.size());
+            for (size_t i = 0; i < capVertices.size(); i++) {
+                const Vec3f offset = capVertices[i] - center;
+                angles.push_back(AngleIndex(std::atan2(offset.dot(yAxis), offset.dot(xAxis)), i));
+            }
+            std::sort(angles.begin(), angles.end());
+
+            // sides are wound clockwise when seen from outside, and the front cap faces against the plane normal
+            front.sides.push_back(SplitSide(frontCapFace));
+            back.sides.push_back(SplitSide(backCapFace));
+            SplitSide& frontCap = front.sides.back();
+            SplitSide& backCap = back.sides.back();
+            for (size_t i = 0; i < angles.size(); i++) {
+                frontCap.vertices.push_back(capVertices[angles[i].second]);
+                backCap.vertices.push_back(capVertices[angles[angles.size() - i - 1].second]);
+            }
+
+            for (size_t i = 0; i < frontCap.vertices.size(); i++) {
+                const EdgeInfo capEdge(frontCap.vertices[i], frontCap.vertices[(i + 1) % frontCap.vertices.size()]);
+                front.edges.push_back(capEdge);
+                back.edges.push_back(capEdge);
+            }
+        }
+
         bool BrushGeometry::canMoveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta) {
             FaceManager faceManager;
 
@@ -298,6 +298,42 @@ namespace TrenchBroom {
             vertex(i_vertex) {}
         };
 
+        /**
+         * A side of one part of a brush geometry that was split by a plane. The vertices are ordered like the
+         * vertices of a side.
+         */
+        class SplitSide {
+        public:
+            Face* face;
+            Vec3f::List vertices;
+
+            SplitSide(Face* i_face) :
+            face(i_face) {}
+        };
+
+        typedef std::vector<SplitSide> SplitSideList;
+
+        /**
+         * One part of a brush geometry that was split by a plane, see BrushGeometry::split. Unlike a brush geometry,
+         * it only holds the positions of its vertices and edges, so it is cheap to create and to throw away.
+         */
+        class SplitGeometry {
+        public:
+            Vec3f::List vertices;
+            EdgeInfoList edges;
+            SplitSideList sides;
+
+            inline bool empty() const {
+                return sides.empty();
+            }
+
+            inline void clear() {
+                vertices.clear();
+                edges.clear();
+                sides.clear();
+            }
+        };
+
         class BrushGeometry {
         public:
             enum CutResult {
@@ -355,6 +391,14 @@ namespace TrenchBroom {
 
             SideList incidentSides(const Vertex* vertex);
 
+            /**
+             * Splits this geometry by the given plane in one pass without modifying it. The part above the plane is
+             * stored in front and closed by a side with the given front cap face, and the part below the plane is
+             * stored in back and closed by a side with the given back cap face. If the plane does not intersect this
+             * geometry, one of the parts is empty and the other one is a copy of this geometry.
+             */
+            void split(const Planef& plane, Face* frontCapFace, Face* backCapFace, SplitGeometry& front, SplitGeometry& back) const;
+
             bool canMoveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta);
             Vec3f::List moveVertices(const BBoxf& worldBounds, const Vec3f::List& vertexPositions, const Vec3f& delta, FaceSet& newFaces, FaceSet& droppedFaces);
             bool canMoveEdges(const BBoxf& worldBounds, const EdgeInfoList& edgeInfos, const Vec3f& delta);
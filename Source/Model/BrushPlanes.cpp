@@ -0,0 +1,122 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrushPlanes.h"
+
+#include "Model/Face.h"
+#include "Utility/SIMD.h"
+
+#include <cassert>
+#include <limits>
+
+namespace TrenchBroom {
+    namespace Model {
+        void BrushPlanes::validate(const FaceList& faces) {
+            m_faces = faces;
+
+            // padding planes have a null normal and contain the origin of every ray, so they never clip the ray
+            const size_t paddedCount = (m_faces.size() + 3) / 4 * 4;
+            m_normalX.assign(paddedCount, 0.0f);
+            m_normalY.assign(paddedCount, 0.0f);
+            m_normalZ.assign(paddedCount, 0.0f);
+            m_distances.assign(paddedCount, 1.0f);
+
+            for (size_t i = 0; i < m_faces.size(); i++) {
+                const Planef& boundary = m_faces[i]->boundary();
+                m_normalX[i] = boundary.normal.x();
+                m_normalY[i] = boundary.normal.y();
+                m_normalZ[i] = boundary.normal.z();
+                m_distances[i] = boundary.distance;
+            }
+
+            m_valid = true;
+        }
+
+        float BrushPlanes::intersectWithRay(const Rayf& ray, Face*& face) const {
+            assert(m_valid);
+
+            float entryDistance = -std::numeric_limits<float>::max();
+            float exitDistance = std::numeric_limits<float>::max();
+            size_t entryIndex = m_faces.size();
+
+            float dots[4];
+            float offsets[4];
+#ifdef TRENCHBROOM_SSE
+            const __m128 directionX = _mm_set1_ps(ray.direction.x());
+            const __m128 directionY = _mm_set1_ps(ray.direction.y());
+            const __m128 directionZ = _mm_set1_ps(ray.direction.z());
+            const __m128 originX = _mm_set1_ps(ray.origin.x());
+            const __m128 originY = _mm_set1_ps(ray.origin.y());
+            const __m128 originZ = _mm_set1_ps(ray.origin.z());
+#endif
+
+            for (size_t i = 0; i < m_distances.size(); i += 4) {
+#ifdef TRENCHBROOM_SSE
+                const __m128 normalX = _mm_loadu_ps(&m_normalX[i]);
+                const __m128 normalY = _mm_loadu_ps(&m_normalY[i]);
+                const __m128 normalZ = _mm_loadu_ps(&m_normalZ[i]);
+
+                __m128 dot = _mm_mul_ps(normalX, directionX);
+                dot = _mm_add_ps(dot, _mm_mul_ps(normalY, directionY));
+                dot = _mm_add_ps(dot, _mm_mul_ps(normalZ, directionZ));
+                _mm_storeu_ps(dots, dot);
+
+                __m128 offset = _mm_mul_ps(normalX, originX);
+                offset = _mm_add_ps(offset, _mm_mul_ps(normalY, originY));
+                offset = _mm_add_ps(offset, _mm_mul_ps(normalZ, originZ));
+                offset = _mm_sub_ps(offset, _mm_loadu_ps(&m_distances[i]));
+                _mm_storeu_ps(offsets, offset);
+#else
+                for (size_t j = 0; j < 4; j++) {
+                    dots[j] = m_normalX[i + j] * ray.direction.x() + m_normalY[i + j] * ray.direction.y() + m_normalZ[i + j] * ray.direction.z();
+                    offsets[j] = m_normalX[i + j] * ray.origin.x() + m_normalY[i + j] * ray.origin.y() + m_normalZ[i + j] * ray.origin.z() - m_distances[i + j];
+                }
+#endif
+
+                for (size_t j = 0; j < 4; j++) {
+                    if (Math<float>::zero(dots[j])) {
+                        // the ray is parallel to the plane and misses the brush if it starts above the plane
+                        if (Math<float>::pos(offsets[j]))
+                            return Math<float>::nan();
+                        continue;
+                    }
+
+                    const float distance = -offsets[j] / dots[j];
+                    if (dots[j] < 0.0f) {
+                        if (distance > entryDistance) {
+                            entryDistance = distance;
+                            entryIndex = i + j;
+                        }
+                    } else if (distance < exitDistance) {
+                        exitDistance = distance;
+                    }
+                }
+
+                if (Math<float>::gt(entryDistance, exitDistance))
+                    return Math<float>::nan();
+            }
+
+            if (entryIndex == m_faces.size() || Math<float>::neg(entryDistance))
+                return Math<float>::nan();
+
+            face = m_faces[entryIndex];
+            return entryDistance;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__BrushPlanes__
+#define __TrenchBroom__BrushPlanes__
+
+#include "Model/FaceTypes.h"
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        /**
+         * The boundary planes of a brush, stored component by component and padded to a multiple of four planes so
+         * that they can be processed four at a time. Since a brush is the intersection of the half spaces below its
+         * boundary planes, a ray hits the brush if the interval in which it is below all planes is not empty, and
+         * the plane at which that interval begins belongs to the face which the ray hits.
+         */
+        class BrushPlanes {
+        private:
+            std::vector<float> m_normalX;
+            std::vector<float> m_normalY;
+            std::vector<float> m_normalZ;
+            std::vector<float> m_distances;
+            FaceList m_faces;
+            bool m_valid;
+        public:
+            BrushPlanes() :
+            m_valid(false) {}
+
+            inline bool valid() const {
+                return m_valid;
+            }
+
+            inline void invalidate() {
+                m_valid = false;
+            }
+
+            void validate(const FaceList& faces);
+
+            /**
+             * Returns the distance from the ray's origin to the point where it enters the brush and sets the given
+             * face to the face which contains that point. Returns NaN if the ray misses the brush or if its origin
+             * is inside of the brush.
+             */
+            float intersectWithRay(const Rayf& ray, Face*& face) const;
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__BrushPlanes__) */
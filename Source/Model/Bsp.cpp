@@ -285,25 +285,21 @@ namespace TrenchBroom {
 
         BspManager* BspManager::sharedManager = NULL;
 
-        const Bsp* BspManager::bsp(const String& name, const StringList& paths, Utility::Console& console) {
-            String pathList = Utility::join(paths, ",");
-            String key = pathList + ":" + name;
+        const Bsp* BspManager::bsp(const String& name, const StringList& paths) {
+            String key = Utility::join(paths, ",") + ":" + name;
 
+            wxCriticalSectionLocker lock(m_lock);
             BspMap::iterator it = m_bsps.find(key);
             if (it != m_bsps.end())
                 return it->second;
 
-            console.info("Loading '%s' (searching %s)", name.c_str(), pathList.c_str());
-
             IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
-            if (file.get() != NULL) {
-                Bsp* bsp = new Bsp(name, file->begin(), file->end());
-                m_bsps[key] = bsp;
-                return bsp;
-            }
-
-            console.warn("Unable to find BSP '%s'", name.c_str());
-            return NULL;
+            if (file.get() == NULL)
+                return NULL;
+            
+            Bsp* bsp = new Bsp(name, file->begin(), file->end());
+            m_bsps[key] = bsp;
+            return bsp;
         }
 
         BspManager::BspManager() {}
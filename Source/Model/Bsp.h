@@ -21,9 +21,11 @@
 #define TrenchBroom_Bsp_h
 
 #include "IO/Pak.h"
-#include "Utility/Console.h"
+#include "Utility/String.h"
 #include "Utility/VecMath.h"
 
+#include <wx/thread.h>
+
 #include <istream>
 #include <map>
 #include <vector>
@@ -205,18 +207,22 @@ namespace TrenchBroom {
             }
         };
         
+        /**
+         * Caches the loaded BSP models. The manager may be used from several model loader threads at once.
+         */
         class BspManager {
         private:
             typedef std::map<String, Bsp*> BspMap;
             
             BspMap m_bsps;
+            wxCriticalSection m_lock;
         public:
             static BspManager* sharedManager;
             
             BspManager();
             ~BspManager();
 
-            const Bsp* bsp(const String& name, const StringList& paths, Utility::Console& console);
+            const Bsp* bsp(const String& name, const StringList& paths);
         };
     }
 }
@@ -244,6 +244,7 @@ namespace TrenchBroom {
         void Entity::init() {
             m_map = NULL;
             m_worldspawn = false;
+            m_classnameCategory = CCDefault;
             m_definition = NULL;
             setEditState(EditState::Default);
             m_selectedBrushCount = 0;
@@ -515,6 +516,7 @@ namespace TrenchBroom {
         void Entity::setProperties(const PropertyList& properties, bool replace) {
             if (replace) {
                 m_propertyStore.clear();
+                invalidateSerializedText();
                 setProperty(SpawnFlagsKey, "0");
             }
             PropertyList::const_iterator it, end;
@@ -558,6 +560,7 @@ namespace TrenchBroom {
             
             if (key == ClassnameKey && value != classname()) {
                 m_worldspawn = *value == WorldspawnClassname;
+                m_classnameCategory = Utility::startsWith(*value, "trigger_") ? CCTrigger : CCDefault;
                 setDefinition(NULL);
             }
             
@@ -591,6 +594,7 @@ namespace TrenchBroom {
             else
                 m_propertyStore.setPropertyValue(key, *value);
             invalidateGeometry();
+            invalidateSerializedText();
         }
         
         StringList Entity::linkTargetnames() const {
@@ -40,6 +40,11 @@ namespace TrenchBroom {
 
         class Entity : public MapObject, public Utility::Allocator<Entity> {
         public:
+            enum ClassnameCategory {
+                CCDefault,
+                CCTrigger
+            };
+            
             static String const ClassnameKey;
             static String const NoClassnameValue;
             static String const SpawnFlagsKey;
@@ -77,6 +82,7 @@ namespace TrenchBroom {
             PropertyStore m_propertyStore;
             BrushList m_brushes;
             bool m_worldspawn;
+            ClassnameCategory m_classnameCategory;
 
             EntityDefinition* m_definition;
 
@@ -208,6 +214,10 @@ namespace TrenchBroom {
             inline bool worldspawn() const {
                 return m_worldspawn;
             }
+            
+            inline ClassnameCategory classnameCategory() const {
+                return m_classnameCategory;
+            }
 
             inline const Vec3f origin() const {
                 const PropertyValue* value = propertyForKey(OriginKey);
@@ -21,6 +21,9 @@
 
 #include "Utility/List.h"
 
+#include <algorithm>
+#include <iterator>
+
 namespace TrenchBroom {
     namespace Model {
         ModelDefinitionPropertyEvaluator::ModelDefinitionPropertyEvaluator(const PropertyKey& propertyKey, const PropertyValue& propertyValue) :
@@ -39,6 +42,10 @@ namespace TrenchBroom {
             }
             return false;
         }
+        
+        void ModelDefinitionPropertyEvaluator::addPropertyKeys(PropertyKeyList& propertyKeys) const {
+            propertyKeys.push_back(m_propertyKey);
+        }
 
         ModelDefinitionFlagEvaluator::ModelDefinitionFlagEvaluator(const PropertyKey& propertyKey, int flagValue) :
         m_propertyKey(propertyKey),
@@ -56,6 +63,10 @@ namespace TrenchBroom {
             }
             return false;
         }
+        
+        void ModelDefinitionFlagEvaluator::addPropertyKeys(PropertyKeyList& propertyKeys) const {
+            propertyKeys.push_back(m_propertyKey);
+        }
 
         ModelDefinitionPropertiesEvaluator::ModelDefinitionPropertiesEvaluator(const PropertyKey& modelKey, const PropertyKey& skinKey, const PropertyKey& frameKey) :
         m_modelKey(modelKey),
@@ -65,23 +76,41 @@ namespace TrenchBroom {
         bool ModelDefinitionPropertiesEvaluator::evaluate(const PropertyList& properties) const {
             return false;
         }
+        
+        void ModelDefinitionPropertiesEvaluator::addPropertyKeys(PropertyKeyList& propertyKeys) const {
+            propertyKeys.push_back(m_modelKey);
+            propertyKeys.push_back(m_skinKey);
+            propertyKeys.push_back(m_frameKey);
+        }
+
+        void ModelDefinition::init() {
+            StringStream key;
+            key << Utility::toLower(m_name) << " " << m_skinIndex << " " << m_frameIndex;
+            m_key = key.str();
+        }
 
         ModelDefinition::ModelDefinition(const String& name, unsigned int skinIndex, unsigned int frameIndex) :
         m_name(name),
         m_skinIndex(skinIndex),
-        m_frameIndex(frameIndex) {}
+        m_frameIndex(frameIndex) {
+            init();
+        }
         
         ModelDefinition::ModelDefinition(const String& name, unsigned int skinIndex, unsigned int frameIndex, const PropertyKey& propertyKey, const PropertyValue& propertyValue) :
         m_name(name),
         m_skinIndex(skinIndex),
         m_frameIndex(frameIndex),
-        m_evaluator(new ModelDefinitionPropertyEvaluator(propertyKey, propertyValue)) {}
+        m_evaluator(new ModelDefinitionPropertyEvaluator(propertyKey, propertyValue)) {
+            init();
+        }
         
         ModelDefinition::ModelDefinition(const String& name, unsigned int skinIndex, unsigned int frameIndex, const PropertyKey& propertyKey, int flagValue) :
         m_name(name),
         m_skinIndex(skinIndex),
         m_frameIndex(frameIndex),
-        m_evaluator(new ModelDefinitionFlagEvaluator(propertyKey, flagValue)) {}
+        m_evaluator(new ModelDefinitionFlagEvaluator(propertyKey, flagValue)) {
+            init();
+        }
         
         EntityDefinition::EntityDefinition(const String& name, const Color& color, const String& description, const PropertyDefinition::List& propertyDefinitions) :
         m_name(name),
@@ -91,15 +120,24 @@ namespace TrenchBroom {
         m_propertyDefinitions(propertyDefinitions) {
         }
         
+        EntityDefinition::EntityDefinition(const EntityDefinition& other) :
+        m_name(other.m_name),
+        m_color(other.m_color),
+        m_description(other.m_description),
+        m_usageCount(0),
+        m_propertyDefinitions(other.m_propertyDefinitions) {}
+        
         PointEntityDefinition::PointEntityDefinition(const String& name, const Color& color, const BBoxf& bounds, const String& description, const PropertyDefinition::List& propertyDefinitions, const ModelDefinition::List& modelDefinitions) :
         EntityDefinition(name, color, description, propertyDefinitions),
         m_bounds(bounds),
-        m_modelDefinitions(modelDefinitions) {}
+        m_modelDefinitions(modelDefinitions) {
+            for (size_t i = 0; i < m_modelDefinitions.size(); i++)
+                m_modelDefinitions[i]->addPropertyKeys(m_modelPropertyKeys);
+            std::sort(m_modelPropertyKeys.begin(), m_modelPropertyKeys.end());
+            m_modelPropertyKeys.erase(std::unique(m_modelPropertyKeys.begin(), m_modelPropertyKeys.end()), m_modelPropertyKeys.end());
+        }
         
-        const ModelDefinition* PointEntityDefinition::model(const PropertyList& properties) const {
-            if (m_modelDefinitions.empty())
-                return NULL;
-            
+        const ModelDefinition* PointEntityDefinition::evaluateModel(const PropertyList& properties) const {
             ModelDefinition::List::const_reverse_iterator it, end;
             for (it = m_modelDefinitions.rbegin(), end = m_modelDefinitions.rend(); it != end; ++it) {
                 const ModelDefinition::Ptr definition = *it;
@@ -109,6 +147,45 @@ namespace TrenchBroom {
             
             return NULL;
         }
+        
+        const ModelDefinition* PointEntityDefinition::model(const PropertyList& properties) const {
+            if (m_modelDefinitions.empty())
+                return NULL;
+            if (m_modelPropertyKeys.empty())
+                return m_modelDefinitions.back().get();
+            
+            // the evaluators only look at the first property with their key
+            std::vector<const PropertyValue*> values(m_modelPropertyKeys.size(), NULL);
+            PropertyList::const_iterator propertyIt, propertyEnd;
+            for (propertyIt = properties.begin(), propertyEnd = properties.end(); propertyIt != propertyEnd; ++propertyIt) {
+                const Property& property = *propertyIt;
+                PropertyKeyList::const_iterator keyIt = std::lower_bound(m_modelPropertyKeys.begin(), m_modelPropertyKeys.end(), property.key());
+                if (keyIt != m_modelPropertyKeys.end() && *keyIt == property.key()) {
+                    const size_t index = static_cast<size_t>(std::distance(m_modelPropertyKeys.begin(), keyIt));
+                    if (values[index] == NULL)
+                        values[index] = &property.value();
+                }
+            }
+            
+            // a missing property is an empty entry, and the value of a present one is prefixed so that it is not
+            // mistaken for a missing one
+            String cacheKey;
+            for (size_t i = 0; i < values.size(); i++) {
+                if (values[i] != NULL) {
+                    cacheKey += '=';
+                    cacheKey += *values[i];
+                }
+                cacheKey += '\0';
+            }
+            
+            ModelCache::iterator cacheIt = m_modelCache.find(cacheKey);
+            if (cacheIt != m_modelCache.end())
+                return cacheIt->second;
+            
+            const ModelDefinition* definition = evaluateModel(properties);
+            m_modelCache[cacheKey] = definition;
+            return definition;
+        }
 
         BrushEntityDefinition::BrushEntityDefinition(const String& name, const Color& color, const String& description, const PropertyDefinition::List& propertyDefinitions) :
         EntityDefinition(name, color, description, propertyDefinitions) {}
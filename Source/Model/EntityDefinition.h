@@ -33,6 +33,12 @@
 #include <cstdlib>
 #include <vector>
 
+#if defined _WIN32
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif
+
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
@@ -41,9 +47,21 @@ namespace TrenchBroom {
         public:
             typedef std::tr1::shared_ptr<ModelDefinitionEvaluator> Ptr;
             
+            enum Type {
+                PropertyEvaluator,
+                FlagEvaluator,
+                PropertiesEvaluator
+            };
+            
             virtual ~ModelDefinitionEvaluator() {}
             
+            virtual Type type() const = 0;
             virtual bool evaluate(const PropertyList& properties) const = 0;
+            
+            /**
+             * Adds the keys of the properties that this evaluator looks at to the given list.
+             */
+            virtual void addPropertyKeys(PropertyKeyList& propertyKeys) const = 0;
         };
         
         class ModelDefinitionPropertyEvaluator : public ModelDefinitionEvaluator {
@@ -53,7 +71,20 @@ namespace TrenchBroom {
         public:
             ModelDefinitionPropertyEvaluator(const PropertyKey& propertyKey, const PropertyValue& propertyValue);
             
+            inline Type type() const {
+                return PropertyEvaluator;
+            }
+            
+            inline const PropertyKey& propertyKey() const {
+                return m_propertyKey;
+            }
+            
+            inline const PropertyValue& propertyValue() const {
+                return m_propertyValue;
+            }
+            
             bool evaluate(const PropertyList& properties) const;
+            void addPropertyKeys(PropertyKeyList& propertyKeys) const;
         };
         
         class ModelDefinitionFlagEvaluator : public ModelDefinitionEvaluator {
@@ -63,7 +94,20 @@ namespace TrenchBroom {
         public:
             ModelDefinitionFlagEvaluator(const PropertyKey& propertyKey, int flagValue);
             
+            inline Type type() const {
+                return FlagEvaluator;
+            }
+            
+            inline const PropertyKey& propertyKey() const {
+                return m_propertyKey;
+            }
+            
+            inline int flagValue() const {
+                return m_flagValue;
+            }
+            
             bool evaluate(const PropertyList& properties) const;
+            void addPropertyKeys(PropertyKeyList& propertyKeys) const;
         };
         
         class ModelDefinitionPropertiesEvaluator : public ModelDefinitionEvaluator {
@@ -74,7 +118,12 @@ namespace TrenchBroom {
         public:
             ModelDefinitionPropertiesEvaluator(const PropertyKey& modelKey, const PropertyKey& skinKey, const PropertyKey& frameKey);
             
+            inline Type type() const {
+                return PropertiesEvaluator;
+            }
+            
             bool evaluate(const PropertyList& properties) const;
+            void addPropertyKeys(PropertyKeyList& propertyKeys) const;
         };
         
         class ModelDefinition {
@@ -85,8 +134,11 @@ namespace TrenchBroom {
             String m_name;
             unsigned int m_skinIndex;
             unsigned int m_frameIndex;
+            String m_key;
         
             ModelDefinitionEvaluator::Ptr m_evaluator;
+            
+            void init();
         public:
             ModelDefinition(const String& name, unsigned int skinIndex, unsigned int frameIndex);
             ModelDefinition(const String& name, unsigned int skinIndex, unsigned int frameIndex, const PropertyKey& propertyKey, const PropertyValue& propertyValue);
@@ -104,11 +156,27 @@ namespace TrenchBroom {
                 return m_frameIndex;
             }
             
+            /**
+             * Identifies the model, skin and frame regardless of the case of the model name.
+             */
+            inline const String& key() const {
+                return m_key;
+            }
+            
+            inline const ModelDefinitionEvaluator* evaluator() const {
+                return m_evaluator.get();
+            }
+            
             inline bool matches(const PropertyList& properties) const {
                 if (m_evaluator == NULL)
                     return true;
                 return m_evaluator->evaluate(properties);
             }
+            
+            inline void addPropertyKeys(PropertyKeyList& propertyKeys) const {
+                if (m_evaluator != NULL)
+                    m_evaluator->addPropertyKeys(propertyKeys);
+            }
         };
         
         class EntityDefinition {
@@ -118,6 +186,8 @@ namespace TrenchBroom {
             String m_description;
             unsigned int m_usageCount;
             PropertyDefinition::List m_propertyDefinitions;
+            
+            EntityDefinition(const EntityDefinition& other);
         public:
             enum Type {
                 PointEntity,
@@ -129,6 +199,12 @@ namespace TrenchBroom {
             
             virtual Type type() const = 0;
             
+            /**
+             * Returns a copy of this definition which shares its property and model definitions. The usage count of
+             * the copy starts at zero.
+             */
+            virtual EntityDefinition* clone() const = 0;
+            
             inline const String& name() const {
                 return m_name;
             }
@@ -151,6 +227,14 @@ namespace TrenchBroom {
                 return m_color;
             }
             
+            inline const String& description() const {
+                return m_description;
+            }
+            
+            inline const PropertyDefinition::List& propertyDefinitions() const {
+                return m_propertyDefinitions;
+            }
+            
             const FlagsPropertyDefinition* spawnflags() const {
                 PropertyDefinition::List::const_iterator it, end;
                 for (it = m_propertyDefinitions.begin(), end = m_propertyDefinitions.end(); it != end; ++it) {
@@ -187,8 +271,14 @@ namespace TrenchBroom {
         
         class PointEntityDefinition : public EntityDefinition {
         protected:
+            typedef std::tr1::unordered_map<String, const ModelDefinition*> ModelCache;
+            
             BBoxf m_bounds;
             ModelDefinition::List m_modelDefinitions;
+            PropertyKeyList m_modelPropertyKeys;
+            mutable ModelCache m_modelCache;
+            
+            const ModelDefinition* evaluateModel(const PropertyList& properties) const;
         public:
             PointEntityDefinition(const String& name, const Color& color, const BBoxf& bounds, const String& description, const PropertyDefinition::List& propertyDefinitions, const ModelDefinition::List& modelDefinitions = ModelDefinition::List());
             
@@ -196,10 +286,23 @@ namespace TrenchBroom {
                 return PointEntity;
             }
             
+            inline EntityDefinition* clone() const {
+                return new PointEntityDefinition(*this);
+            }
+            
             inline const BBoxf& bounds() const {
                 return m_bounds;
             }
+            
+            inline const ModelDefinition::List& modelDefinitions() const {
+                return m_modelDefinitions;
+            }
 
+            /**
+             * Returns the last model definition that matches the given properties. The result is cached for the
+             * values of the properties that the model definitions look at, so this must only be called on the main
+             * thread.
+             */
             const ModelDefinition* model(const PropertyList& properties = EmptyPropertyList) const;
         };
         
@@ -210,6 +313,10 @@ namespace TrenchBroom {
             inline Type type() const {
                 return BrushEntity;
             }
+            
+            inline EntityDefinition* clone() const {
+                return new BrushEntityDefinition(*this);
+            }
         };
     }
 }
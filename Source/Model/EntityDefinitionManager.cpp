@@ -22,16 +22,100 @@
 #include "IO/FileManager.h"
 #include "IO/DefParser.h"
 #include "IO/FgdParser.h"
+#include "IO/IOException.h"
 #include "Utility/Color.h"
 #include "Utility/Console.h"
+#include "Utility/List.h"
 #include "Utility/Map.h"
 #include "Utility/Preferences.h"
 #include "Utility/String.h"
 
+#include <wx/stopwatch.h>
+
 #include <algorithm>
 
 namespace TrenchBroom {
     namespace Model {
+        EntityDefinitionManager::SharedDefinitions::~SharedDefinitions() {
+            Utility::deleteAll(definitions);
+        }
+
+        EntityDefinitionManager::SharedDefinitionsMap& EntityDefinitionManager::sharedDefinitions() {
+            static SharedDefinitionsMap definitions;
+            return definitions;
+        }
+        
+        bool EntityDefinitionManager::parseDefinitions(const String& path, const IO::MappedFile& file, const Color& defaultColor, EntityDefinitionList& definitions) {
+            EntityDefinitionMap newDefinitions;
+            
+            try {
+                IO::FileManager fileManager;
+                const String extension = fileManager.pathExtension(path);
+                if (Utility::equalsString(extension, "def", false)) {
+                    IO::DefParser parser(file.begin(), file.end(), defaultColor);
+                    
+                    EntityDefinition* definition = NULL;
+                    while ((definition = parser.nextDefinition()) != NULL)
+                        Utility::insertOrReplace(newDefinitions, definition->name(), definition);
+                } else if (Utility::equalsString(extension, "fgd", false)) {
+                    IO::FgdParser parser(file.begin(), file.end(), defaultColor);
+                    
+                    EntityDefinition* definition = NULL;
+                    while ((definition = parser.nextDefinition()) != NULL)
+                        Utility::insertOrReplace(newDefinitions, definition->name(), definition);
+                }
+            } catch (IO::ParserException& e) {
+                Utility::deleteAll(newDefinitions);
+                m_console.error(e.what());
+                return false;
+            }
+            
+            EntityDefinitionMap::const_iterator it, end;
+            for (it = newDefinitions.begin(), end = newDefinitions.end(); it != end; ++it)
+                definitions.push_back(it->second);
+            return true;
+        }
+        
+        bool EntityDefinitionManager::loadCache(SharedDefinitions& definitions) {
+            const String cachePath = IO::EntityDefinitionCache::cachePath(definitions.key.path);
+            IO::FileManager fileManager;
+            if (!fileManager.exists(cachePath))
+                return false;
+            
+            IO::MappedFile::Ptr cacheFile = fileManager.mapFile(cachePath);
+            if (cacheFile.get() == NULL)
+                return false;
+            
+            wxStopWatch watch;
+            try {
+                IO::EntityDefinitionCacheReader reader(cacheFile->begin(), cacheFile->end());
+                if (!reader.read(definitions.key, definitions.definitions)) {
+                    m_console.info("Entity definition cache %s is out of date", cachePath.c_str());
+                    return false;
+                }
+            } catch (IO::IOException& e) {
+                m_console.warn("Could not read entity definition cache %s: %s", cachePath.c_str(), e.what());
+                return false;
+            }
+            
+            m_console.info("Loaded entity definitions from cache in %f seconds", watch.Time() / 1000.0f);
+            return true;
+        }
+        
+        void EntityDefinitionManager::writeCache(const SharedDefinitions& definitions) {
+            // the cache is small enough to be written right away, unlike the geometry cache
+            std::vector<char> buffer;
+            IO::EntityDefinitionCacheWriter writer;
+            if (!writer.writeToBuffer(definitions.key, definitions.definitions, buffer))
+                return;
+            
+            const String cachePath = IO::EntityDefinitionCache::cachePath(definitions.key.path);
+            if (IO::BinaryCache::writeFile(cachePath, buffer))
+                m_console.debug("Wrote entity definition cache %s", cachePath.c_str());
+            else
+                m_console.warn("Could not write entity definition cache %s", cachePath.c_str());
+        }
+        
         EntityDefinitionManager::EntityDefinitionManager(Utility::Console& console) :
         m_console(console) {}
         
@@ -59,37 +143,38 @@ namespace TrenchBroom {
         void EntityDefinitionManager::load(const String& path) {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
             const Color& defaultColor = prefs.getColor(Preferences::EntityBoundsColor);
-            EntityDefinitionMap newDefinitions;
             
             IO::FileManager fileManager;
             IO::MappedFile::Ptr file = fileManager.mapFile(path);
-            if (file.get() != NULL) {
-                try {
-                    const String extension = fileManager.pathExtension(path);
-                    if (Utility::equalsString(extension, "def", false)) {
-                        IO::DefParser parser(file->begin(), file->end(), defaultColor);
-                        
-                        EntityDefinition* definition = NULL;
-                        while ((definition = parser.nextDefinition()) != NULL)
-                            Utility::insertOrReplace(newDefinitions, definition->name(), definition);
-                    } else if (Utility::equalsString(extension, "fgd", false)) {
-                        IO::FgdParser parser(file->begin(), file->end(), defaultColor);
-                        
-                        EntityDefinition* definition = NULL;
-                        while ((definition = parser.nextDefinition()) != NULL)
-                            Utility::insertOrReplace(newDefinitions, definition->name(), definition);
-                    }
-                    
-                    clear();
-                    m_entityDefinitions = newDefinitions;
-                    m_path = path;
-                } catch (IO::ParserException& e) {
-                    Utility::deleteAll(newDefinitions);
-                    m_console.error(e.what());
-                }
-            } else {
+            if (file.get() == NULL) {
                 m_console.error("Unable to open entity definition file %s", path.c_str());
+                return;
+            }
+            
+            const IO::EntityDefinitionCache::Key key(path, file->begin(), file->end(), static_cast<int64_t>(fileManager.modificationTime(path)), defaultColor);
+            
+            SharedDefinitionsMap& shared = sharedDefinitions();
+            SharedDefinitionsMap::iterator sharedIt = shared.find(path);
+            SharedDefinitions::Ptr definitions;
+            if (sharedIt != shared.end() && sharedIt->second->key == key) {
+                definitions = sharedIt->second;
+            } else {
+                definitions = SharedDefinitions::Ptr(new SharedDefinitions(key));
+                if (!loadCache(*definitions)) {
+                    if (!parseDefinitions(path, *file, defaultColor, definitions->definitions))
+                        return;
+                    writeCache(*definitions);
+                }
+                shared[path] = definitions;
+            }
+            
+            clear();
+            EntityDefinitionList::const_iterator it, end;
+            for (it = definitions->definitions.begin(), end = definitions->definitions.end(); it != end; ++it) {
+                const EntityDefinition* definition = *it;
+                m_entityDefinitions[definition->name()] = definition->clone();
             }
+            m_path = path;
         }
         
         void EntityDefinitionManager::clear() {
@@ -19,13 +19,19 @@
 #ifndef __TrenchBroom__EntityDefinitionManager__
 #define __TrenchBroom__EntityDefinitionManager__
 
+#include "IO/EntityDefinitionCache.h"
 #include "Model/EntityDefinitionTypes.h"
 #include "Model/EntityDefinition.h"
+#include "Utility/SharedPointer.h"
 #include "Utility/String.h"
 
 #include <map>
 
 namespace TrenchBroom {
+    namespace IO {
+        class MappedFile;
+    }
+    
     namespace Utility {
         class Console;
     }
@@ -66,6 +72,32 @@ namespace TrenchBroom {
             };
             
             typedef std::map<String, EntityDefinition*> EntityDefinitionMap;
+            
+            /**
+             * The definitions that were loaded from a definition file. They are shared by the definition managers
+             * of all open documents, which work on copies of them because every document counts the usages of the
+             * definitions separately.
+             */
+            class SharedDefinitions {
+            public:
+                typedef std::tr1::shared_ptr<SharedDefinitions> Ptr;
+                
+                IO::EntityDefinitionCache::Key key;
+                EntityDefinitionList definitions;
+                
+                SharedDefinitions(const IO::EntityDefinitionCache::Key& i_key) :
+                key(i_key) {}
+                
+                ~SharedDefinitions();
+            };
+            
+            typedef std::map<String, SharedDefinitions::Ptr> SharedDefinitionsMap;
+            
+            static SharedDefinitionsMap& sharedDefinitions();
+            
+            bool parseDefinitions(const String& path, const IO::MappedFile& file, const Color& defaultColor, EntityDefinitionList& definitions);
+            bool loadCache(SharedDefinitions& definitions);
+            void writeCache(const SharedDefinitions& definitions);
 
             Utility::Console& m_console;
             String m_path;
@@ -76,6 +108,10 @@ namespace TrenchBroom {
             
             static StringList builtinDefinitionFiles();
             
+            /**
+             * Loads the definitions from the given file. The parsed definitions are kept in memory and in a cache
+             * file so that neither this nor any other document has to parse the file again until it changes.
+             */
             void load(const String& path);
             void clear();
             
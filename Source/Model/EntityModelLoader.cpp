@@ -0,0 +1,105 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "EntityModelLoader.h"
+
+#include "IO/FileManager.h"
+#include "Model/Alias.h"
+#include "Model/Bsp.h"
+
+#include <wx/app.h>
+
+namespace TrenchBroom {
+    namespace Model {
+        EntityModelLoader::Result EntityModelLoader::load(const Request& request) {
+            IO::FileManager fileManager;
+            const String ext = Utility::toLower(fileManager.pathExtension(request.modelName));
+            if (ext == "mdl") {
+                const Alias* alias = AliasManager::sharedManager->alias(request.modelName, request.searchPaths);
+                if (alias != NULL && request.frameIndex < alias->frameCount())
+                    alias->frame(request.frameIndex);
+                return Result(request, alias, NULL);
+            } else if (ext == "bsp") {
+                const Bsp* bsp = BspManager::sharedManager->bsp(request.modelName, request.searchPaths);
+                return Result(request, NULL, bsp);
+            }
+            return Result(request, NULL, NULL);
+        }
+        
+        wxThread::ExitCode EntityModelLoader::Entry() {
+            while (true) {
+                Request request;
+                {
+                    wxMutexLocker lock(m_mutex);
+                    while (m_requests.empty() && !m_stopped)
+                        m_condition.Wait();
+                    if (m_stopped)
+                        break;
+                    request = m_requests.front();
+                    m_requests.pop_front();
+                }
+                
+                Result result = load(request);
+                
+                bool notify = false;
+                {
+                    wxMutexLocker lock(m_mutex);
+                    m_results.push_back(result);
+                    if (!m_notificationPending) {
+                        m_notificationPending = true;
+                        notify = true;
+                    }
+                }
+                
+                if (notify)
+                    wxTheApp->QueueEvent(new ExecutableEvent(m_notification));
+            }
+            
+            return (wxThread::ExitCode)0;
+        }
+        
+        EntityModelLoader::EntityModelLoader(ExecutableEvent::Executable::Ptr notification) :
+        wxThread(wxTHREAD_JOINABLE),
+        m_notification(notification),
+        m_notificationPending(false),
+        m_stopped(false),
+        m_condition(m_mutex) {}
+        
+        void EntityModelLoader::request(unsigned int key, const String& modelName, const StringList& searchPaths, unsigned int frameIndex, unsigned int skinIndex) {
+            wxMutexLocker lock(m_mutex);
+            m_requests.push_back(Request(key, modelName, searchPaths, frameIndex, skinIndex));
+            m_condition.Signal();
+        }
+        
+        void EntityModelLoader::takeResults(ResultList& results) {
+            wxMutexLocker lock(m_mutex);
+            results.swap(m_results);
+            m_results.clear();
+            m_notificationPending = false;
+        }
+        
+        void EntityModelLoader::stop() {
+            wxMutexLocker lock(m_mutex);
+            m_requests.clear();
+            m_stopped = true;
+            m_condition.Signal();
+        }
+    }
+}
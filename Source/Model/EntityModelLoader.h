@@ -0,0 +1,116 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef __TrenchBroom__EntityModelLoader__
+#define __TrenchBroom__EntityModelLoader__
+
+#include "Utility/ExecutableEvent.h"
+#include "Utility/String.h"
+
+#include <wx/thread.h>
+
+#include <deque>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        class Alias;
+        class Bsp;
+        
+        /**
+         * Loads entity models on a worker thread so that opening a map or browsing the entity definitions never
+         * blocks on reading and decoding MDL and BSP files. Of an MDL model, only the requested frame is decoded.
+         * Whenever models have been loaded, the given notification is queued on the UI thread, which then takes
+         * the results. Notifications are coalesced until the results have been taken.
+         */
+        class EntityModelLoader : public wxThread {
+        public:
+            class Request {
+            public:
+                unsigned int key;
+                String modelName;
+                StringList searchPaths;
+                unsigned int frameIndex;
+                unsigned int skinIndex;
+                
+                Request() :
+                key(0),
+                frameIndex(0),
+                skinIndex(0) {}
+                
+                Request(unsigned int i_key, const String& i_modelName, const StringList& i_searchPaths, unsigned int i_frameIndex, unsigned int i_skinIndex) :
+                key(i_key),
+                modelName(i_modelName),
+                searchPaths(i_searchPaths),
+                frameIndex(i_frameIndex),
+                skinIndex(i_skinIndex) {}
+            };
+            
+            class Result {
+            public:
+                unsigned int key;
+                String modelName;
+                const Alias* alias;
+                const Bsp* bsp;
+                unsigned int frameIndex;
+                unsigned int skinIndex;
+                
+                Result(const Request& request, const Alias* i_alias, const Bsp* i_bsp) :
+                key(request.key),
+                modelName(request.modelName),
+                alias(i_alias),
+                bsp(i_bsp),
+                frameIndex(request.frameIndex),
+                skinIndex(request.skinIndex) {}
+            };
+            
+            typedef std::vector<Result> ResultList;
+        private:
+            typedef std::deque<Request> RequestQueue;
+            
+            ExecutableEvent::Executable::Ptr m_notification;
+            RequestQueue m_requests;
+            ResultList m_results;
+            bool m_notificationPending;
+            bool m_stopped;
+            wxMutex m_mutex;
+            wxCondition m_condition;
+            
+            Result load(const Request& request);
+            ExitCode Entry();
+        public:
+            EntityModelLoader(ExecutableEvent::Executable::Ptr notification);
+            
+            /**
+             * Queues a request for the given model. The key is passed back with the result so that the caller can
+             * identify it.
+             */
+            void request(unsigned int key, const String& modelName, const StringList& searchPaths, unsigned int frameIndex, unsigned int skinIndex);
+            void takeResults(ResultList& results);
+            
+            /**
+             * Discards all pending requests and signals the thread to exit. The caller must still wait for it.
+             */
+            void stop();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__EntityModelLoader__) */
@@ -22,6 +22,7 @@
 #include "Model/Brush.h"
 #include "Model/BrushGeometry.h"
 #include "Model/Texture.h"
+#include "Utility/SpinLock.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -99,7 +100,11 @@ namespace TrenchBroom {
         
         void Face::init() {
             static unsigned int currentId = 1;
-            m_faceId = currentId++;
+            static Utility::SpinLock idLock;
+            {
+                Utility::SpinLocker locker(idLock);
+                m_faceId = currentId++;
+            }
             for (size_t i = 0; i < 3; i++)
                 m_points[i] = Vec3f::Null;
             m_xOffset = 0.0f;
@@ -171,28 +176,31 @@ namespace TrenchBroom {
             size_t vertexCount = m_side->vertices.size();
             m_vertexCache.resize(3 * (vertexCount - 2));
             
-            Vec2f texCoords;
             size_t j = 0;
             for (size_t i = 1; i < vertexCount - 1; i++) {
-                m_vertexCache[j++] = Renderer::FaceVertex(m_side->vertices[0]->position,
-                                                          m_boundary.normal,
-                                                          Vec2f((m_side->vertices[0]->position.dot(m_scaledTexAxisX) + m_xOffset) / width,
-                                                                (m_side->vertices[0]->position.dot(m_scaledTexAxisY) + m_yOffset) / height)
-                                                          );
-                m_vertexCache[j++] = Renderer::FaceVertex(m_side->vertices[i]->position,
-                                                          m_boundary.normal,
-                                                          Vec2f((m_side->vertices[i]->position.dot(m_scaledTexAxisX) + m_xOffset) / width,
-                                                                (m_side->vertices[i]->position.dot(m_scaledTexAxisY) + m_yOffset) / height)
-                                                          );
-                m_vertexCache[j++] = Renderer::FaceVertex(m_side->vertices[i+1]->position,
-                                                          m_boundary.normal,
-                                                          Vec2f((m_side->vertices[i+1]->position.dot(m_scaledTexAxisX) + m_xOffset) / width,
-                                                                (m_side->vertices[i+1]->position.dot(m_scaledTexAxisY) + m_yOffset) / height)
-                                                          );
+                m_vertexCache[j++] = faceVertex(m_side->vertices[0]->position, width, height);
+                m_vertexCache[j++] = faceVertex(m_side->vertices[i]->position, width, height);
+                m_vertexCache[j++] = faceVertex(m_side->vertices[i+1]->position, width, height);
             }
             
             m_vertexCacheValid = true;
         }
+
+        void Face::addPolygonVertices(const Vec3f::List& polygon, Renderer::FaceVertex::List& vertices) const {
+            assert(polygon.size() >= 3);
+
+            if (!m_texAxesValid)
+                validateTexAxes(m_boundary.normal);
+
+            unsigned int width = m_texture != NULL ? m_texture->width() : 1;
+            unsigned int height = m_texture != NULL ? m_texture->height() : 1;
+
+            for (size_t i = 1; i < polygon.size() - 1; i++) {
+                vertices.push_back(faceVertex(polygon[0], width, height));
+                vertices.push_back(faceVertex(polygon[i], width, height));
+                vertices.push_back(faceVertex(polygon[i+1], width, height));
+            }
+        }
         
         void Face::compensateTransformation(const Mat4f& transformation) {
             if (!m_texAxesValid)
@@ -348,6 +356,16 @@ namespace TrenchBroom {
             } else {
                 m_contentType = CTDefault;
             }
+            
+            // the filter also matches the texture names, so the brush must be notified even if the content type
+            // remains the same
+            if (m_brush != NULL)
+                m_brush->invalidateContentTypes();
+        }
+        
+        void Face::invalidateSerializedText() {
+            if (m_brush != NULL)
+                m_brush->invalidateSerializedText();
         }
 
         Face::Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Vec3f& point1, const Vec3f& point2, const Vec3f& point3, const String& textureName) : m_worldBounds(worldBounds), m_textureName(textureName) {
@@ -369,7 +387,18 @@ namespace TrenchBroom {
             restore(faceTemplate);
         }
         
+        Face::Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FacePoints& points, const Planef& boundary, const String& textureName) :
+        m_boundary(boundary),
+        m_worldBounds(worldBounds),
+        m_forceIntegerFacePoints(forceIntegerFacePoints) {
+            init();
+            for (size_t i = 0; i < 3; i++)
+                m_points[i] = points[i];
+            setTextureName(textureName);
+        }
+        
         Face::Face(const Face& face) :
+        m_brush(NULL),
         m_side(NULL),
         m_faceId(face.faceId()),
         m_boundary(face.boundary()),
@@ -433,17 +462,28 @@ namespace TrenchBroom {
             m_vertexCacheValid = false;
 			m_selected = faceTemplate.selected();
             m_contentType = faceTemplate.contentType();
+            if (m_brush != NULL)
+                m_brush->invalidateContentTypes();
+            invalidateSerializedText();
         }
         
         void Face::setBrush(Brush* brush) {
             if (brush == m_brush)
                 return;
             
-            if (m_brush != NULL && m_selected)
-                m_brush->decSelectedFaceCount();
+            if (m_brush != NULL) {
+                if (m_selected)
+                    m_brush->decSelectedFaceCount();
+                m_brush->invalidateContentTypes();
+            }
+            invalidateSerializedText();
             m_brush = brush;
-            if (m_brush != NULL && m_selected)
-                m_brush->incSelectedFaceCount();
+            if (m_brush != NULL) {
+                if (m_selected)
+                    m_brush->incSelectedFaceCount();
+                m_brush->invalidateContentTypes();
+            }
+            invalidateSerializedText();
         }
         
         void Face::updatePointsFromVertices() {
@@ -503,6 +543,7 @@ namespace TrenchBroom {
         void Face::correctFacePoints() {
             for (size_t i = 0; i < 3; i++)
                 m_points[i].correct();
+            invalidateSerializedText();
         }
         
         void Face::setForceIntegerFacePoints(bool forceIntegerFacePoints) {
@@ -525,6 +566,7 @@ namespace TrenchBroom {
                 m_texture->incUsageCount();
             m_vertexCacheValid = false;
             updateContentType();
+            invalidateSerializedText();
         }
         
         void Face::moveTexture(const Vec3f& up, const Vec3f& right, Direction direction, float distance) {
@@ -626,6 +668,7 @@ namespace TrenchBroom {
             }
             
             m_vertexCacheValid = false;
+            invalidateSerializedText();
         }
         
         void Face::rotateTexture(float angle) {
@@ -638,6 +681,7 @@ namespace TrenchBroom {
                 m_rotation -= angle;
             m_texAxesValid = false;
             m_vertexCacheValid = false;
+            invalidateSerializedText();
         }
         
         void Face::setSelected(bool selected) {
@@ -658,8 +702,7 @@ namespace TrenchBroom {
                 compensateTransformation(pointTransform);
             
             m_boundary.transform(pointTransform, vectorTransform);
-            for (size_t i = 0; i < 3; i++)
-                m_points[i] = pointTransform * m_points[i];
+            transformPoints(pointTransform, m_points, 3, m_points);
             if (invertOrientation)
                 std::swap(m_points[1], m_points[2]);
             if (m_forceIntegerFacePoints)
@@ -669,6 +712,7 @@ namespace TrenchBroom {
 
             m_texAxesValid = false;
             m_vertexCacheValid = false;
+            invalidateSerializedText();
         }
     }
 }
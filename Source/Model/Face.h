@@ -151,12 +151,27 @@ namespace TrenchBroom {
             void validateTexAxes(const Vec3f& faceNormal) const;
             void validateVertexCache() const;
 
+            inline Renderer::FaceVertex faceVertex(const Vec3f& position, unsigned int width, unsigned int height) const {
+                return Renderer::FaceVertex(position,
+                                            m_boundary.normal,
+                                            Vec2f((position.dot(m_scaledTexAxisX) + m_xOffset) / width,
+                                                  (position.dot(m_scaledTexAxisY) + m_yOffset) / height)
+                                            );
+            }
+
             void projectOntoTexturePlane(Vec3f& xAxis, Vec3f& yAxis);
             void compensateTransformation(const Mat4f& transformation);
             void updateContentType();
+            void invalidateSerializedText();
         public:
             Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Vec3f& point1, const Vec3f& point2, const Vec3f& point3, const String& textureName);
             Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Face& faceTemplate);
+            
+            /**
+             * Creates a face from previously computed points and boundary plane without correcting the points. Used
+             * to restore faces from the geometry cache.
+             */
+            Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FacePoints& points, const Planef& boundary, const String& textureName);
             Face(const Face& face);
 			~Face();
 
@@ -238,6 +253,7 @@ namespace TrenchBroom {
             inline void setTextureName(const String& textureName) {
                 m_textureName = textureName;
                 updateContentType();
+                invalidateSerializedText();
             }
 
             inline Texture* texture() const {
@@ -255,6 +271,7 @@ namespace TrenchBroom {
                     return;
                 m_xOffset = xOffset;
                 m_vertexCacheValid = false;
+                invalidateSerializedText();
             }
 
             inline float yOffset() const {
@@ -266,6 +283,7 @@ namespace TrenchBroom {
                     return;
                 m_yOffset = yOffset;
                 m_vertexCacheValid = false;
+                invalidateSerializedText();
             }
 
             inline float rotation() const {
@@ -278,6 +296,7 @@ namespace TrenchBroom {
                 m_rotation = rotation;
                 m_texAxesValid = false;
                 m_vertexCacheValid = false;
+                invalidateSerializedText();
             }
 
             inline float xScale() const {
@@ -290,6 +309,7 @@ namespace TrenchBroom {
                 m_xScale = xScale;
                 m_texAxesValid = false;
                 m_vertexCacheValid = false;
+                invalidateSerializedText();
             }
 
             inline float yScale() const {
@@ -302,6 +322,7 @@ namespace TrenchBroom {
                 m_yScale = yScale;
                 m_texAxesValid = false;
                 m_vertexCacheValid = false;
+                invalidateSerializedText();
             }
 
             inline void setAttributes(const Face& face) {
@@ -331,6 +352,12 @@ namespace TrenchBroom {
                 return m_vertexCache;
             }
 
+            /**
+             * Appends the vertices of the triangles of the given polygon, which must lie on this face's boundary and be
+             * wound like the sides of a brush, to the given list.
+             */
+            void addPolygonVertices(const Vec3f::List& polygon, Renderer::FaceVertex::List& vertices) const;
+
             inline bool selected() const {
                 return m_selected;
             }
@@ -81,6 +81,40 @@ namespace TrenchBroom {
         class DefaultFilter : public Filter {
         protected:
             const View::ViewOptions& m_viewOptions;
+            
+            static inline unsigned int contentTypeBit(Face::ContentType contentType) {
+                return 1u << contentType;
+            }
+            
+            inline bool facesVisible(const Model::Brush& brush) const {
+                const unsigned int contentTypes = brush.contentTypes();
+                if (!m_viewOptions.showClipBrushes() && contentTypes == contentTypeBit(Face::CTClip))
+                    return false;
+                if (!m_viewOptions.showSkipBrushes() && contentTypes == contentTypeBit(Face::CTSkip))
+                    return false;
+                if (!m_viewOptions.showHintBrushes() && contentTypes == contentTypeBit(Face::CTHint))
+                    return false;
+                if (!m_viewOptions.showLiquidBrushes() && contentTypes == contentTypeBit(Face::CTLiquid))
+                    return false;
+                if (!m_viewOptions.showTriggerBrushes() && contentTypes == contentTypeBit(Face::CTTrigger))
+                    return false;
+                
+                const String& pattern = m_viewOptions.filterPattern();
+                if (pattern.empty())
+                    return true;
+                
+                // only the faces with regular textures are matched against the pattern
+                if ((contentTypes & contentTypeBit(Face::CTDefault)) == 0)
+                    return false;
+                
+                const Model::FaceList& faces = brush.faces();
+                for (size_t i = 0; i < faces.size(); i++) {
+                    const Model::Face& face = *faces[i];
+                    if (face.contentType() == Face::CTDefault && Utility::containsString(face.textureName(), pattern, false))
+                        return true;
+                }
+                return false;
+            }
         public:
             DefaultFilter(const View::ViewOptions& viewOptions) :
             m_viewOptions(viewOptions) {}
@@ -120,65 +154,22 @@ namespace TrenchBroom {
             virtual inline bool brushVisible(const Model::Brush& brush) const {
                 if (!m_viewOptions.showBrushes() || brush.hidden())
                     return false;
-
-                const String& pattern = m_viewOptions.filterPattern();
-                if (!pattern.empty() ||
-                    !m_viewOptions.showClipBrushes() || !m_viewOptions.showSkipBrushes() ||
-                    !m_viewOptions.showHintBrushes() || !m_viewOptions.showLiquidBrushes() ||
-                    !m_viewOptions.showTriggerBrushes()) {
-                    
-                    if (!m_viewOptions.showTriggerBrushes()) {
-                        Model::Entity* entity = brush.entity();
-                        if (entity != NULL && Utility::startsWith(entity->safeClassname(), "trigger_"))
-                            return false;
-                    }
-                    
-                    const Model::FaceList& faces = brush.faces();
-                    unsigned int clipCount = 0;
-                    unsigned int skipCount = 0;
-                    unsigned int hintCount = 0;
-                    unsigned int liquidCount = 0;
-                    unsigned int triggerCount = 0;
-                    bool matches = pattern.empty();
-                    for (unsigned int i = 0; i < faces.size(); i++) {
-                        switch (faces[i]->contentType()) {
-                            case Face::CTLiquid:
-                                liquidCount++;
-                                break;
-                            case Face::CTClip:
-                                clipCount++;
-                                break;
-                            case Face::CTSkip:
-                                skipCount++;
-                                break;
-                            case Face::CTHint:
-                                hintCount++;
-                                break;
-                            case Face::CTTrigger:
-                                triggerCount++;
-                                break;
-                            default:
-                                if (!matches)
-                                    matches = Utility::containsString(faces[i]->textureName(), pattern, false);
-                                break;
-                        }
-                    }
-
-                    if (!m_viewOptions.showClipBrushes() && clipCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showSkipBrushes() && skipCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showHintBrushes() && hintCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showLiquidBrushes() && liquidCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showTriggerBrushes() && triggerCount == faces.size())
+                
+                if (!m_viewOptions.showTriggerBrushes()) {
+                    Model::Entity* entity = brush.entity();
+                    if (entity != NULL && entity->classnameCategory() == Model::Entity::CCTrigger)
                         return false;
-
-                    return matches;
                 }
-
-                return true;
+                
+                // the result only depends on the faces of the brush and the view options, so it is cached in the
+                // brush until either of them changes
+                const unsigned int filterGeneration = m_viewOptions.brushFilterGeneration();
+                bool result;
+                if (!brush.cachedFilterResult(filterGeneration, result)) {
+                    result = facesVisible(brush);
+                    brush.cacheFilterResult(filterGeneration, result);
+                }
+                return result;
             }
 
             virtual inline bool brushPickable(const Model::Brush& brush) const {
@@ -22,7 +22,9 @@
 #include "Controller/Autosaver.h"
 #include "Controller/Command.h"
 #include "IO/FileManager.h"
+#include "IO/GameFileSystem.h"
 #include "IO/IOException.h"
+#include "IO/MapCache.h"
 #include "IO/MapParser.h"
 #include "IO/MapWriter.h"
 #include "IO/Wad.h"
@@ -36,6 +38,7 @@
 #include "Model/Picker.h"
 #include "Model/PointFile.h"
 #include "Model/TextureManager.h"
+#include "Renderer/EntityModelRendererManager.h"
 #include "Renderer/SharedResources.h"
 #include "Renderer/TextureRendererManager.h"
 #include "Utility/Console.h"
@@ -65,6 +68,22 @@ namespace TrenchBroom {
 
         IMPLEMENT_DYNAMIC_CLASS(MapDocument, wxDocument)
 
+        /**
+         * Logs the result of writing the geometry cache on the UI thread. The document detaches it before it
+         * starts another write or is destroyed.
+         */
+        class MapDocument::MapCacheWritten : public Utility::Future<bool>::Continuation {
+        private:
+            MapDocument& m_document;
+        public:
+            MapCacheWritten(MapDocument& document) :
+            m_document(document) {}
+
+            void operator()(const bool& success) {
+                m_document.logMapCacheWritten(success);
+            }
+        };
+
         bool MapDocument::DoOpenDocument(const wxString& file) {
             const String path = file.ToStdString();
             IO::FileManager fileManager;
@@ -76,7 +95,7 @@ namespace TrenchBroom {
                 console().info("Loading file %s", file.mbc_str().data());
                 
                 View::ProgressIndicatorDialog progressIndicator;
-                loadMap(mappedFile->begin(), mappedFile->end(), progressIndicator);
+                loadMap(path, mappedFile->begin(), mappedFile->end(), progressIndicator);
                 loadTextures();
                 loadEntityDefinitionFile();
 
@@ -108,10 +127,10 @@ namespace TrenchBroom {
         }
 
         void MapDocument::clear() {
-            m_sharedResources->textureRendererManager().invalidate();
             m_editStateManager->clear();
             m_map->clear();
             m_octree->clear();
+            m_sharedResources->textureRendererManager().releaseCollections(m_textureManager->collections());
             m_textureManager->clear();
             m_definitionManager->clear();
             unloadPointFile();
@@ -128,7 +147,13 @@ namespace TrenchBroom {
             m_sharedResources->loadPalette(palettePath);
         }
 
-        void MapDocument::loadMap(char* begin, char* end, Utility::ProgressIndicator& progressIndicator) {
+        void MapDocument::loadMap(const String& path, char* begin, char* end, Utility::ProgressIndicator& progressIndicator) {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const bool useGeometryCache = prefs.getBool(Preferences::UseGeometryCache);
+            const uint64_t mapHash = useGeometryCache ? IO::BinaryCache::hash(begin, end) : 0;
+            if (useGeometryCache && loadMapCache(path, mapHash))
+                return;
+            
             progressIndicator.setText("Loading map file...");
             
             wxStopWatch watch;
@@ -136,6 +161,69 @@ namespace TrenchBroom {
             parser.parseMap(*m_map, &progressIndicator);
             
             console().info("Loaded map file in %f seconds", watch.Time() / 1000.0f);
+            
+            if (useGeometryCache)
+                writeMapCache(path, mapHash);
+        }
+        
+        bool MapDocument::loadMapCache(const String& path, uint64_t mapHash) {
+            IO::FileManager fileManager;
+            const String cachePath = IO::MapCache::cachePath(path);
+            if (!fileManager.exists(cachePath))
+                return false;
+            
+            // the cache might still be written if the same map is reopened right after loading it
+            finishMapCacheWriter();
+            
+            IO::MappedFile::Ptr cacheFile = fileManager.mapFile(cachePath);
+            if (cacheFile.get() == NULL)
+                return false;
+            
+            wxStopWatch watch;
+            try {
+                IO::MapCacheReader reader(cacheFile->begin(), cacheFile->end());
+                if (!reader.read(*m_map, mapHash)) {
+                    console().info("Geometry cache %s is out of date", cachePath.c_str());
+                    return false;
+                }
+            } catch (IO::IOException& e) {
+                console().warn("Could not read geometry cache %s: %s", cachePath.c_str(), e.what());
+                return false;
+            }
+            
+            console().info("Loaded map from geometry cache in %f seconds", watch.Time() / 1000.0f);
+            return true;
+        }
+        
+        void MapDocument::writeMapCache(const String& path, uint64_t mapHash) {
+            finishMapCacheWriter();
+            
+            // serialize on the UI thread so that the cache reflects the map as it was loaded
+            std::vector<char> buffer;
+            IO::MapCacheWriter writer;
+            writer.writeToBuffer(*m_map, mapHash, buffer);
+            
+            m_mapCachePath = IO::MapCache::cachePath(path);
+            m_mapCacheWritten = Utility::runAsync(new IO::MapCacheWriteTask(m_mapCachePath, buffer));
+            m_mapCacheWritten->then(new MapCacheWritten(*this));
+        }
+        
+        void MapDocument::finishMapCacheWriter() {
+            if (m_mapCacheWritten.get() == NULL)
+                return;
+            
+            // if the continuation has not been called yet, it is replaced by logging the result right away
+            const bool success = m_mapCacheWritten->get();
+            if (m_mapCacheWritten->detach())
+                logMapCacheWritten(success);
+            m_mapCacheWritten = Utility::Future<bool>::Ptr();
+        }
+        
+        void MapDocument::logMapCacheWritten(bool success) {
+            if (success)
+                console().debug("Wrote geometry cache %s", m_mapCachePath.c_str());
+            else
+                console().warn("Could not write geometry cache %s", m_mapCachePath.c_str());
         }
 
         void MapDocument::setAllTexturesToNull() {
@@ -219,10 +307,12 @@ namespace TrenchBroom {
         m_mruTextureName(""),
         m_textureLock(true),
         m_modificationCount(0),
+        m_searchPathsId(0),
         m_searchPathsValid(false),
         m_pointFile(NULL) {}
 
         MapDocument::~MapDocument() {
+            finishMapCacheWriter();
             delete m_autosaveTimer;
             m_autosaveTimer = NULL;
             delete m_autosaver;
@@ -237,11 +327,12 @@ namespace TrenchBroom {
             m_map = NULL;
             delete m_definitionManager;
             m_definitionManager = NULL;
+            m_sharedResources->textureRendererManager().releaseCollections(m_textureManager->collections());
             delete m_textureManager;
             m_textureManager = NULL;
             delete m_grid;
             m_grid = NULL;
-            m_sharedResources->Destroy(); // makes sure that the resources are deleted after the last frame
+            m_sharedResources->release(*m_console);
             m_sharedResources = NULL;
             delete m_console;
             m_console = NULL;
@@ -492,14 +583,22 @@ namespace TrenchBroom {
 
                 IO::FileManager fileManager;
                 m_searchPaths = fileManager.resolveSearchpaths(quakePath, m_searchPaths);
+                m_searchPathsId = sharedResources().modelRendererManager().searchPathsId(m_searchPaths);
                 m_searchPathsValid = true;
             }
 
             return m_searchPaths;
         }
         
+        unsigned int MapDocument::searchPathsId() const {
+            searchPaths();
+            return m_searchPathsId;
+        }
+        
         void MapDocument::invalidateSearchPaths() {
             m_searchPathsValid = false;
+            if (IO::GameFileSystem::sharedFileSystem != NULL)
+                IO::GameFileSystem::sharedFileSystem->invalidate();
         }
 
         bool MapDocument::pointFileExists() {
@@ -596,6 +695,7 @@ namespace TrenchBroom {
 
         void MapDocument::loadTextures() {
             setAllTexturesToNull();
+            m_sharedResources->textureRendererManager().releaseCollections(m_textureManager->collections());
             m_textureManager->clear();
             
             const String* wads = worldspawn().propertyForKey(Entity::WadKey);
@@ -626,7 +726,7 @@ namespace TrenchBroom {
 
             m_console = new Utility::Console();
             m_textureManager = new TextureManager();
-            m_sharedResources = new Renderer::SharedResources(*m_textureManager, *m_console);
+            m_sharedResources = &Renderer::SharedResources::retain(*m_console);
             m_map = new Model::Map(worldBounds, false);
             m_editStateManager = new Model::EditStateManager();
             m_octree = new Octree(*m_map);
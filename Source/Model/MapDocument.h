@@ -22,11 +22,18 @@
 
 #include "Model/BrushTypes.h"
 #include "Model/EntityTypes.h"
+#include "Utility/Future.h"
 #include "Utility/String.h"
 
 #include <wx/docview.h>
 #include <wx/timer.h>
 
+#if defined _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
 namespace TrenchBroom {
     namespace Controller {
         class Autosaver;
@@ -59,8 +66,13 @@ namespace TrenchBroom {
         class MapDocument : public wxDocument {
             DECLARE_DYNAMIC_CLASS(MapDocument)
         protected:
+            class MapCacheWritten;
+            friend class MapCacheWritten;
+
             Controller::Autosaver* m_autosaver;
             wxTimer* m_autosaveTimer;
+            Utility::Future<bool>::Ptr m_mapCacheWritten;
+            String m_mapCachePath;
             Utility::Console* m_console;
             Renderer::SharedResources* m_sharedResources;
             Map* m_map;
@@ -76,6 +88,7 @@ namespace TrenchBroom {
             int m_modificationCount;
             
             mutable StringList m_searchPaths;
+            mutable unsigned int m_searchPathsId;
             mutable bool m_searchPathsValid;
             
             PointFile* m_pointFile;
@@ -86,7 +99,11 @@ namespace TrenchBroom {
             void clear();
 
             void loadPalette();
-            void loadMap(char* begin, char* end, Utility::ProgressIndicator& progressIndicator);
+            void loadMap(const String& path, char* begin, char* end, Utility::ProgressIndicator& progressIndicator);
+            bool loadMapCache(const String& path, uint64_t mapHash);
+            void writeMapCache(const String& path, uint64_t mapHash);
+            void finishMapCacheWriter();
+            void logMapCacheWritten(bool success);
 
             void setAllTexturesToNull();
             void refreshAllTextures();
@@ -125,6 +142,11 @@ namespace TrenchBroom {
             Utility::Grid& grid() const;
             
             const StringList& searchPaths() const;
+            
+            /**
+             * Identifies the current search paths in the entity model renderer manager.
+             */
+            unsigned int searchPathsId() const;
             void invalidateSearchPaths();
             
             bool pointFileExists();
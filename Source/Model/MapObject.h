@@ -22,6 +22,7 @@
 
 #include "Model/EditState.h"
 #include "Model/MapObjectTypes.h"
+#include "Utility/String.h"
 #include "Utility/VecMath.h"
 
 #include <vector>
@@ -41,6 +42,10 @@ namespace TrenchBroom {
             
             size_t m_fileFirstLine;
             size_t m_fileLineCount;
+            
+            // the text written for this object during the last save, reused until the object changes
+            mutable String m_serializedText;
+            mutable bool m_serializedTextValid;
         public:
             enum Type {
                 EntityObject,
@@ -51,7 +56,8 @@ namespace TrenchBroom {
             m_editState(EditState::Default),
             m_previouslyLocked(false),
             m_fileFirstLine(0),
-            m_fileLineCount(0) {
+            m_fileLineCount(0),
+            m_serializedTextValid(false) {
                 static unsigned int currentId = 1;
                 m_uniqueId = currentId++;
             }
@@ -144,6 +150,10 @@ namespace TrenchBroom {
                 return m_fileFirstLine;
             }
             
+            inline size_t fileLineCount() const {
+                return m_fileLineCount;
+            }
+            
             inline bool occupiesFileLine(size_t line) const {
                 return line >= m_fileFirstLine && line < m_fileFirstLine + m_fileLineCount;
             }
@@ -152,6 +162,27 @@ namespace TrenchBroom {
                 m_fileFirstLine = firstLine;
                 m_fileLineCount = lineCount;
             }
+            
+            inline bool serializedTextValid() const {
+                return m_serializedTextValid;
+            }
+            
+            inline const String& serializedText() const {
+                assert(m_serializedTextValid);
+                return m_serializedText;
+            }
+            
+            inline void setSerializedText(const String& serializedText) const {
+                m_serializedText = serializedText;
+                m_serializedTextValid = true;
+            }
+            
+            inline void invalidateSerializedText() {
+                if (!m_serializedTextValid)
+                    return;
+                String().swap(m_serializedText);
+                m_serializedTextValid = false;
+            }
         };
     }
 }
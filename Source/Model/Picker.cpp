@@ -23,6 +23,7 @@
 #include "Model/Octree.h"
 
 #include <algorithm>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Model {
@@ -117,8 +118,23 @@ namespace TrenchBroom {
             PickResult* pickResults = new PickResult();
 
             MapObjectList objects = m_octree.intersect(ray);
+
+            // test the bounds of all candidate brushes at once and skip the brushes which the ray misses
+            std::vector<const BBoxf*> brushBounds;
             for (unsigned int i = 0; i < objects.size(); i++)
+                if (objects[i]->objectType() == MapObject::BrushObject)
+                    brushBounds.push_back(&objects[i]->bounds());
+
+            std::vector<bool> brushHits;
+            if (!brushBounds.empty())
+                intersectBoundsWithRay(ray, &brushBounds[0], brushBounds.size(), brushHits);
+
+            size_t brushIndex = 0;
+            for (unsigned int i = 0; i < objects.size(); i++) {
+                if (objects[i]->objectType() == MapObject::BrushObject && !brushHits[brushIndex++])
+                    continue;
                 objects[i]->pick(ray, *pickResults);
+            }
 
             return pickResults;
         }
@@ -40,6 +40,7 @@ namespace TrenchBroom {
                 TargetDestinationProperty,
                 StringProperty,
                 IntegerProperty,
+                FloatProperty,
                 ChoiceProperty,
                 FlagsProperty
             };
@@ -109,7 +110,7 @@ namespace TrenchBroom {
             float m_defaultValue;
         public:
             FloatPropertyDefinition(const String& name, const String& description, float defaultValue) :
-            PropertyDefinition(name, IntegerProperty, description),
+            PropertyDefinition(name, FloatProperty, description),
             m_defaultValue(defaultValue) {}
             
             inline float defaultValue() const {
@@ -23,6 +23,8 @@
 #include <GL/glew.h>
 #include "Utility/String.h"
 
+#include <wx/atomic.h>
+
 namespace TrenchBroom {
     namespace Model {
         class TextureCollection;
@@ -37,7 +39,7 @@ namespace TrenchBroom {
             IdType m_uniqueId;
             unsigned int m_width;
             unsigned int m_height;
-            unsigned int m_usageCount;
+            wxAtomicInt m_usageCount;
             bool m_overridden;
         public:
             Texture(TextureCollection& collection, const String& name, unsigned int width, unsigned int height) :
@@ -72,15 +74,16 @@ namespace TrenchBroom {
             }
             
             inline unsigned int usageCount() const {
-                return m_usageCount;
+                return static_cast<unsigned int>(m_usageCount);
             }
             
+            // faces change their textures on worker threads when brushes are modified in parallel
             inline void incUsageCount() {
-                m_usageCount++;
+                wxAtomicInc(m_usageCount);
             }
             
             inline void decUsageCount() {
-                m_usageCount--;
+                wxAtomicDec(m_usageCount);
             }
             
             inline bool overridden() const {
@@ -19,6 +19,7 @@
 
 #include "TextureManager.h"
 
+#include "IO/FileManager.h"
 #include "Renderer/Palette.h"
 #include "Utility/List.h"
 
@@ -27,16 +28,18 @@ namespace TrenchBroom {
         TextureCollectionLoader::TextureCollectionLoader(const String& path) throw (IO::IOException) :
         m_wad(path) {}
 
-        unsigned char* TextureCollectionLoader::load(const Texture& texture, const Renderer::Palette& palette, Color& averageColor) throw (IO::IOException) {
-            IO::Mip* mip = NULL;
+        IO::Mip* TextureCollectionLoader::loadMip(const Texture& texture) const {
             try {
-                mip = m_wad.loadMip(texture.name(), 1);
+                return m_wad.loadMip(texture.name(), 1);
             } catch (IO::IOException&) {
-                 delete mip;
                 return NULL;
             }
+        }
 
-            assert(mip != NULL);
+        unsigned char* TextureCollectionLoader::load(const Texture& texture, const Renderer::Palette& palette, Color& averageColor) throw (IO::IOException) {
+            IO::Mip* mip = loadMip(texture);
+            if (mip == NULL)
+                return NULL;
 
             size_t pixelCount = texture.width() * texture.height();
             unsigned char* rgbImage = new unsigned char[pixelCount * 3];
@@ -48,7 +51,11 @@ namespace TrenchBroom {
 
         TextureCollection::TextureCollection(const String& name, const String& path) throw (IO::IOException) :
         m_name(name),
-        m_path(path) {
+        m_path(path),
+        m_modificationTime(0) {
+            IO::FileManager fileManager;
+            m_modificationTime = fileManager.modificationTime(m_path);
+
             IO::Mip::List mips;
             try {
                 IO::Wad wad(m_path);
@@ -27,6 +27,7 @@
 #include "Utility/String.h"
 
 #include <algorithm>
+#include <ctime>
 #include <map>
 
 namespace TrenchBroom {
@@ -68,6 +69,12 @@ namespace TrenchBroom {
             IO::Wad m_wad;
         public:
             TextureCollectionLoader(const String& path) throw (IO::IOException);
+            
+            /**
+             * Returns the first mip level of the given texture or NULL if it cannot be loaded. Only reads from the
+             * mapped wad file, so it can be called for several textures concurrently.
+             */
+            IO::Mip* loadMip(const Texture& texture) const;
             unsigned char* load(const Texture& texture, const Renderer::Palette& palette, Color& averageColor) throw (IO::IOException);
         };
         
@@ -80,6 +87,7 @@ namespace TrenchBroom {
             mutable TextureList m_texturesByUsage;
             String m_name;
             String m_path;
+            time_t m_modificationTime;
         public:
             TextureCollection(const String& name, const String& path) throw (IO::IOException);
             ~TextureCollection();
@@ -99,6 +107,18 @@ namespace TrenchBroom {
                 return m_name;
             }
             
+            inline const String& path() const {
+                return m_path;
+            }
+            
+            /**
+             * Returns the modification time of the wad file at the time the collection was loaded. Together with the
+             * path, it identifies the contents of the collection.
+             */
+            inline time_t modificationTime() const {
+                return m_modificationTime;
+            }
+            
             inline void update(const String& name, const String& path) {
                 m_name = name;
                 m_path = path;
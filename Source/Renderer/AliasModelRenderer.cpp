@@ -49,34 +49,35 @@ namespace TrenchBroom {
             m_vertexArray = NULL;
         }
 
-        void AliasModelRenderer::render(ShaderProgram& shaderProgram) {
-            if (m_vertexArray == NULL) {
-                assert(m_skinIndex < m_alias.skins().size());
-                assert(m_frameIndex < m_alias.frames().size());
-                
-                Model::AliasSkin& skin = *m_alias.skins()[m_skinIndex];
-                m_texture = TextureRendererPtr(new TextureRenderer(skin, 0, m_palette));
-
-                Model::AliasSingleFrame& frame = m_alias.frame(m_frameIndex);
-                const Model::AliasFrameTriangleList& triangles = frame.triangles();
-                unsigned int vertexCount = static_cast<unsigned int>(3 * triangles.size());
-                
-                m_vertexArray = new VertexArray(m_vbo, GL_TRIANGLES, vertexCount,
-                                                Attribute::position3f(),
-                                                Attribute::texCoord02f());
-
-                SetVboState mapVbo(m_vbo, Vbo::VboMapped);
-                for (unsigned int i = 0; i < triangles.size(); i++) {
-                    Model::AliasFrameTriangle& triangle = *triangles[i];
-                    for (unsigned int j = 0; j < 3; j++) {
-                        Model::AliasFrameVertex& vertex = triangle[j];
-                        m_vertexArray->addAttribute(vertex.position());
-                        m_vertexArray->addAttribute(vertex.texCoords());
-                    }
+        void AliasModelRenderer::buildVertexArray() {
+            assert(m_skinIndex < m_alias.skins().size());
+            assert(m_frameIndex < m_alias.frameCount());
+            
+            Model::AliasSkin& skin = *m_alias.skins()[m_skinIndex];
+            m_texture = TextureRendererPtr(new TextureRenderer(skin, 0, m_palette));
+
+            Model::AliasSingleFrame& frame = m_alias.frame(m_frameIndex);
+            const Model::AliasFrameTriangleList& triangles = frame.triangles();
+            unsigned int vertexCount = static_cast<unsigned int>(3 * triangles.size());
+            
+            m_vertexArray = new VertexArray(m_vbo, GL_TRIANGLES, vertexCount,
+                                            Attribute::position3f(),
+                                            Attribute::texCoord02f());
+
+            SetVboState mapVbo(m_vbo, Vbo::VboMapped);
+            for (unsigned int i = 0; i < triangles.size(); i++) {
+                Model::AliasFrameTriangle& triangle = *triangles[i];
+                for (unsigned int j = 0; j < 3; j++) {
+                    Model::AliasFrameVertex& vertex = triangle[j];
+                    m_vertexArray->addAttribute(vertex.position());
+                    m_vertexArray->addAttribute(vertex.texCoords());
                 }
             }
+        }
 
-            assert(m_vertexArray != NULL);
+        void AliasModelRenderer::render(ShaderProgram& shaderProgram) {
+            if (m_vertexArray == NULL)
+                buildVertexArray();
             
             glActiveTexture(GL_TEXTURE0);
             m_texture->activate();
@@ -85,6 +86,17 @@ namespace TrenchBroom {
             m_texture->deactivate();
         }
 
+        void AliasModelRenderer::renderInstances(ShaderProgram& shaderProgram, unsigned int instanceCount) {
+            if (m_vertexArray == NULL)
+                buildVertexArray();
+            
+            glActiveTexture(GL_TEXTURE0);
+            m_texture->activate();
+            shaderProgram.setUniformVariable("Texture", 0);
+            m_vertexArray->renderInstanced(instanceCount);
+            m_texture->deactivate();
+        }
+
         const Vec3f& AliasModelRenderer::center() const {
             return m_alias.frame(m_frameIndex).center();
         }
@@ -97,17 +109,18 @@ namespace TrenchBroom {
             Model::AliasSingleFrame& frame = m_alias.frame(m_frameIndex);
             const Model::AliasFrameTriangleList& triangles = frame.triangles();
 
-            BBoxf bounds;
-            bounds.min = bounds.max = transformation * (*triangles[0])[0].position();
-            
-            for (unsigned int i = 1; i < triangles.size(); i++) {
-                Model::AliasFrameTriangle& triangle = *triangles[i];
-                for (unsigned int j = 0; j < 3; j++) {
-                    Model::AliasFrameVertex& vertex = triangle[j];
-                    bounds.mergeWith(transformation * vertex.position());
-                }
+            Vec3f::List positions;
+            positions.reserve(3 * triangles.size());
+            for (unsigned int i = 0; i < triangles.size(); i++) {
+                const Model::AliasFrameTriangle& triangle = *triangles[i];
+                for (unsigned int j = 0; j < 3; j++)
+                    positions.push_back(triangle[j].position());
             }
             
+            BBoxf bounds;
+            bounds.min = bounds.max = transformation * positions[0];
+            mergeTransformedBounds(bounds, transformation, &positions[0], positions.size());
+            
             return bounds;
         }
     }
@@ -26,6 +26,7 @@
 #include "Renderer/Shader/ShaderProgram.h"
 #include "Utility/String.h"
 
+#include <algorithm>
 #include <cassert>
 #include <vector>
 
@@ -93,6 +94,11 @@ namespace TrenchBroom {
                 return attr;
             }
             
+            static const Attribute& texCoord12f() {
+                static const Attribute attr = Attribute(2, GL_FLOAT, TexCoord1);
+                return attr;
+            }
+            
             inline GLint size() const {
                 return m_size;
             }
@@ -236,16 +242,20 @@ namespace TrenchBroom {
                 m_block = vbo.allocBlock(m_vertexCapacity * (m_vertexSize + m_padBy));
             }
 
+            inline size_t writeVertex() const {
+                return m_writeOffset / (m_vertexSize + m_padBy);
+            }
+            
             inline void attributesAdded(size_t count = 1) {
                 assert(count <= 1 || m_padBy == 0);
                 if (count > 1) {
-                    m_vertexCount += count;
+                    m_vertexCount = std::max(m_vertexCount, writeVertex());
                 } else {
                     m_specIndex = static_cast<size_t>(succ(m_specIndex, m_attributes.size()));
                     if (m_specIndex == 0) {
                         if (m_padBy > 0)
                             m_writeOffset += m_padBy;
-                        m_vertexCount++;
+                        m_vertexCount = std::max(m_vertexCount, writeVertex());
                     }
                 }
             }
@@ -341,8 +351,22 @@ namespace TrenchBroom {
                 return m_vertexCount;
             }
             
+            inline size_t vertexCapacity() const {
+                return m_vertexCapacity;
+            }
+            
+            /**
+             * Moves the write position to the given vertex so that previously written vertices can be overwritten.
+             * The vertex count only grows when vertices beyond it are written.
+             */
+            inline void seek(size_t vertexIndex) {
+                assert(m_specIndex == 0);
+                assert(vertexIndex <= m_vertexCapacity);
+                m_writeOffset = vertexIndex * (m_vertexSize + m_padBy);
+            }
+            
             inline void addAttribute(float value) {
-                assert(m_vertexCount < m_vertexCapacity);
+                assert(writeVertex() < m_vertexCapacity);
                 assert(m_attributes[m_specIndex].valueType() == GL_FLOAT);
                 assert(m_attributes[m_specIndex].size() == 1);
 
@@ -351,7 +375,7 @@ namespace TrenchBroom {
             }
 
             inline void addAttribute(const Vec2f& value) {
-                assert(m_vertexCount < m_vertexCapacity);
+                assert(writeVertex() < m_vertexCapacity);
                 assert(m_attributes[m_specIndex].valueType() == GL_FLOAT);
                 assert(m_attributes[m_specIndex].size() == 2);
 
@@ -361,7 +385,7 @@ namespace TrenchBroom {
 
             inline void addAttributes(const Vec2f::List& values) {
                 assert(values.size() % m_attributes.size() == 0);
-                assert(m_vertexCount + values.size() / m_attributes.size() <= m_vertexCapacity);
+                assert(writeVertex() + values.size() / m_attributes.size() <= m_vertexCapacity);
                 for (size_t i = 0; i < m_attributes.size(); i++) {
                     const Attribute& attribute = m_attributes[i];
                     assert(attribute.valueType() == GL_FLOAT);
@@ -376,7 +400,7 @@ namespace TrenchBroom {
             }
 
             inline void addAttribute(const Vec3f& value) {
-                assert(m_vertexCount < m_vertexCapacity);
+                assert(writeVertex() < m_vertexCapacity);
                 assert(m_attributes[m_specIndex].valueType() == GL_FLOAT);
                 assert(m_attributes[m_specIndex].size() == 3);
 
@@ -386,7 +410,7 @@ namespace TrenchBroom {
             
             inline void addAttributes(const Vec3f::List& values) {
                 assert(values.size() % m_attributes.size() == 0);
-                assert(m_vertexCount + values.size() / m_attributes.size() <= m_vertexCapacity);
+                assert(writeVertex() + values.size() / m_attributes.size() <= m_vertexCapacity);
                 for (size_t i = 0; i < m_attributes.size(); i++) {
                     const Attribute& attribute = m_attributes[i];
                     assert(attribute.valueType() == GL_FLOAT);
@@ -409,7 +433,7 @@ namespace TrenchBroom {
                 assert(m_attributes[1].attributeType() == Attribute::Normal);
                 assert(m_attributes[1].valueType() == GL_FLOAT);
                 assert(m_attributes[1].size() == 3);
-                assert(m_vertexCount + vertices.size() <= m_vertexCapacity);
+                assert(writeVertex() + vertices.size() <= m_vertexCapacity);
                 if (m_padBy == 0) {
                     for (size_t i = 0; i < vertices.size(); i++) {
                         m_writeOffset = m_block->writeVec(vertices[i], m_writeOffset);
@@ -434,7 +458,7 @@ namespace TrenchBroom {
                 assert(m_attributes[1].attributeType() == Attribute::Color);
                 assert(m_attributes[1].valueType() == GL_FLOAT);
                 assert(m_attributes[1].size() == 4);
-                assert(m_vertexCount + vertices.size() <= m_vertexCapacity);
+                assert(writeVertex() + vertices.size() <= m_vertexCapacity);
                 if (m_padBy == 0) {
                     for (size_t i = 0; i < vertices.size(); i++) {
                         m_writeOffset = m_block->writeVec(vertices[i], m_writeOffset);
@@ -452,7 +476,7 @@ namespace TrenchBroom {
             }
             
             inline void addAttribute(const Vec4f& value) {
-                assert(m_vertexCount < m_vertexCapacity);
+                assert(writeVertex() < m_vertexCapacity);
                 assert(m_attributes[m_specIndex].valueType() == GL_FLOAT);
                 assert(m_attributes[m_specIndex].size() == 4);
                 
@@ -460,6 +484,22 @@ namespace TrenchBroom {
                 attributesAdded();
             }
             
+            /**
+             * Appends vertices whose attributes are already interleaved in the layout of this array, e.g. vertices
+             * which were generated in advance on another thread.
+             */
+            template <typename T>
+            inline void addVertices(const std::vector<T>& vertices) {
+                assert(sizeof(T) == m_vertexSize + m_padBy);
+                assert(m_specIndex == 0);
+                assert(writeVertex() + vertices.size() <= m_vertexCapacity);
+                if (vertices.empty())
+                    return;
+
+                m_writeOffset = m_block->writeBuffer(reinterpret_cast<const unsigned char*>(&vertices.front()), m_writeOffset, static_cast<size_t>(vertices.size() * sizeof(T)));
+                m_vertexCount = std::max(m_vertexCount, writeVertex());
+            }
+
             inline void addAttributes(const FaceVertex::List& cachedVertices) {
                 assert(m_attributes[0].attributeType() == Attribute::Position);
                 assert(m_attributes[0].valueType() == GL_FLOAT);
@@ -471,7 +511,7 @@ namespace TrenchBroom {
                 assert(m_attributes[2].valueType() == GL_FLOAT);
                 assert(m_attributes[2].size() == 2);
                 assert(m_padBy == 0);
-                assert(m_vertexCount + cachedVertices.size() <= m_vertexCapacity);
+                assert(writeVertex() + cachedVertices.size() <= m_vertexCapacity);
                 
                 m_writeOffset = m_block->writeBuffer(reinterpret_cast<const unsigned char*>(&cachedVertices.front()), m_writeOffset, static_cast<size_t>(cachedVertices.size() * sizeof(FaceVertex)));
                 attributesAdded(static_cast<size_t>(cachedVertices.size()));
@@ -20,6 +20,7 @@
 #include "BrushFigure.h"
 
 #include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
 #include "Model/Face.h"
 #include "Model/Texture.h"
 #include "Renderer/EdgeRenderer.h"
@@ -74,6 +75,20 @@ namespace TrenchBroom {
                     }
                     
                     m_faceRenderer = new FaceRenderer(vbo, m_textureRendererManager, faceSorter, m_faceColor);
+                } else if (!m_brushParts.empty()) {
+                    FaceRenderer::TextureVertexMap vertices;
+                    
+                    BrushPartList::const_iterator partIt, partEnd;
+                    Model::SplitSideList::const_iterator sideIt, sideEnd;
+                    for (partIt = m_brushParts.begin(), partEnd = m_brushParts.end(); partIt != partEnd; ++partIt) {
+                        const Model::SplitSideList& sides = partIt->geometry->sides;
+                        for (sideIt = sides.begin(), sideEnd = sides.end(); sideIt != sideEnd; ++sideIt) {
+                            const Model::SplitSide& side = *sideIt;
+                            side.face->addPolygonVertices(side.vertices, vertices[side.face->texture()]);
+                        }
+                    }
+                    
+                    m_faceRenderer = new FaceRenderer(vbo, m_textureRendererManager, vertices, m_faceColor);
                 }
                 m_faceRendererValid = true;
             }
@@ -99,6 +114,31 @@ namespace TrenchBroom {
                         m_edgeRenderer = new EdgeRenderer(vbo, m_brushes, Model::EmptyFaceList, m_edgeColor);
                     else
                         m_edgeRenderer = new EdgeRenderer(vbo, m_brushes, Model::EmptyFaceList);
+                } else if (!m_brushParts.empty()) {
+                    BrushPartList::const_iterator partIt, partEnd;
+                    Model::EdgeInfoList::const_iterator edgeIt, edgeEnd;
+                    if (m_edgeMode == EMDefault) {
+                        EdgeRenderer::ColoredVertexList vertices;
+                        for (partIt = m_brushParts.begin(), partEnd = m_brushParts.end(); partIt != partEnd; ++partIt) {
+                            const Color& edgeColor = EdgeRenderer::edgeColor(*partIt->brush, m_edgeColor);
+                            const Model::EdgeInfoList& edges = partIt->geometry->edges;
+                            for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
+                                vertices.push_back(EdgeRenderer::ColoredVertex(edgeIt->start, edgeColor));
+                                vertices.push_back(EdgeRenderer::ColoredVertex(edgeIt->end, edgeColor));
+                            }
+                        }
+                        m_edgeRenderer = new EdgeRenderer(vbo, vertices);
+                    } else {
+                        Vec3f::List vertices;
+                        for (partIt = m_brushParts.begin(), partEnd = m_brushParts.end(); partIt != partEnd; ++partIt) {
+                            const Model::EdgeInfoList& edges = partIt->geometry->edges;
+                            for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
+                                vertices.push_back(edgeIt->start);
+                                vertices.push_back(edgeIt->end);
+                            }
+                        }
+                        m_edgeRenderer = new EdgeRenderer(vbo, vertices);
+                    }
                 }
                 m_edgeRendererValid = true;
             }
@@ -24,9 +24,12 @@
 #include "Renderer/Figure.h"
 #include "Utility/Color.h"
 
+#include <vector>
+
 namespace TrenchBroom {
     namespace Model {
         class Brush;
+        class SplitGeometry;
     }
     
     namespace Renderer {
@@ -41,9 +44,26 @@ namespace TrenchBroom {
                 EMOverride,
                 EMRenderOccluded
             } EdgeMode;
+
+
+            /**
+             * A part of a brush that was split by a plane, see Model::BrushGeometry::split.
+             */
+            class BrushPart {
+            public:
+                const Model::Brush* brush;
+                const Model::SplitGeometry* geometry;
+
+                BrushPart(const Model::Brush* i_brush, const Model::SplitGeometry* i_geometry) :
+                brush(i_brush),
+                geometry(i_geometry) {}
+            };
+
+            typedef std::vector<BrushPart> BrushPartList;
         private:
             TextureRendererManager& m_textureRendererManager;
             Model::BrushList m_brushes;
+            BrushPartList m_brushParts;
             FaceRenderer* m_faceRenderer;
             EdgeRenderer* m_edgeRenderer;
             Color m_faceColor;
@@ -62,6 +82,7 @@ namespace TrenchBroom {
 
             inline void setBrushes(const Model::BrushList& brushes) {
                 m_brushes = brushes;
+                m_brushParts.clear();
                 m_edgeRendererValid = false;
                 m_faceRendererValid = false;
             }
@@ -69,6 +90,18 @@ namespace TrenchBroom {
             inline void setBrush(Model::Brush& brush) {
                 m_brushes.clear();
                 m_brushes.push_back(&brush);
+                m_brushParts.clear();
+                m_edgeRendererValid = false;
+                m_faceRendererValid = false;
+            }
+
+            /**
+             * Renders the given brush parts instead of whole brushes. The parts must not change or be deleted until
+             * other brushes or parts are set.
+             */
+            inline void setBrushParts(const BrushPartList& brushParts) {
+                m_brushes.clear();
+                m_brushParts = brushParts;
                 m_edgeRendererValid = false;
                 m_faceRendererValid = false;
             }
@@ -119,6 +119,20 @@ namespace TrenchBroom {
             }
         }
         
+        void BspModelRenderer::renderInstances(ShaderProgram& shaderProgram, unsigned int instanceCount) {
+            if (m_vertexArrays.empty())
+                buildVertexArrays();
+            
+            glActiveTexture(GL_TEXTURE0);
+            for (unsigned int i = 0; i < m_vertexArrays.size(); i++) {
+                TextureVertexArray& textureVertexArray = m_vertexArrays[i];
+                textureVertexArray.texture->activate();
+                shaderProgram.setUniformVariable("Texture", 0);
+                textureVertexArray.vertexArray->renderInstanced(instanceCount);
+                textureVertexArray.texture->deactivate();
+            }
+        }
+        
         const Vec3f& BspModelRenderer::center() const {
             return m_bsp.models()[0]->center();
         }
@@ -137,8 +151,8 @@ namespace TrenchBroom {
             for (unsigned int i = 0; i < faces.size(); i++) {
                 Model::BspFace* face = faces[i];
                 const Vec3f::List& vertices = face->vertices();
-                for (unsigned int j = 0; j < vertices.size(); j++)
-                    bounds.mergeWith(transformation * vertices[j]);
+                if (!vertices.empty())
+                    mergeTransformedBounds(bounds, transformation, &vertices[0], vertices.size());
             }
             
             return bounds;
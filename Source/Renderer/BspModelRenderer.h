@@ -59,6 +59,7 @@ namespace TrenchBroom {
             ~BspModelRenderer();
             
             void render(ShaderProgram& shaderProgram);
+            void renderInstances(ShaderProgram& shaderProgram, unsigned int instanceCount);
             
             const Vec3f& center() const;
             const BBoxf& bounds() const;
@@ -154,6 +154,12 @@ namespace TrenchBroom {
                 return m_viewMatrix;
             }
             
+            inline const Mat4f& matrix() const {
+                if (!m_valid)
+                    validate();
+                return m_matrix;
+            }
+            
             const Mat4f billboardMatrix(bool fixUp = false) const;
             void frustumPlanes(Planef& top, Planef& right, Planef& bottom, Planef& left) const;
 
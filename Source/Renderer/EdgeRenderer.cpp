@@ -28,107 +28,115 @@
 #include "Renderer/VertexArray.h"
 #include "Renderer/Shader/ShaderManager.h"
 #include "Renderer/Shader/ShaderProgram.h"
+#include "Utility/Parallel.h"
+
+#include <cassert>
 
 namespace TrenchBroom {
     namespace Renderer {
-        unsigned int EdgeRenderer::vertexCount(const Model::BrushList& brushes, const Model::FaceList& faces) {
-            Model::BrushList::const_iterator brushIt, brushEnd;
-            Model::FaceList::const_iterator faceIt, faceEnd;
-            unsigned int vertexCount = 0;
-            
-            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
-                const Model::Brush& brush = **brushIt;
-                vertexCount += brush.edges().size();
-            }
-            
-            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
-                const Model::Face& face = **faceIt;
-                vertexCount += face.edges().size();
-            }
-            
-            return 2 * vertexCount;
-        }
-        
-        void EdgeRenderer::writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces) {
-            m_vertexArray = new VertexArray(vbo, GL_LINES, vertexCount(brushes, faces),
-                                            Attribute::position3f());
-
-            Model::BrushList::const_iterator brushIt, brushEnd;
-            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
-                const Model::Brush& brush = **brushIt;
-                const Model::EdgeList& edges = brush.edges();
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    m_vertexArray->addAttribute(edge.start->position);
-                    m_vertexArray->addAttribute(edge.end->position);
-                }
-            }
-            
-            Model::FaceList::const_iterator faceIt, faceEnd;
-            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
-                const Model::Face& face = **faceIt;
-                const Model::EdgeList& edges = face.edges();
+        class GenerateEdgeVerticesTask : public Utility::ParallelTask {
+        private:
+            const Model::BrushList& m_brushes;
+            const Model::FaceList& m_faces;
+            const std::vector<size_t>& m_offsets;
+            const Color* m_defaultColor;
+            Vec3f::List& m_vertices;
+            EdgeRenderer::ColoredVertexList& m_coloredVertices;
+        public:
+            GenerateEdgeVerticesTask(const Model::BrushList& brushes, const Model::FaceList& faces, const std::vector<size_t>& offsets, const Color* defaultColor, Vec3f::List& vertices, EdgeRenderer::ColoredVertexList& coloredVertices) :
+            m_brushes(brushes),
+            m_faces(faces),
+            m_offsets(offsets),
+            m_defaultColor(defaultColor),
+            m_vertices(vertices),
+            m_coloredVertices(coloredVertices) {}
+
+            void run(size_t index) {
+                // the brushes come first, followed by the faces
+                const Model::Brush& brush = index < m_brushes.size() ? *m_brushes[index] : *m_faces[index - m_brushes.size()]->brush();
+                const Model::EdgeList& edges = index < m_brushes.size() ? brush.edges() : m_faces[index - m_brushes.size()]->edges();
+
+                size_t offset = m_offsets[index];
                 Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    m_vertexArray->addAttribute(edge.start->position);
-                    m_vertexArray->addAttribute(edge.end->position);
+                if (m_defaultColor != NULL) {
+                    const Color& edgeColor = EdgeRenderer::edgeColor(brush, *m_defaultColor);
+                    for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
+                        const Model::Edge& edge = **edgeIt;
+                        m_coloredVertices[offset++] = EdgeRenderer::ColoredVertex(edge.start->position, edgeColor);
+                        m_coloredVertices[offset++] = EdgeRenderer::ColoredVertex(edge.end->position, edgeColor);
+                    }
+                } else {
+                    for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
+                        const Model::Edge& edge = **edgeIt;
+                        m_vertices[offset++] = edge.start->position;
+                        m_vertices[offset++] = edge.end->position;
+                    }
                 }
             }
+        };
+
+        const Color& EdgeRenderer::edgeColor(const Model::Brush& brush, const Color& defaultColor) {
+            const Model::Entity* entity = brush.entity();
+            const Model::EntityDefinition* definition = entity != NULL ? entity->definition() : NULL;
+            return (entity != NULL && !entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultColor;
         }
-        
-        void EdgeRenderer::writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor) {
-            m_vertexArray = new VertexArray(vbo, GL_LINES, vertexCount(brushes, faces),
-                                            Attribute::position3f(),
-                                            Attribute::color4f());
-
-            Model::BrushList::const_iterator brushIt, brushEnd;
-            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
-                const Model::Brush& brush = **brushIt;
-                const Model::Entity* entity = brush.entity();
-                const Model::EntityDefinition* definition = entity != NULL ? entity->definition() : NULL;
-                const Color& color = (entity != NULL && !entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultColor;
-                
-                const Model::EdgeList& edges = brush.edges();
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    m_vertexArray->addAttribute(edge.start->position);
-                    m_vertexArray->addAttribute(color);
-                    m_vertexArray->addAttribute(edge.end->position);
-                    m_vertexArray->addAttribute(color);
-                }
-            }
 
-            Model::FaceList::const_iterator faceIt, faceEnd;
-            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
-                const Model::Face& face = **faceIt;
-                const Model::Brush* brush = face.brush();
-                const Model::Entity* entity = brush->entity();
-                const Model::EntityDefinition* definition = entity != NULL ? entity->definition() : NULL;
-                const Color& color = (entity != NULL && !entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultColor;
-                
-                const Model::EdgeList& edges = face.edges();
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    m_vertexArray->addAttribute(edge.start->position);
-                    m_vertexArray->addAttribute(color);
-                    m_vertexArray->addAttribute(edge.end->position);
-                    m_vertexArray->addAttribute(color);
-                }
+        void EdgeRenderer::generateEdgeData(const Model::BrushList& brushes, const Model::FaceList& faces, const Color* defaultColor) {
+            std::vector<size_t> offsets(brushes.size() + faces.size());
+            size_t vertexCount = 0;
+            for (size_t i = 0; i < brushes.size(); i++) {
+                offsets[i] = vertexCount;
+                vertexCount += 2 * brushes[i]->edges().size();
+            }
+            for (size_t i = 0; i < faces.size(); i++) {
+                offsets[brushes.size() + i] = vertexCount;
+                vertexCount += 2 * faces[i]->edges().size();
             }
+
+            m_colored = defaultColor != NULL;
+            if (m_colored)
+                m_coloredVertices.resize(vertexCount);
+            else
+                m_vertices.resize(vertexCount);
+
+            GenerateEdgeVerticesTask task(brushes, faces, offsets, defaultColor, m_vertices, m_coloredVertices);
+            Utility::runParallel(task, offsets.size());
+        }
+
+        EdgeRenderer::EdgeRenderer(const Model::BrushList& brushes, const Model::FaceList& faces) :
+        m_vertexArray(NULL) {
+            generateEdgeData(brushes, faces, NULL);
+        }
+
+        EdgeRenderer::EdgeRenderer(const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor) :
+        m_vertexArray(NULL) {
+            generateEdgeData(brushes, faces, &defaultColor);
         }
 
         EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces) :
         m_vertexArray(NULL) {
-            writeEdgeData(vbo, brushes, faces);
+            generateEdgeData(brushes, faces, NULL);
+            upload(vbo);
         }
         
         EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor) :
         m_vertexArray(NULL) {
-            writeEdgeData(vbo, brushes, faces, defaultColor);
+            generateEdgeData(brushes, faces, &defaultColor);
+            upload(vbo);
+        }
+
+        EdgeRenderer::EdgeRenderer(Vbo& vbo, const Vec3f::List& vertices) :
+        m_vertexArray(NULL),
+        m_colored(false),
+        m_vertices(vertices) {
+            upload(vbo);
+        }
+
+        EdgeRenderer::EdgeRenderer(Vbo& vbo, const ColoredVertexList& vertices) :
+        m_vertexArray(NULL),
+        m_colored(true),
+        m_coloredVertices(vertices) {
+            upload(vbo);
         }
 
         EdgeRenderer::~EdgeRenderer() {
@@ -136,6 +144,25 @@ namespace TrenchBroom {
             m_vertexArray = NULL;
         }
 
+        void EdgeRenderer::upload(Vbo& vbo) {
+            assert(m_vertexArray == NULL);
+
+            if (m_colored) {
+                m_vertexArray = new VertexArray(vbo, GL_LINES, m_coloredVertices.size(),
+                                                Attribute::position3f(),
+                                                Attribute::color4f(),
+                                                0);
+                m_vertexArray->addVertices(m_coloredVertices);
+                ColoredVertexList().swap(m_coloredVertices);
+            } else {
+                m_vertexArray = new VertexArray(vbo, GL_LINES, m_vertices.size(),
+                                                Attribute::position3f(),
+                                                0);
+                m_vertexArray->addVertices(m_vertices);
+                Vec3f::List().swap(m_vertices);
+            }
+        }
+
 
         void EdgeRenderer::render(RenderContext& context) {
             assert(m_vertexArray != NULL);
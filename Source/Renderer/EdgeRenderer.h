@@ -23,6 +23,11 @@
 #include "Model/BrushTypes.h"
 #include "Model/FaceTypes.h"
 #include "Utility/Color.h"
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Renderer {
@@ -31,17 +36,55 @@ namespace TrenchBroom {
         class VertexArray;
         
         class EdgeRenderer {
+        public:
+            class ColoredVertex {
+            public:
+                Vec3f position;
+                Color color;
+
+                ColoredVertex() {}
+
+                ColoredVertex(const Vec3f& i_position, const Color& i_color) :
+                position(i_position),
+                color(i_color) {}
+            };
+
+            typedef std::vector<ColoredVertex> ColoredVertexList;
+
+            /**
+             * Returns the color of the edges of the given brush, which is the color of its entity's definition if it
+             * belongs to a brush entity, and the given default color otherwise.
+             */
+            static const Color& edgeColor(const Model::Brush& brush, const Color& defaultColor);
         protected:
             VertexArray* m_vertexArray;
-            
-            unsigned int vertexCount(const Model::BrushList& brushes, const Model::FaceList& faces);
-            void writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces);
-            void writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor);
+            bool m_colored;
+            Vec3f::List m_vertices;
+            ColoredVertexList m_coloredVertices;
+
+            void generateEdgeData(const Model::BrushList& brushes, const Model::FaceList& faces, const Color* defaultColor);
         public:
+            /**
+             * Generates the vertices of the edges of the given brushes and faces on the worker threads of the shared
+             * thread pool. They must be uploaded into a VBO before the edges can be rendered.
+             */
+            EdgeRenderer(const Model::BrushList& brushes, const Model::FaceList& faces);
+            EdgeRenderer(const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor);
             EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces);
             EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor);
+
+            /**
+             * Uploads the given vertices, which must form lines, into the given VBO, which must be mapped.
+             */
+            EdgeRenderer(Vbo& vbo, const Vec3f::List& vertices);
+            EdgeRenderer(Vbo& vbo, const ColoredVertexList& vertices);
             ~EdgeRenderer();
 
+            /**
+             * Copies the generated vertices into the given VBO, which must be mapped.
+             */
+            void upload(Vbo& vbo);
+
             void render(RenderContext& context);
             void render(RenderContext& context, const Color& color);
         };
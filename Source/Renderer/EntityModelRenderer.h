@@ -39,6 +39,12 @@ namespace TrenchBroom {
             virtual void render(ShaderProgram& shaderProgram, Transformation& transformation, const Model::Entity& entity);
             virtual void render(ShaderProgram& shaderProgram, Transformation& transformation, const Vec3f& position, const Quatf& rotation);
             virtual void render(ShaderProgram& shaderProgram) = 0;
+            
+            /**
+             * Renders the given number of instances of this model in a single draw call per texture. The instance
+             * transformations must already be bound to the given shader program.
+             */
+            virtual void renderInstances(ShaderProgram& shaderProgram, unsigned int instanceCount) = 0;
             virtual const Vec3f& center() const = 0;
             virtual const BBoxf& bounds() const = 0;
             virtual BBoxf boundsAfterTransformation(const Mat4f& transformation) const = 0;
@@ -20,6 +20,7 @@
 #include "EntityModelRendererManager.h"
 
 #include <GL/glew.h>
+#include "Controller/Command.h"
 #include "Model/Alias.h"
 #include "Model/Bsp.h"
 #include "Model/Entity.h"
@@ -29,92 +30,99 @@
 #include "Renderer/EntityModelRenderer.h"
 #include "Renderer/Palette.h"
 #include "Renderer/Vbo.h"
-#include "IO/FileManager.h"
 #include "Utility/Console.h"
-#include "Utility/Map.h"
 #include "Utility/Preferences.h"
+#include "View/AbstractApp.h"
 
 #include <cassert>
 
 namespace TrenchBroom {
     namespace Renderer {
-        const String EntityModelRendererManager::modelRendererKey(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths) {
-            StringStream key;
-            for (size_t i = 0; i < searchPaths.size(); i++)
-                key << searchPaths[i] << " ";
-            key << modelDefinition.name() << " " << modelDefinition.skinIndex() << " " << modelDefinition.frameIndex();
-            return Utility::toLower(key.str());
+        unsigned int EntityModelRendererManager::modelId(const Model::ModelDefinition& modelDefinition, unsigned int searchPathsId) {
+            assert(searchPathsId < m_modelIds.size());
+            
+            ModelIdMap& modelIds = m_modelIds[searchPathsId];
+            ModelIdMap::iterator it = modelIds.find(modelDefinition.key());
+            if (it != modelIds.end())
+                return it->second;
+            
+            const unsigned int modelId = static_cast<unsigned int>(m_models.size());
+            m_models.push_back(CachedModel());
+            modelIds[modelDefinition.key()] = modelId;
+            return modelId;
         }
 
-        EntityModelRenderer* EntityModelRendererManager::modelRenderer(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths) {
+        void EntityModelRendererManager::LoadNotification::execute() {
+            if (m_manager != NULL && m_manager->processLoadedModels()) {
+                Controller::Command command(Controller::Command::EntityModelsLoaded);
+                static_cast<AbstractApp*>(wxTheApp)->UpdateAllViews(NULL, &command);
+            }
+        }
+        
+        EntityModelRenderer* EntityModelRendererManager::modelRenderer(const Model::ModelDefinition& modelDefinition, unsigned int searchPathsId) {
             assert(m_palette != NULL);
-            IO::FileManager fileManager;
             
             if (!m_valid) {
                 clear();
                 m_valid = true;
             }
             
-            const String key = modelRendererKey(modelDefinition, searchPaths);
-            MismatchCache::iterator mismatchIt = m_mismatches.find(key);
-            if (mismatchIt != m_mismatches.end())
-                return NULL;
+            const unsigned int id = modelId(modelDefinition, searchPathsId);
+            CachedModel& model = m_models[id];
+            if (model.state != CachedModel::Unknown)
+                return model.renderer;
             
-            EntityModelRendererCache::iterator rendererIt = m_modelRenderers.find(key);
-            if (rendererIt != m_modelRenderers.end())
-                return rendererIt->second;
-
+            model.state = CachedModel::Pending;
             String modelName = Utility::toLower(modelDefinition.name().substr(1));
-            String ext = Utility::toLower(fileManager.pathExtension(modelName));
-            if (ext == "mdl") {
-                unsigned int skinIndex = modelDefinition.skinIndex();
-                unsigned int frameIndex = modelDefinition.frameIndex();
-
-                Model::AliasManager& aliasManager = *Model::AliasManager::sharedManager;
-                const Model::Alias* alias = aliasManager.alias(modelName, searchPaths, m_console);
-
-                if (alias != NULL && skinIndex < alias->skins().size() && frameIndex < alias->frames().size()) {
-                    Renderer::EntityModelRenderer* renderer = new AliasModelRenderer(*alias, frameIndex, skinIndex, *m_vbo, *m_palette);
-                    m_modelRenderers[key] = renderer;
-                    return renderer;
-                }
-            } else if (ext == "bsp") {
-                Model::BspManager& bspManager = *Model::BspManager::sharedManager;
-                const Model::Bsp* bsp = bspManager.bsp(modelName, searchPaths, m_console);
-                if (bsp != NULL) {
-                    Renderer::EntityModelRenderer* renderer = new BspModelRenderer(*bsp, *m_vbo, *m_palette);
-                    m_modelRenderers[key] = renderer;
-                    return renderer;
-                }
-            } else {
-                m_console.warn("Unknown model type '%s'", ext.c_str());
-            }
-
-            m_mismatches.insert(key);
+            m_loader->request(id, modelName, m_searchPaths[searchPathsId], modelDefinition.frameIndex(), modelDefinition.skinIndex());
             return NULL;
         }
 
         EntityModelRendererManager::EntityModelRendererManager(Utility::Console& console) :
         m_palette(NULL),
         m_console(console),
-        m_valid(true) {
+        m_valid(true),
+        m_notification(new LoadNotification(this)),
+        m_loader(NULL) {
             m_vbo = new Renderer::Vbo(GL_ARRAY_BUFFER, 0xFFFF);
+            
+            m_loader = new Model::EntityModelLoader(m_notification);
+            if (m_loader->Create() != wxTHREAD_NO_ERROR || m_loader->Run() != wxTHREAD_NO_ERROR)
+                m_console.error("Unable to start entity model loader thread");
         }
 
         EntityModelRendererManager::~EntityModelRendererManager() {
+            m_notification->detach();
+            m_loader->stop();
+            m_loader->Wait();
+            delete m_loader;
+            m_loader = NULL;
+            
             clear();
             delete m_vbo;
             m_vbo = NULL;
         }
 
-        EntityModelRenderer* EntityModelRendererManager::modelRenderer(const Model::PointEntityDefinition& entityDefinition, const StringList& searchPaths) {
+        unsigned int EntityModelRendererManager::searchPathsId(const StringList& searchPaths) {
+            SearchPathsIdMap::iterator it = m_searchPathsIds.find(searchPaths);
+            if (it != m_searchPathsIds.end())
+                return it->second;
+            
+            const unsigned int searchPathsId = static_cast<unsigned int>(m_searchPaths.size());
+            m_searchPaths.push_back(searchPaths);
+            m_modelIds.push_back(ModelIdMap());
+            m_searchPathsIds[searchPaths] = searchPathsId;
+            return searchPathsId;
+        }
+
+        EntityModelRenderer* EntityModelRendererManager::modelRenderer(const Model::PointEntityDefinition& entityDefinition, unsigned int searchPathsId) {
             const Model::ModelDefinition* modelDefinition = entityDefinition.model();
             if (modelDefinition == NULL)
                 return NULL;
-            return modelRenderer(*modelDefinition, searchPaths);
+            return modelRenderer(*modelDefinition, searchPathsId);
         }
 
-        EntityModelRenderer* EntityModelRendererManager::modelRenderer(const Model::Entity& entity, const StringList& searchPaths) {
+        EntityModelRenderer* EntityModelRendererManager::modelRenderer(const Model::Entity& entity, unsigned int searchPathsId) {
             const Model::EntityDefinition* definition = entity.definition();
             if (definition == NULL || definition->type() != Model::EntityDefinition::PointEntity)
                 return NULL;
@@ -122,16 +130,65 @@ namespace TrenchBroom {
             const Model::ModelDefinition* modelDefinition = pointDefinition->model(entity.properties());
             if (modelDefinition == NULL)
                 return NULL;
-            return modelRenderer(*modelDefinition, searchPaths);
+            return modelRenderer(*modelDefinition, searchPathsId);
         }
 
         void EntityModelRendererManager::clear() {
-            clearMismatches();
-            Utility::deleteAll(m_modelRenderers);
+            // pending models stay pending, their renderers will be created when they have been loaded
+            CachedModelList::iterator it, end;
+            for (it = m_models.begin(), end = m_models.end(); it != end; ++it) {
+                CachedModel& model = *it;
+                if (model.state != CachedModel::Pending) {
+                    delete model.renderer;
+                    model.renderer = NULL;
+                    model.state = CachedModel::Unknown;
+                }
+            }
         }
         
         void EntityModelRendererManager::clearMismatches() {
-            m_mismatches.clear();
+            CachedModelList::iterator it, end;
+            for (it = m_models.begin(), end = m_models.end(); it != end; ++it) {
+                CachedModel& model = *it;
+                if (model.state == CachedModel::Mismatch)
+                    model.state = CachedModel::Unknown;
+            }
+        }
+
+        bool EntityModelRendererManager::processLoadedModels() {
+            Model::EntityModelLoader::ResultList results;
+            m_loader->takeResults(results);
+            if (results.empty())
+                return false;
+            
+            Model::EntityModelLoader::ResultList::const_iterator it, end;
+            for (it = results.begin(), end = results.end(); it != end; ++it) {
+                const Model::EntityModelLoader::Result& result = *it;
+                assert(result.key < m_models.size());
+                
+                CachedModel& model = m_models[result.key];
+                assert(model.state == CachedModel::Pending);
+                
+                if (result.alias != NULL) {
+                    const Model::Alias& alias = *result.alias;
+                    if (result.skinIndex < alias.skins().size() && result.frameIndex < alias.frameCount()) {
+                        model.renderer = new AliasModelRenderer(alias, result.frameIndex, result.skinIndex, *m_vbo, *m_palette);
+                        model.state = CachedModel::Loaded;
+                        continue;
+                    }
+                    m_console.warn("Invalid skin or frame index for model '%s'", result.modelName.c_str());
+                } else if (result.bsp != NULL) {
+                    model.renderer = new BspModelRenderer(*result.bsp, *m_vbo, *m_palette);
+                    model.state = CachedModel::Loaded;
+                    continue;
+                } else {
+                    m_console.warn("Unable to load model '%s'", result.modelName.c_str());
+                }
+                
+                model.state = CachedModel::Mismatch;
+            }
+            
+            return true;
         }
 
         void EntityModelRendererManager::setPalette(const Palette& palette) {
@@ -20,11 +20,18 @@
 #ifndef TrenchBroom_EntityModelRendererManager_h
 #define TrenchBroom_EntityModelRendererManager_h
 
+#include "Model/EntityModelLoader.h"
+#include "Utility/ExecutableEvent.h"
 #include "Utility/String.h"
 
 #include <map>
 #include <vector>
-#include <set>
+
+#if defined _WIN32
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif
 
 namespace TrenchBroom {
     namespace Model {
@@ -42,21 +49,67 @@ namespace TrenchBroom {
         class Palette;
         class Vbo;
         
+        /**
+         * Creates and caches the renderers for the entity models. The models are loaded asynchronously, and until a
+         * model has been loaded, no renderer is returned for it. Once loaded models are available, all documents
+         * are notified with an EntityModelsLoaded command so that they can request the renderers again.
+         *
+         * Sets of search paths are identified by IDs, and every combination of search paths and model key is
+         * interned into a model ID, so that looking up a renderer only takes a hash lookup of the model key.
+         */
         class EntityModelRendererManager {
         private:
-            typedef std::map<String, EntityModelRenderer*> EntityModelRendererCache;
-            typedef std::set<String> MismatchCache;
+            class CachedModel {
+            public:
+                typedef enum {
+                    Unknown,
+                    Pending,
+                    Loaded,
+                    Mismatch
+                } State;
+                
+                EntityModelRenderer* renderer;
+                State state;
+                
+                CachedModel() :
+                renderer(NULL),
+                state(Unknown) {}
+            };
+            
+            typedef std::vector<CachedModel> CachedModelList;
+            typedef std::map<StringList, unsigned int> SearchPathsIdMap;
+            typedef std::tr1::unordered_map<String, unsigned int> ModelIdMap;
+            typedef std::vector<ModelIdMap> ModelIdMapList;
+            
+            class LoadNotification : public ExecutableEvent::Executable {
+            private:
+                EntityModelRendererManager* m_manager;
+            protected:
+                void execute();
+            public:
+                LoadNotification(EntityModelRendererManager* manager) :
+                m_manager(manager) {}
+                
+                inline void detach() {
+                    m_manager = NULL;
+                }
+            };
             
             const Palette* m_palette;
             Utility::Console& m_console;
             
             Vbo* m_vbo;
-            EntityModelRendererCache m_modelRenderers;
-            MismatchCache m_mismatches;
+            SearchPathsIdMap m_searchPathsIds;
+            std::vector<StringList> m_searchPaths;
+            ModelIdMapList m_modelIds;
+            CachedModelList m_models;
             bool m_valid;
+            
+            std::tr1::shared_ptr<LoadNotification> m_notification;
+            Model::EntityModelLoader* m_loader;
 
-            const String modelRendererKey(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths);
-            EntityModelRenderer* modelRenderer(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths);
+            unsigned int modelId(const Model::ModelDefinition& modelDefinition, unsigned int searchPathsId);
+            EntityModelRenderer* modelRenderer(const Model::ModelDefinition& modelDefinition, unsigned int searchPathsId);
 
             // prevent copying
             EntityModelRendererManager(const EntityModelRendererManager& other);
@@ -65,11 +118,22 @@ namespace TrenchBroom {
             EntityModelRendererManager(Utility::Console& console);
             ~EntityModelRendererManager();
             
-            EntityModelRenderer* modelRenderer(const Model::PointEntityDefinition& entityDefinition, const StringList& searchPaths);
-            EntityModelRenderer* modelRenderer(const Model::Entity& entity, const StringList& searchPaths);
+            /**
+             * Returns the ID of the given search paths. The ID stays valid for the lifetime of this manager.
+             */
+            unsigned int searchPathsId(const StringList& searchPaths);
+            
+            EntityModelRenderer* modelRenderer(const Model::PointEntityDefinition& entityDefinition, unsigned int searchPathsId);
+            EntityModelRenderer* modelRenderer(const Model::Entity& entity, unsigned int searchPathsId);
             void clear();
             void clearMismatches();
             
+            /**
+             * Creates the renderers for the models which have been loaded since the last call. Returns true if any
+             * renderers were created.
+             */
+            bool processLoadedModels();
+            
             void setPalette(const Palette& palette);
             
             void activate();
@@ -22,10 +22,12 @@
 #include "Model/MapDocument.h"
 #include "Renderer/EntityModelRenderer.h"
 #include "Renderer/EntityModelRendererManager.h"
+#include "Renderer/PointHandleRenderer.h"
 #include "Renderer/SharedResources.h"
 #include "Renderer/Shader/ShaderManager.h"
 #include "Renderer/Shader/ShaderProgram.h"
 #include "Renderer/Text/FontManager.h"
+#include "Utility/List.h"
 #include "Utility/Preferences.h"
 
 #include <cassert>
@@ -49,82 +51,149 @@ namespace TrenchBroom {
             return Text::Alignment::Bottom;
         }
 
+        EntityRenderer::EntityModelInstances::EntityModelInstances(EntityModelRenderer& renderer, const Vec4f::List& positions, const Vec4f::List& rotations) :
+        m_renderer(renderer),
+        m_instanceCount(static_cast<unsigned int>(positions.size())),
+        m_positions("position", positions),
+        m_rotations("rotation", rotations) {
+            assert(positions.size() == rotations.size());
+        }
+        
+        void EntityRenderer::EntityModelInstances::render(ShaderProgram& shaderProgram) {
+            // texture unit 0 is used by the model's skin
+            glActiveTexture(GL_TEXTURE1);
+            m_positions.setup();
+            shaderProgram.setUniformVariable(m_positions.name(), 1);
+            shaderProgram.setUniformVariable(m_positions.textureSizeName(), m_positions.textureSize());
+            
+            glActiveTexture(GL_TEXTURE2);
+            m_rotations.setup();
+            shaderProgram.setUniformVariable(m_rotations.name(), 2);
+            shaderProgram.setUniformVariable(m_rotations.textureSizeName(), m_rotations.textureSize());
+            
+            m_renderer.renderInstances(shaderProgram, m_instanceCount);
+            
+            glActiveTexture(GL_TEXTURE2);
+            m_rotations.cleanup();
+            glActiveTexture(GL_TEXTURE1);
+            m_positions.cleanup();
+            glActiveTexture(GL_TEXTURE0);
+        }
+        
         bool EntityRenderer::EntityClassnameFilter::stringVisible(RenderContext& context, const EntityKey& entity) const {
             return context.filter().entityVisible(*entity);
         }
 
-        void EntityRenderer::writeColoredBounds(RenderContext& context, const Model::EntityList& entities) {
-            if (entities.empty())
-                return;
-
-            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
-            Vec3f::List vertices(24);
-
-            for (unsigned int i = 0; i < entities.size(); i++) {
-                Model::Entity* entity = entities[i];
-                const BBoxf& bounds = entity->bounds();
-                const Model::EntityDefinition* definition = entity->definition();
-                Color entityColor;
-                if (definition != NULL) {
-                    entityColor = definition->color();
-                    entityColor[3] = prefs.getColor(Preferences::EntityBoundsColor).a();
-                } else {
-                    entityColor = prefs.getColor(Preferences::EntityBoundsColor);
-                }
-
-                bounds.vertices(vertices);
-                for (unsigned int j = 0; j < vertices.size(); j++) {
-                    m_boundsVertexArray->addAttribute(vertices[j]);
-                    m_boundsVertexArray->addAttribute(entityColor);
-                }
+        static const size_t BoundsSlotVertexCount = 2 * 12;
+        
+        void EntityRenderer::allocateBoundsSlot(Model::Entity& entity) {
+            size_t slotIndex;
+            if (!m_freeSlots.empty()) {
+                slotIndex = m_freeSlots.back();
+                m_freeSlots.pop_back();
+                m_slots[slotIndex] = EntityBoundsSlot();
+            } else {
+                slotIndex = m_slots.size();
+                m_slots.push_back(EntityBoundsSlot());
             }
+            m_boundsSlots[&entity] = slotIndex;
         }
-
-        void EntityRenderer::writeBounds(RenderContext& context, const Model::EntityList& entities) {
-            if (entities.empty())
+        
+        void EntityRenderer::freeBoundsSlot(Model::Entity& entity) {
+            EntityBoundsSlotMap::iterator it = m_boundsSlots.find(&entity);
+            if (it == m_boundsSlots.end())
                 return;
-
-            Vec3f::List vertices(24);
-            for (unsigned int i = 0; i < entities.size(); i++) {
-                Model::Entity* entity = entities[i];
-                const BBoxf& bounds = entity->bounds();
-                bounds.vertices(vertices);
-
-                for (unsigned int j = 0; j < vertices.size(); j++)
-                    m_boundsVertexArray->addAttribute(vertices[j]);
+            m_freeSlots.push_back(it->second);
+            m_boundsSlots.erase(it);
+        }
+        
+        Color EntityRenderer::boundsColor(const Model::Entity& entity) const {
+            const Model::EntityDefinition* definition = entity.definition();
+            if (definition == NULL)
+                return m_defaultBoundsColor;
+            
+            Color color = definition->color();
+            color[3] = m_defaultBoundsColor.a();
+            return color;
+        }
+        
+        void EntityRenderer::writeBounds(size_t slotIndex, const BBoxf& bounds, const Color& color) {
+            Vec3f::List vertices(BoundsSlotVertexCount);
+            bounds.vertices(vertices);
+            
+            m_boundsVertexArray->seek(slotIndex * BoundsSlotVertexCount);
+            for (unsigned int i = 0; i < vertices.size(); i++) {
+                m_boundsVertexArray->addAttribute(vertices[i]);
+                m_boundsVertexArray->addAttribute(color);
             }
         }
 
         void EntityRenderer::validateBounds(RenderContext& context) {
-            delete m_boundsVertexArray;
-            m_boundsVertexArray = NULL;
-
-            Model::EntityList entities;
-            Model::EntitySet::iterator entityIt, entityEnd;
-            for (entityIt = m_entities.begin(), entityEnd = m_entities.end(); entityIt != entityEnd; ++entityIt) {
-                Model::Entity* entity = *entityIt;
-                if (context.filter().entityVisible(*entity))
-                    entities.push_back(entity);
+            // the instances depend on the positions and the visibility of the entities
+            m_modelInstancesValid = false;
+            
+            m_visibleSlotIndices.clear();
+            m_visibleSlotCounts.clear();
+            
+            bool rewriteAll = false;
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const Color& defaultBoundsColor = prefs.getColor(Preferences::EntityBoundsColor);
+            if (defaultBoundsColor != m_defaultBoundsColor) {
+                m_defaultBoundsColor = defaultBoundsColor;
+                rewriteAll = true;
             }
-
-            if (entities.empty())
-                return;
-
-            SetVboState mapVbo(m_boundsVbo, Vbo::VboMapped);
-
-            if (m_overrideBoundsColor) {
-                unsigned int vertexCount = 2 * 4 * 6 * static_cast<unsigned int>(entities.size());
-                m_boundsVertexArray = new VertexArray(m_boundsVbo, GL_LINES, vertexCount,
-                                                      Attribute::position3f());
-                writeBounds(context, entities);
-            } else {
-                unsigned int vertexCount = 2 * 4 * 6 * static_cast<unsigned int>(entities.size());
-                m_boundsVertexArray = new VertexArray(m_boundsVbo, GL_LINES, vertexCount,
+            
+            const size_t requiredCapacity = m_slots.size() * BoundsSlotVertexCount;
+            if (m_boundsVertexArray == NULL || m_boundsVertexArray->vertexCapacity() < requiredCapacity) {
+                size_t capacity = m_boundsVertexArray != NULL ? 2 * m_boundsVertexArray->vertexCapacity() : 64 * BoundsSlotVertexCount;
+                while (capacity < requiredCapacity)
+                    capacity *= 2;
+                
+                delete m_boundsVertexArray;
+                m_boundsVertexArray = new VertexArray(m_boundsVbo, GL_LINES, capacity,
                                                       Attribute::position3f(),
                                                       Attribute::color4f());
-                writeColoredBounds(context, entities);
+                rewriteAll = true;
             }
-
+            
+            // the slots of hidden entities are not rewritten now, so they must be written once they become visible
+            if (rewriteAll) {
+                for (size_t i = 0; i < m_slots.size(); i++)
+                    m_slots[i].written = false;
+            }
+            
+            typedef std::vector<EntityBoundsSlotMap::const_iterator> SlotUpdateList;
+            SlotUpdateList updates;
+            
+            EntityBoundsSlotMap::const_iterator it, end;
+            for (it = m_boundsSlots.begin(), end = m_boundsSlots.end(); it != end; ++it) {
+                const Model::Entity& entity = *it->first;
+                if (!context.filter().entityVisible(entity))
+                    continue;
+                
+                const size_t slotIndex = it->second;
+                const EntityBoundsSlot& slot = m_slots[slotIndex];
+                if (!slot.written || !(slot.bounds == entity.bounds()) || slot.color != boundsColor(entity))
+                    updates.push_back(it);
+                
+                m_visibleSlotIndices.push_back(static_cast<GLint>(slotIndex * BoundsSlotVertexCount));
+                m_visibleSlotCounts.push_back(static_cast<GLsizei>(BoundsSlotVertexCount));
+            }
+            
+            if (!updates.empty()) {
+                SetVboState mapVbo(m_boundsVbo, Vbo::VboMapped);
+                for (size_t i = 0; i < updates.size(); i++) {
+                    const Model::Entity& entity = *updates[i]->first;
+                    const size_t slotIndex = updates[i]->second;
+                    EntityBoundsSlot& slot = m_slots[slotIndex];
+                    
+                    slot.bounds = entity.bounds();
+                    slot.color = boundsColor(entity);
+                    slot.written = true;
+                    writeBounds(slotIndex, slot.bounds, slot.color);
+                }
+            }
+            
             m_boundsValid = true;
         }
 
@@ -137,17 +206,52 @@ namespace TrenchBroom {
                 Model::Entity* entity = *entityIt;
                 const String* classname = entity->classname();
                 if (classname != NULL) {
-                    EntityModelRenderer* renderer = modelRendererManager.modelRenderer(*entity, m_document.searchPaths());
+                    EntityModelRenderer* renderer = modelRendererManager.modelRenderer(*entity, m_document.searchPathsId());
                     if (renderer != NULL)
                         m_modelRenderers[entity] = CachedEntityModelRenderer(renderer, *classname);
                 }
             }
 
             m_modelRendererCacheValid = true;
+            m_modelInstancesValid = false;
+        }
+
+        void EntityRenderer::validateModelInstances(RenderContext& context) {
+            Utility::deleteAll(m_modelInstances);
+            
+            typedef std::map<EntityModelRenderer*, Model::EntityList> EntityModelRendererMap;
+            EntityModelRendererMap entitiesByRenderer;
+            
+            EntityModelRenderers::iterator it, end;
+            for (it = m_modelRenderers.begin(), end = m_modelRenderers.end(); it != end; ++it) {
+                Model::Entity* entity = it->first;
+                if (context.filter().entityVisible(*entity))
+                    entitiesByRenderer[it->second.renderer].push_back(entity);
+            }
+            
+            m_modelInstances.reserve(entitiesByRenderer.size());
+            EntityModelRendererMap::iterator rendererIt, rendererEnd;
+            for (rendererIt = entitiesByRenderer.begin(), rendererEnd = entitiesByRenderer.end(); rendererIt != rendererEnd; ++rendererIt) {
+                EntityModelRenderer* renderer = rendererIt->first;
+                const Model::EntityList& entities = rendererIt->second;
+                
+                Vec4f::List positions(entities.size());
+                Vec4f::List rotations(entities.size());
+                for (size_t i = 0; i < entities.size(); i++) {
+                    const Model::Entity& entity = *entities[i];
+                    const Quatf rotation = entity.rotation();
+                    positions[i] = Vec4f(entity.origin(), 1.0f);
+                    rotations[i] = Vec4f(rotation.v, rotation.s);
+                }
+                
+                m_modelInstances.push_back(new EntityModelInstances(*renderer, positions, rotations));
+            }
+            
+            m_modelInstancesValid = true;
         }
 
         void EntityRenderer::renderBounds(RenderContext& context) {
-            if (m_boundsVertexArray == NULL)
+            if (m_boundsVertexArray == NULL || m_visibleSlotIndices.empty())
                 return;
 
             ShaderManager& shaderManager = m_document.sharedResources().shaderManager();
@@ -159,17 +263,17 @@ namespace TrenchBroom {
                     if (m_renderOccludedBounds) {
                         glDisable(GL_DEPTH_TEST);
                         edgeProgram.setUniformVariable("Color", m_occludedBoundsColor);
-                        m_boundsVertexArray->render();
+                        m_boundsVertexArray->render(m_visibleSlotIndices, m_visibleSlotCounts);
                         glEnable(GL_DEPTH_TEST);
                     }
                     edgeProgram.setUniformVariable("Color", m_boundsColor);
-                    m_boundsVertexArray->render();
+                    m_boundsVertexArray->render(m_visibleSlotIndices, m_visibleSlotCounts);
                     edgeProgram.deactivate();
                 }
             } else {
                 ShaderProgram& coloredEdgeProgram = shaderManager.shaderProgram(Shaders::ColoredEdgeShader);
                 if (coloredEdgeProgram.activate()) {
-                    m_boundsVertexArray->render();
+                    m_boundsVertexArray->render(m_visibleSlotIndices, m_visibleSlotCounts);
                     coloredEdgeProgram.deactivate();
                 }
             }
@@ -181,8 +285,8 @@ namespace TrenchBroom {
                 return;
 
             ShaderManager& shaderManager = m_document.sharedResources().shaderManager();
-            ShaderProgram& textProgram = shaderManager.shaderProgram(Shaders::TextShader);
-            ShaderProgram& textBackgroundProgram = shaderManager.shaderProgram(Shaders::TextBackgroundShader);
+            ShaderProgram& textProgram = shaderManager.shaderProgram(Shaders::TextLabelShader);
+            ShaderProgram& textBackgroundProgram = shaderManager.shaderProgram(Shaders::TextLabelBackgroundShader);
 
             EntityClassnameFilter classnameFilter;
             if (m_renderOccludedClassnames) {
@@ -202,6 +306,11 @@ namespace TrenchBroom {
         void EntityRenderer::renderModels(RenderContext& context) {
             if (m_modelRenderers.empty())
                 return;
+            
+            if (PointHandleRenderer::instancingSupported()) {
+                renderModelInstances(context);
+                return;
+            }
 
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
             EntityModelRendererManager& modelRendererManager = m_document.sharedResources().modelRendererManager();
@@ -230,12 +339,43 @@ namespace TrenchBroom {
             }
         }
 
+        void EntityRenderer::renderModelInstances(RenderContext& context) {
+            if (!m_modelInstancesValid)
+                validateModelInstances(context);
+            if (m_modelInstances.empty())
+                return;
+            
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            EntityModelRendererManager& modelRendererManager = m_document.sharedResources().modelRendererManager();
+            
+            ShaderManager& shaderManager = m_document.sharedResources().shaderManager();
+            ShaderProgram& entityModelProgram = shaderManager.shaderProgram(Shaders::InstancedEntityModelShader);
+            
+            if (entityModelProgram.activate()) {
+                modelRendererManager.activate();
+                entityModelProgram.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
+                entityModelProgram.setUniformVariable("ApplyTinting", m_applyTinting);
+                entityModelProgram.setUniformVariable("TintColor", m_tintColor);
+                entityModelProgram.setUniformVariable("GrayScale", m_grayscale);
+                
+                EntityModelInstancesList::iterator it, end;
+                for (it = m_modelInstances.begin(), end = m_modelInstances.end(); it != end; ++it) {
+                    EntityModelInstances& instances = **it;
+                    instances.render(entityModelProgram);
+                }
+                
+                modelRendererManager.deactivate();
+                entityModelProgram.deactivate();
+            }
+        }
+
         EntityRenderer::EntityRenderer(Vbo& boundsVbo, Model::MapDocument& document) :
         m_boundsVbo(boundsVbo),
         m_document(document),
         m_boundsVertexArray(NULL),
         m_boundsValid(true),
         m_modelRendererCacheValid(true),
+        m_modelInstancesValid(false),
         m_classnameRenderer(NULL),
         m_classnameColor(1.0f, 1.0f, 1.0f, 1.0f),
         m_classnameBackgroundColor(0.0f, 0.0f, 0.0f, 0.6f),
@@ -258,6 +398,7 @@ namespace TrenchBroom {
         }
 
         EntityRenderer::~EntityRenderer() {
+            Utility::deleteAll(m_modelInstances);
             delete m_boundsVertexArray;
             m_boundsVertexArray = NULL;
             delete m_classnameRenderer;
@@ -278,7 +419,7 @@ namespace TrenchBroom {
             if (classname == NULL)
                 classname = &Model::Entity::NoClassnameValue;
             if (classname != NULL) {
-                EntityModelRenderer* renderer = modelRendererManager.modelRenderer(entity, m_document.searchPaths());
+                EntityModelRenderer* renderer = modelRendererManager.modelRenderer(entity, m_document.searchPathsId());
                 if (renderer != NULL)
                     m_modelRenderers[&entity] = CachedEntityModelRenderer(renderer, *classname);
 
@@ -286,7 +427,7 @@ namespace TrenchBroom {
             }
 
 
-            m_entities.insert(&entity);
+            allocateBoundsSlot(entity);
             m_boundsValid = false;
         }
 
@@ -298,24 +439,28 @@ namespace TrenchBroom {
 
             for (unsigned int i = 0; i < entities.size(); i++) {
                 Model::Entity* entity = entities[i];
+                if (!m_entities.insert(entity).second)
+                    continue;
+
                 const String* classname = entity->classname();
                 if (classname == NULL)
                     classname = &Model::Entity::NoClassnameValue;
                 if (classname != NULL) {
-                    EntityModelRenderer* renderer = modelRendererManager.modelRenderer(*entity, m_document.searchPaths());
+                    EntityModelRenderer* renderer = modelRendererManager.modelRenderer(*entity, m_document.searchPathsId());
                     if (renderer != NULL)
                         m_modelRenderers[entity] = CachedEntityModelRenderer(renderer, *classname);
 
                     m_classnameRenderer->addString(entity, *classname, Text::TextAnchor::Ptr(new EntityClassnameAnchor(*entity, renderer)));
                 }
+                allocateBoundsSlot(*entity);
             }
 
-            m_entities.insert(entities.begin(), entities.end());
             m_boundsValid = false;
         }
 
         void EntityRenderer::invalidateBounds() {
             m_boundsValid = false;
+            m_classnameRenderer->invalidateAnchors();
         }
 
         void EntityRenderer::invalidateModels() {
@@ -324,16 +469,24 @@ namespace TrenchBroom {
 
         void EntityRenderer::clear() {
             m_entities.clear();
+            m_boundsSlots.clear();
+            m_slots.clear();
+            m_freeSlots.clear();
+            m_visibleSlotIndices.clear();
+            m_visibleSlotCounts.clear();
             m_boundsValid = false;
             m_modelRenderers.clear();
             m_modelRendererCacheValid = true;
+            Utility::deleteAll(m_modelInstances);
+            m_modelInstancesValid = false;
             m_classnameRenderer->clear();
         }
 
         void EntityRenderer::removeEntity(Model::Entity& entity) {
             m_modelRenderers.erase(&entity);
             m_classnameRenderer->removeString(&entity);
-            m_entities.erase(&entity);
+            if (m_entities.erase(&entity) > 0)
+                freeBoundsSlot(entity);
             m_boundsValid = false;
         }
 
@@ -345,7 +498,8 @@ namespace TrenchBroom {
                 Model::Entity* entity = entities[i];
                 m_modelRenderers.erase(entity);
                 m_classnameRenderer->removeString(entity);
-                m_entities.erase(entity);
+                if (m_entities.erase(entity) > 0)
+                    freeBoundsSlot(*entity);
             }
             m_boundsValid = false;
         }
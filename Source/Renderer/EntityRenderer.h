@@ -21,15 +21,18 @@
 #define __TrenchBroom__EntityRenderer__
 
 #include "Model/EntityTypes.h"
+#include "Renderer/InstancedVertexArray.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/Shader/Shader.h"
 #include "Renderer/Text/TextRenderer.h"
+#include "Renderer/VertexArray.h"
 #include "Utility/String.h"
 
 #include "Utility/Color.h"
 
 #include <map>
 #include <set>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Model {
@@ -40,7 +43,6 @@ namespace TrenchBroom {
     namespace Renderer {
         class EntityModelRenderer;
         class Vbo;
-        class VertexArray;
         
         class EntityRenderer {
         private:
@@ -67,8 +69,41 @@ namespace TrenchBroom {
                 EntityClassnameAnchor(Model::Entity& entity, Renderer::EntityModelRenderer* renderer);
             };
             
+            /**
+             * All visible instances of a model, which are rendered with a single instanced draw call. The instance
+             * positions and rotations are stored in float textures.
+             */
+            class EntityModelInstances {
+            private:
+                EntityModelRenderer& m_renderer;
+                unsigned int m_instanceCount;
+                InstanceAttributesVec4f m_positions;
+                InstanceAttributesVec4f m_rotations;
+            public:
+                EntityModelInstances(EntityModelRenderer& renderer, const Vec4f::List& positions, const Vec4f::List& rotations);
+                
+                void render(ShaderProgram& shaderProgram);
+            };
+            
+            /**
+             * Every entity owns a fixed slot of 24 vertices in the bounds vertex array. A slot is only rewritten
+             * when the bounds or the color of its entity have changed since it was last written.
+             */
+            class EntityBoundsSlot {
+            public:
+                BBoxf bounds;
+                Color color;
+                bool written;
+                
+                EntityBoundsSlot() : written(false) {}
+            };
+            
             typedef Model::Entity* EntityKey;
             typedef std::map<EntityKey, CachedEntityModelRenderer> EntityModelRenderers;
+            typedef std::map<EntityKey, size_t> EntityBoundsSlotMap;
+            typedef std::vector<EntityBoundsSlot> EntityBoundsSlotList;
+            typedef std::vector<size_t> FreeSlotList;
+            typedef std::vector<EntityModelInstances*> EntityModelInstancesList;
             typedef Text::TextRenderer<EntityKey> EntityClassnameRenderer;
             
             class EntityClassnameFilter : public EntityClassnameRenderer::TextRendererFilter {
@@ -82,8 +117,16 @@ namespace TrenchBroom {
             Model::EntitySet m_entities;
             VertexArray* m_boundsVertexArray;
             bool m_boundsValid;
+            EntityBoundsSlotMap m_boundsSlots;
+            EntityBoundsSlotList m_slots;
+            FreeSlotList m_freeSlots;
+            VertexArray::IndexArray m_visibleSlotIndices;
+            VertexArray::CountArray m_visibleSlotCounts;
+            Color m_defaultBoundsColor;
             EntityModelRenderers m_modelRenderers;
             bool m_modelRendererCacheValid;
+            EntityModelInstancesList m_modelInstances;
+            bool m_modelInstancesValid;
             EntityClassnameRenderer* m_classnameRenderer;
             
             Color m_classnameColor;
@@ -99,14 +142,18 @@ namespace TrenchBroom {
             Color m_tintColor;
             bool m_grayscale;
             
-            void writeColoredBounds(RenderContext& context, const Model::EntityList& entities);
-            void writeBounds(RenderContext& context, const Model::EntityList& entities);
+            void allocateBoundsSlot(Model::Entity& entity);
+            void freeBoundsSlot(Model::Entity& entity);
+            Color boundsColor(const Model::Entity& entity) const;
+            void writeBounds(size_t slotIndex, const BBoxf& bounds, const Color& color);
             void validateBounds(RenderContext& context);
             void validateModels(RenderContext& context);
+            void validateModelInstances(RenderContext& context);
             
             void renderBounds(RenderContext& context);
             void renderClassnames(RenderContext& context);
             void renderModels(RenderContext& context);
+            void renderModelInstances(RenderContext& context);
             void renderFigures(RenderContext& context);
 
             // prevent copying
@@ -27,20 +27,61 @@
 #include "Renderer/TextureRendererManager.h"
 #include "Renderer/VertexArray.h"
 #include "Utility/Grid.h"
+#include "Utility/Parallel.h"
 #include "Utility/Preferences.h"
 #include "Utility/VecMath.h"
 
+#include <algorithm>
+#include <cassert>
+
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Renderer {
         String FaceRenderer::AlphaBlendedTextures[] = {"clip", "hint", /*"skip",*/ "hintskip", "trigger"};
 
-        void FaceRenderer::writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter) {
+        class FaceVertexSlot {
+        public:
+            Model::Face* face;
+            size_t batchIndex;
+            size_t offset;
+
+            FaceVertexSlot(Model::Face* i_face, size_t i_batchIndex, size_t i_offset) :
+            face(i_face),
+            batchIndex(i_batchIndex),
+            offset(i_offset) {}
+        };
+
+        typedef std::vector<FaceVertexSlot> FaceVertexSlotList;
+
+        template <class BatchList>
+        class GenerateFaceVerticesTask : public Utility::ParallelTask {
+        private:
+            const FaceVertexSlotList& m_slots;
+            BatchList& m_batches;
+        public:
+            GenerateFaceVerticesTask(const FaceVertexSlotList& slots, BatchList& batches) :
+            m_slots(slots),
+            m_batches(batches) {}
+
+            void run(size_t index) {
+                // validating the vertex cache only touches the face itself, and every face has its own slot
+                const FaceVertexSlot& slot = m_slots[index];
+                const FaceVertex::List& vertices = slot.face->cachedVertices();
+                FaceVertex::List& target = m_batches[slot.batchIndex].vertices;
+                assert(slot.offset + vertices.size() <= target.size());
+                std::copy(vertices.begin(), vertices.end(), target.begin() + static_cast<FaceVertex::List::difference_type>(slot.offset));
+            }
+        };
+
+        void FaceRenderer::generateFaceData(TextureRendererManager& textureRendererManager, const Sorter& faceSorter) {
             const FaceCollectionMap& faceCollectionMap = faceSorter.collections();
             if (faceCollectionMap.empty())
                 return;
-            
+
+            FaceVertexSlotList slots;
+            m_batches.reserve(faceCollectionMap.size());
+
             FaceCollectionMap::const_iterator it, end;
             for (it = faceCollectionMap.begin(), end = faceCollectionMap.end(); it != end; ++it) {
                 Model::Texture* texture = it->first;
@@ -48,22 +89,40 @@ namespace TrenchBroom {
                 const FaceCollection& faceCollection = it->second;
                 const Model::FaceList& faces = faceCollection.polygons();
                 const size_t vertexCount = 3 * faceCollection.vertexCount() - 6 * faces.size();
-                VertexArray* vertexArray = new VertexArray(vbo, GL_TRIANGLES, vertexCount,
+
+                const size_t batchIndex = m_batches.size();
+                m_batches.push_back(Batch(textureRenderer, texture != NULL && alphaBlend(texture->name()), vertexCount));
+
+                size_t offset = 0;
+                for (size_t i = 0; i < faces.size(); i++) {
+                    Model::Face* face = faces[i];
+                    slots.push_back(FaceVertexSlot(face, batchIndex, offset));
+                    offset += 3 * (face->vertices().size() - 2);
+                }
+                assert(offset == vertexCount);
+            }
+
+            GenerateFaceVerticesTask<BatchList> task(slots, m_batches);
+            Utility::runParallel(task, slots.size());
+        }
+
+        void FaceRenderer::upload(Vbo& vbo) {
+            for (size_t i = 0; i < m_batches.size(); i++) {
+                const Batch& batch = m_batches[i];
+                VertexArray* vertexArray = new VertexArray(vbo, GL_TRIANGLES, batch.vertices.size(),
                                                            Attribute::position3f(),
                                                            Attribute::normal3f(),
                                                            Attribute::texCoord02f(),
                                                            0);
-                
-                for (size_t i = 0; i < faces.size(); i++) {
-                    Model::Face* face = faces[i];
-                    vertexArray->addAttributes(face->cachedVertices());
-                }
-                
-                if (texture != NULL && alphaBlend(texture->name()))
-                    m_transparentVertexArrays.push_back(TextureVertexArray(textureRenderer, vertexArray));
+                vertexArray->addVertices(batch.vertices);
+
+                if (batch.transparent)
+                    m_transparentVertexArrays.push_back(TextureVertexArray(batch.texture, vertexArray));
                 else
-                    m_vertexArrays.push_back(TextureVertexArray(textureRenderer, vertexArray));
+                    m_vertexArrays.push_back(TextureVertexArray(batch.texture, vertexArray));
             }
+
+            BatchList().swap(m_batches);
         }
 
         void FaceRenderer::render(RenderContext& context, bool grayScale, const Color* tintColor) {
@@ -116,11 +175,18 @@ namespace TrenchBroom {
         void FaceRenderer::renderFaces(const TextureVertexArrayList& vertexArrays, ShaderProgram& shader, const bool applyTexture) {
             for (size_t i = 0; i < vertexArrays.size(); i++) {
                 const TextureVertexArray& textureVertexArray = vertexArrays[i];
-                if (textureVertexArray.texture != NULL) {
-                    textureVertexArray.texture->activate();
+                TextureRenderer* texture = textureVertexArray.texture;
+                const bool textured = texture != NULL && texture->uploaded();
+                if (textured) {
+                    texture->activate();
                     shader.setUniformVariable("ApplyTexture", applyTexture);
                     shader.setUniformVariable("FaceTexture", 0);
-                    shader.setUniformVariable("Color", textureVertexArray.texture->averageColor());
+                    shader.setUniformVariable("Color", texture->averageColor());
+                } else if (texture != NULL) {
+                    // render the faces with the average color until the texture has been uploaded
+                    m_uploadQueue.request(*texture);
+                    shader.setUniformVariable("ApplyTexture", false);
+                    shader.setUniformVariable("Color", texture->averageColor());
                 } else {
                     shader.setUniformVariable("ApplyTexture", false);
                     shader.setUniformVariable("Color", m_faceColor);
@@ -128,14 +194,38 @@ namespace TrenchBroom {
                 
                 textureVertexArray.vertexArray->render();
                 
-                if (textureVertexArray.texture != NULL)
-                    textureVertexArray.texture->deactivate();
+                if (textured)
+                    texture->deactivate();
             }
         }
 
+        FaceRenderer::FaceRenderer(TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor) :
+        m_uploadQueue(textureRendererManager.uploadQueue()),
+        m_faceColor(faceColor) {
+            generateFaceData(textureRendererManager, faceSorter);
+        }
+
         FaceRenderer::FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor) :
+        m_uploadQueue(textureRendererManager.uploadQueue()),
         m_faceColor(faceColor) {
-            writeFaceData(vbo, textureRendererManager, faceSorter);
+            generateFaceData(textureRendererManager, faceSorter);
+            upload(vbo);
+        }
+
+        FaceRenderer::FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const TextureVertexMap& vertices, const Color& faceColor) :
+        m_uploadQueue(textureRendererManager.uploadQueue()),
+        m_faceColor(faceColor) {
+            m_batches.reserve(vertices.size());
+
+            TextureVertexMap::const_iterator it, end;
+            for (it = vertices.begin(), end = vertices.end(); it != end; ++it) {
+                Model::Texture* texture = it->first;
+                TextureRenderer* textureRenderer = texture != NULL ? &textureRendererManager.renderer(texture) : NULL;
+                m_batches.push_back(Batch(textureRenderer, texture != NULL && alphaBlend(texture->name()), 0));
+                m_batches.back().vertices = it->second;
+            }
+
+            upload(vbo);
         }
         
         void FaceRenderer::render(RenderContext& context, bool grayScale) {
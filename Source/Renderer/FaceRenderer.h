@@ -20,10 +20,14 @@
 #ifndef __TrenchBroom__FaceRenderer__
 #define __TrenchBroom__FaceRenderer__
 
+#include "Renderer/FaceVertex.h"
 #include "Renderer/TexturedPolygonSorter.h"
 #include "Renderer/TextureVertexArray.h"
 #include "Utility/Color.h"
 
+#include <map>
+#include <vector>
+
 namespace TrenchBroom {
     namespace Model {
         class Face;
@@ -32,17 +36,39 @@ namespace TrenchBroom {
     
     namespace Renderer {
         class RenderContext;
+        class TextureRenderer;
         class TextureRendererManager;
+        class TextureUploadQueue;
         class Vbo;
         
         class FaceRenderer {
         public:
             typedef TexturedPolygonSorter<Model::Texture, Model::Face*> Sorter;
+            typedef std::map<Model::Texture*, FaceVertex::List> TextureVertexMap;
         protected:
             typedef Sorter::PolygonCollection FaceCollection;
             typedef Sorter::PolygonCollectionMap FaceCollectionMap;
 
+            /**
+             * The vertices of the faces with one texture, generated before they are uploaded into a VBO.
+             */
+            class Batch {
+            public:
+                TextureRenderer* texture;
+                bool transparent;
+                FaceVertex::List vertices;
+
+                Batch(TextureRenderer* i_texture, bool i_transparent, size_t vertexCount) :
+                texture(i_texture),
+                transparent(i_transparent),
+                vertices(vertexCount) {}
+            };
+
+            typedef std::vector<Batch> BatchList;
+
+            TextureUploadQueue& m_uploadQueue;
             Color m_faceColor;
+            BatchList m_batches;
             TextureVertexArrayList m_vertexArrays;
             TextureVertexArrayList m_transparentVertexArrays;
             
@@ -59,13 +85,29 @@ namespace TrenchBroom {
                 return false;
             }
             
-            void writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter);
+            void generateFaceData(TextureRendererManager& textureRendererManager, const Sorter& faceSorter);
             void render(RenderContext& context, bool grayScale, const Color* tintColor);
             void renderOpaqueFaces(ShaderProgram& shader, const bool applyTexture);
             void renderTransparentFaces(ShaderProgram& shader, const bool applyTexture);
             void renderFaces(const TextureVertexArrayList& vertexArrays, ShaderProgram& shader, const bool applyTexture);
         public:
+            /**
+             * Generates the vertices of the given faces on the worker threads of the shared thread pool. They must be
+             * uploaded into a VBO before the faces can be rendered.
+             */
+            FaceRenderer(TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor);
             FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor);
+
+            /**
+             * Uploads the given vertices, which must form triangles and are sorted by their textures, into the given
+             * VBO, which must be mapped.
+             */
+            FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const TextureVertexMap& vertices, const Color& faceColor);
+
+            /**
+             * Copies the generated vertices into the given VBO, which must be mapped.
+             */
+            void upload(Vbo& vbo);
             
             void render(RenderContext& context, bool grayScale);
             void render(RenderContext& context, bool grayScale, const Color& tintColor);
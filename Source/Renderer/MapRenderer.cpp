@@ -143,59 +143,73 @@ namespace TrenchBroom {
             Model::BrushList unselectedBrushes(unselectedWorldBrushes);
             unselectedBrushes.insert(unselectedBrushes.end(), unselectedEntityBrushes.begin(), unselectedEntityBrushes.end());
 
-            // write face triangles
-            m_faceVbo->activate();
-            m_faceVbo->map();
-            
-            // make sure that the VBO is sufficiently large
-            size_t totalFaceVertexCount = unselectedFaceSorter.vertexCount() + selectedFaceSorter.vertexCount() + lockedFaceSorter.vertexCount();
-            size_t totalPolygonCount = unselectedFaceSorter.polygonCount() + selectedFaceSorter.polygonCount() + lockedFaceSorter.polygonCount();
-            size_t totalTriangleVertexCount = 3 * totalFaceVertexCount - 6 * totalPolygonCount;
-            m_faceVbo->ensureFreeCapacity(static_cast<unsigned int>(totalTriangleVertexCount) * FaceVertexSize);
-            
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
             TextureRendererManager& textureRendererManager = m_document.sharedResources().textureRendererManager();
             const Color& faceColor = prefs.getColor(Preferences::FaceColor);
+            const Color& edgeColor = prefs.getColor(Preferences::EdgeColor);
 
+            // generate the vertices on worker threads first so that the VBOs are only mapped while they are copied
             if (!m_geometryDataValid && !unselectedFaceSorter.empty()) {
                 assert(m_faceRenderer == NULL);
-                m_faceRenderer = new FaceRenderer(*m_faceVbo, textureRendererManager, unselectedFaceSorter, faceColor);
+                m_faceRenderer = new FaceRenderer(textureRendererManager, unselectedFaceSorter, faceColor);
             }
             
             if (!m_selectedGeometryDataValid && !selectedFaceSorter.empty()) {
                 assert(m_selectedFaceRenderer == NULL);
-                m_selectedFaceRenderer = new FaceRenderer(*m_faceVbo, textureRendererManager, selectedFaceSorter, faceColor);
+                m_selectedFaceRenderer = new FaceRenderer(textureRendererManager, selectedFaceSorter, faceColor);
             }
             
             if (!m_lockedGeometryDataValid && !lockedFaceSorter.empty()) {
                 assert(m_lockedFaceRenderer == NULL);
-                m_lockedFaceRenderer = new FaceRenderer(*m_faceVbo, textureRendererManager, lockedFaceSorter, faceColor);
+                m_lockedFaceRenderer = new FaceRenderer(textureRendererManager, lockedFaceSorter, faceColor);
             }
             
-            m_faceVbo->unmap();
-            m_faceVbo->deactivate();
-            
-            // write edges
-            m_edgeVbo->activate();
-            m_edgeVbo->map();
-            
-            const Color& edgeColor = prefs.getColor(Preferences::EdgeColor);
-
             if (!m_geometryDataValid && !unselectedBrushes.empty()) {
                 assert(m_edgeRenderer == NULL);
-                m_edgeRenderer = new EdgeRenderer(*m_edgeVbo, unselectedBrushes, Model::EmptyFaceList, edgeColor);
+                m_edgeRenderer = new EdgeRenderer(unselectedBrushes, Model::EmptyFaceList, edgeColor);
             }
             
             if (!m_selectedGeometryDataValid && (!selectedBrushes.empty() || !partiallySelectedBrushFaces.empty())) {
                 assert(m_selectedEdgeRenderer == NULL);
-                m_selectedEdgeRenderer = new EdgeRenderer(*m_edgeVbo, selectedBrushes, partiallySelectedBrushFaces);
+                m_selectedEdgeRenderer = new EdgeRenderer(selectedBrushes, partiallySelectedBrushFaces);
             }
             
             if (!m_lockedGeometryDataValid && !lockedBrushes.empty()) {
                 assert(m_lockedEdgeRenderer == NULL);
-                m_lockedEdgeRenderer = new EdgeRenderer(*m_edgeVbo, lockedBrushes, Model::EmptyFaceList);
+                m_lockedEdgeRenderer = new EdgeRenderer(lockedBrushes, Model::EmptyFaceList);
             }
             
+            // write face triangles
+            m_faceVbo->activate();
+            
+            // make sure that the VBO is sufficiently large
+            size_t totalFaceVertexCount = unselectedFaceSorter.vertexCount() + selectedFaceSorter.vertexCount() + lockedFaceSorter.vertexCount();
+            size_t totalPolygonCount = unselectedFaceSorter.polygonCount() + selectedFaceSorter.polygonCount() + lockedFaceSorter.polygonCount();
+            size_t totalTriangleVertexCount = 3 * totalFaceVertexCount - 6 * totalPolygonCount;
+            m_faceVbo->ensureFreeCapacity(static_cast<unsigned int>(totalTriangleVertexCount) * FaceVertexSize);
+            m_faceVbo->map();
+            
+            if (!m_geometryDataValid && m_faceRenderer != NULL)
+                m_faceRenderer->upload(*m_faceVbo);
+            if (!m_selectedGeometryDataValid && m_selectedFaceRenderer != NULL)
+                m_selectedFaceRenderer->upload(*m_faceVbo);
+            if (!m_lockedGeometryDataValid && m_lockedFaceRenderer != NULL)
+                m_lockedFaceRenderer->upload(*m_faceVbo);
+            
+            m_faceVbo->unmap();
+            m_faceVbo->deactivate();
+            
+            // write edges
+            m_edgeVbo->activate();
+            m_edgeVbo->map();
+            
+            if (!m_geometryDataValid && m_edgeRenderer != NULL)
+                m_edgeRenderer->upload(*m_edgeVbo);
+            if (!m_selectedGeometryDataValid && m_selectedEdgeRenderer != NULL)
+                m_selectedEdgeRenderer->upload(*m_edgeVbo);
+            if (!m_lockedGeometryDataValid && m_lockedEdgeRenderer != NULL)
+                m_lockedEdgeRenderer->upload(*m_edgeVbo);
+            
             m_edgeVbo->unmap();
             m_edgeVbo->deactivate();
             
@@ -430,7 +444,7 @@ namespace TrenchBroom {
             m_faceVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
             m_edgeVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
             m_entityVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
-            m_utilityVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
+            m_utilityVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF, Vbo::VboStreaming);
             
             m_entityRenderer = new EntityRenderer(*m_entityVbo, m_document);
             m_entityRenderer->setClassnameFadeDistance(prefs.getFloat(Preferences::InfoOverlayFadeDistance));
@@ -516,6 +530,10 @@ namespace TrenchBroom {
                         invalidateEntityModelRendererCache();
                     break;
                 }
+                case Controller::Command::EntityModelsLoaded: {
+                    invalidateEntityModelRendererCache();
+                    break;
+                }
                 case Controller::Command::SetFaceAttributes:
                 case Controller::Command::MoveTextures:
                 case Controller::Command::RotateTextures: {
@@ -616,6 +634,7 @@ namespace TrenchBroom {
             
             if (m_pointTraceRenderer != NULL)
                 m_pointTraceRenderer->render(*m_utilityVbo, context);
+            m_utilityVbo->fence();
             
             m_rendering = false;
         }
@@ -108,6 +108,19 @@ namespace TrenchBroom {
             glBindFramebuffer(GL_FRAMEBUFFER, 0);
         }
 
+        void OffscreenRenderer::blit(GLuint framebufferId, GLint x, GLint y, GLint width, GLint height) {
+            assert(m_valid);
+            assert(width <= static_cast<GLint>(m_width) && height <= static_cast<GLint>(m_height));
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebufferId);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebufferId);
+            glBlitFramebuffer(0, 0, width, height,
+                              x, y, x + width, y + height,
+                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+            glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferId);
+        }
+
         wxImage* OffscreenRenderer::getImage() {
             assert(m_valid);
 
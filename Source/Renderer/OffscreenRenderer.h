@@ -59,6 +59,13 @@ namespace TrenchBroom {
             void preRender();
             void postRender();
 
+            /**
+             * Copies the lower left rectangle of the given size from the color buffer to the given position in the
+             * given framebuffer, resolving the samples if multisampling is enabled. Must be called between preRender
+             * and postRender.
+             */
+            void blit(GLuint framebufferId, GLint x, GLint y, GLint width, GLint height);
+
             wxImage* getImage();
         };
     }
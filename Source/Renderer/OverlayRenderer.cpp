@@ -42,7 +42,7 @@ namespace TrenchBroom {
 
         void OverlayRenderer::render(RenderContext& context, const float viewWidth, const float viewHeight) {
             if (m_vbo == NULL)
-                m_vbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
+                m_vbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF, Vbo::VboStreaming);
             if (m_compass == NULL)
                 m_compass = new CompassRenderer();
 
@@ -56,6 +56,7 @@ namespace TrenchBroom {
             Renderer::ApplyModelMatrix applyCompassTranslate(context.transformation(), compassTransformation);
 
             m_compass->render(*m_vbo, context);
+            m_vbo->fence();
         }
     }
 }
@@ -38,6 +38,14 @@ namespace TrenchBroom {
             
             void operator= (Palette other);
             
+            inline const unsigned char* data() const {
+                return m_data;
+            }
+            
+            inline size_t size() const {
+                return m_size;
+            }
+            
             inline void indexedToRgb(const unsigned char* indexedImage, unsigned char* rgbImage, size_t pixelCount, Color& averageColor) const {
                 double avg[3];
                 avg[0] = avg[1] = avg[2] = 0;
@@ -29,9 +29,12 @@ namespace TrenchBroom {
             const ShaderConfig ColoredEdgeShader = ShaderConfig("Colored Edge Shader Program", "ColoredEdge.vertsh", "Edge.fragsh");
             const ShaderConfig EdgeShader = ShaderConfig("Edge Shader Program", "Edge.vertsh", "Edge.fragsh");
             const ShaderConfig EntityModelShader = ShaderConfig("Entity Model Shader Program", "EntityModel.vertsh", "EntityModel.fragsh");
+            const ShaderConfig InstancedEntityModelShader = ShaderConfig("Instanced Entity Model Shader Program", "InstancedEntityModel.vertsh", "EntityModel.fragsh");
             const ShaderConfig FaceShader = ShaderConfig("Face Shader Program", "Face.vertsh", "Face.fragsh");
             const ShaderConfig TextShader = ShaderConfig("Text Shader Program", "Text.vertsh", "Text.fragsh");
             const ShaderConfig TextBackgroundShader = ShaderConfig("Text Background Shader Program", "TextBackground.vertsh", "TextBackground.fragsh");
+            const ShaderConfig TextLabelShader = ShaderConfig("Text Label Shader Program", "TextLabel.vertsh", "Text.fragsh");
+            const ShaderConfig TextLabelBackgroundShader = ShaderConfig("Text Label Background Shader Program", "TextLabel.vertsh", "TextBackground.fragsh");
             const ShaderConfig TextureBrowserShader = ShaderConfig("Texture Browser Shader Program", "TextureBrowser.vertsh", "TextureBrowser.fragsh");
             const ShaderConfig TextureBrowserBorderShader = ShaderConfig("Texture Browser Border Shader Program", "TextureBrowserBorder.vertsh", "TextureBrowserBorder.fragsh");
             const ShaderConfig BrowserGroupShader = ShaderConfig("Browser Group Shader Program", "BrowserGroup.vertsh", "BrowserGroup.fragsh");
@@ -29,6 +29,7 @@
 #include "Utility/Preferences.h"
 
 #include <GL/glew.h>
+#include <algorithm>
 #include <wx/glcanvas.h>
 #include <wx/sizer.h>
 
@@ -40,6 +41,25 @@ namespace TrenchBroom {
         EVT_IDLE(SharedResources::OnIdle)
         END_EVENT_TABLE()
 
+        SharedResources* SharedResources::sharedInstance = NULL;
+
+        void SharedResources::DocumentConsole::addConsole(Utility::Console& console) {
+            m_consoles.push_back(&console);
+        }
+        
+        void SharedResources::DocumentConsole::removeConsole(Utility::Console& console) {
+            ConsoleList::iterator it = std::find(m_consoles.begin(), m_consoles.end(), &console);
+            if (it != m_consoles.end())
+                m_consoles.erase(it);
+        }
+        
+        void SharedResources::DocumentConsole::log(const LogMessage& message) {
+            if (m_consoles.empty())
+                Utility::Console::log(message);
+            else
+                m_consoles.back()->log(message);
+        }
+
         SharedResources::SharedResources() :
         wxFrame(NULL, wxID_ANY, wxT("TrenchBroom Render Resources"), wxDefaultPosition, wxDefaultSize, wxCAPTION | wxCLIP_CHILDREN | wxFRAME_NO_TASKBAR),
         m_palette(NULL),
@@ -55,7 +75,7 @@ namespace TrenchBroom {
         m_glCanvas(NULL),
         m_retainCount(0) {}
 
-        SharedResources::SharedResources(Model::TextureManager& textureManager, Utility::Console& console) :
+        SharedResources::SharedResources(Utility::Console& console) :
         wxFrame(NULL, wxID_ANY, wxT("TrenchBroom Render Resources"), wxDefaultPosition, wxDefaultSize, wxCAPTION | wxCLIP_CHILDREN | wxFRAME_NO_TASKBAR),
         m_palette(NULL),
         m_modelRendererManager(NULL),
@@ -69,10 +89,11 @@ namespace TrenchBroom {
         m_sharedContext(NULL),
         m_glCanvas(NULL),
         m_retainCount(0) {
-            Create(textureManager, console);
+            m_console.addConsole(console);
+            Create();
         }
         
-        void SharedResources::Create(Model::TextureManager& textureManager, Utility::Console& console) {
+        void SharedResources::Create() {
             int attribs[] =
             {
                 // 32 bit depth buffer, 4 samples
@@ -166,28 +187,28 @@ namespace TrenchBroom {
             const char* vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
             const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
             const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
-            console.info("Renderer info: %s version %s from %s", renderer, version, vendor);
-            console.info("Depth buffer bits: %d", m_depthbits);
+            m_console.info("Renderer info: %s version %s from %s", renderer, version, vendor);
+            m_console.info("Depth buffer bits: %d", m_depthbits);
             
             if (m_multisample)
-                console.info("Multisampling enabled");
+                m_console.info("Multisampling enabled");
             else
-                console.info("Multisampling disabled");
+                m_console.info("Multisampling disabled");
             
             glewExperimental = GL_TRUE;
             GLenum glewState = glewInit();
             if (glewState != GLEW_OK)
-                console.error("Unable to initialize glew: %s", glewGetErrorString(glewState));
+                m_console.error("Unable to initialize glew: %s", glewGetErrorString(glewState));
             
             if (PointHandleRenderer::instancingSupported())
-                console.info("OpenGL instancing enabled");
+                m_console.info("OpenGL instancing enabled");
             else
-                console.info("OpenGL instancing disabled");
+                m_console.info("OpenGL instancing disabled");
             
-            m_modelRendererManager = new EntityModelRendererManager(console);
-            m_shaderManager = new ShaderManager(console);
-            m_textureRendererManager = new TextureRendererManager(textureManager);
-            m_fontManager = new Text::FontManager(console);
+            m_modelRendererManager = new EntityModelRendererManager(m_console);
+            m_shaderManager = new ShaderManager(m_console);
+            m_textureRendererManager = new TextureRendererManager(m_console);
+            m_fontManager = new Text::FontManager(m_console);
             
             SetPosition(wxPoint(-10, -10));
             Hide();
@@ -212,10 +233,35 @@ namespace TrenchBroom {
             wxDELETE(m_sharedContext);
         }
 
+        SharedResources& SharedResources::retain(Utility::Console& console) {
+            if (sharedInstance == NULL)
+                sharedInstance = new SharedResources(console);
+            else
+                sharedInstance->m_console.addConsole(console);
+            sharedInstance->m_retainCount++;
+            return *sharedInstance;
+        }
+        
+        void SharedResources::release(Utility::Console& console) {
+            assert(m_retainCount > 0);
+            m_console.removeConsole(console);
+            
+            m_retainCount--;
+            if (m_retainCount == 0) {
+                if (sharedInstance == this)
+                    sharedInstance = NULL;
+                Destroy(); // makes sure that the resources are deleted after the last frame
+            }
+        }
+
         void SharedResources::loadPalette(const String& palettePath) {
+            if (m_palette != NULL && palettePath == m_palettePath)
+                return;
+            
             if (m_palette != NULL)
                 delete m_palette;
             m_palette = new Palette(palettePath);
+            m_palettePath = palettePath;
 
             m_modelRendererManager->setPalette(*m_palette);
             m_textureRendererManager->setPalette(*m_palette);
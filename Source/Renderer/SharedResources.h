@@ -20,24 +20,18 @@
 #ifndef __TrenchBroom__SharedResources__
 #define __TrenchBroom__SharedResources__
 
+#include "Utility/Console.h"
 #include "Utility/String.h"
 
 #include <wx/frame.h>
 
 #include <cassert>
+#include <vector>
 
 class wxGLCanvas;
 class wxGLContext;
 
 namespace TrenchBroom {
-    namespace Model {
-        class TextureManager;
-    }
-
-    namespace Utility {
-        class Console;
-    }
-
     namespace Renderer {
         namespace Text {
             class FontManager;
@@ -48,11 +42,35 @@ namespace TrenchBroom {
         class ShaderManager;
         class TextureRendererManager;
 
+        /**
+         * Owns the GL context and the render resources of all open documents. The first document creates the
+         * resources and the last document to release them destroys them, so the textures, entity models, shaders
+         * and fonts are only loaded once while several documents are open.
+         */
         class SharedResources : public wxFrame {
         private:
             DECLARE_DYNAMIC_CLASS(SharedResources)
+            
+            static SharedResources* sharedInstance;
         protected:
+            /**
+             * Forwards the messages of the shared resources to the console of the document which retained them most
+             * recently.
+             */
+            class DocumentConsole : public Utility::Console {
+            private:
+                typedef std::vector<Utility::Console*> ConsoleList;
+                ConsoleList m_consoles;
+            public:
+                void addConsole(Utility::Console& console);
+                void removeConsole(Utility::Console& console);
+                
+                void log(const LogMessage& message);
+            };
+            
+            DocumentConsole m_console;
             Palette* m_palette;
+            String m_palettePath;
             EntityModelRendererManager* m_modelRendererManager;
             ShaderManager* m_shaderManager;
             TextureRendererManager* m_textureRendererManager;
@@ -66,18 +84,34 @@ namespace TrenchBroom {
             wxGLCanvas* m_glCanvas;
 
             unsigned int m_retainCount;
+            
+            SharedResources(Utility::Console& console);
+            void Create();
         public:
             SharedResources();
-            SharedResources(Model::TextureManager& textureManager, Utility::Console& console);
             ~SharedResources();
             
-            void Create(Model::TextureManager& textureManager, Utility::Console& console);
+            /**
+             * Returns the shared resources and creates them if no document has retained them yet. The given console
+             * receives the messages of the shared resources until it is released again.
+             */
+            static SharedResources& retain(Utility::Console& console);
+            
+            /**
+             * Releases the resources retained with the given console. The resources are destroyed when the last
+             * document releases them.
+             */
+            void release(Utility::Console& console);
 
             inline const Palette& palette() const {
                 assert(m_palette != NULL);
                 return *m_palette;
             }
 
+            /**
+             * Loads the palette at the given path unless it is already loaded, in which case the textures and entity
+             * models of the other documents remain valid.
+             */
             void loadPalette(const String& palettePath);
 
             inline EntityModelRendererManager& modelRendererManager() const {
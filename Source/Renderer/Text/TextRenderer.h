@@ -33,7 +33,10 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <map>
+#include <set>
+#include <vector>
 
 using namespace TrenchBroom::VecMath;
 
@@ -74,15 +77,24 @@ namespace TrenchBroom {
             public:
                 virtual ~TextAnchor() {}
 
-                inline const Vec3f offset(const Camera& camera, const Vec2f& size) const {
+                /**
+                 * Returns the screen space offset of the lower left corner of a text of the given size from the
+                 * projected anchor position.
+                 */
+                inline const Vec2f alignmentOffset(const Vec2f& size) const {
                     const Vec2f halfSize = size / 2.0f;
                     const Vec2f factors = alignmentFactors();
+                    Vec2f offset;
+                    for (size_t i = 0; i < 2; i++)
+                        offset[i] = factors[i] * size[i] - halfSize[i];
+                    return offset;
+                }
+
+                inline const Vec3f offset(const Camera& camera, const Vec2f& size) const {
+                    const Vec2f alignment = alignmentOffset(size);
                     Vec3f offset = camera.project(basePosition());
-                    for (size_t i = 0; i < 2; i++) {
-                        offset[i] += factors[i] * size[i];
-                        offset[i] -= halfSize[i];
-                        offset[i] = Math<float>::round(offset[i]);
-                    }
+                    for (size_t i = 0; i < 2; i++)
+                        offset[i] = Math<float>::round(offset[i] + alignment[i]);
                     return offset;
                 }
 
@@ -135,17 +147,81 @@ namespace TrenchBroom {
                 };
 
             protected:
+                /**
+                 * A cell of the uniform grid that is used to find the strings within the fade distance. The cells
+                 * are as large as the fade distance, so that at most 27 cells need to be visited.
+                 */
+                class GridCell {
+                private:
+                    int m_x;
+                    int m_y;
+                    int m_z;
+                public:
+                    GridCell() :
+                    m_x(0),
+                    m_y(0),
+                    m_z(0) {}
+
+                    GridCell(int x, int y, int z) :
+                    m_x(x),
+                    m_y(y),
+                    m_z(z) {}
+
+                    GridCell(const Vec3f& position, float cellSize) :
+                    m_x(static_cast<int>(std::floor(position.x() / cellSize))),
+                    m_y(static_cast<int>(std::floor(position.y() / cellSize))),
+                    m_z(static_cast<int>(std::floor(position.z() / cellSize))) {}
+
+                    inline int x() const {
+                        return m_x;
+                    }
+
+                    inline int y() const {
+                        return m_y;
+                    }
+
+                    inline int z() const {
+                        return m_z;
+                    }
+
+                    inline bool operator== (const GridCell& other) const {
+                        return m_x == other.m_x && m_y == other.m_y && m_z == other.m_z;
+                    }
+
+                    inline bool operator< (const GridCell& other) const {
+                        if (m_x != other.m_x)
+                            return m_x < other.m_x;
+                        if (m_y != other.m_y)
+                            return m_y < other.m_y;
+                        return m_z < other.m_z;
+                    }
+                };
+
+                /**
+                 * Besides the glyph quads of a string, an entry remembers the anchor position and the alignment
+                 * offset that were last written to the vertex arrays, the grid cell it is stored in and the
+                 * location of its vertices in the vertex arrays.
+                 */
                 class TextEntry {
                 private:
                     Vec2f::List m_vertices;
                     Vec2f m_size;
                     TextAnchor::Ptr m_textAnchor;
+                    Vec3f m_position;
+                    Vec2f m_offset;
+                    GridCell m_cell;
+                    size_t m_textIndex;
+                    size_t m_rectIndex;
                 public:
                     TextEntry(const Vec2f::List& vertices, const Vec2f& size, TextAnchor::Ptr textAnchor) :
                     m_vertices(vertices),
                     m_size(size),
-                    m_textAnchor(textAnchor) {}
-                    
+                    m_textAnchor(textAnchor),
+                    m_position(m_textAnchor->position()),
+                    m_offset(m_textAnchor->alignmentOffset(m_size.rounded())),
+                    m_textIndex(0),
+                    m_rectIndex(0) {}
+
                     inline const Vec2f::List& vertices() const {
                         return m_vertices;
                     }
@@ -153,6 +229,7 @@ namespace TrenchBroom {
                     inline void update(const Vec2f::List& vertices, const Vec2f& size) {
                         m_vertices = vertices;
                         m_size = size;
+                        m_offset = m_textAnchor->alignmentOffset(m_size.rounded());
                     }
 
                     inline const Vec2f& size() const {
@@ -162,11 +239,66 @@ namespace TrenchBroom {
                     inline const TextAnchor& textAnchor() const {
                         return *m_textAnchor.get();
                     }
+
+                    inline TextAnchor::Ptr textAnchorPtr() const {
+                        return m_textAnchor;
+                    }
+
+                    inline const Vec3f& position() const {
+                        return m_position;
+                    }
+
+                    inline const Vec2f& offset() const {
+                        return m_offset;
+                    }
+
+                    /**
+                     * Reads the current position and alignment offset from the anchor and returns whether they
+                     * differ from the ones that were last written.
+                     */
+                    inline bool updateAnchor() {
+                        const Vec3f position = m_textAnchor->position();
+                        const Vec2f offset = m_textAnchor->alignmentOffset(m_size.rounded());
+                        if (position == m_position && offset == m_offset)
+                            return false;
+                        m_position = position;
+                        m_offset = offset;
+                        return true;
+                    }
+
+                    inline const GridCell& cell() const {
+                        return m_cell;
+                    }
+
+                    inline void setCell(const GridCell& cell) {
+                        m_cell = cell;
+                    }
+
+                    inline size_t textVertexCount() const {
+                        return m_vertices.size() / 2;
+                    }
+
+                    inline size_t textIndex() const {
+                        return m_textIndex;
+                    }
+
+                    inline size_t rectIndex() const {
+                        return m_rectIndex;
+                    }
+
+                    inline void setIndices(size_t textIndex, size_t rectIndex) {
+                        m_textIndex = textIndex;
+                        m_rectIndex = rectIndex;
+                    }
                 };
 
                 typedef std::map<Key, TextEntry, Comparator> TextMap;
                 typedef std::pair<Key, TextEntry> TextMapItem;
-                typedef std::vector<TextEntry> EntryList;
+                typedef std::set<Key, Comparator> KeySet;
+                typedef std::map<GridCell, KeySet> Grid;
+                typedef std::vector<TextEntry*> EntryList;
+
+                static const size_t RectVertexCount = 3 * 16; // 16 triangles (for a rounded rect with 3 triangles per corner: 3 * 4 + 4 = 16)
 
                 TexturedFont& m_font;
                 float m_fadeDistance;
@@ -174,32 +306,221 @@ namespace TrenchBroom {
                 float m_vInset;
 
                 TextMap m_entries;
+                Grid m_grid;
+                float m_cellSize;
+                bool m_geometryValid;
+                bool m_anchorsValid;
+
                 Vbo* m_vbo;
+                VertexArray* m_textArray;
+                VertexArray* m_rectArray;
+                VertexArray::IndexArray m_textIndices;
+                VertexArray::CountArray m_textCounts;
+                VertexArray::IndexArray m_rectIndices;
+                VertexArray::CountArray m_rectCounts;
+
+                inline float cutoffDistance() const {
+                    return m_fadeDistance + 100.0f;
+                }
+
+                inline void insertIntoGrid(const Key& key, TextEntry& entry) {
+                    const GridCell cell(entry.position(), m_cellSize);
+                    entry.setCell(cell);
+                    m_grid[cell].insert(key);
+                }
+
+                inline void removeFromGrid(const Key& key, const TextEntry& entry) {
+                    typename Grid::iterator it = m_grid.find(entry.cell());
+                    if (it != m_grid.end()) {
+                        it->second.erase(key);
+                        if (it->second.empty())
+                            m_grid.erase(it);
+                    }
+                }
+
+                inline void moveInGrid(const Key& key, TextEntry& entry) {
+                    if (!(GridCell(entry.position(), m_cellSize) == entry.cell())) {
+                        removeFromGrid(key, entry);
+                        insertIntoGrid(key, entry);
+                    }
+                }
 
                 inline void addString(Key key, const Vec2f::List& vertices, const Vec2f& size, TextAnchor::Ptr anchor) {
                     removeString(key);
-                    m_entries.insert(TextMapItem(key, TextEntry(vertices, size, anchor)));
+                    typename TextMap::iterator it = m_entries.insert(TextMapItem(key, TextEntry(vertices, size, anchor))).first;
+                    insertIntoGrid(key, it->second);
+                    m_geometryValid = false;
+                }
+
+                void writeEntry(TextEntry& entry) {
+                    const Vec3f& position = entry.position();
+                    const Vec2f& offset = entry.offset();
+
+                    m_textArray->seek(entry.textIndex());
+                    const Vec2f::List& textVertices = entry.vertices();
+                    for (size_t i = 0; i < textVertices.size() / 2; i++) {
+                        const Vec2f& vertex = textVertices[2 * i];
+                        const Vec2f& texCoords = textVertices[2 * i + 1];
+
+                        m_textArray->addAttribute(position);
+                        m_textArray->addAttribute(texCoords);
+                        m_textArray->addAttribute(vertex + offset);
+                    }
+
+                    const Vec2f size = entry.size().rounded();
+                    const Vec2f rectOffset = offset + size / 2.0f;
+
+                    Vec2f::List rectVertices;
+                    rectVertices.reserve(RectVertexCount);
+                    roundedRect(size.x() + 2.0f * m_hInset, size.y() + 2.0f * m_vInset, 3.0f, 3, rectVertices);
+                    assert(rectVertices.size() == RectVertexCount);
+
+                    m_rectArray->seek(entry.rectIndex());
+                    for (size_t i = 0; i < rectVertices.size(); i++) {
+                        m_rectArray->addAttribute(position);
+                        m_rectArray->addAttribute(rectVertices[i] + rectOffset);
+                    }
                 }
 
-                EntryList visibleEntries(RenderContext& context, const TextRendererFilter& filter) {
-                    float cutoff = (m_fadeDistance + 100) * (m_fadeDistance + 100);
-                    EntryList result;
+                /**
+                 * Lays out the vertices of all strings in the vertex arrays. This only happens when strings were
+                 * added, removed or changed.
+                 */
+                void validateGeometry() {
+                    size_t textVertexCount = 0;
+                    typename TextMap::iterator it, end;
+                    for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it)
+                        textVertexCount += it->second.textVertexCount();
+                    const size_t rectVertexCount = RectVertexCount * m_entries.size();
+
+                    if (m_vbo == NULL)
+                        m_vbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
+
+                    if (m_textArray == NULL || m_textArray->vertexCapacity() < textVertexCount) {
+                        delete m_textArray;
+                        m_textArray = new VertexArray(*m_vbo, GL_QUADS, std::max(2 * textVertexCount, static_cast<size_t>(1024)),
+                                                      Attribute::position3f(),
+                                                      Attribute::texCoord02f(),
+                                                      Attribute::texCoord12f());
+                    }
+
+                    if (m_rectArray == NULL || m_rectArray->vertexCapacity() < rectVertexCount) {
+                        delete m_rectArray;
+                        m_rectArray = new VertexArray(*m_vbo, GL_TRIANGLES, std::max(2 * rectVertexCount, 16 * RectVertexCount),
+                                                      Attribute::position3f(),
+                                                      Attribute::texCoord12f());
+                    }
+
+                    SetVboState mapVbo(*m_vbo, Vbo::VboMapped);
+                    size_t textIndex = 0;
+                    size_t rectIndex = 0;
+                    for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
+                        TextEntry& entry = it->second;
+                        entry.setIndices(textIndex, rectIndex);
+                        writeEntry(entry);
+
+                        textIndex += entry.textVertexCount();
+                        rectIndex += RectVertexCount;
+                    }
+
+                    m_geometryValid = true;
+                }
+
+                /**
+                 * Rereads the positions of all anchors after they were invalidated, e.g. because the anchored
+                 * objects have moved.
+                 */
+                void validateAnchors() {
+                    EntryList changedEntries;
 
                     typename TextMap::iterator it, end;
                     for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
-                        Key key = it->first;
-                        if (filter.stringVisible(context, key)) {
-                            const TextEntry& entry = it->second;
-                            const TextAnchor& anchor = entry.textAnchor();
-                            const Vec3f position = anchor.position();
-
-                            float dist2 = context.camera().squaredDistanceTo(position);
-                            if (dist2 <= cutoff)
-                                result.push_back(entry);
+                        TextEntry& entry = it->second;
+                        if (entry.updateAnchor()) {
+                            moveInGrid(it->first, entry);
+                            changedEntries.push_back(&entry);
                         }
                     }
 
-                    return result;
+                    if (m_geometryValid && !changedEntries.empty()) {
+                        SetVboState mapVbo(*m_vbo, Vbo::VboMapped);
+                        for (size_t i = 0; i < changedEntries.size(); i++)
+                            writeEntry(*changedEntries[i]);
+                    }
+
+                    m_anchorsValid = true;
+                }
+
+                void validateGrid() {
+                    m_grid.clear();
+                    m_cellSize = cutoffDistance();
+
+                    typename TextMap::iterator it, end;
+                    for (it = m_entries.begin(), end = m_entries.end(); it != end; ++it)
+                        insertIntoGrid(it->first, it->second);
+                }
+
+                /**
+                 * Collects the vertex ranges of the strings within the fade distance from the grid cells around
+                 * the camera. Since some anchors depend on the camera, the anchors of these strings are checked
+                 * and their vertices are rewritten if they have changed.
+                 */
+                void collectVisibleEntries(RenderContext& context, const TextRendererFilter& filter) {
+                    m_textIndices.clear();
+                    m_textCounts.clear();
+                    m_rectIndices.clear();
+                    m_rectCounts.clear();
+
+                    const float cutoff = cutoffDistance();
+                    const float cutoff2 = cutoff * cutoff;
+                    const Vec3f& cameraPosition = context.camera().position();
+                    const GridCell minCell(cameraPosition - Vec3f(cutoff, cutoff, cutoff), m_cellSize);
+                    const GridCell maxCell(cameraPosition + Vec3f(cutoff, cutoff, cutoff), m_cellSize);
+
+                    typedef std::vector<std::pair<Key, TextEntry*> > MovedEntryList;
+                    MovedEntryList movedEntries;
+                    EntryList changedEntries;
+
+                    for (int x = minCell.x(); x <= maxCell.x(); x++) {
+                        for (int y = minCell.y(); y <= maxCell.y(); y++) {
+                            for (int z = minCell.z(); z <= maxCell.z(); z++) {
+                                typename Grid::const_iterator cellIt = m_grid.find(GridCell(x, y, z));
+                                if (cellIt == m_grid.end())
+                                    continue;
+
+                                const KeySet& keys = cellIt->second;
+                                typename KeySet::const_iterator keyIt, keyEnd;
+                                for (keyIt = keys.begin(), keyEnd = keys.end(); keyIt != keyEnd; ++keyIt) {
+                                    const Key& key = *keyIt;
+                                    if (!filter.stringVisible(context, key))
+                                        continue;
+
+                                    TextEntry& entry = m_entries.find(key)->second;
+                                    if (entry.updateAnchor()) {
+                                        changedEntries.push_back(&entry);
+                                        if (!(GridCell(entry.position(), m_cellSize) == entry.cell()))
+                                            movedEntries.push_back(std::make_pair(key, &entry));
+                                    }
+
+                                    if (context.camera().squaredDistanceTo(entry.position()) <= cutoff2) {
+                                        m_textIndices.push_back(static_cast<GLint>(entry.textIndex()));
+                                        m_textCounts.push_back(static_cast<GLsizei>(entry.textVertexCount()));
+                                        m_rectIndices.push_back(static_cast<GLint>(entry.rectIndex()));
+                                        m_rectCounts.push_back(static_cast<GLsizei>(RectVertexCount));
+                                    }
+                                }
+                            }
+                        }
+                    }
+
+                    for (size_t i = 0; i < movedEntries.size(); i++)
+                        moveInGrid(movedEntries[i].first, *movedEntries[i].second);
+
+                    if (!changedEntries.empty()) {
+                        SetVboState mapVbo(*m_vbo, Vbo::VboMapped);
+                        for (size_t i = 0; i < changedEntries.size(); i++)
+                            writeEntry(*changedEntries[i]);
+                    }
                 }
             public:
                 TextRenderer(TexturedFont& font) :
@@ -207,10 +528,19 @@ namespace TrenchBroom {
                 m_fadeDistance(100.0f),
                 m_hInset(4.0f),
                 m_vInset(4.0f),
-                m_vbo(NULL) {}
+                m_cellSize(cutoffDistance()),
+                m_geometryValid(false),
+                m_anchorsValid(true),
+                m_vbo(NULL),
+                m_textArray(NULL),
+                m_rectArray(NULL) {}
 
                 ~TextRenderer() {
                     clear();
+                    delete m_textArray;
+                    m_textArray = NULL;
+                    delete m_rectArray;
+                    m_rectArray = NULL;
                     delete m_vbo;
                     m_vbo = NULL;
                 }
@@ -224,7 +554,9 @@ namespace TrenchBroom {
                 inline void removeString(Key key)  {
                     typename TextMap::iterator it = m_entries.find(key);
                     if (it != m_entries.end()) {
+                        removeFromGrid(it->first, it->second);
                         m_entries.erase(it);
+                        m_geometryValid = false;
                     }
                 }
 
@@ -232,7 +564,8 @@ namespace TrenchBroom {
                     typename TextMap::iterator it = m_entries.find(key);
                     if (it != m_entries.end()) {
                         TextEntry& entry = it->second;
-                        entry.setVertices(m_font.quads(string, true));
+                        entry.update(m_font.quads(string, true), m_font.measure(string));
+                        m_geometryValid = false;
                     }
                 }
 
@@ -240,98 +573,81 @@ namespace TrenchBroom {
                     typename TextMap::iterator it = m_entries.find(key);
                     if (it != m_entries.end()) {
                         TextEntry& entry = it->second;
-                        destination.addString(key, entry.vertices(), entry.textAnchor());
-                        m_entries.erase(it);
+                        destination.addString(key, entry.vertices(), entry.size(), entry.textAnchorPtr());
+                        removeString(key);
                     }
                 }
 
+                /**
+                 * Must be called when the positions of the anchors have changed, e.g. because the anchored objects
+                 * were moved.
+                 */
+                inline void invalidateAnchors() {
+                    m_anchorsValid = false;
+                }
+
                 inline bool empty() const {
                     return m_entries.empty();
                 }
 
                 inline void clear()  {
                     m_entries.clear();
+                    m_grid.clear();
+                    m_geometryValid = false;
                 }
 
                 inline void setFadeDistance(float fadeDistance)  {
+                    if (fadeDistance == m_fadeDistance)
+                        return;
                     m_fadeDistance = fadeDistance;
+                    validateGrid();
                 }
 
+                /**
+                 * Renders the strings within the fade distance. The glyph quads and background rectangles of all
+                 * strings stay in the vertex arrays between frames. Every vertex stores the position of its anchor
+                 * and its screen space offset, and the given shader programs project the anchor and apply the
+                 * offset, so nothing needs to be rewritten when the camera moves.
+                 */
                 void render(RenderContext& context, const TextRendererFilter& filter, ShaderProgram& textProgram, const Color& textColor, ShaderProgram& backgroundProgram, const Color& backgroundColor) {
                     if (m_entries.empty())
                         return;
 
-                    EntryList entries = visibleEntries(context, filter);
-                    if (entries.empty())
-                        return;
-
-                    if (m_vbo == NULL)
-                        m_vbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
-
-                    size_t textVertexCount = 0;
-                    for (size_t i = 0; i < entries.size(); i++) {
-                        const TextEntry& entry = entries[i];
-                        textVertexCount += entry.vertices().size() / 2;
-                    }
-
-                    VertexArray textArray(*m_vbo, GL_QUADS, static_cast<unsigned int>(textVertexCount),
-                                          Attribute::position3f(),
-                                          Attribute::texCoord02f());
-
-                    size_t rectVertexCount = 3 * 16 * entries.size(); // 16 triangles (for a rounded rect with 3 triangles per corner: 3 * 4 + 4 = 16)
-                    VertexArray rectArray(*m_vbo, GL_TRIANGLES, static_cast<unsigned int>(rectVertexCount),
-                                          Attribute::position3f());
-
-                    SetVboState mapVbo(*m_vbo, Vbo::VboMapped);
-                    for (size_t i = 0; i < entries.size(); i++) {
-                        const TextEntry& entry = entries[i];
-                        const Vec2f& size = entry.size().rounded();
-                        const TextAnchor& anchor = entry.textAnchor();
-                        const Vec3f offset = anchor.offset(context.camera(), size);
-
-                        const Vec2f::List& textVertices = entry.vertices();
-                        for (size_t j = 0; j < textVertices.size() / 2; j++) {
-                            const Vec2f& vertex = textVertices[2 * j];
-                            const Vec2f& texCoords = textVertices[2 * j + 1];
-
-                            textArray.addAttribute(Vec3f(vertex.x() + offset.x(), vertex.y() + offset.y(), -offset.z()));
-                            textArray.addAttribute(texCoords);
-                        }
+                    if (!m_anchorsValid)
+                        validateAnchors();
+                    if (!m_geometryValid)
+                        validateGeometry();
 
-                        Vec2f::List rectVertices;
-                        rectVertices.reserve(3 * 16);
-                        roundedRect(size.x() + 2.0f * m_hInset, size.y() + 2.0f * m_vInset, 3.0f, 3, rectVertices);
-                        for (size_t j = 0; j < rectVertices.size(); j++) {
-                            const Vec2f& vertex = rectVertices[j];
-                            rectArray.addAttribute(Vec3f(vertex.x() + offset.x() + size.x() / 2.0f, vertex.y() + offset.y() + size.y() / 2.0f, -offset.z()));
-                        }
-                    }
-
-                    const Camera::Viewport& viewport = context.camera().viewport();
-
-                    const Mat4f projection = orthoMatrix(0.0f, 1.0f,
-                                                         static_cast<float>(viewport.x),
-                                                         static_cast<float>(viewport.height),
-                                                         static_cast<float>(viewport.width),
-                                                         static_cast<float>(viewport.y));
-                    const Mat4f view = viewMatrix(Vec3f::NegZ, Vec3f::PosY);
+                    collectVisibleEntries(context, filter);
+                    if (m_textIndices.empty())
+                        return;
 
-                    ApplyTransformation ortho(context.transformation(), projection, view);
+                    const Camera& camera = context.camera();
+                    const Camera::Viewport& viewport = camera.viewport();
+                    const Mat4f& cameraMatrix = camera.matrix();
+                    const Vec4f viewportVec(static_cast<float>(viewport.x),
+                                            static_cast<float>(viewport.y),
+                                            static_cast<float>(viewport.width),
+                                            static_cast<float>(viewport.height));
 
                     SetVboState activateVbo(*m_vbo, Vbo::VboActive);
                     glDepthMask(GL_FALSE);
 
                     if (backgroundProgram.activate()) {
+                        backgroundProgram.setUniformVariable("CameraMatrix", cameraMatrix);
+                        backgroundProgram.setUniformVariable("Viewport", viewportVec);
                         backgroundProgram.setUniformVariable("Color", backgroundColor);
-                        rectArray.render();
+                        m_rectArray->render(m_rectIndices, m_rectCounts);
                         backgroundProgram.deactivate();
                     }
 
                     if (textProgram.activate()) {
+                        textProgram.setUniformVariable("CameraMatrix", cameraMatrix);
+                        textProgram.setUniformVariable("Viewport", viewportVec);
                         textProgram.setUniformVariable("Color", textColor);
                         textProgram.setUniformVariable("Texture", 0);
                         m_font.activate();
-                        textArray.render();
+                        m_textArray->render(m_textIndices, m_textCounts);
                         m_font.deactivate();
                         textProgram.deactivate();
                     }
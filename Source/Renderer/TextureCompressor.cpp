@@ -0,0 +1,236 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+namespace TrenchBroom {
+    namespace Renderer {
+        static inline unsigned short packRgb565(const unsigned char* color) {
+            const unsigned int r = (static_cast<unsigned int>(color[0]) * 31 + 127) / 255;
+            const unsigned int g = (static_cast<unsigned int>(color[1]) * 63 + 127) / 255;
+            const unsigned int b = (static_cast<unsigned int>(color[2]) * 31 + 127) / 255;
+            return static_cast<unsigned short>((r << 11) | (g << 5) | b);
+        }
+        
+        static inline void unpackRgb565(unsigned short packed, int* color) {
+            const int r = (packed >> 11) & 0x1F;
+            const int g = (packed >> 5) & 0x3F;
+            const int b = packed & 0x1F;
+            color[0] = (r << 3) | (r >> 2);
+            color[1] = (g << 2) | (g >> 4);
+            color[2] = (b << 3) | (b >> 2);
+        }
+        
+        static inline void writeShort(unsigned short value, unsigned char* result) {
+            result[0] = static_cast<unsigned char>(value & 0xFF);
+            result[1] = static_cast<unsigned char>(value >> 8);
+        }
+        
+        /**
+         * Copies the pixels of the block at the given position, repeating the last row and column of the image for
+         * blocks which extend beyond its bounds.
+         */
+        static void fetchBlock(const unsigned char* image, unsigned int componentCount, unsigned int width, unsigned int height, unsigned int blockX, unsigned int blockY, unsigned char* block) {
+            for (unsigned int y = 0; y < 4; y++) {
+                const unsigned int imageY = std::min(blockY + y, height - 1);
+                for (unsigned int x = 0; x < 4; x++) {
+                    const unsigned int imageX = std::min(blockX + x, width - 1);
+                    const unsigned char* pixel = image + (imageY * width + imageX) * componentCount;
+                    memcpy(block + (y * 4 + x) * componentCount, pixel, componentCount);
+                }
+            }
+        }
+        
+        static void encodeColorBlock(const unsigned char* block, unsigned char* result) {
+            // find the principal axis of the colors by power iteration on their covariance matrix
+            float mean[3] = { 0.0f, 0.0f, 0.0f };
+            for (unsigned int i = 0; i < 16; i++)
+                for (unsigned int j = 0; j < 3; j++)
+                    mean[j] += block[i * 3 + j];
+            for (unsigned int j = 0; j < 3; j++)
+                mean[j] /= 16.0f;
+            
+            float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+            for (unsigned int i = 0; i < 16; i++) {
+                const float r = block[i * 3 + 0] - mean[0];
+                const float g = block[i * 3 + 1] - mean[1];
+                const float b = block[i * 3 + 2] - mean[2];
+                covariance[0] += r * r;
+                covariance[1] += r * g;
+                covariance[2] += r * b;
+                covariance[3] += g * g;
+                covariance[4] += g * b;
+                covariance[5] += b * b;
+            }
+            
+            float axis[3] = { 1.0f, 1.0f, 1.0f };
+            for (unsigned int iteration = 0; iteration < 4; iteration++) {
+                const float r = axis[0] * covariance[0] + axis[1] * covariance[1] + axis[2] * covariance[2];
+                const float g = axis[0] * covariance[1] + axis[1] * covariance[3] + axis[2] * covariance[4];
+                const float b = axis[0] * covariance[2] + axis[1] * covariance[4] + axis[2] * covariance[5];
+                const float length = std::max(std::max(std::abs(r), std::abs(g)), std::abs(b));
+                if (length == 0.0f)
+                    break;
+                axis[0] = r / length;
+                axis[1] = g / length;
+                axis[2] = b / length;
+            }
+            
+            // the colors with the smallest and the largest projection onto the axis become the end points
+            unsigned int minIndex = 0;
+            unsigned int maxIndex = 0;
+            float minDot = 0.0f;
+            float maxDot = 0.0f;
+            for (unsigned int i = 0; i < 16; i++) {
+                const float dot = block[i * 3 + 0] * axis[0] + block[i * 3 + 1] * axis[1] + block[i * 3 + 2] * axis[2];
+                if (i == 0 || dot < minDot) {
+                    minDot = dot;
+                    minIndex = i;
+                }
+                if (i == 0 || dot > maxDot) {
+                    maxDot = dot;
+                    maxIndex = i;
+                }
+            }
+            
+            unsigned short color0 = packRgb565(block + maxIndex * 3);
+            unsigned short color1 = packRgb565(block + minIndex * 3);
+            
+            // the first color must be the larger one, otherwise the decoder uses the three color mode
+            if (color0 < color1)
+                std::swap(color0, color1);
+            
+            writeShort(color0, result);
+            writeShort(color1, result + 2);
+            if (color0 == color1) {
+                memset(result + 4, 0, 4);
+                return;
+            }
+            
+            int palette[4][3];
+            unpackRgb565(color0, palette[0]);
+            unpackRgb565(color1, palette[1]);
+            for (unsigned int j = 0; j < 3; j++) {
+                palette[2][j] = (2 * palette[0][j] + palette[1][j]) / 3;
+                palette[3][j] = (palette[0][j] + 2 * palette[1][j]) / 3;
+            }
+            
+            unsigned int indices = 0;
+            for (unsigned int i = 0; i < 16; i++) {
+                unsigned int bestIndex = 0;
+                int bestDistance = 0;
+                for (unsigned int k = 0; k < 4; k++) {
+                    int distance = 0;
+                    for (unsigned int j = 0; j < 3; j++) {
+                        const int delta = static_cast<int>(block[i * 3 + j]) - palette[k][j];
+                        distance += delta * delta;
+                    }
+                    if (k == 0 || distance < bestDistance) {
+                        bestDistance = distance;
+                        bestIndex = k;
+                    }
+                }
+                indices |= bestIndex << (2 * i);
+            }
+            
+            for (unsigned int i = 0; i < 4; i++)
+                result[4 + i] = static_cast<unsigned char>((indices >> (8 * i)) & 0xFF);
+        }
+        
+        static void encodeAlphaBlock(const unsigned char* block, unsigned char* result) {
+            unsigned char alpha0 = block[0];
+            unsigned char alpha1 = block[0];
+            for (unsigned int i = 1; i < 16; i++) {
+                alpha0 = std::max(alpha0, block[i]);
+                alpha1 = std::min(alpha1, block[i]);
+            }
+            
+            result[0] = alpha0;
+            result[1] = alpha1;
+            if (alpha0 == alpha1) {
+                memset(result + 2, 0, 6);
+                return;
+            }
+            
+            // since the first alpha value is larger, the decoder interpolates six values between the end points
+            int palette[8];
+            palette[0] = alpha0;
+            palette[1] = alpha1;
+            for (int i = 1; i < 7; i++)
+                palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+            
+            uint64_t indices = 0;
+            for (unsigned int i = 0; i < 16; i++) {
+                unsigned int bestIndex = 0;
+                int bestDistance = 256;
+                for (unsigned int k = 0; k < 8; k++) {
+                    const int distance = std::abs(static_cast<int>(block[i]) - palette[k]);
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        bestIndex = k;
+                    }
+                }
+                indices |= static_cast<uint64_t>(bestIndex) << (3 * i);
+            }
+            
+            for (unsigned int i = 0; i < 6; i++)
+                result[2 + i] = static_cast<unsigned char>((indices >> (8 * i)) & 0xFF);
+        }
+        
+        size_t TextureCompressor::compressedSize(Format format, unsigned int width, unsigned int height) {
+            const size_t blockCount = static_cast<size_t>((width + 3) / 4) * static_cast<size_t>((height + 3) / 4);
+            return blockCount * (format == BC1 ? 8 : 16);
+        }
+        
+        void TextureCompressor::compress(Format format, const unsigned char* rgbImage, const unsigned char* alphaImage, unsigned int width, unsigned int height, unsigned char* result) {
+            assert(rgbImage != NULL);
+            assert(format == BC1 || alphaImage != NULL);
+            assert(width > 0 && height > 0);
+            
+            unsigned char colorBlock[16 * 3];
+            unsigned char alphaBlock[16];
+            
+            for (unsigned int blockY = 0; blockY < height; blockY += 4) {
+                for (unsigned int blockX = 0; blockX < width; blockX += 4) {
+                    if (format == BC3) {
+                        fetchBlock(alphaImage, 1, width, height, blockX, blockY, alphaBlock);
+                        encodeAlphaBlock(alphaBlock, result);
+                        result += 8;
+                    }
+                    
+                    fetchBlock(rgbImage, 3, width, height, blockX, blockY, colorBlock);
+                    encodeColorBlock(colorBlock, result);
+                    result += 8;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__TextureCompressor__
+#define __TrenchBroom__TextureCompressor__
+
+#include <cstddef>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        /**
+         * Encodes images into the block compressed formats BC1 (DXT1) and BC3 (DXT5). Every block of 4x4 pixels is
+         * encoded independently by fitting a line through its colors, so the encoder is fast enough to compress the
+         * textures of a wad when it is loaded. The functions only read their arguments and can be called
+         * concurrently.
+         */
+        class TextureCompressor {
+        public:
+            typedef enum {
+                BC1 = 1,
+                BC3 = 3
+            } Format;
+            
+            static size_t compressedSize(Format format, unsigned int width, unsigned int height);
+            
+            /**
+             * Compresses the given image with three bytes per pixel into the given buffer, which must be large enough
+             * to hold compressedSize(format, width, height) bytes. The alpha image with one byte per pixel is only
+             * used for BC3, where it must not be NULL.
+             */
+            static void compress(Format format, const unsigned char* rgbImage, const unsigned char* alphaImage, unsigned int width, unsigned int height, unsigned char* result);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__TextureCompressor__) */
@@ -23,6 +23,10 @@
 #include "Model/Bsp.h"
 #include "Model/Alias.h"
 #include "Renderer/Palette.h"
+#include "Utility/Preferences.h"
+
+#include <cassert>
+#include <cstring>
 
 namespace TrenchBroom {
     namespace Renderer {
@@ -30,6 +34,8 @@ namespace TrenchBroom {
             m_width = width;
             m_height = height;
             m_textureBuffer = NULL;
+            m_compressedFormat = 0;
+            m_compressedSize = 0;
 			m_textureId = 0;
         }
         
@@ -38,11 +44,36 @@ namespace TrenchBroom {
             m_textureBuffer = rgbImage;
         }
         
+        void TextureRenderer::createTexture(const GLvoid* pixels) {
+            assert(!uploaded());
+            
+            glGenTextures(1, &m_textureId);
+            glBindTexture(GL_TEXTURE_2D, m_textureId);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            if (m_compressedFormat != 0)
+                glCompressedTexImage2D(GL_TEXTURE_2D, 0, m_compressedFormat, static_cast<GLsizei>(m_width), static_cast<GLsizei>(m_height), 0, static_cast<GLsizei>(m_compressedSize), pixels);
+            else
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(m_width), static_cast<GLsizei>(m_height), 0, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+            
+            delete [] m_textureBuffer;
+            m_textureBuffer = NULL;
+        }
+        
         TextureRenderer::TextureRenderer(unsigned char* rgbImage, const Color& averageColor, unsigned int width, unsigned int height) :
         m_averageColor(averageColor) {
             init(rgbImage, width, height);
         }
         
+        TextureRenderer::TextureRenderer(unsigned char* compressedImage, size_t size, TextureCompressor::Format format, const Color& averageColor, unsigned int width, unsigned int height) :
+        m_averageColor(averageColor) {
+            init(compressedImage, width, height);
+            m_compressedFormat = format == TextureCompressor::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            m_compressedSize = size;
+        }
+        
         TextureRenderer::TextureRenderer(const Model::AliasSkin& skin, unsigned int skinIndex, const Palette& palette) {
             init(skin.width(), skin.height());
             m_textureBuffer = new unsigned char[m_width * m_height * 3];
@@ -69,20 +100,27 @@ namespace TrenchBroom {
                 delete [] m_textureBuffer;
         }
 
+        bool TextureRenderer::compressionSupported() {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            return prefs.getBool(Preferences::RendererTextureCompression) && GLEW_EXT_texture_compression_s3tc;
+        }
+
+        void TextureRenderer::copyImage(unsigned char* buffer) const {
+            assert(!uploaded());
+            std::memcpy(buffer, m_textureBuffer, imageSize());
+        }
+        
+        void TextureRenderer::upload() {
+            createTexture(m_textureBuffer);
+        }
+        
+        void TextureRenderer::upload(size_t pixelBufferOffset) {
+            createTexture(reinterpret_cast<const GLvoid*>(pixelBufferOffset));
+        }
+        
         void TextureRenderer::activate() {
-            if (m_textureId == 0) {
-                if (m_textureBuffer != NULL) {
-                    glGenTextures(1, &m_textureId);
-                    glBindTexture(GL_TEXTURE_2D, m_textureId);
-                    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-                    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-                    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-                    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(m_width), static_cast<GLsizei>(m_height), 0, GL_RGB, GL_UNSIGNED_BYTE, m_textureBuffer);
-                    delete [] m_textureBuffer;
-                    m_textureBuffer = NULL;
-                }
-            }
+            if (m_textureId == 0 && m_textureBuffer != NULL)
+                upload();
             
             glBindTexture(GL_TEXTURE_2D, m_textureId);
         }
@@ -21,8 +21,11 @@
 #define __TrenchBroom__TextureRenderer__
 
 #include <GL/glew.h>
+#include "Renderer/TextureCompressor.h"
 #include "Utility/Color.h"
 
+#include <cstddef>
+
 namespace TrenchBroom {
     namespace IO {
         class Mip;
@@ -42,25 +45,72 @@ namespace TrenchBroom {
             unsigned int m_width;
             unsigned int m_height;
             unsigned char* m_textureBuffer;
+            GLenum m_compressedFormat;
+            size_t m_compressedSize;
             Color m_averageColor;
             
             void init(unsigned int width, unsigned int height);
             void init(unsigned char* rgbImage, unsigned int width, unsigned int height);
+            void createTexture(const GLvoid* pixels);
 
             // prevent copying
             TextureRenderer(const TextureRenderer& other);
             void operator= (const TextureRenderer& other);
         public:
             TextureRenderer(unsigned char* rgbImage, const Color& averageColor, unsigned int width, unsigned int height);
+            TextureRenderer(unsigned char* compressedImage, size_t size, TextureCompressor::Format format, const Color& averageColor, unsigned int width, unsigned int height);
             TextureRenderer(const Model::AliasSkin& skin, unsigned int skinIndex, const Palette& palette);
             TextureRenderer(const Model::BspTexture& texture, const Palette& palette);
             TextureRenderer();
             ~TextureRenderer();
+            
+            /**
+             * Returns whether the textures of wad files should be compressed, which requires the S3TC extension and
+             * must be enabled in the preferences.
+             */
+            static bool compressionSupported();
 
             inline const Color& averageColor() const {
                 return m_averageColor;
             }
             
+            /**
+             * Returns whether the texture image has already been uploaded, which happens when the texture is
+             * activated for the first time or when its request in the TextureUploadQueue is processed.
+             */
+            inline bool uploaded() const {
+                return m_textureId != 0 || m_textureBuffer == NULL;
+            }
+            
+            /**
+             * Returns the number of bytes of the image which has yet to be uploaded, or 0 if the texture has already
+             * been uploaded.
+             */
+            inline size_t imageSize() const {
+                if (uploaded())
+                    return 0;
+                if (m_compressedFormat != 0)
+                    return m_compressedSize;
+                return static_cast<size_t>(m_width) * static_cast<size_t>(m_height) * 3;
+            }
+            
+            /**
+             * Copies the image which has yet to be uploaded into the given buffer, which must hold at least
+             * imageSize() bytes.
+             */
+            void copyImage(unsigned char* buffer) const;
+            
+            /**
+             * Uploads the image from client memory.
+             */
+            void upload();
+            
+            /**
+             * Uploads the image from the given offset of the currently bound pixel unpack buffer, into which it must
+             * have been copied by copyImage.
+             */
+            void upload(size_t pixelBufferOffset);
+            
             void activate();
             void deactivate();
         };
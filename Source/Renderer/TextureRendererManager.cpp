@@ -19,36 +19,192 @@
 
 #include "TextureRendererManager.h"
 
+#include "IO/FileManager.h"
+#include "IO/IOException.h"
+#include "IO/TextureCache.h"
+#include "IO/Wad.h"
 #include "Model/Texture.h"
 #include "Model/TextureManager.h"
+#include "Renderer/Palette.h"
+#include "Renderer/TextureCompressor.h"
 #include "Renderer/TextureRenderer.h"
-#include "Utility/Map.h"
+#include "Utility/Console.h"
+#include "Utility/List.h"
+#include "Utility/Parallel.h"
 
 #include <cassert>
-#include <exception>
+
+#include <wx/stopwatch.h>
 
 namespace TrenchBroom {
     namespace Renderer {
-        TextureRendererCollection::TextureRendererCollection(Model::TextureCollection& textureCollection, const Palette& palette) {
+        class CompressTexturesTask : public Utility::ParallelTask {
+        private:
+            const Model::TextureCollectionLoader& m_loader;
+            const Palette& m_palette;
+            const Model::TextureList& m_textures;
+            IO::TextureCache::Entry::List& m_entries;
+        public:
+            CompressTexturesTask(const Model::TextureCollectionLoader& loader, const Palette& palette, const Model::TextureList& textures, IO::TextureCache::Entry::List& entries) :
+            m_loader(loader),
+            m_palette(palette),
+            m_textures(textures),
+            m_entries(entries) {}
+
+            void run(size_t index) {
+                // every texture has its own entry, and the loader only reads from the mapped wad file
+                const Model::Texture& texture = *m_textures[index];
+                IO::Mip* mip = m_loader.loadMip(texture);
+                if (mip == NULL)
+                    return;
+
+                const unsigned int width = mip->width();
+                const unsigned int height = mip->height();
+                const size_t pixelCount = width * height;
+
+                Color averageColor;
+                unsigned char* rgbImage = new unsigned char[pixelCount * 3];
+                m_palette.indexedToRgb(mip->mip0(), rgbImage, pixelCount, averageColor);
+
+                // the last palette index marks the transparent pixels of textures whose names start with '{'
+                TextureCompressor::Format format = TextureCompressor::BC1;
+                unsigned char* alphaImage = NULL;
+                if (!texture.name().empty() && texture.name()[0] == '{') {
+                    format = TextureCompressor::BC3;
+                    alphaImage = new unsigned char[pixelCount];
+                    for (size_t i = 0; i < pixelCount; i++)
+                        alphaImage[i] = mip->mip0()[i] == 0xFF ? 0x00 : 0xFF;
+                }
+
+                const size_t size = TextureCompressor::compressedSize(format, width, height);
+                unsigned char* compressedImage = new unsigned char[size];
+                TextureCompressor::compress(format, rgbImage, alphaImage, width, height, compressedImage);
+
+                delete [] alphaImage;
+                delete [] rgbImage;
+                delete mip;
+
+                m_entries[index] = new IO::TextureCache::Entry(texture.name(), static_cast<uint8_t>(format), width, height, averageColor, compressedImage, size);
+            }
+        };
+
+        static bool validCacheEntry(const IO::TextureCache::Entry& entry) {
+            if (entry.format() != TextureCompressor::BC1 && entry.format() != TextureCompressor::BC3)
+                return false;
+            const TextureCompressor::Format format = static_cast<TextureCompressor::Format>(entry.format());
+            return entry.size() == TextureCompressor::compressedSize(format, entry.width(), entry.height());
+        }
+
+        static bool loadTextureCache(const IO::TextureCache::Key& key, IO::TextureCache::Entry::List& entries, Utility::Console& console) {
+            const String cachePath = IO::TextureCache::cachePath(key);
+            IO::FileManager fileManager;
+            if (!fileManager.exists(cachePath))
+                return false;
+
+            IO::MappedFile::Ptr cacheFile = fileManager.mapFile(cachePath);
+            if (cacheFile.get() == NULL)
+                return false;
+
+            try {
+                IO::TextureCacheReader reader(cacheFile->begin(), cacheFile->end());
+                if (!reader.read(key, entries)) {
+                    console.info("Texture cache %s is out of date", cachePath.c_str());
+                    return false;
+                }
+            } catch (IO::IOException& e) {
+                console.warn("Could not read texture cache %s: %s", cachePath.c_str(), e.what());
+                return false;
+            }
+
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (!validCacheEntry(*entries[i])) {
+                    console.warn("Could not read texture cache %s: Invalid texture %s", cachePath.c_str(), entries[i]->name().c_str());
+                    Utility::deleteAll(entries);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static void writeTextureCache(const IO::TextureCache::Key& key, const IO::TextureCache::Entry::List& entries, Utility::Console& console) {
+            std::vector<char> buffer;
+            IO::TextureCacheWriter writer;
+            writer.writeToBuffer(key, entries, buffer);
+
+            const String cachePath = IO::TextureCache::cachePath(key);
+            if (!IO::BinaryCache::writeFile(cachePath, buffer))
+                console.warn("Could not write texture cache %s", cachePath.c_str());
+        }
+
+        void TextureRendererCollection::addRenderer(const String& name, TextureRenderer* textureRenderer) {
             typedef std::pair<TextureRendererMap::iterator, bool> InsertResult;
+            InsertResult result = m_textures.insert(TextureRendererEntry(name, textureRenderer));
+            if (!result.second)
+                delete textureRenderer;
+        }
 
+        void TextureRendererCollection::loadUncompressed(const Model::TextureCollection& textureCollection, const Palette& palette) {
             Color averageColor;
             Model::TextureCollection::LoaderPtr loader = textureCollection.loader();
 
             const Model::TextureList& textures = textureCollection.textures();
             for (unsigned int i = 0; i < textures.size(); i++) {
                 Model::Texture& texture = *textures[i];
+                if (m_textures.count(texture.name()) > 0)
+                    continue;
+                
                 unsigned char* textureImage = loader->load(texture, palette, averageColor);
-                if (textureImage != NULL) {
-                    TextureRenderer* textureRenderer = new TextureRenderer(textureImage, averageColor, texture.width(), texture.height());
-                    InsertResult result = m_textures.insert(TextureRendererEntry(&texture, textureRenderer));
-                    assert(result.second);
-                }
+                if (textureImage != NULL)
+                    addRenderer(texture.name(), new TextureRenderer(textureImage, averageColor, texture.width(), texture.height()));
+            }
+        }
+
+        bool TextureRendererCollection::loadCompressed(const Model::TextureCollection& textureCollection, const Palette& palette, Utility::Console& console) {
+            IO::FileManager fileManager;
+            IO::MappedFile::Ptr wadFile = fileManager.mapFile(textureCollection.path());
+            if (wadFile.get() == NULL)
+                return false;
+
+            const char* paletteData = reinterpret_cast<const char*>(palette.data());
+            const IO::TextureCache::Key key(wadFile->begin(), wadFile->end(), paletteData, paletteData + palette.size());
+
+            IO::TextureCache::Entry::List entries;
+            if (!loadTextureCache(key, entries, console)) {
+                wxStopWatch watch;
+                Model::TextureCollection::LoaderPtr loader = textureCollection.loader();
+                const Model::TextureList& textures = textureCollection.textures();
+
+                IO::TextureCache::Entry::List compressedEntries(textures.size(), NULL);
+                CompressTexturesTask task(*loader, palette, textures, compressedEntries);
+                Utility::runParallel(task, textures.size());
+
+                // textures which could not be loaded have no entry
+                for (size_t i = 0; i < compressedEntries.size(); i++)
+                    if (compressedEntries[i] != NULL)
+                        entries.push_back(compressedEntries[i]);
+
+                console.info("Compressed %u textures of %s in %f seconds", static_cast<unsigned int>(entries.size()), textureCollection.name().c_str(), watch.Time() / 1000.0f);
+                writeTextureCache(key, entries, console);
+            }
+
+            for (size_t i = 0; i < entries.size(); i++) {
+                IO::TextureCache::Entry& entry = *entries[i];
+                const TextureCompressor::Format format = static_cast<TextureCompressor::Format>(entry.format());
+                const size_t size = entry.size();
+                addRenderer(entry.name(), new TextureRenderer(entry.releaseData(), size, format, entry.averageColor(), entry.width(), entry.height()));
             }
+
+            Utility::deleteAll(entries);
+            return true;
+        }
+
+        TextureRendererCollection::TextureRendererCollection(const Model::TextureCollection& textureCollection, const Palette& palette, Utility::Console& console) {
+            if (!TextureRenderer::compressionSupported() || !loadCompressed(textureCollection, palette, console))
+                loadUncompressed(textureCollection, palette);
         }
         
-        TextureRenderer* TextureRendererCollection::renderer(Model::Texture& texture) const {
-            TextureRendererMap::const_iterator it = m_textures.find(&texture);
+        TextureRenderer* TextureRendererCollection::renderer(const Model::Texture& texture) const {
+            TextureRendererMap::const_iterator it = m_textures.find(texture.name());
             if (it == m_textures.end())
                 return NULL;
             return it->second;
@@ -61,18 +217,39 @@ namespace TrenchBroom {
             m_textures.clear();
         }
 
+        TextureRendererManager::CollectionKey::CollectionKey(const Model::TextureCollection& collection) :
+        path(collection.path()),
+        modificationTime(collection.modificationTime()) {}
+
         void TextureRendererManager::clear() {
-            Utility::deleteAll(m_textureCollections);
+            // the collections stay retained, their renderers are created again when they are requested
+            m_uploadQueue.clear();
+            SharedCollectionMap::iterator it, end;
+            for (it = m_sharedCollections.begin(), end = m_sharedCollections.end(); it != end; ++it) {
+                SharedCollection& sharedCollection = it->second;
+                delete sharedCollection.renderers;
+                sharedCollection.renderers = NULL;
+            }
+        }
+
+        void TextureRendererManager::deleteReleasedCollections() {
+            if (m_releasedCollections.empty())
+                return;
+            m_uploadQueue.clear();
+            Utility::deleteAll(m_releasedCollections);
         }
 
-        TextureRendererManager::TextureRendererManager(Model::TextureManager& textureManager) :
-        m_textureManager(textureManager),
+        TextureRendererManager::TextureRendererManager(Utility::Console& console) :
+        m_console(console),
         m_dummyTexture(new TextureRenderer()),
         m_palette(NULL),
         m_valid(true) {}
         
         TextureRendererManager::~TextureRendererManager() {
             clear();
+            deleteReleasedCollections();
+            m_sharedCollections.clear();
+            m_bindings.clear();
             delete m_dummyTexture;
             m_dummyTexture = NULL;
         }
@@ -80,6 +257,7 @@ namespace TrenchBroom {
         TextureRenderer& TextureRendererManager::renderer(Model::Texture* texture) {
             assert(m_palette != NULL);
             
+            deleteReleasedCollections();
             if (!m_valid) {
                 clear();
                 m_valid = true;
@@ -88,24 +266,46 @@ namespace TrenchBroom {
             if (texture == NULL)
                 return *m_dummyTexture;
             
-            Model::TextureCollection& collection = texture->collection();
-            TextureRendererCollection* rendererCollection = NULL;
-            TextureRendererCollectionMap::iterator it = m_textureCollections.find(&collection);
-            if (it == m_textureCollections.end()) {
-                rendererCollection = new TextureRendererCollection(collection, *m_palette);
-                m_textureCollections[&collection] = rendererCollection;
+            const Model::TextureCollection& collection = texture->collection();
+            SharedCollectionMap::iterator sharedIt;
+            CollectionBindingMap::iterator bindingIt = m_bindings.find(&collection);
+            if (bindingIt == m_bindings.end()) {
+                sharedIt = m_sharedCollections.insert(SharedCollectionEntry(CollectionKey(collection), SharedCollection())).first;
+                sharedIt->second.retainCount++;
+                m_bindings[&collection] = sharedIt;
             } else {
-                rendererCollection = it->second;
+                sharedIt = bindingIt->second;
             }
 
-            if (rendererCollection == NULL)
-                return *m_dummyTexture;
+            SharedCollection& sharedCollection = sharedIt->second;
+            if (sharedCollection.renderers == NULL)
+                sharedCollection.renderers = new TextureRendererCollection(collection, *m_palette, m_console);
             
-            TextureRenderer* textureRenderer = rendererCollection->renderer(*texture);
+            TextureRenderer* textureRenderer = sharedCollection.renderers->renderer(*texture);
             if (textureRenderer == NULL)
                 return *m_dummyTexture;
 
             return *textureRenderer;
         }
+
+        void TextureRendererManager::releaseCollections(const Model::TextureCollectionList& collections) {
+            Model::TextureCollectionList::const_iterator it, end;
+            for (it = collections.begin(), end = collections.end(); it != end; ++it) {
+                CollectionBindingMap::iterator bindingIt = m_bindings.find(*it);
+                if (bindingIt == m_bindings.end())
+                    continue;
+                
+                SharedCollectionMap::iterator sharedIt = bindingIt->second;
+                m_bindings.erase(bindingIt);
+                
+                SharedCollection& sharedCollection = sharedIt->second;
+                assert(sharedCollection.retainCount > 0);
+                if (--sharedCollection.retainCount == 0) {
+                    if (sharedCollection.renderers != NULL)
+                        m_releasedCollections.push_back(sharedCollection.renderers);
+                    m_sharedCollections.erase(sharedIt);
+                }
+            }
+        }
     }
 }
@@ -21,14 +21,28 @@
 #define __TrenchBroom__TextureRendererManager__
 
 #include "Model/Texture.h"
+#include "Model/TextureTypes.h"
+#include "Renderer/TextureUploadQueue.h"
+#include "Utility/String.h"
 
+#include <ctime>
 #include <map>
+#include <vector>
+
+#if defined _WIN32
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif
 
 namespace TrenchBroom {
     namespace Model {
         class Texture;
         class TextureCollection;
-        class TextureManager;
+    }
+    
+    namespace Utility {
+        class Console;
     }
     
     namespace Renderer {
@@ -37,31 +51,84 @@ namespace TrenchBroom {
         
         class TextureRendererCollection {
         protected:
-            typedef std::map<Model::Texture*, TextureRenderer*> TextureRendererMap;
-            typedef std::pair<Model::Texture*, TextureRenderer*> TextureRendererEntry;
+            typedef std::tr1::unordered_map<String, TextureRenderer*> TextureRendererMap;
+            typedef std::pair<String, TextureRenderer*> TextureRendererEntry;
             
             TextureRendererMap m_textures;
+            
+            void addRenderer(const String& name, TextureRenderer* textureRenderer);
+            void loadUncompressed(const Model::TextureCollection& textureCollection, const Palette& palette);
+            
+            /**
+             * Creates compressed renderers from the texture cache, or compresses the textures on the worker threads
+             * and stores them in the cache if it is missing or out of date. Returns false if the wad file cannot
+             * be read, in which case the textures must be loaded uncompressed.
+             */
+            bool loadCompressed(const Model::TextureCollection& textureCollection, const Palette& palette, Utility::Console& console);
         public:
-            TextureRendererCollection(Model::TextureCollection& textureCollection, const Palette& palette);
+            TextureRendererCollection(const Model::TextureCollection& textureCollection, const Palette& palette, Utility::Console& console);
             ~TextureRendererCollection();
             
-            TextureRenderer* renderer(Model::Texture& texture) const;
+            TextureRenderer* renderer(const Model::Texture& texture) const;
         };
         
+        /**
+         * Creates and caches the renderers for the textures of all open documents. Texture collections which were
+         * loaded from the same wad file are identified by the path and the modification time of the file, so every
+         * wad is only decoded and uploaded once, no matter how many documents use it.
+         *
+         * A texture collection of a document retains the shared renderers when one of its textures is rendered for
+         * the first time. The documents must release their collections before deleting them, and the renderers of a
+         * wad are deleted once no collection retains them anymore.
+         */
         class TextureRendererManager {
         protected:
-            typedef std::map<Model::TextureCollection*, TextureRendererCollection*> TextureRendererCollectionMap;
-            typedef std::pair<Model::TextureCollection*, TextureRendererCollection*> TextureRendererCollectionEntry;
+            class CollectionKey {
+            public:
+                String path;
+                time_t modificationTime;
+                
+                CollectionKey(const Model::TextureCollection& collection);
+                
+                inline bool operator< (const CollectionKey& other) const {
+                    if (modificationTime != other.modificationTime)
+                        return modificationTime < other.modificationTime;
+                    return path < other.path;
+                }
+            };
             
-            Model::TextureManager& m_textureManager;
+            class SharedCollection {
+            public:
+                TextureRendererCollection* renderers;
+                unsigned int retainCount;
+                
+                SharedCollection() :
+                renderers(NULL),
+                retainCount(0) {}
+            };
+            
+            typedef std::map<CollectionKey, SharedCollection> SharedCollectionMap;
+            typedef std::pair<CollectionKey, SharedCollection> SharedCollectionEntry;
+            typedef std::map<const Model::TextureCollection*, SharedCollectionMap::iterator> CollectionBindingMap;
+            typedef std::vector<TextureRendererCollection*> TextureRendererCollectionList;
+            
+            Utility::Console& m_console;
             TextureRenderer* m_dummyTexture;
             Palette* m_palette;
-            TextureRendererCollectionMap m_textureCollections;
+            SharedCollectionMap m_sharedCollections;
+            CollectionBindingMap m_bindings;
+            TextureRendererCollectionList m_releasedCollections;
+            TextureUploadQueue m_uploadQueue;
             bool m_valid;
 
             void clear();
+            void deleteReleasedCollections();
+            
+            // prevent copying
+            TextureRendererManager(const TextureRendererManager& other);
+            void operator= (const TextureRendererManager& other);
         public:
-            TextureRendererManager(Model::TextureManager& textureManager);
+            TextureRendererManager(Utility::Console& console);
             ~TextureRendererManager();
             
             inline void setPalette(Palette& palette) {
@@ -73,9 +140,16 @@ namespace TrenchBroom {
             
             TextureRenderer& renderer(Model::Texture* texture);
             
-            inline void invalidate() {
-                m_valid = false;
+            inline TextureUploadQueue& uploadQueue() {
+                return m_uploadQueue;
             }
+            
+            /**
+             * Releases the renderers retained by the given collections. Must be called before the collections are
+             * deleted. The renderers which are not used by any other collection anymore are deleted the next time a
+             * renderer is requested, because the GL context is not guaranteed to be current here.
+             */
+            void releaseCollections(const Model::TextureCollectionList& collections);
         };
     }
 }
@@ -0,0 +1,143 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureUploadQueue.h"
+
+#include "Renderer/TextureRenderer.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class CompareRequestsByFrame {
+        public:
+            template <typename Request>
+            inline bool operator() (const Request& left, const Request& right) const {
+                return left.first > right.first;
+            }
+        };
+        
+        static inline size_t stagedSize(const TextureRenderer& textureRenderer) {
+            // keep every image in the pixel buffer aligned to 16 bytes
+            return (textureRenderer.imageSize() + 15) & ~static_cast<size_t>(15);
+        }
+        
+        bool TextureUploadQueue::pixelBuffersSupported() const {
+            return GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object;
+        }
+        
+        bool TextureUploadQueue::uploadFromPixelBuffer(const RequestList& requests, size_t count, size_t size) {
+            if (m_pixelBufferId == 0)
+                glGenBuffers(1, &m_pixelBufferId);
+            
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBufferId);
+            
+            // orphan the previous contents so that mapping the buffer does not wait for the last uploads to finish
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), NULL, GL_STREAM_DRAW);
+            unsigned char* buffer = reinterpret_cast<unsigned char*>(glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
+            if (buffer == NULL) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                return false;
+            }
+            
+            std::vector<size_t> offsets(count);
+            size_t offset = 0;
+            for (size_t i = 0; i < count; i++) {
+                const TextureRenderer& textureRenderer = *requests[i].second;
+                assert(offset + textureRenderer.imageSize() <= size);
+                
+                textureRenderer.copyImage(buffer + offset);
+                offsets[i] = offset;
+                offset += stagedSize(textureRenderer);
+            }
+            
+            // the buffer contents are undefined if unmapping fails
+            if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                return false;
+            }
+            
+            for (size_t i = 0; i < count; i++)
+                requests[i].second->upload(offsets[i]);
+            
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return true;
+        }
+        
+        TextureUploadQueue::TextureUploadQueue() :
+        m_frame(0),
+        m_pixelBufferId(0) {}
+        
+        TextureUploadQueue::~TextureUploadQueue() {
+            clear();
+            if (m_pixelBufferId != 0) {
+                glDeleteBuffers(1, &m_pixelBufferId);
+                m_pixelBufferId = 0;
+            }
+        }
+        
+        void TextureUploadQueue::request(TextureRenderer& textureRenderer) {
+            if (!textureRenderer.uploaded())
+                m_requests[&textureRenderer] = m_frame;
+        }
+        
+        bool TextureUploadQueue::uploadTextures() {
+            m_frame++;
+            if (m_requests.empty())
+                return false;
+            
+            // textures which were activated directly in the meantime need not be uploaded anymore
+            RequestList requests;
+            requests.reserve(m_requests.size());
+            RequestMap::const_iterator it, end;
+            for (it = m_requests.begin(), end = m_requests.end(); it != end; ++it)
+                if (!it->first->uploaded())
+                    requests.push_back(Request(it->second, it->first));
+            std::stable_sort(requests.begin(), requests.end(), CompareRequestsByFrame());
+            
+            size_t count = 0;
+            size_t size = 0;
+            while (count < requests.size()) {
+                const size_t imageSize = stagedSize(*requests[count].second);
+                if (count > 0 && size + imageSize > MaxBytesPerFrame)
+                    break;
+                size += imageSize;
+                count++;
+            }
+            
+            if (count > 0) {
+                if (!pixelBuffersSupported() || !uploadFromPixelBuffer(requests, count, size)) {
+                    for (size_t i = 0; i < count; i++)
+                        requests[i].second->upload();
+                }
+                glBindTexture(GL_TEXTURE_2D, 0);
+            }
+            
+            m_requests.clear();
+            for (size_t i = count; i < requests.size(); i++)
+                m_requests[requests[i].second] = requests[i].first;
+            return !m_requests.empty();
+        }
+        
+        void TextureUploadQueue::clear() {
+            m_requests.clear();
+        }
+    }
+}
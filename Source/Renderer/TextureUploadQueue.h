@@ -0,0 +1,82 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__TextureUploadQueue__
+#define __TrenchBroom__TextureUploadQueue__
+
+#include <GL/glew.h>
+
+#include <map>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class TextureRenderer;
+        
+        /**
+         * Spreads the uploads of the wad textures across several frames. The renderers request the textures they
+         * need but which have not been uploaded yet, and after every frame, at most MaxBytesPerFrame of the
+         * requested images are staged in a pixel buffer object and uploaded from there. The textures requested in
+         * the most recent frames are uploaded first, so visible textures take precedence over textures which have
+         * been scrolled or moved out of view in the meantime.
+         */
+        class TextureUploadQueue {
+        public:
+            static const size_t MaxBytesPerFrame = 4 * 1024 * 1024;
+        private:
+            typedef std::map<TextureRenderer*, size_t> RequestMap;
+            typedef std::pair<size_t, TextureRenderer*> Request;
+            typedef std::vector<Request> RequestList;
+            
+            RequestMap m_requests;
+            size_t m_frame;
+            GLuint m_pixelBufferId;
+            
+            bool pixelBuffersSupported() const;
+            bool uploadFromPixelBuffer(const RequestList& requests, size_t count, size_t size);
+            
+            // prevent copying
+            TextureUploadQueue(const TextureUploadQueue& other);
+            void operator= (const TextureUploadQueue& other);
+        public:
+            TextureUploadQueue();
+            ~TextureUploadQueue();
+            
+            /**
+             * Requests the given texture to be uploaded after the current frame. Until then, it should be rendered
+             * with its average color.
+             */
+            void request(TextureRenderer& textureRenderer);
+            
+            /**
+             * Uploads the requested textures, limited to MaxBytesPerFrame, but at least one texture. Must be called
+             * with a current GL context. Returns true if requests remain, in which case the caller should render
+             * another frame.
+             */
+            bool uploadTextures();
+            
+            /**
+             * Drops all requests. Must be called before requested textures are deleted.
+             */
+            void clear();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__TextureUploadQueue__) */
@@ -0,0 +1,129 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThumbnailAtlas.h"
+
+#include "Renderer/OffscreenRenderer.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        void ThumbnailAtlas::addFreeTiles(size_t page) {
+            const unsigned int columns = m_pageSize / m_tileWidth;
+            const unsigned int rows = m_pageSize / m_tileHeight;
+
+            // the tiles are allocated from the back of the free list, so add them in reverse order
+            for (unsigned int row = rows; row > 0; row--)
+                for (unsigned int column = columns; column > 0; column--)
+                    m_freeTiles.push_back(Tile(page, (column - 1) * m_tileWidth, (row - 1) * m_tileHeight));
+        }
+
+        void ThumbnailAtlas::createPage() {
+            Page page;
+
+            glGenTextures(1, &page.textureId);
+            glBindTexture(GL_TEXTURE_2D, page.textureId);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(m_pageSize), static_cast<GLsizei>(m_pageSize), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            GLint previousFramebufferId;
+            glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebufferId);
+
+            glGenFramebuffers(1, &page.framebufferId);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, page.framebufferId);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, page.textureId, 0);
+
+            GLenum status = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER);
+            assert(status == GL_FRAMEBUFFER_COMPLETE);
+
+            // unused tiles must be transparent
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(previousFramebufferId));
+
+            m_pages.push_back(page);
+            addFreeTiles(m_pages.size() - 1);
+        }
+
+        ThumbnailAtlas::ThumbnailAtlas(unsigned int tileWidth, unsigned int tileHeight, unsigned int pageSize) :
+        m_tileWidth(tileWidth),
+        m_tileHeight(tileHeight),
+        m_pageSize(pageSize) {
+            assert(m_tileWidth > 0 && m_tileWidth <= m_pageSize);
+            assert(m_tileHeight > 0 && m_tileHeight <= m_pageSize);
+        }
+
+        ThumbnailAtlas::~ThumbnailAtlas() {
+            for (size_t i = 0; i < m_pages.size(); i++) {
+                Page& page = m_pages[i];
+                if (page.framebufferId != 0) {
+                    glDeleteFramebuffers(1, &page.framebufferId);
+                    page.framebufferId = 0;
+                }
+                if (page.textureId != 0) {
+                    glDeleteTextures(1, &page.textureId);
+                    page.textureId = 0;
+                }
+            }
+            m_pages.clear();
+            m_freeTiles.clear();
+        }
+
+        ThumbnailAtlas::Tile ThumbnailAtlas::allocateTile() {
+            if (m_freeTiles.empty())
+                createPage();
+
+            Tile tile = m_freeTiles.back();
+            m_freeTiles.pop_back();
+            return tile;
+        }
+
+        void ThumbnailAtlas::freeTile(const Tile& tile) {
+            assert(tile.page < m_pages.size());
+            m_freeTiles.push_back(tile);
+        }
+
+        void ThumbnailAtlas::freeAllTiles() {
+            m_freeTiles.clear();
+            for (size_t i = m_pages.size(); i > 0; i--)
+                addFreeTiles(i - 1);
+        }
+
+        void ThumbnailAtlas::storeTile(const Tile& tile, OffscreenRenderer& renderer, unsigned int width, unsigned int height) {
+            assert(tile.page < m_pages.size());
+            assert(width <= m_tileWidth && height <= m_tileHeight);
+
+            renderer.blit(m_pages[tile.page].framebufferId, static_cast<GLint>(tile.x), static_cast<GLint>(tile.y), static_cast<GLint>(width), static_cast<GLint>(height));
+        }
+
+        void ThumbnailAtlas::activatePage(size_t page) {
+            assert(page < m_pages.size());
+            glBindTexture(GL_TEXTURE_2D, m_pages[page].textureId);
+        }
+
+        void ThumbnailAtlas::deactivatePage() {
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+    }
+}
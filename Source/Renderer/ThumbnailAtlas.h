@@ -0,0 +1,120 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__ThumbnailAtlas__
+#define __TrenchBroom__ThumbnailAtlas__
+
+#include "GL/glew.h"
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Renderer {
+        class OffscreenRenderer;
+
+        /**
+         * Stores small images of equal maximum size in the tiles of one or more square textures. The images are
+         * rendered offscreen and copied into their tiles on the GPU, so they never have to be read back. A new page
+         * is created whenever all tiles of the existing pages are in use.
+         */
+        class ThumbnailAtlas {
+        public:
+            class Tile {
+            public:
+                size_t page;
+                unsigned int x;
+                unsigned int y;
+
+                Tile() :
+                page(0),
+                x(0),
+                y(0) {}
+
+                Tile(size_t i_page, unsigned int i_x, unsigned int i_y) :
+                page(i_page),
+                x(i_x),
+                y(i_y) {}
+            };
+        private:
+            class Page {
+            public:
+                GLuint textureId;
+                GLuint framebufferId;
+
+                Page() :
+                textureId(0),
+                framebufferId(0) {}
+            };
+
+            typedef std::vector<Page> PageList;
+            typedef std::vector<Tile> TileList;
+
+            unsigned int m_tileWidth;
+            unsigned int m_tileHeight;
+            unsigned int m_pageSize;
+            PageList m_pages;
+            TileList m_freeTiles;
+
+            void addFreeTiles(size_t page);
+            void createPage();
+        public:
+            ThumbnailAtlas(unsigned int tileWidth, unsigned int tileHeight, unsigned int pageSize = 1024);
+            ~ThumbnailAtlas();
+
+            inline unsigned int tileWidth() const {
+                return m_tileWidth;
+            }
+
+            inline unsigned int tileHeight() const {
+                return m_tileHeight;
+            }
+
+            inline size_t pageCount() const {
+                return m_pages.size();
+            }
+
+            Tile allocateTile();
+            void freeTile(const Tile& tile);
+            void freeAllTiles();
+
+            /**
+             * Copies the lower left rectangle of the given size from the color buffer of the given offscreen renderer
+             * into the given tile. The offscreen renderer must be active.
+             */
+            void storeTile(const Tile& tile, OffscreenRenderer& renderer, unsigned int width, unsigned int height);
+
+            /**
+             * Returns the texture coordinates of the given point, which is relative to the lower left corner of
+             * the given tile.
+             */
+            inline Vec2f texCoords(const Tile& tile, unsigned int x, unsigned int y) const {
+                const float pageSize = static_cast<float>(m_pageSize);
+                return Vec2f(static_cast<float>(tile.x + x) / pageSize, static_cast<float>(tile.y + y) / pageSize);
+            }
+
+            void activatePage(size_t page);
+            void deactivatePage();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__ThumbnailAtlas__) */
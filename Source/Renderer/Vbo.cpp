@@ -33,46 +33,21 @@ namespace TrenchBroom {
             m_vbo.freeBlock(*this);
         }
         
-        size_t Vbo::findFreeBlockInRange(size_t address, size_t capacity, size_t start, size_t length) {
-            assert(length > 0);
-            
-            size_t pivot = start + length / 2;
-            VboBlock* block = m_freeBlocks[pivot];
-
-            int order = block->compare(address, capacity);
-            if (order == 0)
-                return pivot;
-            if (length == 1) {
-                if (order > 0)
-                    return pivot;
-                return pivot + 1;
-            }
-            
-            if (order > 0)
-                return findFreeBlockInRange(address, capacity, start, length / 2);
-            return findFreeBlockInRange(address, capacity, pivot, (length + 1) / 2);
-        }
-        
-        size_t Vbo::findFreeBlock(size_t address, size_t capacity) {
-            if (m_freeBlocks.empty()) return 0;
-            size_t index = findFreeBlockInRange(address, capacity, 0, static_cast<size_t>(m_freeBlocks.size()));
-            assert(index == m_freeBlocks.size() ||
-                   capacity < m_freeBlocks[index]->capacity() ||
-                   (capacity == m_freeBlocks[index]->capacity() && address <= m_freeBlocks[index]->address()));
-            return index;
+        // the used blocks and a new allocation may fill at most this percentage of the buffer after it has been
+        // compacted, otherwise the buffer grows so that it does not have to be compacted again right away
+        static const size_t MaxFillPercentage = 75;
+
+        VboBlock* Vbo::findFreeBlock(size_t capacity) {
+            FreeBlockMap::iterator it = m_freeBlocks.lower_bound(FreeBlockKey(capacity, 0));
+            if (it == m_freeBlocks.end())
+                return NULL;
+            return it->second;
         }
 
         void Vbo::insertFreeBlock(VboBlock& block) {
             assert(block.free());
-            size_t index = findFreeBlock(block.address(), block.capacity());
-            assert(index <= m_freeBlocks.size());
-            if (index < m_freeBlocks.size()) {
-                std::vector<VboBlock*>::iterator it = m_freeBlocks.begin();
-                std::advance(it, index);
-                m_freeBlocks.insert(it, &block);
-            } else {
-                m_freeBlocks.push_back(&block);
-            }
+            const bool inserted = m_freeBlocks.insert(FreeBlockMap::value_type(FreeBlockKey(block.capacity(), block.address()), &block)).second;
+            assert(inserted);
 #ifdef _DEBUG_VBO
             checkFreeBlocks();
 #endif
@@ -80,165 +55,224 @@ namespace TrenchBroom {
         
         void Vbo::removeFreeBlock(VboBlock& block) {
             assert(block.free());
-            size_t index = findFreeBlock(block.address(), block.capacity());
-            assert(index < m_freeBlocks.size());
-            assert(m_freeBlocks[index] == &block);
-            std::vector<VboBlock*>::iterator it = m_freeBlocks.begin();
-            std::advance(it, index);
+            FreeBlockMap::iterator it = m_freeBlocks.find(FreeBlockKey(block.capacity(), block.address()));
+            assert(it != m_freeBlocks.end() && it->second == &block);
             m_freeBlocks.erase(it);
 #ifdef _DEBUG_VBO
             checkFreeBlocks();
 #endif
         }
         
-        void Vbo::resizeVbo(size_t newCapacity) {
-            VboState oldState = m_state;
-            
-            unsigned char* temp = NULL;
-            MemBlock::List memBlocks;
-            if (m_vboId != 0 && m_freeCapacity < m_totalCapacity) {
-                VboBlock* currentBlock = m_first;
-                size_t totalLength = 0;
-                
-                while (currentBlock != NULL) {
-                    while (currentBlock != NULL && currentBlock->free())
-                        currentBlock = currentBlock->m_next;
-                    if (currentBlock != NULL) {
-                        size_t start = currentBlock->address();
-                        size_t length = 0;
-                        while (currentBlock != NULL && !currentBlock->free()) {
-                            length += currentBlock->capacity();
-                            currentBlock = currentBlock->m_next;
+        void Vbo::resizeBlock(VboBlock& block, size_t newCapacity) {
+            if (block.capacity() == newCapacity) return;
+            if (block.free()) {
+                removeFreeBlock(block);
+                block.m_capacity = newCapacity;
+                insertFreeBlock(block);
+            }
+        }
+
+        size_t Vbo::relocationCapacity(size_t capacity) const {
+            const size_t requiredCapacity = m_totalCapacity - m_freeCapacity + capacity;
+            size_t newCapacity = m_totalCapacity > 0 ? m_totalCapacity : requiredCapacity;
+            while (requiredCapacity * 100 > newCapacity * MaxFillPercentage)
+                newCapacity *= 2;
+            return newCapacity;
+        }
+
+        GLuint Vbo::copyBlocks(const BlockMove::List& moves, size_t usedCapacity, size_t newCapacity) {
+            GLuint newVboId = 0;
+            glGenBuffers(1, &newVboId);
+
+            if (GLEW_ARB_copy_buffer) {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, newVboId);
+                glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newCapacity), NULL, GL_DYNAMIC_DRAW);
+                glBindBuffer(GL_COPY_READ_BUFFER, m_vboId);
+
+                BlockMove::List::const_iterator it, end;
+                for (it = moves.begin(), end = moves.end(); it != end; ++it) {
+                    const BlockMove& move = *it;
+                    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(move.from), static_cast<GLintptr>(move.to), static_cast<GLsizeiptr>(move.length));
+                }
+
+                glBindBuffer(GL_COPY_READ_BUFFER, 0);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            } else {
+                // without ARB_copy_buffer, the blocks must take a detour through client memory
+                std::vector<unsigned char> temp(usedCapacity);
+                glBindBuffer(m_type, m_vboId);
+                if (!moves.empty()) {
+                    const unsigned char* source = reinterpret_cast<const unsigned char*>(glMapBuffer(m_type, GL_READ_ONLY));
+                    if (source != NULL) {
+                        BlockMove::List::const_iterator it, end;
+                        for (it = moves.begin(), end = moves.end(); it != end; ++it) {
+                            const BlockMove& move = *it;
+                            memcpy(&temp[move.to], source + move.from, move.length);
                         }
-                        memBlocks.push_back(MemBlock(start, length));
-                        totalLength += length;
+                        glUnmapBuffer(m_type);
                     }
                 }
-                
-                if (m_state < VboActive)
-                    activate();
-                if (m_state < VboMapped)
-                    map();
-
-                temp = new unsigned char[totalLength];
-                size_t offset = 0;
-                MemBlock::List::const_iterator it, end;
-                for (it = memBlocks.begin(), end = memBlocks.end(); it != end; ++it) {
-                    const MemBlock& memBlock = *it;
-                    memcpy(temp + offset, m_buffer + memBlock.start, memBlock.length);
-                    offset += memBlock.length;
-                }
+
+                glBindBuffer(m_type, newVboId);
+                glBufferData(m_type, static_cast<GLsizeiptr>(newCapacity), NULL, GL_DYNAMIC_DRAW);
+                if (!temp.empty())
+                    glBufferSubData(m_type, 0, static_cast<GLsizeiptr>(temp.size()), &temp[0]);
+                glBindBuffer(m_type, 0);
             }
-            
-            size_t addedCapacity = newCapacity - m_totalCapacity;
-            m_freeCapacity = newCapacity - (m_totalCapacity - m_freeCapacity);
-            m_totalCapacity = newCapacity;
-            
-            if (m_last->free()) {
-                resizeBlock(*m_last, m_last->capacity() + addedCapacity);
-            } else {
-                VboBlock* block = new VboBlock(*this, m_last->address() + m_last->capacity(), addedCapacity);
-                block->insertBetween(m_last, NULL);
-                insertFreeBlock(*block);
+
+            GLenum error = glGetError();
+            if (error != GL_NO_ERROR) {
+                glDeleteBuffers(1, &newVboId);
+                throw VboException(*this, "Vbo could not be relocated", error);
             }
-            
+
+            return newVboId;
+        }
+
+        void Vbo::relocate(size_t newCapacity) {
+#ifdef _DEBUG_VBO
+            checkBlockChain();
+            checkFreeBlocks();
+#endif
+
+            // collect the runs of adjacent used blocks and their addresses in the compacted buffer
+            BlockMove::List moves;
+            size_t usedCapacity = 0;
+            for (VboBlock* block = m_first; block != NULL; block = block->m_next) {
+                if (block->free())
+                    continue;
+                if (!moves.empty() && moves.back().from + moves.back().length == block->address())
+                    moves.back().length += block->capacity();
+                else
+                    moves.push_back(BlockMove(block->address(), usedCapacity, block->capacity()));
+                usedCapacity += block->capacity();
+            }
+
+            assert(usedCapacity == m_totalCapacity - m_freeCapacity);
+            assert(newCapacity > usedCapacity);
+
+            // if the buffer has not been created yet, it will be created with the new capacity when it is activated
+            const VboState oldState = m_state;
             if (m_vboId != 0) {
                 if (m_state == VboMapped)
                     unmap();
                 if (m_state == VboActive)
                     deactivate();
+
+                const GLuint newVboId = copyBlocks(moves, usedCapacity, newCapacity);
                 glDeleteBuffers(1, &m_vboId);
-                m_vboId = 0;
+                m_vboId = newVboId;
             }
-            
-            if (temp != NULL) {
-                assert(!memBlocks.empty());
-                
-                if (m_state < VboActive)
-                    activate();
-                if (m_state < VboMapped)
-                    map();
-                
-                size_t offset = 0;
-                MemBlock::List::const_iterator it, end;
-                for (it = memBlocks.begin(), end = memBlocks.end(); it != end; ++it) {
-                    const MemBlock& memBlock = *it;
-                    memcpy(m_buffer + memBlock.start, temp + offset, memBlock.length);
+
+            // chain the used blocks at their new addresses and replace all free blocks with a single one at the end
+            m_freeBlocks.clear();
+            VboBlock* first = NULL;
+            VboBlock* previous = NULL;
+            VboBlock* block = m_first;
+            size_t address = 0;
+            while (block != NULL) {
+                VboBlock* next = block->m_next;
+                if (block->free()) {
+                    delete block;
+                } else {
+                    block->m_address = address;
+                    address += block->capacity();
+                    block->insertBetween(previous, NULL);
+                    if (first == NULL)
+                        first = block;
+                    previous = block;
                 }
-                
-                delete [] temp;
-                temp = NULL;
-                memBlocks.clear();
-                
-                if (oldState < VboMapped)
-                    unmap();
-                if (oldState < VboActive)
-                    deactivate();
-            } else {
-                if (oldState > VboInactive && m_state < VboActive)
-                    activate();
-                if (oldState > VboActive && m_state < VboMapped)
-                    map();
+                block = next;
             }
-            
+
+            VboBlock* remainder = new VboBlock(*this, usedCapacity, newCapacity - usedCapacity);
+            remainder->insertBetween(previous, NULL);
+            if (first == NULL)
+                first = remainder;
+            insertFreeBlock(*remainder);
+
+            m_first = first;
+            m_last = remainder;
+            m_totalCapacity = newCapacity;
+            m_freeCapacity = newCapacity - usedCapacity;
+
+            if (oldState > VboInactive && m_state < VboActive)
+                activate();
+            if (oldState > VboActive && m_state < VboMapped)
+                map();
+
 #ifdef _DEBUG_VBO
             checkBlockChain();
             checkFreeBlocks();
 #endif
         }
         
-        void Vbo::resizeBlock(VboBlock& block, size_t newCapacity) {
-            if (block.capacity() == newCapacity) return;
-            if (block.free()) {
-                removeFreeBlock(block);
-                block.m_capacity = newCapacity;
-                insertFreeBlock(block);
-            }
+        bool Vbo::streaming() const {
+            return m_usage == VboStreaming && GLEW_ARB_sync && GLEW_ARB_map_buffer_range;
         }
-        
-        VboBlock* Vbo::packBlock(VboBlock& block) {
-            VboBlock* first = block.m_next;
-            if (first == NULL)
-                return NULL;
-            
-            VboBlock* previous = NULL;
-            VboBlock* last = first;
-            size_t size = 0;
-            size_t address = first->address();
+
+        VboBlock* Vbo::releaseBlock(VboBlock& block) {
+#ifdef _DEBUG_VBO
+            checkBlockChain();
+            checkFreeBlocks();
+#endif
+
+            VboBlock* previous = block.m_previous;
+            VboBlock* next = block.m_next;
             
-            do {
-                last->m_address -= block.capacity();
-                size += last->capacity();
-                previous = last;
-                last = last->m_next;
-            } while (last != NULL && !last->free());
+            m_freeCapacity += block.capacity();
+            block.m_free = true;
             
-            memmove(m_buffer + block.address(), m_buffer + address, size);
+            if (previous != NULL && previous->free() && next != NULL && next->free()) {
+                resizeBlock(*previous, previous->capacity() + block.capacity() + next->capacity());
+                if (m_last == next) m_last = previous;
+                removeFreeBlock(*next);
+                previous->insertBetween(previous->m_previous, next->m_next);
+                delete &block;
+                delete next;
+                return previous;
+            }
             
-            if (last != NULL) {
-                last->m_address -= block.capacity();
-                resizeBlock(*last, last->capacity() + block.capacity());
-            } else {
-                VboBlock* newBlock = new VboBlock(*this, previous->address() + previous->capacity(), block.capacity());
-                insertFreeBlock(*newBlock);
-                newBlock->insertBetween(previous, NULL);
-                m_last = newBlock;
+            if (previous != NULL && previous->free()) {
+                resizeBlock(*previous, previous->capacity() + block.capacity());
+                if (m_last == &block) m_last = previous;
+                previous->insertBetween(previous->m_previous, next);
+                delete &block;
+                return previous;
             }
             
-            if (m_first == &block) m_first = block.m_next;
+            if (next != NULL && next->free()) {
+                if (m_last == next) m_last = &block;
+                removeFreeBlock(*next);
+                block.m_capacity += next->capacity();
+                block.m_free = true;
+                block.insertBetween(previous, next->m_next);
+                insertFreeBlock(block);
+                delete next;
+                return &block;
+            }
             
-            removeFreeBlock(block);
-            if (block.m_previous != NULL) block.m_previous->m_next = block.m_next;
-            if (block.m_next != NULL) block.m_next->m_previous = block.m_previous;
-            delete &block;
+            insertFreeBlock(block);
+
+#ifdef _DEBUG_VBO
+            checkBlockChain();
+            checkFreeBlocks();
+#endif
 
-            return last;
+            return &block;
         }
-        
-        Vbo::Vbo(GLenum type, size_t capacity) : m_type(type), m_totalCapacity(capacity), m_freeCapacity(capacity), m_buffer(NULL), m_vboId(0), m_state(VboInactive) {
+
+        Vbo::Vbo(GLenum type, size_t capacity, VboUsage usage) :
+        m_type(type),
+        m_totalCapacity(capacity),
+        m_freeCapacity(capacity),
+        m_buffer(NULL),
+        m_vboId(0),
+        m_state(VboInactive),
+        m_usage(usage) {
             m_first = new VboBlock(*this, 0, m_totalCapacity);
             m_last = m_first;
-            m_freeBlocks.push_back(m_first);
+            insertFreeBlock(*m_first);
 #ifdef _DEBUG_VBO
             checkBlockChain();
             checkFreeBlocks();
@@ -254,6 +288,10 @@ namespace TrenchBroom {
                 unmap();
             if (m_state == VboActive)
                 deactivate();
+            while (!m_pendingBlocks.empty()) {
+                glDeleteSync(m_pendingBlocks.front().fence);
+                m_pendingBlocks.pop_front();
+            }
             if (m_vboId != 0)
                 glDeleteBuffers(1, &m_vboId);
             m_freeBlocks.clear();
@@ -293,7 +331,13 @@ namespace TrenchBroom {
         void Vbo::map() {
             assert(m_state == VboActive);
             
-            m_buffer = (unsigned char *)glMapBuffer(m_type, GL_WRITE_ONLY);
+            if (streaming()) {
+                // the blocks which the GPU may still read are retired or pending, and they are never written to
+                releasePendingBlocks(false);
+                m_buffer = (unsigned char *)glMapBufferRange(m_type, 0, static_cast<GLsizeiptr>(m_totalCapacity), GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            } else {
+                m_buffer = (unsigned char *)glMapBuffer(m_type, GL_WRITE_ONLY);
+            }
             GLenum error = glGetError();
 			if (m_buffer == NULL || error != GL_NO_ERROR)
 				throw VboException(*this, "Vbo could not be mapped", error);
@@ -315,9 +359,11 @@ namespace TrenchBroom {
         }
         
         void Vbo::ensureFreeCapacity(size_t capacity) {
-            pack();
-            if (m_freeCapacity < capacity)
-                resizeVbo(m_totalCapacity + (capacity - m_freeCapacity));
+            if (capacity == 0)
+                return;
+            if (!m_freeBlocks.empty() && m_freeBlocks.rbegin()->second->capacity() >= capacity)
+                return;
+            relocate(relocationCapacity(capacity));
         }
 
         VboBlock* Vbo::allocBlock(size_t capacity) {
@@ -328,30 +374,16 @@ namespace TrenchBroom {
             checkFreeBlocks();
 #endif
 
-            size_t index = findFreeBlock(0, capacity);
-            if (index >= m_freeBlocks.size()) {
-                SetVboState mapVbo(*this, VboMapped);
-                pack();
-
-                if (capacity > m_freeCapacity) {
-                    const size_t usedCapacity = m_totalCapacity - m_freeCapacity;
-                    size_t newCapacity = m_totalCapacity;
-                    size_t newFreeCapacity = m_freeCapacity;
-                    while (capacity > newFreeCapacity) {
-                        newCapacity *= 2;
-                        newFreeCapacity = newCapacity - usedCapacity;
-                    }
-                    resizeVbo(newCapacity);
-                }
-                
-                index = findFreeBlock(0, capacity);
-                assert(index < m_freeBlocks.size());
+            if (!m_pendingBlocks.empty())
+                releasePendingBlocks(false);
+
+            VboBlock* block = findFreeBlock(capacity);
+            if (block == NULL) {
+                relocate(relocationCapacity(capacity));
+                block = findFreeBlock(capacity);
+                assert(block != NULL);
             }
-            
-            VboBlock* block = m_freeBlocks[index];
-            std::vector<VboBlock*>::iterator it = m_freeBlocks.begin();
-            std::advance(it, index);
-            m_freeBlocks.erase(it);
+            removeFreeBlock(*block);
             
             // split block
             if (capacity < block->capacity()) {
@@ -374,57 +406,48 @@ namespace TrenchBroom {
         }
         
         VboBlock* Vbo::freeBlock(VboBlock& block) {
-#ifdef _DEBUG_VBO
-            checkBlockChain();
-            checkFreeBlocks();
-#endif
-
-            VboBlock* previous = block.m_previous;
-            VboBlock* next = block.m_next;
-            
-            m_freeCapacity += block.capacity();
-            block.m_free = true;
-            
-            if (previous != NULL && previous->free() && next != NULL && next->free()) {
-                resizeBlock(*previous, previous->capacity() + block.capacity() + next->capacity());
-                if (m_last == next) m_last = previous;
-                removeFreeBlock(*next);
-                previous->insertBetween(previous->m_previous, next->m_next);
-                delete &block;
-                delete next;
-                return previous;
-            }
-            
-            if (previous != NULL && previous->free()) {
-                resizeBlock(*previous, previous->capacity() + block.capacity());
-                if (m_last == &block) m_last = previous;
-                previous->insertBetween(previous->m_previous, next);
-                delete &block;
-                return previous;
-            }
-            
-            if (next != NULL && next->free()) {
-                if (m_last == next) m_last = &block;
-                removeFreeBlock(*next);
-                block.m_capacity += next->capacity();
-                block.m_free = true;
-                block.insertBetween(previous, next->m_next);
-                insertFreeBlock(block);
-                delete next;
+            if (streaming()) {
+                assert(!block.free());
+                m_retiredBlocks.push_back(&block);
                 return &block;
             }
-            
-            insertFreeBlock(block);
+            return releaseBlock(block);
+        }
 
-#ifdef _DEBUG_VBO
-            checkBlockChain();
-            checkFreeBlocks();
-#endif
+        void Vbo::releasePendingBlocks(bool wait) {
+            while (!m_pendingBlocks.empty()) {
+                PendingBlocks& pending = m_pendingBlocks.front();
+                const GLenum status = glClientWaitSync(pending.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? GL_TIMEOUT_IGNORED : 0);
+                if (status == GL_WAIT_FAILED)
+                    throw VboException(*this, "Vbo could not wait for fence", glGetError());
+                if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                    break;
 
-            return &block;
+                glDeleteSync(pending.fence);
+                for (size_t i = 0; i < pending.blocks.size(); i++)
+                    releaseBlock(*pending.blocks[i]);
+                m_pendingBlocks.pop_front();
+            }
         }
 
         void Vbo::freeAllBlocks() {
+            if (streaming()) {
+                // the GPU must be done with all blocks, including the live ones, before they are overwritten
+                // without synchronization
+                GLsync allBlocksFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                const GLenum status = glClientWaitSync(allBlocksFence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+                glDeleteSync(allBlocksFence);
+                if (status == GL_WAIT_FAILED)
+                    throw VboException(*this, "Vbo could not wait for fence", glGetError());
+
+                // fences are signaled in order, so the GPU has passed all pending fences, too
+                while (!m_pendingBlocks.empty()) {
+                    glDeleteSync(m_pendingBlocks.front().fence);
+                    m_pendingBlocks.pop_front();
+                }
+            }
+
+            m_retiredBlocks.clear();
             m_freeBlocks.clear();
             VboBlock* block = m_first;
             while (block != NULL) {
@@ -433,31 +456,24 @@ namespace TrenchBroom {
                 block = next;
             }
             m_first = m_last = new VboBlock(*this, 0, m_totalCapacity);
-            m_freeBlocks.push_back(m_first);
+            insertFreeBlock(*m_first);
             m_freeCapacity = m_totalCapacity;
         }
 
         void Vbo::pack() {
-            assert(m_state == VboMapped);
-            
-#ifdef _DEBUG_VBO
-            checkBlockChain();
-            checkFreeBlocks();
-#endif
+            if (m_freeBlocks.empty() || (m_freeBlocks.size() == 1 && m_last->free()))
+                return;
+            relocate(m_totalCapacity);
+        }
 
-            if (m_totalCapacity == m_freeCapacity || (m_last->free() && m_last->capacity() == m_freeCapacity)) return;
-            
-            // find first free block
-            VboBlock* block = m_first;
-            while (block != NULL && !block->free())
-                block = block->m_next;
-            while (block != NULL && block->m_next != NULL)
-                block = packBlock(*block);
+        void Vbo::fence() {
+            if (m_retiredBlocks.empty())
+                return;
 
-#ifdef _DEBUG_VBO
-            checkBlockChain();
-            checkFreeBlocks();
-#endif
+            PendingBlocks pending;
+            pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            pending.blocks.swap(m_retiredBlocks);
+            m_pendingBlocks.push_back(pending);
         }
 
 #ifdef _DEBUG_VBO
@@ -477,12 +493,11 @@ namespace TrenchBroom {
         }
         
         void Vbo::checkFreeBlocks() {
-            for (size_t i = 0; i < m_freeBlocks.size(); i++) {
-                VboBlock* block = m_freeBlocks[i];
+            FreeBlockMap::const_iterator it, end;
+            for (it = m_freeBlocks.begin(), end = m_freeBlocks.end(); it != end; ++it) {
+                const VboBlock* block = it->second;
                 assert(block->free());
-                if (i < m_freeBlocks.size() - 1)
-                    assert((block->capacity() < m_freeBlocks[i + 1]->capacity()) || 
-                           (block->capacity() == m_freeBlocks[i + 1]->capacity() && block->address() < m_freeBlocks[i + 1]->address()));
+                assert(it->first.first == block->capacity() && it->first.second == block->address());
             }
         }
 #endif
@@ -26,7 +26,9 @@
 
 #include <cassert>
 #include <cstring>
+#include <deque>
 #include <exception>
+#include <map>
 #include <sstream>
 #include <vector>
 
@@ -45,38 +47,70 @@ namespace TrenchBroom {
                 VboActive   = 1,
                 VboMapped   = 2
             } VboState;
+
+            /**
+             * Static buffers hold geometry which changes rarely, such as the level geometry, and are mapped with
+             * synchronization. Streaming buffers hold small, frequently rebuilt geometry. They are mapped without
+             * synchronization, so their blocks must never be rewritten once they have been drawn; instead, a new
+             * block must be allocated. Freed blocks of a streaming buffer are only reused once the GPU has passed
+             * the fence following the last frame in which they may have been drawn.
+             */
+            typedef enum {
+                VboStatic       = 0,
+                VboStreaming    = 1
+            } VboUsage;
         private:
-            struct MemBlock {
-                typedef std::vector<MemBlock> List;
-                
-                size_t start;
+            typedef std::vector<VboBlock*> BlockList;
+
+            struct PendingBlocks {
+                GLsync fence;
+                BlockList blocks;
+            };
+
+            typedef std::deque<PendingBlocks> PendingBlocksQueue;
+
+            struct BlockMove {
+                typedef std::vector<BlockMove> List;
+
+                size_t from;
+                size_t to;
                 size_t length;
-                
-                MemBlock(size_t i_start, size_t i_length) :
-                start(i_start),
+
+                BlockMove(size_t i_from, size_t i_to, size_t i_length) :
+                from(i_from),
+                to(i_to),
                 length(i_length) {}
-                
-                MemBlock() :
-                start(0),
-                length(0) {}
             };
 
+            /**
+             * Free blocks are indexed by their capacity and then by their address, so that the best fitting free
+             * block for an allocation can be found in logarithmic time.
+             */
+            typedef std::pair<size_t, size_t> FreeBlockKey;
+            typedef std::map<FreeBlockKey, VboBlock*> FreeBlockMap;
+
             GLenum m_type;
             size_t m_totalCapacity;
             size_t m_freeCapacity;
-            std::vector<VboBlock*> m_freeBlocks;
+            FreeBlockMap m_freeBlocks;
             VboBlock* m_first;
             VboBlock* m_last;
             unsigned char* m_buffer;
             GLuint m_vboId;
             VboState m_state;
-            size_t findFreeBlockInRange(size_t address, size_t capacity, size_t start, size_t length);
-            size_t findFreeBlock(size_t address, size_t capacity);
+            VboUsage m_usage;
+            BlockList m_retiredBlocks;
+            PendingBlocksQueue m_pendingBlocks;
+            VboBlock* findFreeBlock(size_t capacity);
             void insertFreeBlock(VboBlock& block);
             void removeFreeBlock(VboBlock& block);
-            void resizeVbo(size_t newCapacity);
             void resizeBlock(VboBlock& block, size_t newCapacity);
-            VboBlock* packBlock(VboBlock& block);
+            size_t relocationCapacity(size_t capacity) const;
+            GLuint copyBlocks(const BlockMove::List& moves, size_t usedCapacity, size_t newCapacity);
+            void relocate(size_t newCapacity);
+            bool streaming() const;
+            VboBlock* releaseBlock(VboBlock& block);
+            void releasePendingBlocks(bool wait);
 #ifdef _DEBUG_VBO
             void checkBlockChain();
             void checkFreeBlocks();
@@ -87,7 +121,7 @@ namespace TrenchBroom {
             Vbo(const Vbo& other);
             void operator= (const Vbo& other);
         public:
-            Vbo(GLenum type, size_t capacity);
+            Vbo(GLenum type, size_t capacity, VboUsage usage = VboStatic);
             ~Vbo();
             void activate();
             void deactivate();
@@ -98,11 +132,27 @@ namespace TrenchBroom {
                 return m_state;
             }
             
+            /**
+             * Makes sure that blocks with the given total capacity can be allocated without moving any blocks. If
+             * the free capacity is too small or too fragmented, the used blocks are moved to the front of a new,
+             * possibly larger buffer.
+             */
             void ensureFreeCapacity(size_t capacity);
             VboBlock* allocBlock(size_t capacity);
             VboBlock* freeBlock(VboBlock& block);
             void freeAllBlocks();
+
+            /**
+             * Moves all used blocks to the front of the buffer so that the free capacity forms a single block. The
+             * blocks are copied on the GPU, so the buffer contents are never read back.
+             */
             void pack();
+
+            /**
+             * Marks the end of the draw calls which use this buffer in the current frame. The blocks of a streaming
+             * buffer which were freed since the previous fence can be reused after the GPU has passed this fence.
+             */
+            void fence();
             bool ownsBlock(VboBlock& block);
         };
 
@@ -241,14 +291,6 @@ namespace TrenchBroom {
             }
 
             void freeBlock();
-
-            inline int compare(size_t address, size_t capacity) {
-                if (m_capacity < capacity) return -1;
-                if (m_capacity > capacity) return 1;
-                if (m_address < address) return -1;
-                if (m_address > address) return 1;
-                return 0;
-            }
         };
 
 		class VboException : public std::exception {
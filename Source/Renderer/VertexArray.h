@@ -33,8 +33,10 @@
 namespace TrenchBroom {
     namespace Renderer {
         class VertexArray : public RenderArray {
-        protected:
         public:
+            typedef std::vector<GLint> IndexArray;
+            typedef std::vector<GLsizei> CountArray;
+
             VertexArray(Vbo& vbo, GLenum primType, size_t vertexCapacity, const Attribute& attribute1, size_t padTo = 16) :
             RenderArray(vbo, primType, vertexCapacity, attribute1, padTo) {}
             
@@ -56,12 +58,32 @@ namespace TrenchBroom {
             inline void renderPrimitives(size_t index, size_t vertexCount) {
                 glDrawArrays(m_primType, static_cast<GLint>(index), static_cast<GLsizei>(vertexCount));
             }
+            
+            /**
+             * Renders only the given ranges of vertices, which are given by their first vertex and their length.
+             */
+            inline void render(const IndexArray& firsts, const CountArray& counts) {
+                assert(firsts.size() == counts.size());
+                if (firsts.empty())
+                    return;
+                
+                setup();
+                glMultiDrawArrays(m_primType, &firsts.front(), &counts.front(), static_cast<GLsizei>(firsts.size()));
+                cleanup();
+            }
 
             inline void render() {
                 setup();
                 glDrawArrays(m_primType, 0, static_cast<GLsizei>(m_vertexCount));
                 cleanup();
             }
+            
+            // requires ARB_draw_instanced
+            inline void renderInstanced(unsigned int instanceCount) {
+                setup();
+                glDrawArraysInstancedARB(m_primType, 0, static_cast<GLsizei>(m_vertexCount), static_cast<GLsizei>(instanceCount));
+                cleanup();
+            }
         };
     }
 }
@@ -20,6 +20,8 @@
 #ifndef TrenchBroom_Allocator_h
 #define TrenchBroom_Allocator_h
 
+#include "Utility/SpinLock.h"
+
 #include <cassert>
 #include <iostream>
 #include <limits>
@@ -31,6 +33,10 @@
 
 namespace TrenchBroom {
     namespace Utility {
+        /**
+         * Pools the memory of small objects which are created and deleted in large numbers. Allocation and
+         * deallocation are thread safe.
+         */
         template <class T, size_t PoolSize = 64, size_t BlocksPerChunk = 256>
         class Allocator {
         private:
@@ -94,6 +100,8 @@ namespace TrenchBroom {
             typedef std::vector<Chunk*> ChunkList;
             typedef std::stack<T*> Pool;
 
+            static SpinLock s_lock;
+
             static inline Pool& pool() {
                 static Pool p;
                 return p;
@@ -117,6 +125,7 @@ namespace TrenchBroom {
 #ifdef _ENABLE_ALLOCATOR
             inline void* operator new(size_t size) {
                 assert(size == sizeof(T));
+                SpinLocker locker(s_lock);
 
                 if (!pool().empty()) {
                     T* t = pool().top();
@@ -149,6 +158,7 @@ namespace TrenchBroom {
 
             inline void operator delete(void* block) {
                 T* t = reinterpret_cast<T*>(block);
+                SpinLocker locker(s_lock);
 
                 size_t poolSize = PoolSize;
                 if (poolSize > 0 && pool().size() < poolSize) {
@@ -201,6 +211,9 @@ namespace TrenchBroom {
             }
 #endif
         };
+
+        template <class T, size_t PoolSize, size_t BlocksPerChunk>
+        SpinLock Allocator<T, PoolSize, BlocksPerChunk>::s_lock;
     }
 }
 
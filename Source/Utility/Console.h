@@ -83,10 +83,11 @@ namespace TrenchBroom {
             void logToFile(const LogMessage& message);
         public:
             Console() : m_textCtrl(NULL) {}
+            virtual ~Console() {}
             
             void setTextCtrl(wxTextCtrl* textCtrl);
             
-            void log(const LogMessage& message);
+            virtual void log(const LogMessage& message);
             
             void debug(const String& message);
             void debug(const char* format, ...);
@@ -0,0 +1,196 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__Future__
+#define __TrenchBroom__Future__
+
+#include "Utility/ExecutableEvent.h"
+#include "Utility/SharedPointer.h"
+#include "Utility/ThreadPool.h"
+
+#include <wx/app.h>
+#include <wx/thread.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Utility {
+        /**
+         * The result of a computation that runs on the thread pool. A thread can block until the result is
+         * available, or a continuation can be attached which is then called with the result on the UI thread.
+         * Futures must be owned by a shared pointer.
+         *
+         * All members are thread safe.
+         */
+        template <typename T>
+        class Future : public std::tr1::enable_shared_from_this<Future<T> > {
+        public:
+            typedef std::tr1::shared_ptr<Future<T> > Ptr;
+
+            /**
+             * Called on the UI thread once the result is available. The continuation is deleted after it was called.
+             * If it refers to objects which may be gone by the time it is called, their owner must detach it.
+             */
+            class Continuation {
+            public:
+                virtual ~Continuation() {}
+                virtual void operator()(const T& result) = 0;
+            };
+        private:
+            class ContinuationExecutable : public ExecutableEvent::Executable {
+            private:
+                typename Future<T>::Ptr m_future;
+            protected:
+                void execute() {
+                    m_future->runContinuation();
+                }
+            public:
+                ContinuationExecutable(typename Future<T>::Ptr future) :
+                m_future(future) {}
+            };
+
+            T m_result;
+            bool m_ready;
+            Continuation* m_continuation;
+            wxMutex m_mutex;
+            wxCondition m_condition;
+
+            inline void queueContinuation() {
+                ExecutableEvent::Executable::Ptr executable(new ContinuationExecutable(this->shared_from_this()));
+                wxTheApp->QueueEvent(new ExecutableEvent(executable));
+            }
+
+            inline void runContinuation() {
+                Continuation* continuation = NULL;
+                {
+                    wxMutexLocker lock(m_mutex);
+                    std::swap(continuation, m_continuation);
+                }
+
+                // the continuation is NULL if it was detached in the meantime
+                if (continuation != NULL) {
+                    (*continuation)(m_result);
+                    delete continuation;
+                }
+            }
+        public:
+            Future() :
+            m_result(),
+            m_ready(false),
+            m_continuation(NULL),
+            m_condition(m_mutex) {}
+
+            ~Future() {
+                delete m_continuation;
+                m_continuation = NULL;
+            }
+
+            inline bool ready() {
+                wxMutexLocker lock(m_mutex);
+                return m_ready;
+            }
+
+            /**
+             * Blocks until the result is available and returns it.
+             */
+            inline const T& get() {
+                wxMutexLocker lock(m_mutex);
+                while (!m_ready)
+                    m_condition.Wait();
+                return m_result;
+            }
+
+            /**
+             * Attaches the given continuation and takes ownership of it. If the result is already available, the
+             * continuation is queued immediately. At most one continuation can be attached.
+             */
+            inline void then(Continuation* continuation) {
+                wxMutexLocker lock(m_mutex);
+                assert(m_continuation == NULL);
+                m_continuation = continuation;
+                if (m_ready)
+                    queueContinuation();
+            }
+
+            /**
+             * Deletes the attached continuation so that it is never called. Returns false if there was no
+             * continuation or if it has already been called. Must be called on the UI thread.
+             */
+            inline bool detach() {
+                wxMutexLocker lock(m_mutex);
+                if (m_continuation == NULL)
+                    return false;
+                delete m_continuation;
+                m_continuation = NULL;
+                return true;
+            }
+
+            inline void setResult(const T& result) {
+                wxMutexLocker lock(m_mutex);
+                assert(!m_ready);
+                m_result = result;
+                m_ready = true;
+                m_condition.Broadcast();
+                if (m_continuation != NULL)
+                    queueContinuation();
+            }
+        };
+
+        /**
+         * A task which computes a value on the thread pool and hands it to its future.
+         */
+        template <typename T>
+        class AsyncTask : public ThreadPool::Task {
+        private:
+            typename Future<T>::Ptr m_future;
+        protected:
+            virtual T compute() = 0;
+        public:
+            AsyncTask() :
+            m_future(new Future<T>()) {}
+
+            inline typename Future<T>::Ptr future() const {
+                return m_future;
+            }
+
+            void run() {
+                m_future->setResult(compute());
+            }
+        };
+
+        /**
+         * Queues the given task on the shared thread pool, or runs it right away if there is no pool, and returns
+         * the future of its result.
+         */
+        template <typename T>
+        inline typename Future<T>::Ptr runAsync(AsyncTask<T>* task) {
+            typename Future<T>::Ptr future = task->future();
+            if (ThreadPool::sharedPool != NULL) {
+                ThreadPool::sharedPool->submit(task);
+            } else {
+                task->run();
+                delete task;
+            }
+            return future;
+        }
+    }
+}
+
+#endif /* defined(__TrenchBroom__Future__) */
@@ -21,6 +21,7 @@
 #define TrenchBroom_Mat_h
 
 #include "Utility/Quat.h"
+#include "Utility/SIMD.h"
 #include "Utility/Vec.h"
 
 namespace TrenchBroom {
@@ -250,6 +251,30 @@ namespace TrenchBroom {
             }
         };
 
+#ifdef TRENCHBROOM_SSE
+        // Every column of a 4x4 float matrix fits into one SSE register. The products are summed in the same order as
+        // in the generic code, so both produce the same results.
+        template <>
+        inline const Vec<float,4> Mat<float,4,4>::operator* (const Vec<float,4>& right) const {
+            __m128 sum = _mm_mul_ps(_mm_loadu_ps(v[0].v), _mm_set1_ps(right.v[0]));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(v[1].v), _mm_set1_ps(right.v[1])));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(v[2].v), _mm_set1_ps(right.v[2])));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(v[3].v), _mm_set1_ps(right.v[3])));
+
+            Vec<float,4> result;
+            _mm_storeu_ps(result.v, sum);
+            return result;
+        }
+
+        template <>
+        inline const Mat<float,4,4> Mat<float,4,4>::operator* (const Mat<float,4,4>& right) const {
+            Mat<float,4,4> result;
+            for (size_t c = 0; c < 4; c++)
+                result.v[c] = *this * right.v[c];
+            return result;
+        }
+#endif
+
         template <typename T, size_t R, size_t C>
         inline Mat<T,R,C> operator* (const T left, const Mat<T,R,C>& right) {
             return right * left;
@@ -0,0 +1,61 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Parallel.h"
+
+#include "Utility/ThreadPool.h"
+
+namespace TrenchBroom {
+    namespace Utility {
+        class ParallelRangeTask : public ThreadPool::Task {
+        private:
+            ParallelTask& m_task;
+            size_t m_begin;
+            size_t m_end;
+        public:
+            ParallelRangeTask(ParallelTask& task, size_t begin, size_t end) :
+            m_task(task),
+            m_begin(begin),
+            m_end(end) {}
+
+            void run() {
+                for (size_t i = m_begin; i < m_end; i++)
+                    m_task.run(i);
+            }
+        };
+
+        void runParallel(ParallelTask& task, size_t count) {
+            ThreadPool* pool = ThreadPool::sharedPool;
+            if (count < 2 || pool == NULL || pool->workerCount() == 0) {
+                for (size_t i = 0; i < count; i++)
+                    task.run(i);
+                return;
+            }
+
+            // a few ranges per thread even out items that take longer than others
+            const size_t threadCount = pool->workerCount() + 1;
+            const size_t rangeCount = count < 4 * threadCount ? count : 4 * threadCount;
+
+            ThreadPool::TaskGroup group;
+            for (size_t i = 0; i < rangeCount; i++)
+                pool->submit(new ParallelRangeTask(task, i * count / rangeCount, (i + 1) * count / rangeCount), &group);
+            pool->wait(group);
+        }
+    }
+}
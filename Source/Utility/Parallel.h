@@ -0,0 +1,72 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__Parallel__
+#define __TrenchBroom__Parallel__
+
+#include <cstddef>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Utility {
+        /**
+         * A piece of work that is split into independent items which can be processed in any order and on any thread.
+         * Implementations must not throw and must not touch state that is shared between items unless it is guarded.
+         */
+        class ParallelTask {
+        public:
+            virtual ~ParallelTask() {}
+            virtual void run(size_t index) = 0;
+        };
+
+        /**
+         * Runs the given task for every index in [0, count) and returns when all items are done. The items are
+         * distributed among the workers of the shared thread pool and the calling thread, so the order in which
+         * they run is undefined. Small counts run on the calling thread, as does everything if there is no pool.
+         */
+        void runParallel(ParallelTask& task, size_t count);
+
+        template <typename T, class Function>
+        class ParallelForEachTask : public ParallelTask {
+        private:
+            const std::vector<T>& m_list;
+            Function& m_function;
+        public:
+            ParallelForEachTask(const std::vector<T>& list, Function& function) :
+            m_list(list),
+            m_function(function) {}
+
+            void run(size_t index) {
+                m_function(m_list[index]);
+            }
+        };
+
+        /**
+         * Calls the given function for every element of the given list, e.g. a BrushList, EntityList or FaceList.
+         * The function is called concurrently, so it must be safe to call it for different elements at once.
+         */
+        template <typename T, class Function>
+        inline void parallelForEach(const std::vector<T>& list, Function& function) {
+            ParallelForEachTask<T, Function> task(list, function);
+            runParallel(task, list.size());
+        }
+    }
+}
+
+#endif /* defined(__TrenchBroom__Parallel__) */
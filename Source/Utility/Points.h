@@ -0,0 +1,215 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Points_h
+#define TrenchBroom_Points_h
+
+#include "Utility/BBox.h"
+#include "Utility/Mat.h"
+#include "Utility/Math.h"
+#include "Utility/Plane.h"
+#include "Utility/SIMD.h"
+#include "Utility/Ray.h"
+#include "Utility/Vec.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace VecMath {
+        /*
+         * Kernels which process arrays of points or boxes at once. They produce the same results as applying the
+         * corresponding single point or box operations to every element, but use SIMD instructions where available.
+         */
+
+#ifdef TRENCHBROOM_SSE
+        inline __m128 loadPoint(const Vec<float,3>& point) {
+            return _mm_setr_ps(point.v[0], point.v[1], point.v[2], 0.0f);
+        }
+
+        inline __m128 transformPoint(const __m128 columns[4], const Vec<float,3>& point) {
+            __m128 sum = _mm_mul_ps(columns[0], _mm_set1_ps(point.v[0]));
+            sum = _mm_add_ps(sum, _mm_mul_ps(columns[1], _mm_set1_ps(point.v[1])));
+            sum = _mm_add_ps(sum, _mm_mul_ps(columns[2], _mm_set1_ps(point.v[2])));
+            sum = _mm_add_ps(sum, columns[3]);
+            return _mm_div_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 3, 3)));
+        }
+#endif
+
+        /**
+         * Stores the product of the given matrix and every given point in result, which must have room for count
+         * points and may be the given points themselves. Like the product of a matrix and a single point, the results
+         * are divided by their w component.
+         */
+        inline void transformPoints(const Mat<float,4,4>& transformation, const Vec<float,3>* points, const size_t count, Vec<float,3>* result) {
+#ifdef TRENCHBROOM_SSE
+            const __m128 columns[4] = {
+                _mm_loadu_ps(transformation.v[0].v),
+                _mm_loadu_ps(transformation.v[1].v),
+                _mm_loadu_ps(transformation.v[2].v),
+                _mm_loadu_ps(transformation.v[3].v)
+            };
+
+            float transformed[4];
+            for (size_t i = 0; i < count; i++) {
+                _mm_storeu_ps(transformed, transformPoint(columns, points[i]));
+                result[i] = Vec<float,3>(transformed[0], transformed[1], transformed[2]);
+            }
+#else
+            for (size_t i = 0; i < count; i++)
+                result[i] = transformation * points[i];
+#endif
+        }
+
+        /**
+         * Stores the status of every given point with respect to the given plane in result, which must have room
+         * for count entries.
+         */
+        inline void pointStatus(const Plane<float>& plane, const Vec<float,3>* points, const size_t count, PointStatus::Type* result, const float epsilon = Math<float>::PointStatusEpsilon) {
+            size_t i = 0;
+#ifdef TRENCHBROOM_SSE
+            const __m128 normalX = _mm_set1_ps(plane.normal.v[0]);
+            const __m128 normalY = _mm_set1_ps(plane.normal.v[1]);
+            const __m128 normalZ = _mm_set1_ps(plane.normal.v[2]);
+            const __m128 distance = _mm_set1_ps(plane.distance);
+            const __m128 above = _mm_set1_ps(epsilon);
+            const __m128 below = _mm_set1_ps(-epsilon);
+
+            for (; i + 4 <= count; i += 4) {
+                const Vec<float,3>* p = points + i;
+                const __m128 x = _mm_setr_ps(p[0].v[0], p[1].v[0], p[2].v[0], p[3].v[0]);
+                const __m128 y = _mm_setr_ps(p[0].v[1], p[1].v[1], p[2].v[1], p[3].v[1]);
+                const __m128 z = _mm_setr_ps(p[0].v[2], p[1].v[2], p[2].v[2], p[3].v[2]);
+
+                __m128 dot = _mm_mul_ps(x, normalX);
+                dot = _mm_add_ps(dot, _mm_mul_ps(y, normalY));
+                dot = _mm_add_ps(dot, _mm_mul_ps(z, normalZ));
+                const __m128 dist = _mm_sub_ps(dot, distance);
+
+                const int aboveMask = _mm_movemask_ps(_mm_cmpgt_ps(dist, above));
+                const int belowMask = _mm_movemask_ps(_mm_cmplt_ps(dist, below));
+                for (size_t j = 0; j < 4; j++) {
+                    if ((aboveMask >> j) & 1)
+                        result[i + j] = PointStatus::PSAbove;
+                    else if ((belowMask >> j) & 1)
+                        result[i + j] = PointStatus::PSBelow;
+                    else
+                        result[i + j] = PointStatus::PSInside;
+                }
+            }
+#endif
+            for (; i < count; i++)
+                result[i] = plane.pointStatus(points[i], epsilon);
+        }
+
+        /**
+         * Extends the given bounds so that they contain the product of the given matrix and every given point.
+         */
+        inline void mergeTransformedBounds(BBox<float>& bounds, const Mat<float,4,4>& transformation, const Vec<float,3>* points, const size_t count) {
+#ifdef TRENCHBROOM_SSE
+            const __m128 columns[4] = {
+                _mm_loadu_ps(transformation.v[0].v),
+                _mm_loadu_ps(transformation.v[1].v),
+                _mm_loadu_ps(transformation.v[2].v),
+                _mm_loadu_ps(transformation.v[3].v)
+            };
+
+            __m128 min = loadPoint(bounds.min);
+            __m128 max = loadPoint(bounds.max);
+            for (size_t i = 0; i < count; i++) {
+                const __m128 point = transformPoint(columns, points[i]);
+                min = _mm_min_ps(min, point);
+                max = _mm_max_ps(max, point);
+            }
+
+            float values[4];
+            _mm_storeu_ps(values, min);
+            bounds.min = Vec<float,3>(values[0], values[1], values[2]);
+            _mm_storeu_ps(values, max);
+            bounds.max = Vec<float,3>(values[0], values[1], values[2]);
+#else
+            for (size_t i = 0; i < count; i++)
+                bounds.mergeWith(transformation * points[i]);
+#endif
+        }
+
+        /**
+         * Returns the reciprocal of the given ray direction component. The reciprocal of a zero component is clamped
+         * to a huge finite value of the same sign so that the slab tests below never multiply infinity by zero.
+         */
+        inline float inverseDirection(const float component) {
+            const float inverse = 1.0f / component;
+            if (component == 0.0f)
+                return inverse > 0.0f ? 1e30f : -1e30f;
+            return inverse;
+        }
+
+        inline bool intersectBoundsWithRay(const BBox<float>& bounds, const Vec<float,3>& origin, const Vec<float,3>& inverse) {
+            float nearDistance = -std::numeric_limits<float>::max();
+            float farDistance = std::numeric_limits<float>::max();
+            for (size_t i = 0; i < 3; i++) {
+                const float t1 = (bounds.min[i] - Math<float>::AlmostZero - origin[i]) * inverse[i];
+                const float t2 = (bounds.max[i] + Math<float>::AlmostZero - origin[i]) * inverse[i];
+                nearDistance = std::max(nearDistance, std::min(t1, t2));
+                farDistance = std::min(farDistance, std::max(t1, t2));
+            }
+            return nearDistance <= farDistance && farDistance >= 0.0f;
+        }
+
+        /**
+         * Determines which of the given boxes are hit by the given ray, using the slab test on four boxes at a time.
+         * The boxes are slightly enlarged so that rays which graze a box still count as hits.
+         */
+        inline void intersectBoundsWithRay(const Ray<float>& ray, const BBox<float>* const* bounds, const size_t count, std::vector<bool>& hits) {
+            const Vec<float,3> inverse(inverseDirection(ray.direction.x()),
+                                       inverseDirection(ray.direction.y()),
+                                       inverseDirection(ray.direction.z()));
+            hits.assign(count, false);
+
+            size_t i = 0;
+#ifdef TRENCHBROOM_SSE
+            const __m128 epsilon = _mm_set1_ps(Math<float>::AlmostZero);
+            const __m128 zero = _mm_setzero_ps();
+            for (; i + 4 <= count; i += 4) {
+                __m128 nearDistance = _mm_set1_ps(-std::numeric_limits<float>::max());
+                __m128 farDistance = _mm_set1_ps(std::numeric_limits<float>::max());
+                for (size_t j = 0; j < 3; j++) {
+                    const __m128 origin = _mm_set1_ps(ray.origin[j]);
+                    const __m128 factor = _mm_set1_ps(inverse[j]);
+                    const __m128 min = _mm_sub_ps(_mm_setr_ps(bounds[i]->min[j], bounds[i + 1]->min[j], bounds[i + 2]->min[j], bounds[i + 3]->min[j]), epsilon);
+                    const __m128 max = _mm_add_ps(_mm_setr_ps(bounds[i]->max[j], bounds[i + 1]->max[j], bounds[i + 2]->max[j], bounds[i + 3]->max[j]), epsilon);
+                    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(min, origin), factor);
+                    const __m128 t2 = _mm_mul_ps(_mm_sub_ps(max, origin), factor);
+                    nearDistance = _mm_max_ps(nearDistance, _mm_min_ps(t1, t2));
+                    farDistance = _mm_min_ps(farDistance, _mm_max_ps(t1, t2));
+                }
+
+                const int mask = _mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(nearDistance, farDistance), _mm_cmpge_ps(farDistance, zero)));
+                for (size_t j = 0; j < 4; j++)
+                    hits[i + j] = (mask & (1 << j)) != 0;
+            }
+#endif
+            for (; i < count; i++)
+                hits[i] = intersectBoundsWithRay(*bounds[i], ray.origin, inverse);
+        }
+    }
+}
+
+#endif
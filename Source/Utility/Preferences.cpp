@@ -154,11 +154,15 @@ namespace TrenchBroom {
         const Preference<String> RendererFontName = Preference<String>(                         "Renderer/Font name",                                           "Arial");
 #endif
 
+        const Preference<bool>  UseGeometryCache = Preference<bool>(                            "General/Use geometry cache",                                   true);
+
         const Preference<int>   RendererInstancingMode = Preference<int>(                       "Renderer/Instancing mode",                                     0);
         const int               RendererInstancingModeAutodetect    = 0;
         const int               RendererInstancingModeForceOn       = 1;
         const int               RendererInstancingModeForceOff      = 2;
 
+        const Preference<bool>  RendererTextureCompression = Preference<bool>(                  "Renderer/Compress textures",                                   false);
+
         const Preference<KeyboardShortcut>  CameraMoveForward = Preference<KeyboardShortcut>(   "Controls/Camera/Move Forward",     KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'W', KeyboardShortcut::SCAny, "Move Camera Forward"));
         const Preference<KeyboardShortcut>  CameraMoveBackward = Preference<KeyboardShortcut>(  "Controls/Camera/Move Backward",    KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'S', KeyboardShortcut::SCAny, "Move Camera Backward"));
         const Preference<KeyboardShortcut>  CameraMoveLeft = Preference<KeyboardShortcut>(      "Controls/Camera/Move Left",        KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'A', KeyboardShortcut::SCAny, "Move Camera Left"));
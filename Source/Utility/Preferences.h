@@ -358,11 +358,13 @@ namespace TrenchBroom {
         extern const Preference<float>  TextureBrowserIconSize;
 
         extern const Preference<String> QuakePath;
+        extern const Preference<bool>   UseGeometryCache;
         extern const Preference<String> RendererFontName;
         extern const Preference<int>    RendererInstancingMode;
         extern const int                RendererInstancingModeAutodetect;
         extern const int                RendererInstancingModeForceOn;
         extern const int                RendererInstancingModeForceOff;
+        extern const Preference<bool>   RendererTextureCompression;
 
         extern const Preference<KeyboardShortcut>   CameraMoveForward;
         extern const Preference<KeyboardShortcut>   CameraMoveBackward;
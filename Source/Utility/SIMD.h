@@ -0,0 +1,30 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_SIMD_h
+#define TrenchBroom_SIMD_h
+
+// SSE is available on every x86-64 target and on 32 bit targets that are built with /arch:SSE or -msse. Define
+// TRENCHBROOM_NO_SIMD to build the scalar code paths instead.
+#if !defined TRENCHBROOM_NO_SIMD && (defined __SSE__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 1))
+#define TRENCHBROOM_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#endif
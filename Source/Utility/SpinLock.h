@@ -0,0 +1,73 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_SpinLock_h
+#define TrenchBroom_SpinLock_h
+
+#if defined _WIN32
+#include <intrin.h>
+#pragma intrinsic(_InterlockedExchange)
+#endif
+
+namespace TrenchBroom {
+    namespace Utility {
+        /**
+         * A minimal lock for guarding very short critical sections. Unlike wxCriticalSection, it does not depend on
+         * wxWidgets and needs no construction, so a zero initialized static spin lock is a valid, unlocked lock.
+         */
+        class SpinLock {
+        private:
+            volatile long m_locked;
+        public:
+            inline void lock() {
+#if defined _WIN32
+                while (_InterlockedExchange(&m_locked, 1) != 0)
+                    while (m_locked != 0);
+#else
+                while (__sync_lock_test_and_set(&m_locked, 1) != 0)
+                    while (m_locked != 0);
+#endif
+            }
+
+            inline void unlock() {
+#if defined _WIN32
+                _InterlockedExchange(&m_locked, 0);
+#else
+                __sync_lock_release(&m_locked);
+#endif
+            }
+        };
+
+        class SpinLocker {
+        private:
+            SpinLock& m_lock;
+        public:
+            SpinLocker(SpinLock& lock) :
+            m_lock(lock) {
+                m_lock.lock();
+            }
+
+            ~SpinLocker() {
+                m_lock.unlock();
+            }
+        };
+    }
+}
+
+#endif
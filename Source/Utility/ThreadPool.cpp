@@ -0,0 +1,225 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThreadPool.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Utility {
+        ThreadPool::TaskGroup::TaskGroup() :
+        m_pendingTasks(0),
+        m_condition(m_mutex) {}
+
+        void ThreadPool::TaskGroup::taskAdded() {
+            wxMutexLocker lock(m_mutex);
+            m_pendingTasks++;
+        }
+
+        void ThreadPool::TaskGroup::taskDone() {
+            wxMutexLocker lock(m_mutex);
+            assert(m_pendingTasks > 0);
+            m_pendingTasks--;
+            if (m_pendingTasks == 0)
+                m_condition.Broadcast();
+        }
+
+        bool ThreadPool::TaskGroup::done() {
+            wxMutexLocker lock(m_mutex);
+            return m_pendingTasks == 0;
+        }
+
+        void ThreadPool::TaskGroup::waitUntilDone() {
+            wxMutexLocker lock(m_mutex);
+            while (m_pendingTasks > 0)
+                m_condition.Wait();
+        }
+
+        void ThreadPool::WorkQueue::push(const QueuedTask& queuedTask) {
+            wxCriticalSectionLocker lock(m_lock);
+            m_tasks.push_back(queuedTask);
+        }
+
+        bool ThreadPool::WorkQueue::pop(QueuedTask& queuedTask) {
+            wxCriticalSectionLocker lock(m_lock);
+            if (m_tasks.empty())
+                return false;
+            queuedTask = m_tasks.back();
+            m_tasks.pop_back();
+            return true;
+        }
+
+        bool ThreadPool::WorkQueue::steal(QueuedTask& queuedTask) {
+            wxCriticalSectionLocker lock(m_lock);
+            if (m_tasks.empty())
+                return false;
+            queuedTask = m_tasks.front();
+            m_tasks.pop_front();
+            return true;
+        }
+
+        ThreadPool::Worker::Worker(ThreadPool& pool, size_t index) :
+        wxThread(wxTHREAD_JOINABLE),
+        m_pool(pool),
+        m_index(index) {}
+
+        wxThread::ExitCode ThreadPool::Worker::Entry() {
+            m_pool.work(m_index);
+            return 0;
+        }
+
+        ThreadPool* ThreadPool::sharedPool = NULL;
+
+        size_t ThreadPool::queueIndex() {
+            // tasks that are submitted by a worker go to its own queue, where it will find them first
+            wxThread* thread = wxThread::This();
+            if (thread != NULL) {
+                for (size_t i = 0; i < m_workers.size(); i++)
+                    if (m_workers[i] == thread)
+                        return i;
+            }
+
+            wxMutexLocker lock(m_mutex);
+            const size_t index = m_nextQueue;
+            m_nextQueue = (m_nextQueue + 1) % m_queues.size();
+            return index;
+        }
+
+        bool ThreadPool::takeTask(size_t queueIndex, QueuedTask& queuedTask) {
+            bool found = m_queues[queueIndex]->pop(queuedTask);
+            for (size_t i = 1; i < m_queues.size() && !found; i++)
+                found = m_queues[(queueIndex + i) % m_queues.size()]->steal(queuedTask);
+            if (!found)
+                return false;
+
+            wxMutexLocker lock(m_mutex);
+            assert(m_queuedTasks > 0);
+            m_queuedTasks--;
+            return true;
+        }
+
+        void ThreadPool::runTask(const QueuedTask& queuedTask) {
+            queuedTask.task->run();
+            delete queuedTask.task;
+            if (queuedTask.group != NULL)
+                queuedTask.group->taskDone();
+        }
+
+        void ThreadPool::work(size_t workerIndex) {
+            while (true) {
+                QueuedTask queuedTask;
+                if (takeTask(workerIndex, queuedTask)) {
+                    runTask(queuedTask);
+                    continue;
+                }
+
+                wxMutexLocker lock(m_mutex);
+                while (m_queuedTasks == 0 && !m_stopping)
+                    m_condition.Wait();
+                if (m_queuedTasks == 0 && m_stopping)
+                    return;
+            }
+        }
+
+        ThreadPool::ThreadPool(size_t workerCount) :
+        m_nextQueue(0),
+        m_queuedTasks(0),
+        m_stopping(false),
+        m_condition(m_mutex) {
+            // the waiting threads need a queue even if there are no workers
+            const size_t queueCount = workerCount > 0 ? workerCount : 1;
+            for (size_t i = 0; i < queueCount; i++)
+                m_queues.push_back(new WorkQueue());
+
+            for (size_t i = 0; i < workerCount; i++) {
+                Worker* worker = new Worker(*this, i);
+                if (worker->Create() != wxTHREAD_NO_ERROR) {
+                    delete worker;
+                    break;
+                }
+                m_workers.push_back(worker);
+            }
+
+            // the workers look themselves up in the worker list, so they must not run before it is complete
+            for (size_t i = 0; i < m_workers.size(); i++)
+                m_workers[i]->Run();
+        }
+
+        ThreadPool::~ThreadPool() {
+            {
+                wxMutexLocker lock(m_mutex);
+                m_stopping = true;
+                m_condition.Broadcast();
+            }
+
+            // the workers finish all queued tasks before they exit
+            for (size_t i = 0; i < m_workers.size(); i++) {
+                m_workers[i]->Wait();
+                delete m_workers[i];
+            }
+            m_workers.clear();
+
+            QueuedTask queuedTask;
+            for (size_t i = 0; i < m_queues.size(); i++) {
+                while (m_queues[i]->pop(queuedTask))
+                    runTask(queuedTask);
+                delete m_queues[i];
+            }
+            m_queues.clear();
+        }
+
+        size_t ThreadPool::defaultWorkerCount() {
+            const int cpuCount = wxThread::GetCPUCount();
+            return cpuCount > 1 ? static_cast<size_t>(cpuCount - 1) : 0;
+        }
+
+        void ThreadPool::submit(Task* task, TaskGroup* group) {
+            assert(task != NULL);
+            if (group != NULL)
+                group->taskAdded();
+
+            if (m_workers.empty()) {
+                runTask(QueuedTask(task, group));
+                return;
+            }
+
+            const size_t index = queueIndex();
+
+            // the task is counted before it can be taken so that the count never drops below zero
+            wxMutexLocker lock(m_mutex);
+            m_queuedTasks++;
+            m_queues[index]->push(QueuedTask(task, group));
+            m_condition.Signal();
+        }
+
+        void ThreadPool::wait(TaskGroup& group) {
+            const size_t index = queueIndex();
+            while (!group.done()) {
+                QueuedTask queuedTask;
+                if (takeTask(index, queuedTask)) {
+                    runTask(queuedTask);
+                } else {
+                    // the remaining tasks of the group are running on other threads
+                    group.waitUntilDone();
+                    return;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,148 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__ThreadPool__
+#define __TrenchBroom__ThreadPool__
+
+#include <wx/thread.h>
+
+#include <deque>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Utility {
+        /**
+         * A fixed set of worker threads which run short, independent tasks. Every worker has its own task queue; a
+         * worker takes the most recently queued task from its own queue and steals the oldest task from the other
+         * queues when its own queue is empty, which keeps the workers busy without contending for a single lock.
+         *
+         * Tasks that are submitted from a worker go to that worker's queue, all other tasks are distributed among
+         * the queues in turn. The pool is shared by the whole application and is created and destroyed by the app.
+         *
+         * All public members are thread safe.
+         */
+        class ThreadPool {
+        public:
+            /**
+             * A unit of work for the pool. Tasks must not throw. The pool deletes a task after it has run.
+             */
+            class Task {
+            public:
+                virtual ~Task() {}
+                virtual void run() = 0;
+            };
+
+            /**
+             * Tracks a number of tasks so that a thread can wait until all of them are done.
+             */
+            class TaskGroup {
+            private:
+                size_t m_pendingTasks;
+                wxMutex m_mutex;
+                wxCondition m_condition;
+
+                friend class ThreadPool;
+                void taskAdded();
+                void taskDone();
+                bool done();
+                void waitUntilDone();
+            public:
+                TaskGroup();
+            };
+        private:
+            class QueuedTask {
+            public:
+                Task* task;
+                TaskGroup* group;
+
+                QueuedTask() :
+                task(NULL),
+                group(NULL) {}
+
+                QueuedTask(Task* i_task, TaskGroup* i_group) :
+                task(i_task),
+                group(i_group) {}
+            };
+
+            class WorkQueue {
+            private:
+                std::deque<QueuedTask> m_tasks;
+                wxCriticalSection m_lock;
+            public:
+                void push(const QueuedTask& queuedTask);
+                bool pop(QueuedTask& queuedTask);
+                bool steal(QueuedTask& queuedTask);
+            };
+
+            class Worker : public wxThread {
+            private:
+                ThreadPool& m_pool;
+                size_t m_index;
+            public:
+                Worker(ThreadPool& pool, size_t index);
+                ExitCode Entry();
+            };
+
+            typedef std::vector<Worker*> WorkerList;
+            typedef std::vector<WorkQueue*> WorkQueueList;
+
+            WorkerList m_workers;
+            WorkQueueList m_queues;
+            size_t m_nextQueue;
+            size_t m_queuedTasks;
+            bool m_stopping;
+            wxMutex m_mutex;
+            wxCondition m_condition;
+
+            size_t queueIndex();
+            bool takeTask(size_t queueIndex, QueuedTask& queuedTask);
+            void runTask(const QueuedTask& queuedTask);
+            void work(size_t workerIndex);
+        public:
+            static ThreadPool* sharedPool;
+
+            /**
+             * Creates a pool with the given number of workers. By default, there is one worker less than there are
+             * CPUs because the thread that waits for tasks helps running them.
+             */
+            ThreadPool(size_t workerCount = defaultWorkerCount());
+            ~ThreadPool();
+
+            static size_t defaultWorkerCount();
+
+            inline size_t workerCount() const {
+                return m_workers.size();
+            }
+
+            /**
+             * Queues the given task and takes ownership of it. If a group is given, the task is added to it. A pool
+             * without workers runs the task right away on the calling thread.
+             */
+            void submit(Task* task, TaskGroup* group = NULL);
+
+            /**
+             * Returns when all tasks of the given group are done. The calling thread runs queued tasks while it waits,
+             * so it is safe to wait for a group from within a task.
+             */
+            void wait(TaskGroup& group);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__ThreadPool__) */
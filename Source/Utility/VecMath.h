@@ -36,6 +36,7 @@
 #include "Utility/Mat.h"
 #include "Utility/Mat.h"
 #include "Utility/Plane.h"
+#include "Utility/Points.h"
 #include "Utility/Quat.h"
 #include "Utility/Ray.h"
 #include "Utility/Vec.h"
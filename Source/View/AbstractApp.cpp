@@ -26,11 +26,13 @@
 #include <wx/fs_mem.h>
 
 #include "IO/FileManager.h"
+#include "IO/GameFileSystem.h"
 #include "IO/Pak.h"
 #include "Model/Alias.h"
 #include "Model/Bsp.h"
 #include "Model/MapDocument.h"
 #include "Utility/DocManager.h"
+#include "Utility/ThreadPool.h"
 #include "View/AboutDialog.h"
 #include "View/CommandIds.h"
 #include "View/EditorFrame.h"
@@ -213,8 +215,10 @@ bool AbstractApp::OnInit() {
 
     // initialize globals
     TrenchBroom::IO::PakManager::sharedManager = new TrenchBroom::IO::PakManager();
+    TrenchBroom::IO::GameFileSystem::sharedFileSystem = new TrenchBroom::IO::GameFileSystem();
     TrenchBroom::Model::AliasManager::sharedManager = new TrenchBroom::Model::AliasManager();
     TrenchBroom::Model::BspManager::sharedManager = new TrenchBroom::Model::BspManager();
+    TrenchBroom::Utility::ThreadPool::sharedPool = new TrenchBroom::Utility::ThreadPool();
 
 	m_docManager = new DocManager();
     m_docManager->FileHistoryLoad(*wxConfig::Get());
@@ -256,6 +260,11 @@ int AbstractApp::OnExit() {
     wxDELETE(m_docManager);
     wxDELETE(m_helpController);
 
+    // queued tasks may still use the other globals
+    delete TrenchBroom::Utility::ThreadPool::sharedPool;
+    TrenchBroom::Utility::ThreadPool::sharedPool = NULL;
+    delete TrenchBroom::IO::GameFileSystem::sharedFileSystem;
+    TrenchBroom::IO::GameFileSystem::sharedFileSystem = NULL;
     delete TrenchBroom::IO::PakManager::sharedManager;
     TrenchBroom::IO::PakManager::sharedManager = NULL;
     delete TrenchBroom::Model::AliasManager::sharedManager;
@@ -88,7 +88,7 @@ namespace TrenchBroom {
             }
 
             inline bool intersectsY(float y, float height) const {
-                return bottom() >= y || top() <= y + height;
+                return bottom() >= y && top() <= y + height;
             }
         };
 
@@ -352,15 +352,22 @@ namespace TrenchBroom {
                 }
             }
 
+            /**
+             * Returns the index of the first row whose bottom is below the given y coordinate, or the number of
+             * rows if there is no such row. Since the rows are sorted by their y coordinates, the row is found
+             * by binary search.
+             */
             size_t indexOfRowAt(float y) const {
-                for (size_t i = 0; i < m_rows.size(); i++) {
-                    const Row& row = m_rows[i];
-                    const LayoutBounds& rowBounds = row.bounds();
-                    if (y < rowBounds.bottom())
-                        return i;
+                size_t first = 0;
+                size_t last = m_rows.size();
+                while (first < last) {
+                    const size_t mid = first + (last - first) / 2;
+                    if (y < m_rows[mid].bounds().bottom())
+                        last = mid;
+                    else
+                        first = mid + 1;
                 }
-                
-                return m_rows.size();
+                return first;
             }
             
             bool rowAt(float y, const Row** result) const {
@@ -446,6 +453,7 @@ namespace TrenchBroom {
             GroupList m_groups;
             bool m_valid;
             float m_height;
+            unsigned int m_revision;
 
             void validate() {
                 if (m_width <= 0.0f)
@@ -494,7 +502,8 @@ namespace TrenchBroom {
             m_minCellWidth(100.0f),
             m_maxCellWidth(100.0f),
             m_minCellHeight(100.0f),
-            m_maxCellHeight(100.0f) {
+            m_maxCellHeight(100.0f),
+            m_revision(0) {
                 invalidate();
             }
 
@@ -538,6 +547,7 @@ namespace TrenchBroom {
 
                 m_groups.push_back(Group(groupItem, m_outerMargin, y, m_cellMargin, m_rowMargin, titleHeight, m_width - 2.0f * m_outerMargin, m_maxCellsPerRow, m_maxUpScale, m_minCellWidth, m_maxCellWidth, m_minCellHeight, m_maxCellHeight));
                 m_height += m_groups.back().bounds().height();
+                m_revision++;
             }
 
             void addItem(const CellType item, float itemWidth, float itemHeight, float titleWidth, float titleHeight) {
@@ -556,6 +566,7 @@ namespace TrenchBroom {
                 const float newGroupHeight = m_groups.back().bounds().height();
 
                 m_height += (newGroupHeight - oldGroupHeight);
+                m_revision++;
             }
 
             inline void clear() {
@@ -581,6 +592,26 @@ namespace TrenchBroom {
                 return false;
             }
 
+            /**
+             * Returns the index of the first group whose bottom is below the given y coordinate, or the number of
+             * groups if there is no such group.
+             */
+            size_t indexOfGroupAt(float y) {
+                if (!m_valid)
+                    validate();
+
+                size_t first = 0;
+                size_t last = m_groups.size();
+                while (first < last) {
+                    const size_t mid = first + (last - first) / 2;
+                    if (y < m_groups[mid].bounds().bottom())
+                        last = mid;
+                    else
+                        first = mid + 1;
+                }
+                return first;
+            }
+
             bool groupAt(float x, float y, Group* result) {
                 if (!m_valid)
                     validate();
@@ -659,6 +690,16 @@ namespace TrenchBroom {
 
             inline void invalidate() {
                 m_valid = false;
+                m_revision++;
+            }
+
+            /**
+             * Returns a number that changes whenever the cells of this layout are added, removed or moved, so that
+             * clients can tell whether data they derived from the layout is stale. Only meaningful after the layout
+             * has been validated, e.g. by calling size().
+             */
+            inline unsigned int revision() const {
+                return m_revision;
             }
 
             inline void setWidth(float width) {
@@ -724,7 +765,7 @@ namespace TrenchBroom {
             }
             
             inline float outerMargin() const {
-                return m_outerMargin();
+                return m_outerMargin;
             }
             
             inline float groupMargin() const {
@@ -736,7 +777,7 @@ namespace TrenchBroom {
             }
             
             inline float cellMargin() const {
-                return m_cellMargin();
+                return m_cellMargin;
             }
         };
     }
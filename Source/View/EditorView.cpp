@@ -675,7 +675,6 @@ namespace TrenchBroom {
                             }
                             if (entityPropertyCommand.isPropertyAffected(Model::Entity::WadKey)) {
                                 mapDocument().loadTextures();
-                                mapDocument().sharedResources().textureRendererManager().invalidate();
                             }
                         }
                         break;
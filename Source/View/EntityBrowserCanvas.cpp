@@ -26,6 +26,8 @@
 #include "Renderer/EntityModelRendererManager.h"
 #include "Renderer/RenderUtils.h"
 #include "Renderer/SharedResources.h"
+#include "Renderer/ThumbnailAtlas.h"
+#include "Renderer/Transformation.h"
 #include "Renderer/Vbo.h"
 #include "Renderer/VertexArray.h"
 #include "Renderer/Shader/Shader.h"
@@ -36,6 +38,8 @@
 #include "View/DocumentViewHolder.h"
 #include "View/EditorView.h"
 
+#include <algorithm>
+#include <cmath>
 #include <map>
 
 namespace TrenchBroom {
@@ -48,8 +52,8 @@ namespace TrenchBroom {
                 const Vec2f actualSize = fontManager.font(actualFont)->measure(definition->name());
 
                 Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
-                const StringList& searchPaths = m_documentViewHolder.document().searchPaths();
-                Renderer::EntityModelRenderer* modelRenderer = modelRendererManager.modelRenderer(*definition, searchPaths);
+                const unsigned int searchPathsId = m_documentViewHolder.document().searchPathsId();
+                Renderer::EntityModelRenderer* modelRenderer = modelRendererManager.modelRenderer(*definition, searchPathsId);
 
                 BBoxf rotatedBounds;
                 if (modelRenderer != NULL) {
@@ -149,11 +153,257 @@ namespace TrenchBroom {
         }
 
         void EntityBrowserCanvas::doClear() {
+            clearGeometry();
+            clearThumbnails();
+        }
+
+        void EntityBrowserCanvas::clearGeometry() {
+            delete m_thumbnailArray;
+            m_thumbnailArray = NULL;
+            for (size_t i = 0; i < m_titleArrays.size(); i++)
+                delete m_titleArrays[i].vertexArray;
+            m_titleArrays.clear();
+            m_cells.clear();
+            m_groupRowOffsets.clear();
+            m_rowCellOffsets.clear();
+            m_visibleCells.clear();
+        }
+
+        void EntityBrowserCanvas::clearThumbnails() {
+            if (m_thumbnailAtlas != NULL)
+                m_thumbnailAtlas->freeAllTiles();
+            m_thumbnails.clear();
+            for (size_t i = 0; i < m_cells.size(); i++)
+                m_cells[i].hasThumbnail = false;
+        }
+
+        size_t EntityBrowserCanvas::titleArrayIndex(const Renderer::Text::FontDescriptor& fontDescriptor) {
+            for (size_t i = 0; i < m_titleArrays.size(); i++)
+                if (m_titleArrays[i].fontDescriptor.compare(fontDescriptor) == 0)
+                    return i;
+            m_titleArrays.push_back(TitleArray(fontDescriptor));
+            return m_titleArrays.size() - 1;
+        }
+
+        void EntityBrowserCanvas::thumbnailSize(const Layout::Group::Row::Cell& cell, unsigned int& width, unsigned int& height) const {
+            const LayoutBounds& itemBounds = cell.itemBounds();
+            width = std::min(static_cast<unsigned int>(std::ceil(itemBounds.width())), m_thumbnailAtlas->tileWidth());
+            height = std::min(static_cast<unsigned int>(std::ceil(itemBounds.height())), m_thumbnailAtlas->tileHeight());
+        }
+
+        void EntityBrowserCanvas::writeThumbnailQuad(size_t cellIndex, const Layout::Group::Row::Cell& cell, const Thumbnail& thumbnail) {
+            // the thumbnail is aligned with the bottom left corner of the item
+            const LayoutBounds& itemBounds = cell.itemBounds();
+            const float left = itemBounds.left();
+            const float right = left + static_cast<float>(thumbnail.width);
+            const float bottom = -itemBounds.bottom();
+            const float top = bottom + static_cast<float>(thumbnail.height);
+
+            m_thumbnailArray->seek(4 * cellIndex);
+            m_thumbnailArray->addAttribute(Vec2f(left, top));
+            m_thumbnailArray->addAttribute(m_thumbnailAtlas->texCoords(thumbnail.tile, 0, thumbnail.height));
+            m_thumbnailArray->addAttribute(Vec2f(left, bottom));
+            m_thumbnailArray->addAttribute(m_thumbnailAtlas->texCoords(thumbnail.tile, 0, 0));
+            m_thumbnailArray->addAttribute(Vec2f(right, bottom));
+            m_thumbnailArray->addAttribute(m_thumbnailAtlas->texCoords(thumbnail.tile, thumbnail.width, 0));
+            m_thumbnailArray->addAttribute(Vec2f(right, top));
+            m_thumbnailArray->addAttribute(m_thumbnailAtlas->texCoords(thumbnail.tile, thumbnail.width, thumbnail.height));
+
+            CellGeometry& geometry = m_cells[cellIndex];
+            geometry.hasThumbnail = true;
+            geometry.thumbnailPage = thumbnail.tile.page;
+        }
+
+        void EntityBrowserCanvas::validateGeometry(Layout& layout) {
+            clearGeometry();
+
+            Renderer::Text::FontManager& fontManager = m_documentViewHolder.document().sharedResources().fontManager();
+            std::vector<Vec2f::List> titleVertices;
+
+            // the vertices are stored in layout coordinates with the y axis flipped, the scroll position is applied when rendering
+            const size_t groupCount = layout.size();
+            for (size_t i = 0; i < groupCount; i++) {
+                const Layout::Group& group = layout[i];
+                m_groupRowOffsets.push_back(m_rowCellOffsets.size());
+                for (size_t j = 0; j < group.size(); j++) {
+                    const Layout::Group::Row& row = group[j];
+                    m_rowCellOffsets.push_back(m_cells.size());
+                    for (size_t k = 0; k < row.size(); k++) {
+                        const Layout::Group::Row::Cell& cell = row[k];
+                        const size_t arrayIndex = titleArrayIndex(cell.item().fontDescriptor);
+                        if (arrayIndex >= titleVertices.size())
+                            titleVertices.resize(arrayIndex + 1);
+
+                        const LayoutBounds& titleBounds = cell.titleBounds();
+                        const Vec2f offset(titleBounds.left(), -titleBounds.bottom());
+                        Renderer::Text::TexturedFont* font = fontManager.font(cell.item().fontDescriptor);
+                        const Vec2f::List quads = font->quads(cell.item().entityDefinition->name(), false, offset);
+
+                        Vec2f::List& vertices = titleVertices[arrayIndex];
+                        m_cells.push_back(CellGeometry(arrayIndex, vertices.size() / 2, quads.size() / 2));
+                        vertices.insert(vertices.end(), quads.begin(), quads.end());
+                    }
+                }
+            }
+
+            m_layoutRevision = layout.revision();
+            if (m_cells.empty())
+                return;
+
+            m_thumbnailArray = new Renderer::VertexArray(*m_vbo, GL_QUADS, 4 * m_cells.size(),
+                                                         Renderer::Attribute::position2f(),
+                                                         Renderer::Attribute::texCoord02f());
+            for (size_t i = 0; i < m_titleArrays.size(); i++) {
+                if (!titleVertices[i].empty())
+                    m_titleArrays[i].vertexArray = new Renderer::VertexArray(*m_vbo, GL_QUADS, titleVertices[i].size() / 2,
+                                                                             Renderer::Attribute::position2f(),
+                                                                             Renderer::Attribute::texCoord02f(), 0);
+            }
+
+            Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
+            for (size_t i = 0; i < m_titleArrays.size(); i++) {
+                if (m_titleArrays[i].vertexArray != NULL)
+                    m_titleArrays[i].vertexArray->addAttributes(titleVertices[i]);
+            }
+
+            // thumbnails which were rendered for a previous layout can be reused if the size of their items is unchanged
+            size_t cellIndex = 0;
+            for (size_t i = 0; i < groupCount; i++) {
+                const Layout::Group& group = layout[i];
+                for (size_t j = 0; j < group.size(); j++) {
+                    const Layout::Group::Row& row = group[j];
+                    for (size_t k = 0; k < row.size(); k++) {
+                        const Layout::Group::Row::Cell& cell = row[k];
+                        ThumbnailCache::const_iterator it = m_thumbnails.find(cell.item().entityDefinition);
+                        if (it != m_thumbnails.end()) {
+                            unsigned int width, height;
+                            thumbnailSize(cell, width, height);
+                            if (it->second.width == width && it->second.height == height)
+                                writeThumbnailQuad(cellIndex, cell, it->second);
+                        }
+                        cellIndex++;
+                    }
+                }
+            }
+        }
+
+        void EntityBrowserCanvas::collectVisibleCells(Layout& layout, float y, float height) {
+            m_visibleCells.clear();
+
+            const size_t groupCount = layout.size();
+            for (size_t i = layout.indexOfGroupAt(y); i < groupCount; i++) {
+                const Layout::Group& group = layout[i];
+                if (group.bounds().top() > y + height)
+                    break;
+
+                for (size_t j = group.indexOfRowAt(y); j < group.size(); j++) {
+                    const Layout::Group::Row& row = group[j];
+                    if (row.bounds().top() > y + height)
+                        break;
+
+                    const size_t firstCell = m_rowCellOffsets[m_groupRowOffsets[i] + j];
+                    for (size_t k = 0; k < row.size(); k++)
+                        m_visibleCells.push_back(VisibleCell(firstCell + k, &row[k]));
+                }
+            }
+        }
+
+        bool EntityBrowserCanvas::validateThumbnails() {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const float brightness = prefs.getFloat(Preferences::RendererBrightness);
+            if (brightness != m_thumbnailBrightness) {
+                clearThumbnails();
+                m_thumbnailBrightness = brightness;
+            }
+
+            VisibleCellList pendingCells;
+            for (size_t i = 0; i < m_visibleCells.size(); i++)
+                if (!m_cells[m_visibleCells[i].first].hasThumbnail)
+                    pendingCells.push_back(m_visibleCells[i]);
+
+            if (pendingCells.empty())
+                return false;
+
+            // only render a few thumbnails per frame so that opening the browser and scrolling stay smooth, the
+            // remaining thumbnails are rendered in the following frames
+            const size_t thumbnailCount = pendingCells.size() < MaxThumbnailsPerFrame ? pendingCells.size() : MaxThumbnailsPerFrame;
+
+            Renderer::ShaderManager& shaderManager = m_documentViewHolder.document().sharedResources().shaderManager();
+            Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
+            const Mat4f view = viewMatrix(Vec3f::NegX, Vec3f::PosZ) * translationMatrix(Vec3f(256.0f, 0.0f, 0.0f));
+
+            m_thumbnailRenderer.preRender();
+            glEnable(GL_DEPTH_TEST);
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+            // the thumbnails are stored with premultiplied alpha so that the resolved multisamples blend correctly
+            glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+            for (size_t i = 0; i < thumbnailCount; i++) {
+                const Layout::Group::Row::Cell& cell = *pendingCells[i].second;
+                Model::PointEntityDefinition* definition = cell.item().entityDefinition;
+
+                unsigned int width, height;
+                thumbnailSize(cell, width, height);
+
+                ThumbnailCache::iterator it = m_thumbnails.find(definition);
+                if (it == m_thumbnails.end()) {
+                    it = m_thumbnails.insert(ThumbnailCache::value_type(definition, Thumbnail(m_thumbnailAtlas->allocateTile(), width, height))).first;
+                } else {
+                    it->second.width = width;
+                    it->second.height = height;
+                }
+
+                const Mat4f projection = orthoMatrix(-1024.0f, 1024.0f, 0.0f, static_cast<float>(height), static_cast<float>(width), 0.0f);
+                Renderer::Transformation transformation(projection, view);
+
+                glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+                Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
+                if (modelRenderer == NULL) {
+                    Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::EdgeShader);
+                    renderEntityBounds(transformation, shader.currentShader(), *definition, cell.item().bounds, Vec3f::Null, cell.scale());
+                } else {
+                    Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::EntityModelShader);
+                    shader.setUniformVariable("ApplyTinting", false);
+                    shader.setUniformVariable("Brightness", brightness);
+                    shader.setUniformVariable("GrayScale", false);
+
+                    modelRendererManager.activate();
+                    renderEntityModel(transformation, shader.currentShader(), *modelRenderer, cell.item().bounds, Vec3f::Null, cell.scale());
+                    modelRendererManager.deactivate();
+                }
+
+                m_thumbnailAtlas->storeTile(it->second.tile, m_thumbnailRenderer, width, height);
+            }
+
+            m_thumbnailRenderer.postRender();
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glDisable(GL_DEPTH_TEST);
+
+            const wxRect clientRect = GetClientRect();
+            glViewport(clientRect.GetLeft(), clientRect.GetTop(), clientRect.GetWidth(), clientRect.GetHeight());
+
+            Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
+            for (size_t i = 0; i < thumbnailCount; i++) {
+                const VisibleCell& visibleCell = pendingCells[i];
+                const Thumbnail& thumbnail = m_thumbnails.find(visibleCell.second->item().entityDefinition)->second;
+                writeThumbnailQuad(visibleCell.first, *visibleCell.second, thumbnail);
+            }
+
+            return pendingCells.size() > thumbnailCount;
         }
 
         void EntityBrowserCanvas::doRender(Layout& layout, float y, float height) {
             if (m_vbo == NULL)
                 m_vbo = new Renderer::Vbo(GL_ARRAY_BUFFER, 0xFFFF);
+            if (m_thumbnailAtlas == NULL) {
+                const unsigned int tileWidth = static_cast<unsigned int>(std::ceil(layout.maxCellWidth()));
+                const unsigned int tileHeight = static_cast<unsigned int>(std::ceil(layout.maxCellHeight()));
+                m_thumbnailAtlas = new Renderer::ThumbnailAtlas(tileWidth, tileHeight);
+                m_thumbnailRenderer.setDimensions(tileWidth, tileHeight);
+            }
 
             Renderer::ShaderManager& shaderManager = m_documentViewHolder.document().sharedResources().shaderManager();
             Renderer::Text::FontManager& fontManager = m_documentViewHolder.document().sharedResources().fontManager();
@@ -162,11 +412,14 @@ namespace TrenchBroom {
             Renderer::Text::FontDescriptor defaultDescriptor(prefs.getString(Preferences::RendererFontName),
                                                              static_cast<unsigned int>(prefs.getInt(Preferences::TextureBrowserFontSize)));
 
-            Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
+            const size_t groupCount = layout.size();
+            if (layout.revision() != m_layoutRevision)
+                validateGeometry(layout);
+            collectVisibleCells(layout, y, height);
 
             glEnable(GL_BLEND);
             glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glEnable(GL_DEPTH_TEST);
+            const bool pendingThumbnails = validateThumbnails();
 
             const float viewLeft      = static_cast<float>(GetClientRect().GetLeft());
             const float viewTop       = static_cast<float>(GetClientRect().GetBottom());
@@ -174,125 +427,71 @@ namespace TrenchBroom {
             const float viewBottom    = static_cast<float>(GetClientRect().GetTop());
 
             const Mat4f projection = orthoMatrix(-1024.0f, 1024.0f, viewLeft, viewTop, viewRight, viewBottom);
-            Renderer::Transformation transformation(projection, viewMatrix(Vec3f::NegX, Vec3f::PosZ) * translationMatrix(Vec3f(256.0f, 0.0f, 0.0f)));
-
-            size_t visibleGroupCount = 0;
-            size_t visibleItemCount = 0;
-
-            typedef std::map<Renderer::Text::FontDescriptor, Vec2f::List> StringMap;
-            StringMap stringVertices;
-
-            for (unsigned int i = 0; i < layout.size(); i++) {
+            const Mat4f view = viewMatrix(Vec3f::NegZ, Vec3f::PosY) * translationMatrix(Vec3f(0.0f, 0.0f, -1.0f));
+            const Mat4f model = translationMatrix(Vec3f(0.0f, height + y, 0.0f));
+            Renderer::Transformation transformation(projection, view, model);
+
+            // the group titles stick to the top of the view, so they are the only vertices that depend on the scroll position
+            Vec2f::List groupBackgroundVertices;
+            Vec2f::List groupTitleVertices;
+            for (size_t i = layout.indexOfGroupAt(y); i < groupCount; i++) {
                 const Layout::Group& group = layout[i];
-                if (group.intersectsY(y, height)) {
-                    visibleGroupCount++;
-
-                    const String& title = group.item();
-                    if (!title.empty()) {
-                        const LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
-                        const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
-
-                        Renderer::Text::TexturedFont* font = fontManager.font(defaultDescriptor);
-                        Vec2f::List titleVertices = font->quads(title, false, offset);
-                        Vec2f::List& vertices = stringVertices[defaultDescriptor];
-                        vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
-                    }
-
-                    for (unsigned int j = 0; j < group.size(); j++) {
-                        const Layout::Group::Row& row = group[j];
-                        if (row.intersectsY(y, height)) {
-                            for (unsigned int k = 0; k < row.size(); k++) {
-                                visibleItemCount++;
-
-                                const Layout::Group::Row::Cell& cell = row[k];
-                                const LayoutBounds titleBounds = cell.titleBounds();
-                                const Vec2f offset(titleBounds.left(), height - (titleBounds.top() - y) - titleBounds.height());
-
-                                Renderer::Text::TexturedFont* font = fontManager.font(cell.item().fontDescriptor);
-                                Vec2f::List titleVertices = font->quads(cell.item().entityDefinition->name(), false, offset);
-                                Vec2f::List& vertices = stringVertices[cell.item().fontDescriptor];
-                                vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
-                            }
-                        }
-                    }
+                if (group.bounds().top() > y + height)
+                    break;
+
+                const LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
+                groupBackgroundVertices.push_back(Vec2f(titleBounds.left(), -titleBounds.top()));
+                groupBackgroundVertices.push_back(Vec2f(titleBounds.left(), -titleBounds.bottom()));
+                groupBackgroundVertices.push_back(Vec2f(titleBounds.right(), -titleBounds.bottom()));
+                groupBackgroundVertices.push_back(Vec2f(titleBounds.right(), -titleBounds.top()));
+
+                const String& title = group.item();
+                if (!title.empty()) {
+                    const Vec2f offset(titleBounds.left() + 2.0f, -titleBounds.bottom());
+                    Renderer::Text::TexturedFont* font = fontManager.font(defaultDescriptor);
+                    const Vec2f::List titleVertices = font->quads(title, false, offset);
+                    groupTitleVertices.insert(groupTitleVertices.end(), titleVertices.begin(), titleVertices.end());
                 }
             }
 
-            { // render bounds
-                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::EdgeShader);
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
-                            const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-                                    Model::PointEntityDefinition* definition = cell.item().entityDefinition;
-                                    Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
-                                    if (modelRenderer == NULL)
-                                        renderEntityBounds(transformation,
-                                                           shader.currentShader(),
-                                                           *definition,
-                                                           cell.item().bounds, Vec3f(0.0f, cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y)),
-                                                           cell.scale());
-                                }
-                            }
-                        }
+            Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
+
+            if (!m_visibleCells.empty()) { // render thumbnails
+                std::vector<Renderer::VertexArray::IndexArray> pageIndices(m_thumbnailAtlas->pageCount());
+                std::vector<Renderer::VertexArray::CountArray> pageCounts(m_thumbnailAtlas->pageCount());
+                for (size_t i = 0; i < m_visibleCells.size(); i++) {
+                    const size_t cellIndex = m_visibleCells[i].first;
+                    const CellGeometry& geometry = m_cells[cellIndex];
+                    if (geometry.hasThumbnail) {
+                        pageIndices[geometry.thumbnailPage].push_back(static_cast<GLint>(4 * cellIndex));
+                        pageCounts[geometry.thumbnailPage].push_back(4);
                     }
                 }
-            }
 
-            { // render models
-                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::EntityModelShader);
+                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextureBrowserShader);
                 shader.setUniformVariable("ApplyTinting", false);
-                shader.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
+                shader.setUniformVariable("Brightness", 1.0f);
                 shader.setUniformVariable("GrayScale", false);
+                shader.setUniformVariable("Texture", 0);
 
-                modelRendererManager.activate();
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
-                            const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-                                    Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
-                                    if (modelRenderer != NULL)
-                                        renderEntityModel(transformation,
-                                                          shader.currentShader(),
-                                                          *modelRenderer,
-                                                          cell.item().bounds,
-                                                          Vec3f(0.0f, cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y)),
-                                                          cell.scale());
-                                }
-                            }
-                        }
-                    }
+                glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+                for (size_t i = 0; i < pageIndices.size(); i++) {
+                    if (pageIndices[i].empty())
+                        continue;
+
+                    m_thumbnailAtlas->activatePage(i);
+                    m_thumbnailArray->render(pageIndices[i], pageCounts[i]);
+                    m_thumbnailAtlas->deactivatePage();
                 }
-                modelRendererManager.deactivate();
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             }
 
-            glDisable(GL_DEPTH_TEST);
-            transformation = Renderer::Transformation(projection, viewMatrix(Vec3f::NegZ, Vec3f::PosY) * translationMatrix(Vec3f(0.0f, 0.0f, -1.0f)));
-
-            if (visibleGroupCount > 0) { // render group title background
-                unsigned int vertexCount = static_cast<unsigned int>(4 * visibleGroupCount);
-                Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
-                                                  Renderer::Attribute::position2f());
+            if (!groupBackgroundVertices.empty()) { // render group title background
+                Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, groupBackgroundVertices.size(),
+                                                  Renderer::Attribute::position2f(), 0);
 
                 Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
-                        vertexArray.addAttribute(Vec2f(titleBounds.left(), height - (titleBounds.top() - y)));
-                        vertexArray.addAttribute(Vec2f(titleBounds.left(), height - (titleBounds.bottom() - y)));
-                        vertexArray.addAttribute(Vec2f(titleBounds.right(), height - (titleBounds.bottom() - y)));
-                        vertexArray.addAttribute(Vec2f(titleBounds.right(), height - (titleBounds.top() - y)));
-                    }
-                }
+                vertexArray.addAttributes(groupBackgroundVertices);
 
                 Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
                 Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::BrowserGroupShader);
@@ -300,31 +499,53 @@ namespace TrenchBroom {
                 vertexArray.render();
             }
 
-            if (!stringVertices.empty()) { // render strings
-                StringMap::iterator it, end;
-                for (it = stringVertices.begin(), end = stringVertices.end(); it != end; ++it) {
-                    const Renderer::Text::FontDescriptor& descriptor = it->first;
-                    Renderer::Text::TexturedFont* font = fontManager.font(descriptor);
-                    const Vec2f::List& vertices = it->second;
+            { // render strings
+                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextShader);
+                shader.setUniformVariable("Color", prefs.getColor(Preferences::BrowserTextColor));
+                shader.setUniformVariable("Texture", 0);
+
+                for (size_t i = 0; i < m_titleArrays.size(); i++) {
+                    TitleArray& titleArray = m_titleArrays[i];
+                    titleArray.visibleIndices.clear();
+                    titleArray.visibleCounts.clear();
+                }
+
+                for (size_t i = 0; i < m_visibleCells.size(); i++) {
+                    const CellGeometry& geometry = m_cells[m_visibleCells[i].first];
+                    TitleArray& titleArray = m_titleArrays[geometry.titleArrayIndex];
+                    titleArray.visibleIndices.push_back(static_cast<GLint>(geometry.titleIndex));
+                    titleArray.visibleCounts.push_back(static_cast<GLsizei>(geometry.titleVertexCount));
+                }
+
+                for (size_t i = 0; i < m_titleArrays.size(); i++) {
+                    TitleArray& titleArray = m_titleArrays[i];
+                    if (titleArray.vertexArray == NULL || titleArray.visibleIndices.empty())
+                        continue;
 
-                    unsigned int vertexCount = static_cast<unsigned int>(vertices.size() / 2);
-                    Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
+                    Renderer::Text::TexturedFont* font = fontManager.font(titleArray.fontDescriptor);
+                    font->activate();
+                    titleArray.vertexArray->render(titleArray.visibleIndices, titleArray.visibleCounts);
+                    font->deactivate();
+                }
+
+                if (!groupTitleVertices.empty()) {
+                    Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, groupTitleVertices.size() / 2,
                                                       Renderer::Attribute::position2f(),
                                                       Renderer::Attribute::texCoord02f(), 0);
 
                     Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
-                    vertexArray.addAttributes(vertices);
+                    vertexArray.addAttributes(groupTitleVertices);
 
                     Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
-                    Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextShader);
-                    shader.setUniformVariable("Color", prefs.getColor(Preferences::BrowserTextColor));
-                    shader.setUniformVariable("Texture", 0);
-
+                    Renderer::Text::TexturedFont* font = fontManager.font(defaultDescriptor);
                     font->activate();
                     vertexArray.render();
                     font->deactivate();
                 }
             }
+
+            if (pendingThumbnails)
+                Refresh();
         }
 
         bool EntityBrowserCanvas::dndEnabled() {
@@ -399,10 +620,15 @@ namespace TrenchBroom {
         CellLayoutGLCanvas(parent, windowId, documentViewHolder.document().sharedResources().attribs(), documentViewHolder.document().sharedResources().sharedContext(), scrollBar),
         m_documentViewHolder(documentViewHolder),
         m_offscreenRenderer(m_documentViewHolder.document().sharedResources().multisample(), m_documentViewHolder.document().sharedResources().samples()),
+        m_thumbnailRenderer(m_documentViewHolder.document().sharedResources().multisample(), m_documentViewHolder.document().sharedResources().samples()),
+        m_thumbnailAtlas(NULL),
         m_vbo(NULL),
         m_group(false),
         m_hideUnused(false),
-        m_sortOrder(Model::EntityDefinitionManager::Name) {
+        m_sortOrder(Model::EntityDefinitionManager::Name),
+        m_thumbnailBrightness(-1.0f),
+        m_thumbnailArray(NULL),
+        m_layoutRevision(0) {
             const Quatf hRotation = Quatf(Math<float>::radians(-30.0f), Vec3f::PosZ);
             const Quatf vRotation = Quatf(Math<float>::radians(20.0f), Vec3f::PosY);
             m_rotation = vRotation * hRotation;
@@ -410,6 +636,8 @@ namespace TrenchBroom {
 
         EntityBrowserCanvas::~EntityBrowserCanvas() {
             clear();
+            delete m_thumbnailAtlas;
+            m_thumbnailAtlas = NULL;
             delete m_vbo;
             m_vbo = NULL;
         }
@@ -22,11 +22,16 @@
 
 #include "Model/EntityDefinitionManager.h"
 #include "Renderer/OffscreenRenderer.h"
+#include "Renderer/ThumbnailAtlas.h"
+#include "Renderer/VertexArray.h"
 #include "Renderer/Shader/Shader.h"
 #include "Utility/String.h"
 #include "Utility/VecMath.h"
 #include "View/CellLayoutGLCanvas.h"
 
+#include <map>
+#include <vector>
+
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
@@ -61,8 +66,68 @@ namespace TrenchBroom {
 
         class EntityBrowserCanvas : public CellLayoutGLCanvas<EntityCellData, EntityGroupData> {
         protected:
+            /**
+             * The preview of an entity is rendered only once into a tile of the thumbnail atlas, and it is only
+             * rendered again if the size of its cell changes.
+             */
+            class Thumbnail {
+            public:
+                Renderer::ThumbnailAtlas::Tile tile;
+                unsigned int width;
+                unsigned int height;
+
+                Thumbnail(const Renderer::ThumbnailAtlas::Tile& i_tile, unsigned int i_width, unsigned int i_height) :
+                tile(i_tile),
+                width(i_width),
+                height(i_height) {}
+            };
+
+            /**
+             * The vertices of all cells are kept in vertex arrays that are only rewritten when the layout changes.
+             * Each cell owns four vertices in the thumbnail array at the cell's index, which are written once its
+             * thumbnail is available. Its title is stored in the title array of its font.
+             */
+            class CellGeometry {
+            public:
+                size_t titleArrayIndex;
+                size_t titleIndex;
+                size_t titleVertexCount;
+                bool hasThumbnail;
+                size_t thumbnailPage;
+
+                CellGeometry(size_t i_titleArrayIndex, size_t i_titleIndex, size_t i_titleVertexCount) :
+                titleArrayIndex(i_titleArrayIndex),
+                titleIndex(i_titleIndex),
+                titleVertexCount(i_titleVertexCount),
+                hasThumbnail(false),
+                thumbnailPage(0) {}
+            };
+
+            class TitleArray {
+            public:
+                Renderer::Text::FontDescriptor fontDescriptor;
+                Renderer::VertexArray* vertexArray;
+                Renderer::VertexArray::IndexArray visibleIndices;
+                Renderer::VertexArray::CountArray visibleCounts;
+
+                TitleArray(const Renderer::Text::FontDescriptor& i_fontDescriptor) :
+                fontDescriptor(i_fontDescriptor),
+                vertexArray(NULL) {}
+            };
+
+            typedef std::map<const Model::PointEntityDefinition*, Thumbnail> ThumbnailCache;
+            typedef std::vector<CellGeometry> CellGeometryList;
+            typedef std::vector<TitleArray> TitleArrayList;
+            typedef std::vector<size_t> IndexList;
+            typedef std::pair<size_t, const Layout::Group::Row::Cell*> VisibleCell;
+            typedef std::vector<VisibleCell> VisibleCellList;
+
+            static const size_t MaxThumbnailsPerFrame = 8;
+
             DocumentViewHolder& m_documentViewHolder;
             Renderer::OffscreenRenderer m_offscreenRenderer;
+            Renderer::OffscreenRenderer m_thumbnailRenderer;
+            Renderer::ThumbnailAtlas* m_thumbnailAtlas;
             Renderer::Vbo* m_vbo;
             Quatf m_rotation;
 
@@ -71,10 +136,29 @@ namespace TrenchBroom {
             Model::EntityDefinitionManager::SortOrder m_sortOrder;
             String m_filterText;
 
+            ThumbnailCache m_thumbnails;
+            float m_thumbnailBrightness;
+            Renderer::VertexArray* m_thumbnailArray;
+            TitleArrayList m_titleArrays;
+            CellGeometryList m_cells;
+            IndexList m_groupRowOffsets;
+            IndexList m_rowCellOffsets;
+            unsigned int m_layoutRevision;
+            VisibleCellList m_visibleCells;
+
             void addEntityToLayout(Layout& layout, Model::PointEntityDefinition* definition, const Renderer::Text::FontDescriptor& font);
             void renderEntityBounds(Renderer::Transformation& transformation, Renderer::ShaderProgram& boundsProgram, const Model::PointEntityDefinition& definition, const BBoxf& rotatedBounds, const Vec3f& offset, float scaling);
             void renderEntityModel(Renderer::Transformation& transformation, Renderer::ShaderProgram& entityModelProgram, Renderer::EntityModelRenderer& renderer, const BBoxf& rotatedBounds, const Vec3f& offset, float scaling);
 
+            void clearGeometry();
+            void clearThumbnails();
+            size_t titleArrayIndex(const Renderer::Text::FontDescriptor& fontDescriptor);
+            void thumbnailSize(const Layout::Group::Row::Cell& cell, unsigned int& width, unsigned int& height) const;
+            void writeThumbnailQuad(size_t cellIndex, const Layout::Group::Row::Cell& cell, const Thumbnail& thumbnail);
+            void validateGeometry(Layout& layout);
+            void collectVisibleCells(Layout& layout, float y, float height);
+            bool validateThumbnails();
+
             virtual void doInitLayout(Layout& layout);
             virtual void doReloadLayout(Layout& layout);
             virtual void doClear();
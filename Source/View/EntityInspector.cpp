@@ -178,6 +178,9 @@ namespace TrenchBroom {
                         updateEntityBrowser();
                     break;
                 }
+                case Controller::Command::EntityModelsLoaded:
+                    updateEntityBrowser();
+                    break;
                 default:
                     break;
             }
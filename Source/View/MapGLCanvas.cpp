@@ -28,6 +28,8 @@
 #include "Renderer/OverlayRenderer.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/SharedResources.h"
+#include "Renderer/TextureRendererManager.h"
+#include "Renderer/TextureUploadQueue.h"
 #include "Renderer/Vbo.h"
 #include "Renderer/VertexArray.h"
 #include "Model/Filter.h"
@@ -223,8 +225,9 @@ namespace TrenchBroom {
 
                 // render input controller
                 if (m_vbo == NULL)
-                    m_vbo = new Renderer::Vbo(GL_ARRAY_BUFFER, 0xFFFF);
+                    m_vbo = new Renderer::Vbo(GL_ARRAY_BUFFER, 0xFFFF, Renderer::Vbo::VboStreaming);
                 m_inputController->render(*m_vbo, renderContext);
+                m_vbo->fence();
 
                 // render overlays
                 if (m_overlayRenderer == NULL)
@@ -288,6 +291,11 @@ namespace TrenchBroom {
                 }
 
 				SwapBuffers();
+
+                // upload some of the textures requested while rendering and render another frame to show them
+                Renderer::TextureUploadQueue& uploadQueue = m_documentViewHolder.document().sharedResources().textureRendererManager().uploadQueue();
+                if (uploadQueue.uploadTextures())
+                    Refresh();
 			} else {
 				view.console().error("Unable to set current OpenGL context");
 			}
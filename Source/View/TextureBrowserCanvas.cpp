@@ -26,6 +26,7 @@
 #include "Renderer/RenderUtils.h"
 #include "Renderer/TextureRenderer.h"
 #include "Renderer/TextureRendererManager.h"
+#include "Renderer/TextureUploadQueue.h"
 #include "Renderer/Transformation.h"
 #include "Renderer/Vbo.h"
 #include "Renderer/VertexArray.h"
@@ -109,6 +110,170 @@ namespace TrenchBroom {
         }
 
         void TextureBrowserCanvas::doClear() {
+            clearGeometry();
+        }
+
+        void TextureBrowserCanvas::clearGeometry() {
+            delete m_textureArray;
+            m_textureArray = NULL;
+            delete m_borderArray;
+            m_borderArray = NULL;
+            for (size_t i = 0; i < m_titleArrays.size(); i++)
+                delete m_titleArrays[i].vertexArray;
+            m_titleArrays.clear();
+            m_cells.clear();
+            m_groupRowOffsets.clear();
+            m_rowCellOffsets.clear();
+            m_visibleCells.clear();
+        }
+
+        size_t TextureBrowserCanvas::titleArrayIndex(const Renderer::Text::FontDescriptor& fontDescriptor) {
+            for (size_t i = 0; i < m_titleArrays.size(); i++)
+                if (m_titleArrays[i].fontDescriptor.compare(fontDescriptor) == 0)
+                    return i;
+            m_titleArrays.push_back(TitleArray(fontDescriptor));
+            return m_titleArrays.size() - 1;
+        }
+
+        void TextureBrowserCanvas::validateGeometry(Layout& layout) {
+            clearGeometry();
+
+            Renderer::Text::FontManager& fontManager = m_documentViewHolder.document().sharedResources().fontManager();
+            std::vector<Vec2f::List> titleVertices;
+
+            // the vertices are stored in layout coordinates with the y axis flipped, the scroll position is applied when rendering
+            const size_t groupCount = layout.size();
+            for (size_t i = 0; i < groupCount; i++) {
+                const Layout::Group& group = layout[i];
+                m_groupRowOffsets.push_back(m_rowCellOffsets.size());
+                for (size_t j = 0; j < group.size(); j++) {
+                    const Layout::Group::Row& row = group[j];
+                    m_rowCellOffsets.push_back(m_cells.size());
+                    for (size_t k = 0; k < row.size(); k++) {
+                        const Layout::Group::Row::Cell& cell = row[k];
+                        const size_t arrayIndex = titleArrayIndex(cell.item().fontDescriptor);
+                        if (arrayIndex >= titleVertices.size())
+                            titleVertices.resize(arrayIndex + 1);
+
+                        const LayoutBounds& titleBounds = cell.titleBounds();
+                        const Vec2f offset(titleBounds.left() + 2.0f, -titleBounds.bottom());
+                        Renderer::Text::TexturedFont* font = fontManager.font(cell.item().fontDescriptor);
+                        const Vec2f::List quads = font->quads(cell.item().texture->name(), false, offset);
+
+                        Vec2f::List& vertices = titleVertices[arrayIndex];
+                        m_cells.push_back(CellGeometry(arrayIndex, vertices.size() / 2, quads.size() / 2));
+                        vertices.insert(vertices.end(), quads.begin(), quads.end());
+                    }
+                }
+            }
+
+            m_layoutRevision = layout.revision();
+            if (m_cells.empty())
+                return;
+
+            const size_t vertexCount = 4 * m_cells.size();
+            m_textureArray = new Renderer::VertexArray(*m_vbo, GL_QUADS, vertexCount,
+                                                       Renderer::Attribute::position2f(),
+                                                       Renderer::Attribute::texCoord02f());
+            m_borderArray = new Renderer::VertexArray(*m_vbo, GL_QUADS, vertexCount,
+                                                      Renderer::Attribute::position2f(),
+                                                      Renderer::Attribute::color4f());
+            for (size_t i = 0; i < m_titleArrays.size(); i++) {
+                if (!titleVertices[i].empty())
+                    m_titleArrays[i].vertexArray = new Renderer::VertexArray(*m_vbo, GL_QUADS, titleVertices[i].size() / 2,
+                                                                             Renderer::Attribute::position2f(),
+                                                                             Renderer::Attribute::texCoord02f(), 0);
+            }
+
+            Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
+            for (size_t i = 0; i < groupCount; i++) {
+                const Layout::Group& group = layout[i];
+                for (size_t j = 0; j < group.size(); j++) {
+                    const Layout::Group::Row& row = group[j];
+                    for (size_t k = 0; k < row.size(); k++) {
+                        const LayoutBounds& itemBounds = row[k].itemBounds();
+                        m_textureArray->addAttribute(Vec2f(itemBounds.left(), -itemBounds.top()));
+                        m_textureArray->addAttribute(Vec2f(0.0f, 0.0f));
+                        m_textureArray->addAttribute(Vec2f(itemBounds.left(), -itemBounds.bottom()));
+                        m_textureArray->addAttribute(Vec2f(0.0f, 1.0f));
+                        m_textureArray->addAttribute(Vec2f(itemBounds.right(), -itemBounds.bottom()));
+                        m_textureArray->addAttribute(Vec2f(1.0f, 1.0f));
+                        m_textureArray->addAttribute(Vec2f(itemBounds.right(), -itemBounds.top()));
+                        m_textureArray->addAttribute(Vec2f(1.0f, 0.0f));
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < m_titleArrays.size(); i++) {
+                if (m_titleArrays[i].vertexArray != NULL)
+                    m_titleArrays[i].vertexArray->addAttributes(titleVertices[i]);
+            }
+        }
+
+        void TextureBrowserCanvas::collectVisibleCells(Layout& layout, float y, float height) {
+            m_visibleCells.clear();
+
+            const size_t groupCount = layout.size();
+            for (size_t i = layout.indexOfGroupAt(y); i < groupCount; i++) {
+                const Layout::Group& group = layout[i];
+                if (group.bounds().top() > y + height)
+                    break;
+
+                for (size_t j = group.indexOfRowAt(y); j < group.size(); j++) {
+                    const Layout::Group::Row& row = group[j];
+                    if (row.bounds().top() > y + height)
+                        break;
+
+                    const size_t firstCell = m_rowCellOffsets[m_groupRowOffsets[i] + j];
+                    for (size_t k = 0; k < row.size(); k++)
+                        m_visibleCells.push_back(VisibleCell(firstCell + k, &row[k]));
+                }
+            }
+        }
+
+        void TextureBrowserCanvas::validateBorders() {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const Color& selectedColor = prefs.getColor(Preferences::SelectedTextureColor);
+            const Color& usedColor = prefs.getColor(Preferences::UsedTextureColor);
+            const Color& overriddenColor = prefs.getColor(Preferences::OverriddenTextureColor);
+
+            IndexList changedCells;
+            for (size_t i = 0; i < m_visibleCells.size(); i++) {
+                const Model::Texture* texture = m_visibleCells[i].second->item().texture;
+                const bool selected = texture == m_selectedTexture;
+                const bool inUse = texture->usageCount() > 0;
+                const bool overridden = texture->overridden();
+                const bool hasBorder = selected || inUse || overridden;
+                const Color& color = selected ? selectedColor : (inUse ? usedColor : overriddenColor);
+
+                CellGeometry& geometry = m_cells[m_visibleCells[i].first];
+                if (hasBorder != geometry.hasBorder || (hasBorder && color != geometry.borderColor)) {
+                    geometry.hasBorder = hasBorder;
+                    geometry.borderColor = color;
+                    if (hasBorder)
+                        changedCells.push_back(i);
+                }
+            }
+
+            if (changedCells.empty())
+                return;
+
+            Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
+            for (size_t i = 0; i < changedCells.size(); i++) {
+                const VisibleCell& visibleCell = m_visibleCells[changedCells[i]];
+                const LayoutBounds& itemBounds = visibleCell.second->itemBounds();
+                const Color& color = m_cells[visibleCell.first].borderColor;
+
+                m_borderArray->seek(4 * visibleCell.first);
+                m_borderArray->addAttribute(Vec2f(itemBounds.left() - 1.5f, -(itemBounds.top() - 1.5f)));
+                m_borderArray->addAttribute(color);
+                m_borderArray->addAttribute(Vec2f(itemBounds.left() - 1.5f, -(itemBounds.bottom() + 1.5f)));
+                m_borderArray->addAttribute(color);
+                m_borderArray->addAttribute(Vec2f(itemBounds.right() + 1.5f, -(itemBounds.bottom() + 1.5f)));
+                m_borderArray->addAttribute(color);
+                m_borderArray->addAttribute(Vec2f(itemBounds.right() + 1.5f, -(itemBounds.top() - 1.5f)));
+                m_borderArray->addAttribute(color);
+            }
         }
 
         void TextureBrowserCanvas::doRender(Layout& layout, float y, float height) {
@@ -122,6 +287,12 @@ namespace TrenchBroom {
             Renderer::Text::FontDescriptor defaultDescriptor(prefs.getString(Preferences::RendererFontName),
                                                              static_cast<unsigned int>(prefs.getInt(Preferences::TextureBrowserFontSize)));
 
+            const size_t groupCount = layout.size();
+            if (layout.revision() != m_layoutRevision)
+                validateGeometry(layout);
+            collectVisibleCells(layout, y, height);
+            validateBorders();
+
             glEnable(GL_BLEND);
             glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -132,144 +303,82 @@ namespace TrenchBroom {
 
             const Mat4f projection = orthoMatrix(-1.0f, 1.0f, viewLeft, viewTop, viewRight, viewBottom);
             const Mat4f view = viewMatrix(Vec3f::NegZ, Vec3f::PosY) * translationMatrix(Vec3f(0.0f, 0.0f, 0.1f));
-            Renderer::Transformation transformation(projection, view);
+            const Mat4f model = translationMatrix(Vec3f(0.0f, height + y, 0.0f));
+            Renderer::Transformation transformation(projection, view, model);
 
-            size_t visibleGroupCount = 0;
-            size_t visibleItemCount = 0;
-
-            typedef std::map<Renderer::Text::FontDescriptor, Vec2f::List> StringMap;
-            StringMap stringVertices;
-
-            for (unsigned int i = 0; i < layout.size(); i++) {
+            // the group titles stick to the top of the view, so they are the only vertices that depend on the scroll position
+            Vec2f::List groupBackgroundVertices;
+            Vec2f::List groupTitleVertices;
+            for (size_t i = layout.indexOfGroupAt(y); i < groupCount; i++) {
                 const Layout::Group& group = layout[i];
-                if (group.intersectsY(y, height)) {
-                    visibleGroupCount++;
-
-                    Model::TextureCollection* collection = group.item();
-                    if (collection != NULL && !collection->name().empty()) {
-                        const LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
-                        const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
-
+                if (group.bounds().top() > y + height)
+                    break;
+
+                Model::TextureCollection* collection = group.item();
+                if (collection != NULL) {
+                    const LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
+                    groupBackgroundVertices.push_back(Vec2f(titleBounds.left(), -titleBounds.top()));
+                    groupBackgroundVertices.push_back(Vec2f(titleBounds.left(), -titleBounds.bottom()));
+                    groupBackgroundVertices.push_back(Vec2f(titleBounds.right(), -titleBounds.bottom()));
+                    groupBackgroundVertices.push_back(Vec2f(titleBounds.right(), -titleBounds.top()));
+
+                    if (!collection->name().empty()) {
+                        const Vec2f offset(titleBounds.left() + 2.0f, -titleBounds.bottom());
                         Renderer::Text::TexturedFont* font = fontManager.font(defaultDescriptor);
-                        Vec2f::List titleVertices = font->quads(collection->name(), false, offset);
-                        Vec2f::List& vertices = stringVertices[defaultDescriptor];
-                        vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
-                    }
-
-                    for (unsigned int j = 0; j < group.size(); j++) {
-                        const Layout::Group::Row& row = group[j];
-                        if (row.intersectsY(y, height)) {
-                            for (unsigned int k = 0; k < row.size(); k++) {
-                                visibleItemCount++;
-
-                                const Layout::Group::Row::Cell& cell = row[k];
-                                const LayoutBounds titleBounds = cell.titleBounds();
-                                const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
-
-                                Renderer::Text::TexturedFont* font = fontManager.font(cell.item().fontDescriptor);
-                                Vec2f::List titleVertices = font->quads(cell.item().texture->name(), false, offset);
-                                Vec2f::List& vertices = stringVertices[cell.item().fontDescriptor];
-                                vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
-                            }
-                        }
+                        const Vec2f::List titleVertices = font->quads(collection->name(), false, offset);
+                        groupTitleVertices.insert(groupTitleVertices.end(), titleVertices.begin(), titleVertices.end());
                     }
                 }
             }
 
-            if (visibleItemCount > 0) { // render borders
-                unsigned int vertexCount = static_cast<unsigned int>(4 * visibleItemCount);
-                Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
-                                                  Renderer::Attribute::position2f(),
-                                                  Renderer::Attribute::color4f());
+            Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
 
-                Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
-                            const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-
-                                    bool selected = cell.item().texture == m_selectedTexture;
-                                    bool inUse = cell.item().texture->usageCount() > 0;
-                                    bool overridden = cell.item().texture->overridden();
-
-                                    if (selected || inUse || overridden) {
-                                        const Color& color = selected ? prefs.getColor(Preferences::SelectedTextureColor) : (inUse ? prefs.getColor(Preferences::UsedTextureColor) : prefs.getColor(Preferences::OverriddenTextureColor));
-
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                    }
-                                }
-                            }
-                        }
+            if (!m_visibleCells.empty()) { // render borders
+                Renderer::VertexArray::IndexArray indices;
+                Renderer::VertexArray::CountArray counts;
+                for (size_t i = 0; i < m_visibleCells.size(); i++) {
+                    const size_t cellIndex = m_visibleCells[i].first;
+                    if (m_cells[cellIndex].hasBorder) {
+                        indices.push_back(static_cast<GLint>(4 * cellIndex));
+                        counts.push_back(4);
                     }
                 }
 
-                Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
                 Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextureBrowserBorderShader);
-                vertexArray.render();
+                m_borderArray->render(indices, counts);
             }
 
-            { // render textures
+            Renderer::TextureUploadQueue& uploadQueue = m_documentViewHolder.document().sharedResources().textureRendererManager().uploadQueue();
+            if (!m_visibleCells.empty()) { // render textures
                 Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextureBrowserShader);
                 shader.setUniformVariable("ApplyTinting", false);
                 shader.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
-                            const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-                                    shader.setUniformVariable("GrayScale", cell.item().texture->overridden());
-                                    shader.setUniformVariable("Texture", 0);
-                                    cell.item().textureRenderer->activate();
-                                    glBegin(GL_QUADS);
-                                    glTexCoord2f(0.0f, 0.0f);
-                                    glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().top() - y));
-                                    glTexCoord2f(0.0f, 1.0f);
-                                    glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y));
-                                    glTexCoord2f(1.0f, 1.0f);
-                                    glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().bottom() - y));
-                                    glTexCoord2f(1.0f, 0.0f);
-                                    glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().top() - y));
-                                    glEnd();
-                                    cell.item().textureRenderer->deactivate();
-                                }
-                            }
-                        }
+                shader.setUniformVariable("Texture", 0);
+
+                // the textures which have not been uploaded yet are left out until the upload queue has processed them
+                m_textureArray->setup();
+                for (size_t i = 0; i < m_visibleCells.size(); i++) {
+                    const Layout::Group::Row::Cell& cell = *m_visibleCells[i].second;
+                    Renderer::TextureRenderer& textureRenderer = *cell.item().textureRenderer;
+                    if (!textureRenderer.uploaded()) {
+                        uploadQueue.request(textureRenderer);
+                        continue;
                     }
+
+                    shader.setUniformVariable("GrayScale", cell.item().texture->overridden());
+                    textureRenderer.activate();
+                    m_textureArray->renderPrimitives(4 * m_visibleCells[i].first, 4);
+                    textureRenderer.deactivate();
                 }
+                m_textureArray->cleanup();
             }
 
-            if (visibleGroupCount > 0) { // render group title background
-                unsigned int vertexCount = static_cast<unsigned int>(4 * visibleGroupCount);
-                Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
-                                                  Renderer::Attribute::position2f());
+            if (!groupBackgroundVertices.empty()) { // render group title background
+                Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, groupBackgroundVertices.size(),
+                                                  Renderer::Attribute::position2f(), 0);
 
                 Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        if (group.item() != NULL) {
-                            LayoutBounds titleBounds = layout.titleBoundsForVisibleRect(group, y, height);
-                            vertexArray.addAttribute(Vec2f(titleBounds.left(), height - (titleBounds.top() - y)));
-                            vertexArray.addAttribute(Vec2f(titleBounds.left(), height - (titleBounds.bottom() - y)));
-                            vertexArray.addAttribute(Vec2f(titleBounds.right(), height - (titleBounds.bottom() - y)));
-                            vertexArray.addAttribute(Vec2f(titleBounds.right(), height - (titleBounds.top() - y)));
-                        }
-                    }
-                }
+                vertexArray.addAttributes(groupBackgroundVertices);
 
                 Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
                 Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::BrowserGroupShader);
@@ -277,31 +386,53 @@ namespace TrenchBroom {
                 vertexArray.render();
             }
 
-            if (!stringVertices.empty()) { // render strings
-                StringMap::iterator it, end;
-                for (it = stringVertices.begin(), end = stringVertices.end(); it != end; ++it) {
-                    const Renderer::Text::FontDescriptor& descriptor = it->first;
-                    Renderer::Text::TexturedFont* font = fontManager.font(descriptor);
-                    const Vec2f::List& vertices = it->second;
+            { // render strings
+                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextShader);
+                shader.setUniformVariable("Color", prefs.getColor(Preferences::BrowserTextColor));
+                shader.setUniformVariable("Texture", 0);
+
+                for (size_t i = 0; i < m_titleArrays.size(); i++) {
+                    TitleArray& titleArray = m_titleArrays[i];
+                    titleArray.visibleIndices.clear();
+                    titleArray.visibleCounts.clear();
+                }
+
+                for (size_t i = 0; i < m_visibleCells.size(); i++) {
+                    const CellGeometry& geometry = m_cells[m_visibleCells[i].first];
+                    TitleArray& titleArray = m_titleArrays[geometry.titleArrayIndex];
+                    titleArray.visibleIndices.push_back(static_cast<GLint>(geometry.titleIndex));
+                    titleArray.visibleCounts.push_back(static_cast<GLsizei>(geometry.titleVertexCount));
+                }
 
-                    unsigned int vertexCount = static_cast<unsigned int>(vertices.size() / 2);
-                    Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
+                for (size_t i = 0; i < m_titleArrays.size(); i++) {
+                    TitleArray& titleArray = m_titleArrays[i];
+                    if (titleArray.vertexArray == NULL || titleArray.visibleIndices.empty())
+                        continue;
+
+                    Renderer::Text::TexturedFont* font = fontManager.font(titleArray.fontDescriptor);
+                    font->activate();
+                    titleArray.vertexArray->render(titleArray.visibleIndices, titleArray.visibleCounts);
+                    font->deactivate();
+                }
+
+                if (!groupTitleVertices.empty()) {
+                    Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, groupTitleVertices.size() / 2,
                                                       Renderer::Attribute::position2f(),
                                                       Renderer::Attribute::texCoord02f(), 0);
 
                     Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
-                    vertexArray.addAttributes(vertices);
+                    vertexArray.addAttributes(groupTitleVertices);
 
                     Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
-                    Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextShader);
-                    shader.setUniformVariable("Color", prefs.getColor(Preferences::BrowserTextColor));
-                    shader.setUniformVariable("Texture", 0);
-
+                    Renderer::Text::TexturedFont* font = fontManager.font(defaultDescriptor);
                     font->activate();
                     vertexArray.render();
                     font->deactivate();
                 }
             }
+
+            if (uploadQueue.uploadTextures())
+                Refresh();
         }
 
         void TextureBrowserCanvas::handleLeftClick(Layout& layout, float x, float y) {
@@ -336,7 +467,10 @@ namespace TrenchBroom {
         m_group(false),
         m_hideUnused(false),
         m_sortOrder(Model::TextureSortOrder::Name),
-        m_vbo() {}
+        m_vbo(NULL),
+        m_textureArray(NULL),
+        m_borderArray(NULL),
+        m_layoutRevision(0) {}
 
         TextureBrowserCanvas::~TextureBrowserCanvas() {
             clear();
@@ -21,8 +21,12 @@
 #define __TrenchBroom__TextureBrowserCanvas__
 
 #include "Model/TextureManager.h"
+#include "Renderer/VertexArray.h"
+#include "Utility/Color.h"
 #include "View/CellLayoutGLCanvas.h"
 
+#include <vector>
+
 namespace TrenchBroom {
     namespace Model {
         class Texture;
@@ -64,6 +68,44 @@ namespace TrenchBroom {
         
         class TextureBrowserCanvas : public CellLayoutGLCanvas<TextureCellData, TextureGroupData> {
         protected:
+            /**
+             * The vertices of all cells are kept in vertex arrays that are only rewritten when the layout changes.
+             * Each cell owns four vertices in the texture and border arrays at the cell's index. Its title is
+             * stored in the title array of its font.
+             */
+            class CellGeometry {
+            public:
+                size_t titleArrayIndex;
+                size_t titleIndex;
+                size_t titleVertexCount;
+                bool hasBorder;
+                Color borderColor;
+                
+                CellGeometry(size_t i_titleArrayIndex, size_t i_titleIndex, size_t i_titleVertexCount) :
+                titleArrayIndex(i_titleArrayIndex),
+                titleIndex(i_titleIndex),
+                titleVertexCount(i_titleVertexCount),
+                hasBorder(false) {}
+            };
+            
+            class TitleArray {
+            public:
+                Renderer::Text::FontDescriptor fontDescriptor;
+                Renderer::VertexArray* vertexArray;
+                Renderer::VertexArray::IndexArray visibleIndices;
+                Renderer::VertexArray::CountArray visibleCounts;
+                
+                TitleArray(const Renderer::Text::FontDescriptor& i_fontDescriptor) :
+                fontDescriptor(i_fontDescriptor),
+                vertexArray(NULL) {}
+            };
+            
+            typedef std::vector<CellGeometry> CellGeometryList;
+            typedef std::vector<TitleArray> TitleArrayList;
+            typedef std::vector<size_t> IndexList;
+            typedef std::pair<size_t, const Layout::Group::Row::Cell*> VisibleCell;
+            typedef std::vector<VisibleCell> VisibleCellList;
+            
             DocumentViewHolder& m_documentViewHolder;
             Model::Texture* m_selectedTexture;
             
@@ -73,6 +115,21 @@ namespace TrenchBroom {
             String m_filterText;
             Renderer::Vbo* m_vbo;
             
+            Renderer::VertexArray* m_textureArray;
+            Renderer::VertexArray* m_borderArray;
+            TitleArrayList m_titleArrays;
+            CellGeometryList m_cells;
+            IndexList m_groupRowOffsets;
+            IndexList m_rowCellOffsets;
+            unsigned int m_layoutRevision;
+            VisibleCellList m_visibleCells;
+            
+            void clearGeometry();
+            size_t titleArrayIndex(const Renderer::Text::FontDescriptor& fontDescriptor);
+            void validateGeometry(Layout& layout);
+            void collectVisibleCells(Layout& layout, float y, float height);
+            void validateBorders();
+            
             void addTextureToLayout(Layout& layout, Model::Texture* texture, const Renderer::Text::FontDescriptor& font);
             virtual void doInitLayout(Layout& layout);
             virtual void doReloadLayout(Layout& layout);
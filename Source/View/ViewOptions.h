@@ -55,6 +55,16 @@ namespace TrenchBroom {
             bool m_shadeFaces;
             bool m_useFog;
             LinkDisplayMode m_linkDisplayMode;
+            unsigned int m_brushFilterGeneration;
+            
+            /**
+             * The generations are unique across all view options so that brushes can cache their filter results
+             * even if they are filtered with different view options.
+             */
+            static inline unsigned int nextBrushFilterGeneration() {
+                static unsigned int generation = 0;
+                return ++generation;
+            }
         public:
             ViewOptions() :
             m_filterPattern(""),
@@ -73,14 +83,19 @@ namespace TrenchBroom {
             m_renderSelection(true),
             m_shadeFaces(true),
             m_useFog(false),
-            m_linkDisplayMode(LinkDisplayLocal) {}
+            m_linkDisplayMode(LinkDisplayLocal),
+            m_brushFilterGeneration(nextBrushFilterGeneration()) {}
 
             inline const String& filterPattern() const {
                 return m_filterPattern;
             }
 
             inline void setFilterPattern(const String& filterPattern) {
-                m_filterPattern = Utility::trim(filterPattern);
+                const String trimmedPattern = Utility::trim(filterPattern);
+                if (trimmedPattern == m_filterPattern)
+                    return;
+                m_filterPattern = trimmedPattern;
+                m_brushFilterGeneration = nextBrushFilterGeneration();
             }
 
             inline bool showEntities() const {
@@ -128,7 +143,10 @@ namespace TrenchBroom {
             }
 
             inline void setShowClipBrushes(bool showClipBrushes) {
+                if (showClipBrushes == m_showClipBrushes)
+                    return;
                 m_showClipBrushes = showClipBrushes;
+                m_brushFilterGeneration = nextBrushFilterGeneration();
             }
 
             inline bool showSkipBrushes() const {
@@ -136,7 +154,10 @@ namespace TrenchBroom {
             }
 
             inline void setShowSkipBrushes(bool showSkipBrushes) {
+                if (showSkipBrushes == m_showSkipBrushes)
+                    return;
                 m_showSkipBrushes = showSkipBrushes;
+                m_brushFilterGeneration = nextBrushFilterGeneration();
             }
 
             inline bool showHintBrushes() const {
@@ -144,7 +165,10 @@ namespace TrenchBroom {
             }
             
             inline void setShowHintBrushes(bool showHintBrushes) {
+                if (showHintBrushes == m_showHintBrushes)
+                    return;
                 m_showHintBrushes = showHintBrushes;
+                m_brushFilterGeneration = nextBrushFilterGeneration();
             }
             
             inline bool showLiquidBrushes() const {
@@ -152,7 +176,10 @@ namespace TrenchBroom {
             }
             
             inline void setShowLiquidBrushes(bool showLiquidBrushes) {
+                if (showLiquidBrushes == m_showLiquidBrushes)
+                    return;
                 m_showLiquidBrushes = showLiquidBrushes;
+                m_brushFilterGeneration = nextBrushFilterGeneration();
             }
             
             inline bool showTriggerBrushes() const {
@@ -160,7 +187,18 @@ namespace TrenchBroom {
             }
             
             inline void setShowTriggerBrushes(bool showTriggerBrushes) {
+                if (showTriggerBrushes == m_showTriggerBrushes)
+                    return;
                 m_showTriggerBrushes = showTriggerBrushes;
+                m_brushFilterGeneration = nextBrushFilterGeneration();
+            }
+            
+            /**
+             * Changes whenever an option changes that determines whether a brush is filtered because of the
+             * textures of its faces.
+             */
+            inline unsigned int brushFilterGeneration() const {
+                return m_brushFilterGeneration;
             }
             
             inline FaceRenderMode faceRenderMode() const {
@@ -56,6 +56,8 @@ namespace TrenchBroom {
                 registerTestCase(&MatTest::testDeterminant2);
                 registerTestCase(&MatTest::testAdjoin);
                 registerTestCase(&MatTest::testAdjoint);
+                registerTestCase(&MatTest::testTransformPoints);
+                registerTestCase(&MatTest::testMergeTransformedBounds);
             }
         public:
             void testInvert() {
@@ -388,6 +390,41 @@ namespace TrenchBroom {
                                -272.0f,  -72.0f,  104.0f,  192.0f);
                 assert(adjointMatrix(m1) == m2);
             }
+            
+            void testTransformPoints() {
+                const Mat4f m1 = translationMatrix(Vec3f(16.0f, -8.0f, 32.0f)) * rotationMatrix(Math<float>::radians(30.0f), Vec3f::PosZ) * scalingMatrix(Vec3f(2.0f, 1.0f, 0.5f));
+                
+                Vec3f::List points;
+                for (size_t i = 0; i < 7; i++)
+                    points.push_back(Vec3f(static_cast<float>(i) * 3.0f, 1.0f - static_cast<float>(i), static_cast<float>(i * i)));
+                
+                Vec3f::List transformed(points.size());
+                transformPoints(m1, &points[0], points.size(), &transformed[0]);
+                for (size_t i = 0; i < points.size(); i++)
+                    assert(transformed[i] == m1 * points[i]);
+                
+                // the points may be transformed in place
+                transformPoints(m1, &points[0], points.size(), &points[0]);
+                assert(points == transformed);
+            }
+            
+            void testMergeTransformedBounds() {
+                const Mat4f m1 = rotationMatrix(Math<float>::radians(45.0f), Vec3f::PosY) * translationMatrix(Vec3f(4.0f, 5.0f, 6.0f));
+                
+                Vec3f::List points;
+                points.push_back(Vec3f(-1.0f, 2.0f, 3.0f));
+                points.push_back(Vec3f(8.0f, -4.0f, 0.0f));
+                points.push_back(Vec3f(2.0f, 2.0f, -7.0f));
+                
+                BBoxf expected(m1 * points[0], m1 * points[0]);
+                for (size_t i = 1; i < points.size(); i++)
+                    expected.mergeWith(m1 * points[i]);
+                
+                BBoxf bounds(m1 * points[0], m1 * points[0]);
+                mergeTransformedBounds(bounds, m1, &points[0], points.size());
+                assert(bounds.min == expected.min);
+                assert(bounds.max == expected.max);
+            }
         };
     }
 }
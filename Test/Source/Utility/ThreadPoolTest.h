@@ -0,0 +1,186 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TrenchBroom_ThreadPoolTest_h
+#define TrenchBroom_ThreadPoolTest_h
+
+#include "TestSuite.h"
+#include "Utility/Future.h"
+#include "Utility/Parallel.h"
+#include "Utility/ThreadPool.h"
+
+#include <wx/atomic.h>
+
+#include <cassert>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Utility {
+        class ThreadPoolTest : public TestSuite<ThreadPoolTest> {
+        private:
+            class CountTask : public ThreadPool::Task {
+            private:
+                wxAtomicInt& m_counter;
+            public:
+                CountTask(wxAtomicInt& counter) :
+                m_counter(counter) {}
+
+                void run() {
+                    wxAtomicInc(m_counter);
+                }
+            };
+
+            class NestedTask : public ThreadPool::Task {
+            private:
+                ThreadPool& m_pool;
+                wxAtomicInt& m_counter;
+            public:
+                NestedTask(ThreadPool& pool, wxAtomicInt& counter) :
+                m_pool(pool),
+                m_counter(counter) {}
+
+                void run() {
+                    ThreadPool::TaskGroup group;
+                    for (size_t i = 0; i < 10; i++)
+                        m_pool.submit(new CountTask(m_counter), &group);
+                    m_pool.wait(group);
+                }
+            };
+
+            class SquareTask : public ParallelTask {
+            private:
+                std::vector<size_t>& m_results;
+            public:
+                SquareTask(std::vector<size_t>& results) :
+                m_results(results) {}
+
+                void run(size_t index) {
+                    m_results[index] = index * index;
+                }
+            };
+
+            class Double {
+            public:
+                std::vector<int>& results;
+
+                Double(std::vector<int>& i_results) :
+                results(i_results) {}
+
+                void operator()(const int& value) {
+                    results[static_cast<size_t>(value)] = 2 * value;
+                }
+            };
+
+            class SumTask : public AsyncTask<int> {
+            private:
+                int m_count;
+            protected:
+                int compute() {
+                    int sum = 0;
+                    for (int i = 1; i <= m_count; i++)
+                        sum += i;
+                    return sum;
+                }
+            public:
+                SumTask(int count) :
+                m_count(count) {}
+            };
+        protected:
+            void registerTestCases() {
+                registerTestCase(&ThreadPoolTest::testSubmit);
+                registerTestCase(&ThreadPoolTest::testNestedWait);
+                registerTestCase(&ThreadPoolTest::testWithoutWorkers);
+                registerTestCase(&ThreadPoolTest::testRunParallel);
+                registerTestCase(&ThreadPoolTest::testParallelForEach);
+                registerTestCase(&ThreadPoolTest::testFuture);
+            }
+
+            void setup() {
+                ThreadPool::sharedPool = new ThreadPool(4);
+            }
+
+            void teardown() {
+                delete ThreadPool::sharedPool;
+                ThreadPool::sharedPool = NULL;
+            }
+        public:
+            void testSubmit() {
+                ThreadPool& pool = *ThreadPool::sharedPool;
+                assert(pool.workerCount() == 4);
+
+                wxAtomicInt counter = 0;
+                ThreadPool::TaskGroup group;
+                for (size_t i = 0; i < 1000; i++)
+                    pool.submit(new CountTask(counter), &group);
+                pool.wait(group);
+                assert(counter == 1000);
+            }
+
+            void testNestedWait() {
+                ThreadPool& pool = *ThreadPool::sharedPool;
+
+                wxAtomicInt counter = 0;
+                ThreadPool::TaskGroup group;
+                for (size_t i = 0; i < 100; i++)
+                    pool.submit(new NestedTask(pool, counter), &group);
+                pool.wait(group);
+                assert(counter == 1000);
+            }
+
+            void testWithoutWorkers() {
+                ThreadPool pool(0);
+                assert(pool.workerCount() == 0);
+
+                wxAtomicInt counter = 0;
+                ThreadPool::TaskGroup group;
+                for (size_t i = 0; i < 10; i++)
+                    pool.submit(new CountTask(counter), &group);
+                pool.wait(group);
+                assert(counter == 10);
+            }
+
+            void testRunParallel() {
+                std::vector<size_t> results(1000, 0);
+                SquareTask task(results);
+                runParallel(task, results.size());
+                for (size_t i = 0; i < results.size(); i++)
+                    assert(results[i] == i * i);
+            }
+
+            void testParallelForEach() {
+                std::vector<int> values;
+                for (int i = 0; i < 1000; i++)
+                    values.push_back(i);
+
+                std::vector<int> results(values.size(), 0);
+                Double function(results);
+                parallelForEach(values, function);
+                for (size_t i = 0; i < results.size(); i++)
+                    assert(results[i] == 2 * static_cast<int>(i));
+            }
+
+            void testFuture() {
+                Future<int>::Ptr future = runAsync(new SumTask(100));
+                assert(future->get() == 5050);
+                assert(future->ready());
+            }
+        };
+    }
+}
+
+#endif
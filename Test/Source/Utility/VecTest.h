@@ -62,6 +62,8 @@ namespace TrenchBroom {
                 registerTestCase(&VecTest::testSubtractAndAssignVec3);
                 registerTestCase(&VecTest::testMultiplyAndAssignVec3WithScalar);
                 registerTestCase(&VecTest::testDivideAndAssignVec3ByScalar);
+                registerTestCase(&VecTest::testPointStatus);
+                registerTestCase(&VecTest::testIntersectBoundsWithRay);
             }
         public:
             void testConstructFromValidString() {
@@ -213,6 +215,45 @@ namespace TrenchBroom {
                 Vec3f v(2.0f, 36.0f, 4.0f);
                 assert((v /= 2.0f) == Vec3f(1.0f, 18.0f, 2.0f));
             }
+            
+            void testPointStatus() {
+                const Planef plane(Vec3f(1.0f, 1.0f, 0.0f).normalized(), 2.0f);
+                
+                Vec3f::List points;
+                for (size_t i = 0; i < 11; i++)
+                    points.push_back(Vec3f(static_cast<float>(i) * 0.5f, 0.5f, static_cast<float>(i)));
+                points.push_back(plane.normal * plane.distance);
+                
+                std::vector<PointStatus::Type> statuses(points.size());
+                pointStatus(plane, &points[0], points.size(), &statuses[0]);
+                for (size_t i = 0; i < points.size(); i++)
+                    assert(statuses[i] == plane.pointStatus(points[i]));
+                assert(statuses[0] == PointStatus::PSBelow);
+                assert(statuses[10] == PointStatus::PSAbove);
+                assert(statuses[11] == PointStatus::PSInside);
+            }
+
+            void testIntersectBoundsWithRay() {
+                std::vector<BBoxf> bounds;
+                bounds.push_back(BBoxf(Vec3f(4.0f, -1.0f, -1.0f), Vec3f(6.0f, 1.0f, 1.0f)));     // ahead of the origin
+                bounds.push_back(BBoxf(Vec3f(-6.0f, -1.0f, -1.0f), Vec3f(-4.0f, 1.0f, 1.0f)));   // behind the origin
+                bounds.push_back(BBoxf(Vec3f(4.0f, 2.0f, -1.0f), Vec3f(6.0f, 4.0f, 1.0f)));      // beside the ray
+                bounds.push_back(BBoxf(Vec3f(-1.0f, -1.0f, -1.0f), Vec3f(1.0f, 1.0f, 1.0f)));    // contains the origin
+                bounds.push_back(BBoxf(Vec3f(8.0f, 0.0f, -1.0f), Vec3f(9.0f, 2.0f, 1.0f)));      // touched by the ray
+                bounds.push_back(BBoxf(Vec3f(8.0f, -1.0f, 1.0f), Vec3f(9.0f, 1.0f, 2.0f)));      // touched by the ray
+
+                std::vector<const BBoxf*> pointers;
+                for (size_t i = 0; i < bounds.size(); i++)
+                    pointers.push_back(&bounds[i]);
+
+                const Rayf ray(Vec3f::Null, Vec3f::PosX);
+                std::vector<bool> hits;
+                intersectBoundsWithRay(ray, &pointers[0], pointers.size(), hits);
+
+                assert(hits.size() == bounds.size());
+                for (size_t i = 0; i < bounds.size(); i++)
+                    assert(hits[i] == !Math<float>::isnan(bounds[i].intersectWithRay(ray)));
+            }
         };
     }
 }
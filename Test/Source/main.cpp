@@ -23,11 +23,21 @@
 #include "Utility/FindIntegerPlanePointsTest.h"
 #include "Utility/MatTest.h"
 #include "Utility/PlaneTest.h"
+#include "Utility/ThreadPoolTest.h"
 #include "Utility/VecTest.h"
 
+#include <wx/init.h>
+
 int main(int argc, const char * argv[]) {
     using namespace TrenchBroom;
     
+    // the thread pool test creates wxThreads, which require the wx modules to be initialized
+    wxInitializer initializer;
+    if (!initializer.IsOk()) {
+        std::cerr << "Failed to initialize wxWidgets" << std::endl;
+        return 1;
+    }
+    
     VecMath::VecTest vecTest;
     vecTest.run();
     
@@ -37,6 +47,9 @@ int main(int argc, const char * argv[]) {
     VecMath::PlaneTest planeTest;
     planeTest.run();
     
+    Utility::ThreadPoolTest threadPoolTest;
+    threadPoolTest.run();
+    
     /*
     VecMath::FindIntegerPlanePointsTest planePointsTest;
     planePointsTest.run();